@@ -1794,6 +1794,8 @@ check_tuple_attribute(HeapCheckContext *ctx)
 				/* List of all valid compression method IDs */
 			case TOAST_PGLZ_COMPRESSION_ID:
 			case TOAST_LZ4_COMPRESSION_ID:
+			case TOAST_ZSTD_COMPRESSION_ID:
+			case TOAST_SEGMENTED_COMPRESSION_ID:
 				valid = true;
 				break;
 
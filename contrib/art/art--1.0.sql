@@ -0,0 +1,59 @@
+/* contrib/art/art--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION art" to load this file. \quit
+
+CREATE FUNCTION arthandler(internal)
+RETURNS index_am_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- Access method
+CREATE ACCESS METHOD art TYPE INDEX HANDLER arthandler;
+COMMENT ON ACCESS METHOD art IS 'adaptive radix tree index access method';
+
+-- Key encoding functions
+
+CREATE FUNCTION art_int4_key(int4)
+RETURNS bytea
+AS 'MODULE_PATHNAME'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION art_int8_key(int8)
+RETURNS bytea
+AS 'MODULE_PATHNAME'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION art_uuid_key(uuid)
+RETURNS bytea
+AS 'MODULE_PATHNAME'
+LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- Opclasses
+
+CREATE OPERATOR CLASS int4_ops
+DEFAULT FOR TYPE int4 USING art AS
+	OPERATOR	1	<(int4, int4),
+	OPERATOR	2	<=(int4, int4),
+	OPERATOR	3	=(int4, int4),
+	OPERATOR	4	>=(int4, int4),
+	OPERATOR	5	>(int4, int4),
+	FUNCTION	1	art_int4_key(int4);
+
+CREATE OPERATOR CLASS int8_ops
+DEFAULT FOR TYPE int8 USING art AS
+	OPERATOR	1	<(int8, int8),
+	OPERATOR	2	<=(int8, int8),
+	OPERATOR	3	=(int8, int8),
+	OPERATOR	4	>=(int8, int8),
+	OPERATOR	5	>(int8, int8),
+	FUNCTION	1	art_int8_key(int8);
+
+CREATE OPERATOR CLASS uuid_ops
+DEFAULT FOR TYPE uuid USING art AS
+	OPERATOR	1	<(uuid, uuid),
+	OPERATOR	2	<=(uuid, uuid),
+	OPERATOR	3	=(uuid, uuid),
+	OPERATOR	4	>=(uuid, uuid),
+	OPERATOR	5	>(uuid, uuid),
+	FUNCTION	1	art_uuid_key(uuid);
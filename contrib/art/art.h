@@ -0,0 +1,302 @@
+/*-------------------------------------------------------------------------
+ *
+ * art.h
+ *	  Header for adaptive radix tree index.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/art.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _ART_H_
+#define _ART_H_
+
+#include "access/amapi.h"
+#include "access/generic_xlog.h"
+#include "access/itup.h"
+#include "access/xlog.h"
+#include "fmgr.h"
+#include "nodes/pathnodes.h"
+#include "storage/bufpage.h"
+
+/* Support procedures numbers */
+#define ART_KEY_PROC			1
+#define ART_NPROC				1
+
+/*
+ * Scan strategies.  These are the same as btree's, since keys are kept in
+ * the order of their binary encoding, which must match the type's btree
+ * ordering.
+ */
+#define ART_NSTRATEGIES			5
+
+/* Opaque for art pages */
+typedef struct ArtPageOpaqueData
+{
+	uint16		flags;			/* see bit definitions below */
+	uint16		unused1;		/* placeholders to force maxaligning of size
+								 * of ArtPageOpaqueData and to place */
+	uint16		unused2;		/* art_page_id exactly at the end of page */
+	uint16		art_page_id;	/* for identification of ART indexes */
+} ArtPageOpaqueData;
+
+typedef ArtPageOpaqueData *ArtPageOpaque;
+
+/* ART page flags */
+#define ART_META		(1<<0)
+
+/*
+ * The page ID is for the convenience of pg_filedump and similar utilities,
+ * which otherwise would have a hard time telling pages of different index
+ * types apart.  It should be the last 2 bytes on the page.  This is more or
+ * less "free" due to alignment considerations.
+ */
+#define ART_PAGE_ID		0xFF84
+
+#define ArtPageGetOpaque(page) ((ArtPageOpaque) PageGetSpecialPointer(page))
+#define ArtPageIsMeta(page) \
+	((ArtPageGetOpaque(page)->flags & ART_META) != 0)
+
+/* Preserved page numbers */
+#define ART_METAPAGE_BLKNO		(0)
+
+/*
+ * Maximum length of the binary encoding of a key, as returned by the
+ * opclass's key procedure.  Inside the tree, every key is extended with the
+ * heap TID it points to, so that all entries are unique and duplicates of a
+ * key are stored in TID order.
+ */
+#define ART_MAX_KEY_LEN			32
+#define ART_TID_LEN				6
+#define ART_MAX_ENTRY_LEN		(ART_MAX_KEY_LEN + ART_TID_LEN)
+
+/* Metadata of art index */
+typedef struct ArtMetaPageData
+{
+	uint32		magicNumber;
+	uint16		keyLength;		/* length of encoded keys, or 0 if not yet
+								 * known */
+	ItemPointerData root;		/* root node, or invalid if the index is
+								 * empty */
+	uint64		changeCount;	/* bumped by every modification of the tree */
+} ArtMetaPageData;
+
+/* Magic number to distinguish art pages from others */
+#define ART_MAGIC_NUMBER (0xA27C0DED)
+
+#define ArtPageGetMeta(page)	((ArtMetaPageData *) PageGetContents(page))
+
+/*
+ * Items stored on data pages.  Every item starts with a kind byte.
+ *
+ * Inner nodes come in four sizes, chosen by their number of children, as in
+ * the in-memory radix tree in lib/radixtree.h.  Node4 and Node16 keep a
+ * sorted array of key bytes alongside their children; Node48 maps every key
+ * byte to a slot in its children array; Node256 is indexed by key byte
+ * directly.  A node's compressed path (the key bytes shared by all entries
+ * below it) is stored in full after the children, so no key needs to be
+ * fetched to verify it.
+ *
+ * Children are referenced by the TID of the item holding them, and can be
+ * either inner nodes or leaves.  A leaf holds a complete entry, that is the
+ * encoded key followed by the heap TID.  Leaves never move once written;
+ * inner nodes are rewritten in place where possible, and moved to another
+ * page if they outgrow their page.
+ */
+#define ART_NODE4		1
+#define ART_NODE16		2
+#define ART_NODE48		3
+#define ART_NODE256		4
+#define ART_LEAF		5
+
+typedef struct ArtNodeHeader
+{
+	uint8		kind;
+	uint8		prefixlen;		/* length of compressed path */
+	uint16		nchildren;
+} ArtNodeHeader;
+
+typedef struct ArtNode4
+{
+	ArtNodeHeader hdr;
+	uint8		keys[4];
+	ItemPointerData children[4];
+	/* compressed path follows */
+} ArtNode4;
+
+typedef struct ArtNode16
+{
+	ArtNodeHeader hdr;
+	uint8		keys[16];
+	ItemPointerData children[16];
+	/* compressed path follows */
+} ArtNode16;
+
+typedef struct ArtNode48
+{
+	ArtNodeHeader hdr;
+	uint8		slots[256];		/* slot number + 1, or 0 if no child */
+	ItemPointerData children[48];
+	/* compressed path follows */
+} ArtNode48;
+
+typedef struct ArtNode256
+{
+	ArtNodeHeader hdr;
+	ItemPointerData children[256];
+	/* compressed path follows */
+} ArtNode256;
+
+typedef struct ArtLeaf
+{
+	uint8		kind;
+	uint8		length;			/* length of entry */
+	uint8		entry[FLEXIBLE_ARRAY_MEMBER];
+} ArtLeaf;
+
+#define ARTLEAFHDRSZ	offsetof(ArtLeaf, entry)
+
+#define ArtItemGetKind(item)	(*((uint8 *) (item)))
+
+/*
+ * Expanded, in-memory representation of an inner node, used while modifying
+ * it.
+ */
+typedef struct ArtNodeData
+{
+	int			prefixlen;
+	uint8		prefix[ART_MAX_ENTRY_LEN];
+	int			nchildren;
+	ItemPointerData children[256];	/* invalid if no child */
+} ArtNodeData;
+
+typedef struct ArtState
+{
+	FmgrInfo	keyFn;
+	Oid			collation;
+} ArtState;
+
+/*
+ * State of a multi-page modification of the index.  The changes made through
+ * an ArtWriteState are WAL-logged as a single generic xlog record, unless the
+ * caller splits them with ArtWriteContinue() because they touch more pages
+ * than one record can hold; the tree must be consistent after each record.
+ * The metapage is always the first buffer registered, and its exclusive
+ * lock, held until the modification is done, serializes modifications.
+ * Every record bumps the metapage's changeCount, which is how scans, which
+ * lock only the page they read from, notice that the tree changed under
+ * them.
+ */
+typedef struct ArtWriteState
+{
+	Relation	index;
+	bool		building;		/* index build, not WAL-logged per record */
+	GenericXLogState *xlog;
+	int			nbuffers;
+	Buffer		buffers[MAX_GENERIC_XLOG_PAGES];
+	Page		pages[MAX_GENERIC_XLOG_PAGES];
+} ArtWriteState;
+
+/* Number of matching entries an index scan collects at a time */
+#define ART_SCAN_BATCH			256
+
+/* Opaque data structure for art index scan */
+typedef struct ArtScanOpaqueData
+{
+	ArtState	state;
+	bool		isEmpty;		/* no entry can match the scan keys */
+	int			keylen;
+	uint8		lower[ART_MAX_KEY_LEN];
+	bool		haveLower;
+	bool		lowerInclusive;
+	uint8		upper[ART_MAX_KEY_LEN];
+	bool		haveUpper;
+	bool		upperInclusive;
+
+	/*
+	 * Matching heap TIDs are collected in batches of up to ART_SCAN_BATCH
+	 * entries.  Each batch after the first resumes after the last entry of
+	 * the previous one.
+	 */
+	bool		started;		/* bounds set up for the current scan keys */
+	bool		done;			/* no batches left to collect */
+	bool		haveResume;
+	uint8		resume[ART_MAX_ENTRY_LEN];
+	ItemPointerData *items;		/* TIDs of the current batch */
+	int			nitems;
+	int			curitem;
+} ArtScanOpaqueData;
+
+typedef ArtScanOpaqueData *ArtScanOpaque;
+
+/* artutils.c */
+extern void initArtState(ArtState *state, Relation index);
+extern int	ArtEncodeKey(ArtState *state, Datum value, uint8 *key);
+extern void ArtEncodeTid(ItemPointer tid, uint8 *dest);
+extern void ArtDecodeTid(const uint8 *src, ItemPointer tid);
+extern void ArtInitPage(Page page, uint16 flags);
+extern void ArtFillMetapage(Page metaPage);
+extern void ArtInitMetapage(Relation index, ForkNumber forknum);
+extern char *ArtReadItem(Relation index, ItemPointer ptr, Size *size);
+extern char *ArtTryReadItem(Relation index, ItemPointer ptr,
+							BlockNumber nblocks, Size *size);
+extern void ArtNodeExpand(const char *item, ArtNodeData *node);
+extern char *ArtNodeForm(ArtNodeData *node, Size *size);
+extern Size ArtNodeSize(int nchildren, int prefixlen);
+extern const uint8 *ArtNodeGetPrefix(const char *item);
+extern bool ArtNodeFindChild(const char *item, uint8 byte, ItemPointer child);
+extern void ArtNodeSetChild(char *item, uint8 byte, ItemPointer child);
+extern char *ArtFormLeaf(const uint8 *entry, int length, Size *size);
+
+extern void ArtWriteBegin(ArtWriteState *wstate, Relation index, bool building);
+extern bool ArtWriteCanGetPage(ArtWriteState *wstate, BlockNumber blkno);
+extern char *ArtWriteReadItem(ArtWriteState *wstate, ItemPointer ptr,
+							  Size *size);
+extern Page ArtWriteGetPage(ArtWriteState *wstate, BlockNumber blkno);
+extern Page ArtWriteGetTarget(ArtWriteState *wstate, Size needed,
+							  int nitems, BlockNumber *blkno);
+extern void ArtWriteContinue(ArtWriteState *wstate);
+extern void ArtWriteFinish(ArtWriteState *wstate);
+extern void ArtWriteAbort(ArtWriteState *wstate);
+extern OffsetNumber ArtPageAddItem(Page page, const char *item, Size size);
+
+/* artinsert.c */
+extern void ArtInsertEntry(Relation index, const uint8 *entry, int keylen,
+						   bool building);
+
+/* artvacuum.c */
+extern int	ArtDeleteEntries(Relation index, const uint8 *entries,
+							 int nentries);
+
+/* artvalidate.c */
+extern bool artvalidate(Oid opclassoid);
+
+/* index access method interface functions */
+extern bool artinsert(Relation index, Datum *values, bool *isnull,
+					  ItemPointer ht_ctid, Relation heapRel,
+					  IndexUniqueCheck checkUnique,
+					  bool indexUnchanged,
+					  struct IndexInfo *indexInfo);
+extern IndexScanDesc artbeginscan(Relation r, int nkeys, int norderbys);
+extern bool artgettuple(IndexScanDesc scan, ScanDirection dir);
+extern int64 artgetbitmap(IndexScanDesc scan, TIDBitmap *tbm);
+extern void artrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+					  ScanKey orderbys, int norderbys);
+extern void artendscan(IndexScanDesc scan);
+extern IndexBuildResult *artbuild(Relation heap, Relation index,
+								  struct IndexInfo *indexInfo);
+extern void artbuildempty(Relation index);
+extern IndexBulkDeleteResult *artbulkdelete(IndexVacuumInfo *info,
+											IndexBulkDeleteResult *stats, IndexBulkDeleteCallback callback,
+											void *callback_state);
+extern IndexBulkDeleteResult *artvacuumcleanup(IndexVacuumInfo *info,
+											   IndexBulkDeleteResult *stats);
+extern bytea *artoptions(Datum reloptions, bool validate);
+extern void artcostestimate(PlannerInfo *root, IndexPath *path,
+							double loop_count, Cost *indexStartupCost,
+							Cost *indexTotalCost, Selectivity *indexSelectivity,
+							double *indexCorrelation, double *indexPages);
+
+#endif
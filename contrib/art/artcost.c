@@ -0,0 +1,58 @@
+/*-------------------------------------------------------------------------
+ *
+ * artcost.c
+ *		Cost estimate function for art indexes.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/artcost.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "art.h"
+#include "optimizer/optimizer.h"
+#include "utils/selfuncs.h"
+
+/*
+ * Estimate cost of art index scan.
+ */
+void
+artcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
+				Cost *indexStartupCost, Cost *indexTotalCost,
+				Selectivity *indexSelectivity, double *indexCorrelation,
+				double *indexPages)
+{
+	IndexOptInfo *index = path->indexinfo;
+	GenericCosts costs = {0};
+	Cost		descentCost;
+
+	/* As in btcostestimate, count only the metapage as non-leaf */
+	costs.numNonLeafPages = 1;
+
+	/* Use generic estimate */
+	genericcostestimate(root, path, loop_count, &costs);
+
+	/*
+	 * Add a CPU-cost component to represent the costs of the initial descent.
+	 * Each level of the tree consumes at least one key byte, and nodes have
+	 * up to 256 children, so this is about log256(N) node visits; charge one
+	 * cpu_operator_cost per visit, as btcostestimate charges per comparison.
+	 */
+	if (index->tuples > 1)
+	{
+		descentCost = ceil(log(index->tuples) / log(256.0)) * cpu_operator_cost;
+		costs.indexStartupCost += descentCost;
+		costs.indexTotalCost += costs.num_sa_scans * descentCost;
+	}
+
+	*indexStartupCost = costs.indexStartupCost;
+	*indexTotalCost = costs.indexTotalCost;
+	*indexSelectivity = costs.indexSelectivity;
+	*indexCorrelation = costs.indexCorrelation;
+	*indexPages = costs.numIndexPages;
+}
@@ -0,0 +1,467 @@
+/*-------------------------------------------------------------------------
+ *
+ * artinsert.c
+ *		Adaptive radix tree index build and insert functions.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/artinsert.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/generic_xlog.h"
+#include "access/tableam.h"
+#include "access/xloginsert.h"
+#include "art.h"
+#include "nodes/execnodes.h"
+#include "storage/bufmgr.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+PG_MODULE_MAGIC_EXT(
+					.name = "art",
+					.version = PG_VERSION
+);
+
+/*
+ * State of art index build.
+ */
+typedef struct
+{
+	ArtState	artstate;		/* art index state */
+	int64		indtuples;		/* total number of tuples indexed */
+	MemoryContext tmpCtx;		/* temporary memory context reset after each
+								 * tuple */
+} ArtBuildState;
+
+/*
+ * Make 'newchild' the child for key byte 'byte' of the node at *parent, or
+ * the root if *parent is invalid.
+ */
+static void
+artReplaceChild(ArtWriteState *wstate, ItemPointer parent, uint8 byte,
+				ItemPointer newchild)
+{
+	Page		page;
+	ItemId		iid;
+
+	if (!ItemPointerIsValid(parent))
+	{
+		ArtPageGetMeta(wstate->pages[0])->root = *newchild;
+		return;
+	}
+
+	page = ArtWriteGetPage(wstate, ItemPointerGetBlockNumber(parent));
+	iid = PageGetItemId(page, ItemPointerGetOffsetNumber(parent));
+	ArtNodeSetChild((char *) PageGetItem(page, iid), byte, newchild);
+}
+
+/*
+ * Insert an entry (the encoded key followed by the encoded heap TID) into
+ * the tree.  'keylen' is the length of the key part.
+ *
+ * The whole insertion happens while holding the metapage lock, and is
+ * WAL-logged as a single record touching at most four pages: the metapage,
+ * the page receiving new items, the page of the node being changed, and the
+ * page of its parent.
+ */
+void
+ArtInsertEntry(Relation index, const uint8 *entry, int keylen, bool building)
+{
+	ArtWriteState wstate;
+	ArtMetaPageData *meta;
+	int			length = keylen + ART_TID_LEN;
+	char	   *leafitem;
+	Size		leafsize;
+	ItemPointerData parent;
+	uint8		parentbyte = 0;
+	ItemPointerData cur;
+	int			depth = 0;
+	ArtNodeData node;
+	char	   *nodeitem;
+	Size		nodesize;
+	Page		page;
+	BlockNumber blkno;
+	OffsetNumber offnum;
+	ItemPointerData leafptr;
+	ItemPointerData nodeptr;
+
+	ArtWriteBegin(&wstate, index, building);
+	meta = ArtPageGetMeta(wstate.pages[0]);
+
+	if (meta->keyLength == 0)
+		meta->keyLength = keylen;
+	else if (meta->keyLength != keylen)
+		elog(ERROR, "art key procedure returned a key of %d bytes, expected %u",
+			 keylen, meta->keyLength);
+
+	leafitem = ArtFormLeaf(entry, length, &leafsize);
+
+	if (!ItemPointerIsValid(&meta->root))
+	{
+		/* Empty tree: make a root node with the new leaf as its only child */
+		memset(&node, 0, sizeof(node));
+		for (int i = 0; i < 256; i++)
+			ItemPointerSetInvalid(&node.children[i]);
+		node.prefixlen = 0;
+		node.nchildren = 1;
+
+		page = ArtWriteGetTarget(&wstate,
+								 MAXALIGN(leafsize) +
+								 MAXALIGN(ArtNodeSize(1, 0)),
+								 2, &blkno);
+		offnum = ArtPageAddItem(page, leafitem, leafsize);
+		ItemPointerSet(&node.children[entry[0]], blkno, offnum);
+
+		nodeitem = ArtNodeForm(&node, &nodesize);
+		offnum = ArtPageAddItem(page, nodeitem, nodesize);
+		ItemPointerSet(&meta->root, blkno, offnum);
+
+		ArtWriteFinish(&wstate);
+		return;
+	}
+
+	ItemPointerSetInvalid(&parent);
+	cur = meta->root;
+
+	for (;;)
+	{
+		char	   *item;
+		Size		itemsize;
+		const uint8 *prefix;
+		int			prefixlen;
+		ItemPointerData child;
+		int			i;
+
+		item = ArtReadItem(index, &cur, &itemsize);
+
+		if (ArtItemGetKind(item) == ART_LEAF)
+		{
+			ArtLeaf    *leaf = (ArtLeaf *) item;
+
+			if (leaf->length != length)
+				elog(ERROR, "art leaf at (%u,%u) has length %u, expected %d",
+					 ItemPointerGetBlockNumber(&cur),
+					 ItemPointerGetOffsetNumber(&cur),
+					 leaf->length, length);
+
+			for (i = depth; i < length; i++)
+			{
+				if (leaf->entry[i] != entry[i])
+					break;
+			}
+
+			if (i >= length)
+			{
+				/* The very same entry is already present */
+				ArtWriteAbort(&wstate);
+				return;
+			}
+
+			/*
+			 * Replace the leaf with a node holding both it and the new leaf,
+			 * whose compressed path is the part the two entries share.
+			 */
+			memset(&node, 0, sizeof(node));
+			for (int j = 0; j < 256; j++)
+				ItemPointerSetInvalid(&node.children[j]);
+			node.prefixlen = i - depth;
+			memcpy(node.prefix, entry + depth, node.prefixlen);
+			node.nchildren = 2;
+			node.children[leaf->entry[i]] = cur;
+
+			page = ArtWriteGetTarget(&wstate,
+									 MAXALIGN(leafsize) +
+									 MAXALIGN(ArtNodeSize(2, node.prefixlen)),
+									 2, &blkno);
+			offnum = ArtPageAddItem(page, leafitem, leafsize);
+			ItemPointerSet(&node.children[entry[i]], blkno, offnum);
+
+			nodeitem = ArtNodeForm(&node, &nodesize);
+			offnum = ArtPageAddItem(page, nodeitem, nodesize);
+			ItemPointerSet(&nodeptr, blkno, offnum);
+
+			artReplaceChild(&wstate, &parent, parentbyte, &nodeptr);
+
+			ArtWriteFinish(&wstate);
+			return;
+		}
+
+		prefix = ArtNodeGetPrefix(item);
+		prefixlen = ((ArtNodeHeader *) item)->prefixlen;
+
+		for (i = 0; i < prefixlen; i++)
+		{
+			if (prefix[i] != entry[depth + i])
+				break;
+		}
+
+		if (i < prefixlen)
+		{
+			ArtNodeData oldnode;
+			char	   *olditem;
+			Size		oldsize;
+			Page		curpage;
+
+			/*
+			 * The new entry diverges from the compressed path of this node.
+			 * Put a new node in its place, whose compressed path is the part
+			 * they share, and which has the existing node and the new leaf as
+			 * its children.  The existing node keeps only the remainder of
+			 * its compressed path, which makes it smaller, so it can always
+			 * be rewritten in place.
+			 */
+			memset(&node, 0, sizeof(node));
+			for (int j = 0; j < 256; j++)
+				ItemPointerSetInvalid(&node.children[j]);
+			node.prefixlen = i;
+			memcpy(node.prefix, prefix, i);
+			node.nchildren = 2;
+			node.children[prefix[i]] = cur;
+
+			page = ArtWriteGetTarget(&wstate,
+									 MAXALIGN(leafsize) +
+									 MAXALIGN(ArtNodeSize(2, node.prefixlen)),
+									 2, &blkno);
+			offnum = ArtPageAddItem(page, leafitem, leafsize);
+			ItemPointerSet(&node.children[entry[depth + i]], blkno, offnum);
+
+			nodeitem = ArtNodeForm(&node, &nodesize);
+			offnum = ArtPageAddItem(page, nodeitem, nodesize);
+			ItemPointerSet(&nodeptr, blkno, offnum);
+
+			ArtNodeExpand(item, &oldnode);
+			oldnode.prefixlen = prefixlen - i - 1;
+			memmove(oldnode.prefix, oldnode.prefix + i + 1, oldnode.prefixlen);
+			olditem = ArtNodeForm(&oldnode, &oldsize);
+
+			curpage = ArtWriteGetPage(&wstate, ItemPointerGetBlockNumber(&cur));
+			if (!PageIndexTupleOverwrite(curpage,
+										 ItemPointerGetOffsetNumber(&cur),
+										 olditem, oldsize))
+				elog(ERROR, "failed to shorten art node in index \"%s\"",
+					 RelationGetRelationName(index));
+
+			artReplaceChild(&wstate, &parent, parentbyte, &nodeptr);
+
+			ArtWriteFinish(&wstate);
+			return;
+		}
+
+		depth += prefixlen;
+		Assert(depth < length);
+
+		if (ArtNodeFindChild(item, entry[depth], &child))
+		{
+			/* Descend */
+			parent = cur;
+			parentbyte = entry[depth];
+			cur = child;
+			depth++;
+			pfree(item);
+			continue;
+		}
+
+		/*
+		 * No child for this key byte yet, so add the new leaf to this node.
+		 * That can make the node switch to a larger kind.  If there's room
+		 * for that on its page, rewrite it in place, pointing at a
+		 * placeholder for the new child until we know where the leaf goes.
+		 * Otherwise, move the node to a new place and point its parent
+		 * there.
+		 */
+		ArtNodeExpand(item, &node);
+		node.nchildren++;
+		{
+			Page		curpage;
+			ItemId		iid;
+			Size		oldsize;
+
+			curpage = ArtWriteGetPage(&wstate, ItemPointerGetBlockNumber(&cur));
+			iid = PageGetItemId(curpage, ItemPointerGetOffsetNumber(&cur));
+			oldsize = ItemIdGetLength(iid);
+			nodesize = ArtNodeSize(node.nchildren, node.prefixlen);
+
+			if (MAXALIGN(nodesize) <=
+				MAXALIGN(oldsize) + PageGetExactFreeSpace(curpage))
+			{
+				node.children[entry[depth]] = cur;	/* placeholder */
+				nodeitem = ArtNodeForm(&node, &nodesize);
+				if (!PageIndexTupleOverwrite(curpage,
+											 ItemPointerGetOffsetNumber(&cur),
+											 nodeitem, nodesize))
+					elog(ERROR, "failed to grow art node in index \"%s\"",
+						 RelationGetRelationName(index));
+
+				page = ArtWriteGetTarget(&wstate, MAXALIGN(leafsize), 1,
+										 &blkno);
+				offnum = ArtPageAddItem(page, leafitem, leafsize);
+				ItemPointerSet(&leafptr, blkno, offnum);
+
+				/* curpage's item may have moved while adding the leaf */
+				iid = PageGetItemId(curpage, ItemPointerGetOffsetNumber(&cur));
+				ArtNodeSetChild((char *) PageGetItem(curpage, iid),
+								entry[depth], &leafptr);
+			}
+			else
+			{
+				page = ArtWriteGetTarget(&wstate,
+										 MAXALIGN(leafsize) + MAXALIGN(nodesize),
+										 2, &blkno);
+				offnum = ArtPageAddItem(page, leafitem, leafsize);
+				ItemPointerSet(&node.children[entry[depth]], blkno, offnum);
+
+				nodeitem = ArtNodeForm(&node, &nodesize);
+				offnum = ArtPageAddItem(page, nodeitem, nodesize);
+				ItemPointerSet(&nodeptr, blkno, offnum);
+
+				PageIndexTupleDeleteNoCompact(curpage,
+											  ItemPointerGetOffsetNumber(&cur));
+
+				artReplaceChild(&wstate, &parent, parentbyte, &nodeptr);
+			}
+		}
+
+		ArtWriteFinish(&wstate);
+		return;
+	}
+}
+
+/*
+ * Form the entry for a heap tuple, returning its key length, or -1 if the
+ * value is NULL and thus not indexed.
+ */
+static int
+artFormEntry(ArtState *state, Datum value, bool isnull, ItemPointer tid,
+			 uint8 *entry)
+{
+	int			keylen;
+
+	if (isnull)
+		return -1;
+
+	keylen = ArtEncodeKey(state, value, entry);
+	ArtEncodeTid(tid, entry + keylen);
+
+	return keylen;
+}
+
+/*
+ * Per-tuple callback for table_index_build_scan.
+ */
+static void
+artBuildCallback(Relation index, ItemPointer tid, Datum *values,
+				 bool *isnull, bool tupleIsAlive, void *state)
+{
+	ArtBuildState *buildstate = (ArtBuildState *) state;
+	MemoryContext oldCtx;
+	uint8		entry[ART_MAX_ENTRY_LEN];
+	int			keylen;
+
+	oldCtx = MemoryContextSwitchTo(buildstate->tmpCtx);
+
+	keylen = artFormEntry(&buildstate->artstate, values[0], isnull[0], tid,
+						  entry);
+	if (keylen >= 0)
+	{
+		ArtInsertEntry(index, entry, keylen, true);
+		buildstate->indtuples += 1;
+	}
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(buildstate->tmpCtx);
+}
+
+/*
+ * Build a new art index.
+ */
+IndexBuildResult *
+artbuild(Relation heap, Relation index, IndexInfo *indexInfo)
+{
+	IndexBuildResult *result;
+	double		reltuples;
+	ArtBuildState buildstate;
+
+	if (RelationGetNumberOfBlocks(index) != 0)
+		elog(ERROR, "index \"%s\" already contains data",
+			 RelationGetRelationName(index));
+
+	/* Initialize the meta page */
+	ArtInitMetapage(index, MAIN_FORKNUM);
+
+	/* Initialize the art build state */
+	memset(&buildstate, 0, sizeof(buildstate));
+	initArtState(&buildstate.artstate, index);
+	buildstate.tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+											  "Art build temporary context",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	/*
+	 * Do the heap scan.  Entries are inserted one at a time, without writing
+	 * WAL for each of them.
+	 */
+	reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+									   artBuildCallback, &buildstate,
+									   NULL);
+
+	MemoryContextDelete(buildstate.tmpCtx);
+
+	/* WAL-log the whole index at once instead */
+	if (RelationNeedsWAL(index))
+		log_newpage_range(index, MAIN_FORKNUM,
+						  0, RelationGetNumberOfBlocks(index),
+						  true);
+
+	result = palloc_object(IndexBuildResult);
+	result->heap_tuples = reltuples;
+	result->index_tuples = buildstate.indtuples;
+
+	return result;
+}
+
+/*
+ * Build an empty art index in the initialization fork.
+ */
+void
+artbuildempty(Relation index)
+{
+	/* Initialize the meta page */
+	ArtInitMetapage(index, INIT_FORKNUM);
+}
+
+/*
+ * Insert new tuple to the art index.
+ */
+bool
+artinsert(Relation index, Datum *values, bool *isnull,
+		  ItemPointer ht_ctid, Relation heapRel,
+		  IndexUniqueCheck checkUnique,
+		  bool indexUnchanged,
+		  IndexInfo *indexInfo)
+{
+	ArtState	artstate;
+	MemoryContext oldCtx;
+	MemoryContext insertCtx;
+	uint8		entry[ART_MAX_ENTRY_LEN];
+	int			keylen;
+
+	insertCtx = AllocSetContextCreate(CurrentMemoryContext,
+									  "Art insert temporary context",
+									  ALLOCSET_DEFAULT_SIZES);
+
+	oldCtx = MemoryContextSwitchTo(insertCtx);
+
+	initArtState(&artstate, index);
+	keylen = artFormEntry(&artstate, values[0], isnull[0], ht_ctid, entry);
+	if (keylen >= 0)
+		ArtInsertEntry(index, entry, keylen, false);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextDelete(insertCtx);
+
+	return false;
+}
@@ -0,0 +1,522 @@
+/*-------------------------------------------------------------------------
+ *
+ * artscan.c
+ *		Adaptive radix tree index scan functions.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/artscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/relscan.h"
+#include "access/stratnum.h"
+#include "art.h"
+#include "executor/instrument_node.h"
+#include "miscadmin.h"
+#include "nodes/tidbitmap.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "utils/memutils.h"
+
+/*
+ * Number of times a batch is collected without locking the tree before we
+ * give up and hold the metapage lock while collecting it.
+ */
+#define ART_SCAN_OPTIMISTIC_TRIES	3
+
+/* Outcome of collecting entries from a subtree */
+typedef enum ArtSubtreeResult
+{
+	ART_SUBTREE_DONE,			/* went through the whole subtree */
+	ART_SUBTREE_FULL,			/* the batch filled up */
+	ART_SUBTREE_CHANGED,		/* came across an item that isn't there */
+} ArtSubtreeResult;
+
+/*
+ * Begin scan of art index.
+ */
+IndexScanDesc
+artbeginscan(Relation r, int nkeys, int norderbys)
+{
+	IndexScanDesc scan;
+	ArtScanOpaque so;
+
+	scan = RelationGetIndexScan(r, nkeys, norderbys);
+
+	so = (ArtScanOpaque) palloc0_object(ArtScanOpaqueData);
+	initArtState(&so->state, scan->indexRelation);
+	so->items = palloc_array(ItemPointerData, ART_SCAN_BATCH);
+
+	scan->opaque = so;
+
+	return scan;
+}
+
+/*
+ * Rescan an art index.
+ */
+void
+artrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+		  ScanKey orderbys, int norderbys)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+
+	so->started = false;
+	so->nitems = 0;
+	so->curitem = 0;
+
+	if (scankey && scan->numberOfKeys > 0)
+		memcpy(scan->keyData, scankey, scan->numberOfKeys * sizeof(ScanKeyData));
+}
+
+/*
+ * End scan of art index.
+ */
+void
+artendscan(IndexScanDesc scan)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+
+	pfree(so->items);
+	pfree(so);
+}
+
+/*
+ * Tighten the lower bound of the scan to 'key' if that's more restrictive.
+ */
+static void
+artSetLower(ArtScanOpaque so, const uint8 *key, bool inclusive)
+{
+	int			cmp = 0;
+
+	if (so->haveLower)
+		cmp = memcmp(key, so->lower, so->keylen);
+	if (!so->haveLower || cmp > 0 || (cmp == 0 && !inclusive))
+	{
+		memcpy(so->lower, key, so->keylen);
+		so->lowerInclusive = inclusive;
+		so->haveLower = true;
+	}
+}
+
+/*
+ * Tighten the upper bound of the scan to 'key' if that's more restrictive.
+ */
+static void
+artSetUpper(ArtScanOpaque so, const uint8 *key, bool inclusive)
+{
+	int			cmp = 0;
+
+	if (so->haveUpper)
+		cmp = memcmp(key, so->upper, so->keylen);
+	if (!so->haveUpper || cmp < 0 || (cmp == 0 && !inclusive))
+	{
+		memcpy(so->upper, key, so->keylen);
+		so->upperInclusive = inclusive;
+		so->haveUpper = true;
+	}
+}
+
+/*
+ * Turn the scan keys into a range of encoded keys.
+ */
+static void
+artPrepareBounds(IndexScanDesc scan)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+	ScanKey		skey = scan->keyData;
+	int			i;
+
+	so->isEmpty = false;
+	so->keylen = 0;
+	so->haveLower = false;
+	so->haveUpper = false;
+
+	for (i = 0; i < scan->numberOfKeys; i++, skey++)
+	{
+		uint8		key[ART_MAX_KEY_LEN];
+		int			len;
+
+		/* NULLs are not indexed, and all our operators are strict */
+		if (skey->sk_flags & SK_ISNULL)
+		{
+			so->isEmpty = true;
+			return;
+		}
+
+		len = ArtEncodeKey(&so->state, skey->sk_argument, key);
+		if (so->keylen == 0)
+			so->keylen = len;
+		else if (so->keylen != len)
+			elog(ERROR, "art key procedure returned keys of different lengths");
+
+		switch (skey->sk_strategy)
+		{
+			case BTLessStrategyNumber:
+				artSetUpper(so, key, false);
+				break;
+			case BTLessEqualStrategyNumber:
+				artSetUpper(so, key, true);
+				break;
+			case BTEqualStrategyNumber:
+				artSetLower(so, key, true);
+				artSetUpper(so, key, true);
+				break;
+			case BTGreaterEqualStrategyNumber:
+				artSetLower(so, key, true);
+				break;
+			case BTGreaterStrategyNumber:
+				artSetLower(so, key, false);
+				break;
+			default:
+				elog(ERROR, "unrecognized strategy number: %d",
+					 skey->sk_strategy);
+		}
+	}
+
+	if (so->haveLower && so->haveUpper)
+	{
+		int			cmp = memcmp(so->lower, so->upper, so->keylen);
+
+		if (cmp > 0 || (cmp == 0 && !(so->lowerInclusive && so->upperInclusive)))
+			so->isEmpty = true;
+	}
+}
+
+/*
+ * Can the subtree whose entries all start with path[0 .. depth - 1] hold any
+ * entry within the scan's bounds, and after the entry the scan resumes from?
+ */
+static bool
+artPathInRange(ArtScanOpaque so, const uint8 *path, int depth)
+{
+	int			n = Min(depth, so->keylen);
+
+	if (so->haveLower && memcmp(path, so->lower, n) < 0)
+		return false;
+	if (so->haveUpper && memcmp(path, so->upper, n) > 0)
+		return false;
+	if (so->haveResume &&
+		memcmp(path, so->resume, Min(depth, so->keylen + ART_TID_LEN)) < 0)
+		return false;
+	return true;
+}
+
+/*
+ * Is a complete entry within the scan's bounds, and not yet returned by an
+ * earlier batch?
+ */
+static bool
+artEntryMatches(ArtScanOpaque so, const uint8 *entry)
+{
+	int			cmp;
+
+	if (so->haveLower)
+	{
+		cmp = memcmp(entry, so->lower, so->keylen);
+		if (cmp < 0 || (cmp == 0 && !so->lowerInclusive))
+			return false;
+	}
+	if (so->haveUpper)
+	{
+		cmp = memcmp(entry, so->upper, so->keylen);
+		if (cmp > 0 || (cmp == 0 && !so->upperInclusive))
+			return false;
+	}
+	if (so->haveResume &&
+		memcmp(entry, so->resume, so->keylen + ART_TID_LEN) <= 0)
+		return false;
+	return true;
+}
+
+/*
+ * Remember a matching heap TID.
+ */
+static void
+artAddItem(ArtScanOpaque so, ItemPointer tid)
+{
+	Assert(so->nitems < ART_SCAN_BATCH);
+
+	so->items[so->nitems++] = *tid;
+}
+
+/*
+ * Collect matching entries in the subtree at *ptr, whose entries all start
+ * with path[0 .. depth - 1].  Children are visited in key order, so the
+ * entries are collected in key order, and in heap TID order for equal keys.
+ *
+ * We only lock each page while copying an item from it, so the tree can be
+ * modified while we walk it.  When we come across an item that isn't there
+ * or doesn't fit where it was found, we give up on the batch, returning
+ * ART_SUBTREE_CHANGED; the caller must also check that the tree didn't
+ * change in ways we can't notice here.  'nblocks' is the size of the index
+ * before the walk started, which no valid child pointer can exceed.
+ *
+ * Returns ART_SUBTREE_FULL if the batch filled up, in which case so->resume
+ * is set to the last entry collected and the walk must stop.
+ */
+static ArtSubtreeResult
+artScanSubtree(IndexScanDesc scan, ItemPointer ptr, int depth, uint8 *path,
+			   BlockNumber nblocks)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+	char	   *item;
+	Size		itemsize;
+	ArtNodeHeader *hdr;
+	int			lo = 0;
+	int			hi = 255;
+	ItemPointerData child;
+	ArtSubtreeResult result = ART_SUBTREE_DONE;
+
+	CHECK_FOR_INTERRUPTS();
+
+	item = ArtTryReadItem(scan->indexRelation, ptr, nblocks, &itemsize);
+	if (item == NULL)
+		return ART_SUBTREE_CHANGED;
+
+	if (ArtItemGetKind(item) == ART_LEAF)
+	{
+		ArtLeaf    *leaf = (ArtLeaf *) item;
+
+		if (leaf->length != so->keylen + ART_TID_LEN ||
+			memcmp(leaf->entry, path, depth) != 0)
+			result = ART_SUBTREE_CHANGED;
+		else if (artEntryMatches(so, leaf->entry))
+		{
+			ItemPointerData tid;
+
+			ArtDecodeTid(leaf->entry + so->keylen, &tid);
+			artAddItem(so, &tid);
+
+			if (so->nitems >= ART_SCAN_BATCH)
+			{
+				memcpy(so->resume, leaf->entry, so->keylen + ART_TID_LEN);
+				so->haveResume = true;
+				result = ART_SUBTREE_FULL;
+			}
+		}
+		pfree(item);
+		return result;
+	}
+
+	hdr = (ArtNodeHeader *) item;
+	if (depth + hdr->prefixlen >= so->keylen + ART_TID_LEN)
+	{
+		pfree(item);
+		return ART_SUBTREE_CHANGED;
+	}
+	memcpy(path + depth, ArtNodeGetPrefix(item), hdr->prefixlen);
+	depth += hdr->prefixlen;
+
+	if (!artPathInRange(so, path, depth))
+	{
+		pfree(item);
+		return ART_SUBTREE_DONE;
+	}
+
+	/*
+	 * Only children whose key byte lies between the bounds' bytes at this
+	 * depth can hold matching entries, if the path so far is equal to the
+	 * bounds.  Likewise, children before the resume entry's byte hold only
+	 * entries that an earlier batch has returned.
+	 */
+	if (depth < so->keylen)
+	{
+		if (so->haveLower && memcmp(path, so->lower, depth) == 0)
+			lo = so->lower[depth];
+		if (so->haveUpper && memcmp(path, so->upper, depth) == 0)
+			hi = so->upper[depth];
+	}
+	if (so->haveResume && memcmp(path, so->resume, depth) == 0)
+		lo = Max(lo, so->resume[depth]);
+
+	if (lo == hi)
+	{
+		/* Just one key byte to look at, as in equality searches */
+		if (ArtNodeFindChild(item, lo, &child))
+		{
+			path[depth] = lo;
+			result = artScanSubtree(scan, &child, depth + 1, path, nblocks);
+		}
+	}
+	else if (lo < hi)
+	{
+		ArtNodeData *node = palloc_object(ArtNodeData);
+		int			b;
+
+		ArtNodeExpand(item, node);
+		for (b = lo; b <= hi && result == ART_SUBTREE_DONE; b++)
+		{
+			if (!ItemPointerIsValid(&node->children[b]))
+				continue;
+			path[depth] = b;
+			result = artScanSubtree(scan, &node->children[b], depth + 1, path,
+									nblocks);
+		}
+		pfree(node);
+	}
+
+	pfree(item);
+	return result;
+}
+
+/*
+ * Set up a scan for the current scan keys, before its first batch.
+ */
+static void
+artStartScan(IndexScanDesc scan)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+
+	so->nitems = 0;
+	so->curitem = 0;
+	so->haveResume = false;
+	so->started = true;
+
+	pgstat_count_index_scan(scan->indexRelation);
+	if (scan->instrument)
+		scan->instrument->nsearches++;
+
+	artPrepareBounds(scan);
+	so->done = (so->isEmpty || so->keylen == 0);
+}
+
+/*
+ * Collect the next batch of matching entries into so->items, and add them to
+ * the bitmap too if tbm isn't NULL.  so->done is set once the traversal has
+ * gone through the whole range.
+ *
+ * Modifications of the tree hold the metapage's exclusive lock while they
+ * change it, and bump its changeCount, also when replayed from WAL.  So we
+ * walk the tree without holding the metapage lock, and only keep the batch
+ * if changeCount is the same afterwards; otherwise we collect it again.
+ * Writers are never blocked by scans that way.  If the tree keeps changing,
+ * we end up holding the metapage's share lock while walking it, which is
+ * bounded by the batch size.
+ */
+static void
+artNextBatch(IndexScanDesc scan, TIDBitmap *tbm)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+	Relation	index = scan->indexRelation;
+	bool		haveResume = so->haveResume;
+	uint8		resume[ART_MAX_ENTRY_LEN];
+	ArtSubtreeResult result;
+
+	memcpy(resume, so->resume, sizeof(resume));
+
+	for (int attempt = 1;; attempt++)
+	{
+		bool		locked = (attempt > ART_SCAN_OPTIMISTIC_TRIES);
+		BlockNumber nblocks;
+		Buffer		metaBuffer;
+		ArtMetaPageData *meta;
+		ItemPointerData root;
+		uint16		keyLength;
+		uint64		changeCount;
+		bool		changed = false;
+
+		so->nitems = 0;
+		so->curitem = 0;
+		so->haveResume = haveResume;
+		memcpy(so->resume, resume, sizeof(resume));
+
+		metaBuffer = ReadBuffer(index, ART_METAPAGE_BLKNO);
+		LockBuffer(metaBuffer, BUFFER_LOCK_SHARE);
+		meta = ArtPageGetMeta(BufferGetPage(metaBuffer));
+
+		if (meta->magicNumber != ART_MAGIC_NUMBER)
+			elog(ERROR, "relation \"%s\" is not an art index",
+				 RelationGetRelationName(index));
+
+		root = meta->root;
+		keyLength = meta->keyLength;
+		changeCount = meta->changeCount;
+
+		if (!locked)
+			LockBuffer(metaBuffer, BUFFER_LOCK_UNLOCK);
+
+		/* The tree as of changeCount doesn't reference pages added later */
+		nblocks = RelationGetNumberOfBlocks(index);
+
+		if (ItemPointerIsValid(&root))
+		{
+			uint8		path[ART_MAX_ENTRY_LEN];
+
+			if (keyLength != so->keylen)
+				elog(ERROR, "art key procedure returned a key of %d bytes, expected %u",
+					 so->keylen, keyLength);
+
+			result = artScanSubtree(scan, &root, 0, path, nblocks);
+		}
+		else
+			result = ART_SUBTREE_DONE;
+
+		if (!locked)
+		{
+			LockBuffer(metaBuffer, BUFFER_LOCK_SHARE);
+			meta = ArtPageGetMeta(BufferGetPage(metaBuffer));
+			changed = (meta->changeCount != changeCount);
+		}
+		UnlockReleaseBuffer(metaBuffer);
+
+		if (result == ART_SUBTREE_CHANGED && locked)
+			elog(ERROR, "invalid item pointer in art index \"%s\"",
+				 RelationGetRelationName(index));
+		if (result != ART_SUBTREE_CHANGED && !changed)
+			break;
+	}
+
+	if (result == ART_SUBTREE_DONE)
+		so->done = true;
+	if (tbm)
+		tbm_add_tuples(tbm, so->items, so->nitems, false);
+}
+
+/*
+ * Fetch the next matching tuple, collecting another batch of matching heap
+ * TIDs when the current one is used up.
+ */
+bool
+artgettuple(IndexScanDesc scan, ScanDirection dir)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+
+	if (!so->started)
+		artStartScan(scan);
+
+	while (so->curitem >= so->nitems)
+	{
+		if (so->done)
+			return false;
+		artNextBatch(scan, NULL);
+	}
+
+	scan->xs_heaptid = so->items[so->curitem++];
+	scan->xs_recheck = false;
+
+	return true;
+}
+
+/*
+ * Insert all matching tuples into a bitmap.
+ */
+int64
+artgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
+{
+	ArtScanOpaque so = (ArtScanOpaque) scan->opaque;
+	int64		ntids = 0;
+
+	artStartScan(scan);
+	while (!so->done)
+	{
+		artNextBatch(scan, tbm);
+		ntids += so->nitems;
+	}
+
+	return ntids;
+}
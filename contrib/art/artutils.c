@@ -0,0 +1,1114 @@
+/*-------------------------------------------------------------------------
+ *
+ * artutils.c
+ *		Adaptive radix tree index utilities.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/artutils.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/amapi.h"
+#include "access/generic_xlog.h"
+#include "access/reloptions.h"
+#include "art.h"
+#include "commands/vacuum.h"
+#include "port/pg_bswap.h"
+#include "storage/bufmgr.h"
+#include "storage/freespace.h"
+#include "utils/uuid.h"
+#include "varatt.h"
+
+PG_FUNCTION_INFO_V1(arthandler);
+PG_FUNCTION_INFO_V1(art_int4_key);
+PG_FUNCTION_INFO_V1(art_int8_key);
+PG_FUNCTION_INFO_V1(art_uuid_key);
+
+/* Kind of relation options for art index */
+static relopt_kind art_relopt_kind;
+
+/*
+ * Module initialize function: ART indexes have no options of their own, but
+ * we need a relopt kind to reject any that are given.
+ */
+void
+_PG_init(void)
+{
+	art_relopt_kind = add_reloption_kind();
+}
+
+/*
+ * ART handler function: return IndexAmRoutine with access method parameters
+ * and callbacks.
+ */
+Datum
+arthandler(PG_FUNCTION_ARGS)
+{
+	static const IndexAmRoutine amroutine = {
+		.type = T_IndexAmRoutine,
+		.amstrategies = ART_NSTRATEGIES,
+		.amsupport = ART_NPROC,
+		.amoptsprocnum = 0,
+		.amcanorder = false,
+		.amcanorderbyop = false,
+		.amcanhash = false,
+		.amconsistentequality = false,
+		.amconsistentordering = false,
+		.amcanbackward = false,
+		.amcanunique = false,
+		.amcanmulticol = false,
+		.amoptionalkey = false,
+		.amsearcharray = false,
+		.amsearchnulls = false,
+		.amstorage = false,
+		.amclusterable = false,
+		.ampredlocks = false,
+		.amcanparallel = false,
+		.amcanbuildparallel = false,
+		.amcaninclude = false,
+		.amusemaintenanceworkmem = false,
+		.amparallelvacuumoptions =
+		VACUUM_OPTION_PARALLEL_BULKDEL | VACUUM_OPTION_PARALLEL_CLEANUP,
+		.amkeytype = InvalidOid,
+
+		.ambuild = artbuild,
+		.ambuildempty = artbuildempty,
+		.aminsert = artinsert,
+		.aminsertcleanup = NULL,
+		.ambulkdelete = artbulkdelete,
+		.amvacuumcleanup = artvacuumcleanup,
+		.amcanreturn = NULL,
+		.amcostestimate = artcostestimate,
+		.amgettreeheight = NULL,
+		.amoptions = artoptions,
+		.amproperty = NULL,
+		.ambuildphasename = NULL,
+		.amvalidate = artvalidate,
+		.amadjustmembers = NULL,
+		.ambeginscan = artbeginscan,
+		.amrescan = artrescan,
+		.amgettuple = artgettuple,
+		.amgetbitmap = artgetbitmap,
+		.amendscan = artendscan,
+		.ammarkpos = NULL,
+		.amrestrpos = NULL,
+		.amestimateparallelscan = NULL,
+		.aminitparallelscan = NULL,
+		.amparallelrescan = NULL,
+		.amtranslatestrategy = NULL,
+		.amtranslatecmptype = NULL,
+	};
+
+	PG_RETURN_POINTER(&amroutine);
+}
+
+/*
+ * Key encoding functions for the built-in opclasses.
+ *
+ * An opclass's key procedure must return a binary string of the same length
+ * for every value, whose unsigned byte-wise order matches the order of the
+ * type's btree opclass.
+ */
+Datum
+art_int4_key(PG_FUNCTION_ARGS)
+{
+	int32		value = PG_GETARG_INT32(0);
+	bytea	   *result = palloc(VARHDRSZ + sizeof(uint32));
+	uint32		key;
+
+	/* flip the sign bit so that negative values sort first */
+	key = pg_hton32((uint32) value ^ ((uint32) 1 << 31));
+	memcpy(VARDATA(result), &key, sizeof(uint32));
+	SET_VARSIZE(result, VARHDRSZ + sizeof(uint32));
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+Datum
+art_int8_key(PG_FUNCTION_ARGS)
+{
+	int64		value = PG_GETARG_INT64(0);
+	bytea	   *result = palloc(VARHDRSZ + sizeof(uint64));
+	uint64		key;
+
+	/* flip the sign bit so that negative values sort first */
+	key = pg_hton64((uint64) value ^ ((uint64) 1 << 63));
+	memcpy(VARDATA(result), &key, sizeof(uint64));
+	SET_VARSIZE(result, VARHDRSZ + sizeof(uint64));
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+Datum
+art_uuid_key(PG_FUNCTION_ARGS)
+{
+	pg_uuid_t  *value = PG_GETARG_UUID_P(0);
+	bytea	   *result = palloc(VARHDRSZ + UUID_LEN);
+
+	/* uuids are compared with memcmp() already */
+	memcpy(VARDATA(result), value->data, UUID_LEN);
+	SET_VARSIZE(result, VARHDRSZ + UUID_LEN);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+/*
+ * Fill ArtState structure for particular index.
+ */
+void
+initArtState(ArtState *state, Relation index)
+{
+	fmgr_info_copy(&state->keyFn,
+				   index_getprocinfo(index, 1, ART_KEY_PROC),
+				   CurrentMemoryContext);
+	state->collation = index->rd_indcollation[0];
+}
+
+/*
+ * Encode an indexed value into *key, which must have room for
+ * ART_MAX_KEY_LEN bytes.  Returns the length of the encoded key.
+ */
+int
+ArtEncodeKey(ArtState *state, Datum value, uint8 *key)
+{
+	bytea	   *encoded;
+	int			len;
+
+	encoded = DatumGetByteaPP(FunctionCall1Coll(&state->keyFn,
+												state->collation,
+												value));
+	len = VARSIZE_ANY_EXHDR(encoded);
+	if (len < 1 || len > ART_MAX_KEY_LEN)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("art key procedure returned a key of %d bytes",
+						len),
+				 errdetail("Keys must be between 1 and %d bytes long.",
+						   ART_MAX_KEY_LEN)));
+	memcpy(key, VARDATA_ANY(encoded), len);
+
+	return len;
+}
+
+/*
+ * Encode a heap TID so that entries for equal keys sort in TID order.
+ */
+void
+ArtEncodeTid(ItemPointer tid, uint8 *dest)
+{
+	BlockNumber blkno = ItemPointerGetBlockNumber(tid);
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(tid);
+
+	dest[0] = (uint8) (blkno >> 24);
+	dest[1] = (uint8) (blkno >> 16);
+	dest[2] = (uint8) (blkno >> 8);
+	dest[3] = (uint8) blkno;
+	dest[4] = (uint8) (offnum >> 8);
+	dest[5] = (uint8) offnum;
+}
+
+void
+ArtDecodeTid(const uint8 *src, ItemPointer tid)
+{
+	BlockNumber blkno;
+	OffsetNumber offnum;
+
+	blkno = ((BlockNumber) src[0] << 24) | ((BlockNumber) src[1] << 16) |
+		((BlockNumber) src[2] << 8) | (BlockNumber) src[3];
+	offnum = ((OffsetNumber) src[4] << 8) | (OffsetNumber) src[5];
+
+	ItemPointerSet(tid, blkno, offnum);
+}
+
+/*
+ * Initialize any page of an art index.
+ */
+void
+ArtInitPage(Page page, uint16 flags)
+{
+	ArtPageOpaque opaque;
+
+	PageInit(page, BLCKSZ, sizeof(ArtPageOpaqueData));
+
+	opaque = ArtPageGetOpaque(page);
+	opaque->flags = flags;
+	opaque->art_page_id = ART_PAGE_ID;
+}
+
+/*
+ * Fill in metapage for art index.
+ */
+void
+ArtFillMetapage(Page metaPage)
+{
+	ArtMetaPageData *metadata;
+
+	ArtInitPage(metaPage, ART_META);
+	metadata = ArtPageGetMeta(metaPage);
+	memset(metadata, 0, sizeof(ArtMetaPageData));
+	metadata->magicNumber = ART_MAGIC_NUMBER;
+	metadata->keyLength = 0;
+	ItemPointerSetInvalid(&metadata->root);
+	((PageHeader) metaPage)->pd_lower += sizeof(ArtMetaPageData);
+}
+
+/*
+ * Initialize metapage for art index.
+ */
+void
+ArtInitMetapage(Relation index, ForkNumber forknum)
+{
+	Buffer		metaBuffer;
+	Page		metaPage;
+	GenericXLogState *state;
+
+	/*
+	 * Make a new page; since it is first page it should be associated with
+	 * block number 0 (ART_METAPAGE_BLKNO).  No need to hold the extension
+	 * lock because there cannot be concurrent inserters yet.
+	 */
+	metaBuffer = ReadBufferExtended(index, forknum, P_NEW, RBM_NORMAL, NULL);
+	LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+	Assert(BufferGetBlockNumber(metaBuffer) == ART_METAPAGE_BLKNO);
+
+	/* Initialize contents of meta page */
+	state = GenericXLogStart(index);
+	metaPage = GenericXLogRegisterBuffer(state, metaBuffer,
+										 GENERIC_XLOG_FULL_IMAGE);
+	ArtFillMetapage(metaPage);
+	GenericXLogFinish(state);
+
+	UnlockReleaseBuffer(metaBuffer);
+}
+
+/*
+ * Parse reloptions for art index.  There are none, so this only serves to
+ * reject any options given.
+ */
+bytea *
+artoptions(Datum reloptions, bool validate)
+{
+	return (bytea *) build_reloptions(reloptions, validate,
+									  art_relopt_kind,
+									  sizeof(int32),
+									  NULL, 0);
+}
+
+/*
+ * Return a palloc'd copy of the item at *ptr.
+ *
+ * The caller must hold the metapage lock, so that the item can't be moved or
+ * removed concurrently.
+ */
+char *
+ArtReadItem(Relation index, ItemPointer ptr, Size *size)
+{
+	Buffer		buffer;
+	Page		page;
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(ptr);
+	ItemId		iid;
+	char	   *item;
+
+	buffer = ReadBuffer(index, ItemPointerGetBlockNumber(ptr));
+	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buffer);
+
+	if (offnum < FirstOffsetNumber || offnum > PageGetMaxOffsetNumber(page))
+		elog(ERROR, "invalid item pointer (%u,%u) in art index \"%s\"",
+			 ItemPointerGetBlockNumber(ptr), offnum,
+			 RelationGetRelationName(index));
+	iid = PageGetItemId(page, offnum);
+	if (!ItemIdIsNormal(iid))
+		elog(ERROR, "item (%u,%u) in art index \"%s\" is not in use",
+			 ItemPointerGetBlockNumber(ptr), offnum,
+			 RelationGetRelationName(index));
+
+	*size = ItemIdGetLength(iid);
+	item = palloc(*size);
+	memcpy(item, PageGetItem(page, iid), *size);
+
+	UnlockReleaseBuffer(buffer);
+
+	return item;
+}
+
+/*
+ * Node kind used for a node with the given number of children.
+ */
+static int
+ArtNodeKind(int nchildren)
+{
+	if (nchildren <= 4)
+		return ART_NODE4;
+	else if (nchildren <= 16)
+		return ART_NODE16;
+	else if (nchildren <= 48)
+		return ART_NODE48;
+	else
+		return ART_NODE256;
+}
+
+static Size
+ArtNodeKindSize(int kind)
+{
+	switch (kind)
+	{
+		case ART_NODE4:
+			return sizeof(ArtNode4);
+		case ART_NODE16:
+			return sizeof(ArtNode16);
+		case ART_NODE48:
+			return sizeof(ArtNode48);
+		case ART_NODE256:
+			return sizeof(ArtNode256);
+	}
+	elog(ERROR, "unrecognized art node kind: %d", kind);
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * Size of the item for a node with the given number of children and
+ * compressed path length.
+ */
+Size
+ArtNodeSize(int nchildren, int prefixlen)
+{
+	return ArtNodeKindSize(ArtNodeKind(nchildren)) + prefixlen;
+}
+
+/*
+ * Return the compressed path of a node item.
+ */
+const uint8 *
+ArtNodeGetPrefix(const char *item)
+{
+	return (const uint8 *) item + ArtNodeKindSize(ArtItemGetKind(item));
+}
+
+/*
+ * Is 'item' a well-formed node or leaf of 'size' bytes?
+ */
+static bool
+ArtItemIsValid(const char *item, Size size)
+{
+	const ArtNodeHeader *hdr = (const ArtNodeHeader *) item;
+	int			maxchildren;
+
+	if (size < sizeof(ArtNodeHeader))
+		return false;
+
+	switch (hdr->kind)
+	{
+		case ART_LEAF:
+			{
+				const ArtLeaf *leaf = (const ArtLeaf *) item;
+
+				return leaf->length <= ART_MAX_ENTRY_LEN &&
+					size == ARTLEAFHDRSZ + leaf->length;
+			}
+		case ART_NODE4:
+			maxchildren = 4;
+			break;
+		case ART_NODE16:
+			maxchildren = 16;
+			break;
+		case ART_NODE48:
+			maxchildren = 48;
+			break;
+		case ART_NODE256:
+			maxchildren = 256;
+			break;
+		default:
+			return false;
+	}
+
+	if (hdr->nchildren > maxchildren || hdr->prefixlen > ART_MAX_ENTRY_LEN ||
+		size != ArtNodeKindSize(hdr->kind) + hdr->prefixlen)
+		return false;
+
+	if (hdr->kind == ART_NODE48)
+	{
+		const ArtNode48 *n48 = (const ArtNode48 *) item;
+
+		for (int i = 0; i < 256; i++)
+		{
+			if (n48->slots[i] > 48)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Like ArtReadItem, but for callers that walk the tree without holding the
+ * metapage lock, so that *ptr may point to an item that has been removed
+ * since, or whose space has been reused for another one.  Returns NULL if
+ * there is no well-formed item at *ptr; block numbers at or beyond
+ * 'nblocks', which the caller got before reading the metapage, are treated
+ * likewise.  Otherwise the item is at least safe to look at, but whether it
+ * is still part of the tree must be checked with the metapage's
+ * changeCount.
+ */
+char *
+ArtTryReadItem(Relation index, ItemPointer ptr, BlockNumber nblocks,
+			   Size *size)
+{
+	BlockNumber blkno = ItemPointerGetBlockNumber(ptr);
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(ptr);
+	Buffer		buffer;
+	Page		page;
+	ItemId		iid;
+	char	   *item = NULL;
+
+	if (blkno == ART_METAPAGE_BLKNO || blkno >= nblocks)
+		return NULL;
+
+	buffer = ReadBuffer(index, blkno);
+	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buffer);
+
+	if (!PageIsNew(page) &&
+		offnum >= FirstOffsetNumber && offnum <= PageGetMaxOffsetNumber(page))
+	{
+		iid = PageGetItemId(page, offnum);
+		if (ItemIdIsNormal(iid) &&
+			ArtItemIsValid((char *) PageGetItem(page, iid),
+						   ItemIdGetLength(iid)))
+		{
+			*size = ItemIdGetLength(iid);
+			item = palloc(*size);
+			memcpy(item, PageGetItem(page, iid), *size);
+		}
+	}
+
+	UnlockReleaseBuffer(buffer);
+
+	return item;
+}
+
+/*
+ * Look up the child for the given key byte in a node item.  Returns false if
+ * there is none.
+ */
+bool
+ArtNodeFindChild(const char *item, uint8 byte, ItemPointer child)
+{
+	const ArtNodeHeader *hdr = (const ArtNodeHeader *) item;
+	int			i;
+
+	switch (hdr->kind)
+	{
+		case ART_NODE4:
+			{
+				const ArtNode4 *n4 = (const ArtNode4 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+				{
+					if (n4->keys[i] == byte)
+					{
+						*child = n4->children[i];
+						return true;
+					}
+				}
+				return false;
+			}
+		case ART_NODE16:
+			{
+				const ArtNode16 *n16 = (const ArtNode16 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+				{
+					if (n16->keys[i] == byte)
+					{
+						*child = n16->children[i];
+						return true;
+					}
+				}
+				return false;
+			}
+		case ART_NODE48:
+			{
+				const ArtNode48 *n48 = (const ArtNode48 *) item;
+
+				if (n48->slots[byte] == 0)
+					return false;
+				*child = n48->children[n48->slots[byte] - 1];
+				return true;
+			}
+		case ART_NODE256:
+			{
+				const ArtNode256 *n256 = (const ArtNode256 *) item;
+
+				if (!ItemPointerIsValid(&n256->children[byte]))
+					return false;
+				*child = n256->children[byte];
+				return true;
+			}
+	}
+	elog(ERROR, "unrecognized art node kind: %d", hdr->kind);
+	return false;				/* keep compiler quiet */
+}
+
+/*
+ * Replace the existing child for the given key byte in a node item.  This
+ * doesn't change the size of the item, so it can be done in place.
+ */
+void
+ArtNodeSetChild(char *item, uint8 byte, ItemPointer child)
+{
+	ArtNodeHeader *hdr = (ArtNodeHeader *) item;
+	int			i;
+
+	switch (hdr->kind)
+	{
+		case ART_NODE4:
+			{
+				ArtNode4   *n4 = (ArtNode4 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+				{
+					if (n4->keys[i] == byte)
+					{
+						n4->children[i] = *child;
+						return;
+					}
+				}
+				break;
+			}
+		case ART_NODE16:
+			{
+				ArtNode16  *n16 = (ArtNode16 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+				{
+					if (n16->keys[i] == byte)
+					{
+						n16->children[i] = *child;
+						return;
+					}
+				}
+				break;
+			}
+		case ART_NODE48:
+			{
+				ArtNode48  *n48 = (ArtNode48 *) item;
+
+				if (n48->slots[byte] != 0)
+				{
+					n48->children[n48->slots[byte] - 1] = *child;
+					return;
+				}
+				break;
+			}
+		case ART_NODE256:
+			{
+				ArtNode256 *n256 = (ArtNode256 *) item;
+
+				if (ItemPointerIsValid(&n256->children[byte]))
+				{
+					n256->children[byte] = *child;
+					return;
+				}
+				break;
+			}
+		default:
+			elog(ERROR, "unrecognized art node kind: %d", hdr->kind);
+	}
+	elog(ERROR, "art node has no child for key byte %u", byte);
+}
+
+/*
+ * Expand a node item into an ArtNodeData.
+ */
+void
+ArtNodeExpand(const char *item, ArtNodeData *node)
+{
+	const ArtNodeHeader *hdr = (const ArtNodeHeader *) item;
+	int			i;
+
+	node->prefixlen = hdr->prefixlen;
+	memcpy(node->prefix, ArtNodeGetPrefix(item), hdr->prefixlen);
+	node->nchildren = hdr->nchildren;
+	for (i = 0; i < 256; i++)
+		ItemPointerSetInvalid(&node->children[i]);
+
+	switch (hdr->kind)
+	{
+		case ART_NODE4:
+			{
+				const ArtNode4 *n4 = (const ArtNode4 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+					node->children[n4->keys[i]] = n4->children[i];
+				break;
+			}
+		case ART_NODE16:
+			{
+				const ArtNode16 *n16 = (const ArtNode16 *) item;
+
+				for (i = 0; i < hdr->nchildren; i++)
+					node->children[n16->keys[i]] = n16->children[i];
+				break;
+			}
+		case ART_NODE48:
+			{
+				const ArtNode48 *n48 = (const ArtNode48 *) item;
+
+				for (i = 0; i < 256; i++)
+				{
+					if (n48->slots[i] != 0)
+						node->children[i] = n48->children[n48->slots[i] - 1];
+				}
+				break;
+			}
+		case ART_NODE256:
+			{
+				const ArtNode256 *n256 = (const ArtNode256 *) item;
+
+				for (i = 0; i < 256; i++)
+					node->children[i] = n256->children[i];
+				break;
+			}
+		default:
+			elog(ERROR, "unrecognized art node kind: %d", hdr->kind);
+	}
+}
+
+/*
+ * Form a node item from an ArtNodeData, using the smallest node kind that
+ * can hold its children.  The returned item is palloc'd.
+ */
+char *
+ArtNodeForm(ArtNodeData *node, Size *size)
+{
+	int			kind = ArtNodeKind(node->nchildren);
+	char	   *item;
+	ArtNodeHeader *hdr;
+	int			n = 0;
+	int			i;
+
+	Assert(node->prefixlen <= ART_MAX_ENTRY_LEN);
+
+	*size = ArtNodeSize(node->nchildren, node->prefixlen);
+	item = palloc0(*size);
+	hdr = (ArtNodeHeader *) item;
+	hdr->kind = kind;
+	hdr->prefixlen = node->prefixlen;
+	hdr->nchildren = node->nchildren;
+
+	switch (kind)
+	{
+		case ART_NODE4:
+			{
+				ArtNode4   *n4 = (ArtNode4 *) item;
+
+				for (i = 0; i < 256; i++)
+				{
+					if (ItemPointerIsValid(&node->children[i]))
+					{
+						n4->keys[n] = i;
+						n4->children[n] = node->children[i];
+						n++;
+					}
+				}
+				break;
+			}
+		case ART_NODE16:
+			{
+				ArtNode16  *n16 = (ArtNode16 *) item;
+
+				for (i = 0; i < 256; i++)
+				{
+					if (ItemPointerIsValid(&node->children[i]))
+					{
+						n16->keys[n] = i;
+						n16->children[n] = node->children[i];
+						n++;
+					}
+				}
+				break;
+			}
+		case ART_NODE48:
+			{
+				ArtNode48  *n48 = (ArtNode48 *) item;
+
+				for (i = 0; i < 256; i++)
+				{
+					if (ItemPointerIsValid(&node->children[i]))
+					{
+						n48->children[n] = node->children[i];
+						n48->slots[i] = ++n;
+					}
+				}
+				break;
+			}
+		case ART_NODE256:
+			{
+				ArtNode256 *n256 = (ArtNode256 *) item;
+
+				for (i = 0; i < 256; i++)
+				{
+					n256->children[i] = node->children[i];
+					if (ItemPointerIsValid(&node->children[i]))
+						n++;
+				}
+				break;
+			}
+	}
+
+	if (n != node->nchildren)
+		elog(ERROR, "art node has %d children, expected %d",
+			 n, node->nchildren);
+
+	memcpy(item + ArtNodeKindSize(kind), node->prefix, node->prefixlen);
+
+	return item;
+}
+
+/*
+ * Form a palloc'd leaf item holding the given entry.
+ */
+char *
+ArtFormLeaf(const uint8 *entry, int length, Size *size)
+{
+	ArtLeaf    *leaf;
+
+	Assert(length <= ART_MAX_ENTRY_LEN);
+
+	*size = ARTLEAFHDRSZ + length;
+	leaf = palloc(*size);
+	leaf->kind = ART_LEAF;
+	leaf->length = length;
+	memcpy(leaf->entry, entry, length);
+
+	return (char *) leaf;
+}
+
+/*
+ * Add an item to a data page.  The caller must have checked that it fits.
+ */
+OffsetNumber
+ArtPageAddItem(Page page, const char *item, Size size)
+{
+	OffsetNumber offnum;
+
+	offnum = PageAddItem(page, item, size, InvalidOffsetNumber, false, false);
+	if (offnum == InvalidOffsetNumber)
+		elog(ERROR, "failed to add item to art index page");
+
+	return offnum;
+}
+
+/*
+ * Start a modification of the index.  This locks the metapage exclusively
+ * and registers it as the first page of the modification; its contents are
+ * available via wstate->pages[0].  Scans are kept out by a heavyweight lock
+ * on the metapage, which is held until the modification is finished.
+ *
+ * During an index build, the pages are modified directly and not WAL-logged
+ * one by one; artbuild() WAL-logs the whole index at the end instead.  Nobody
+ * else can see the index yet, so no heavyweight lock is needed either.
+ */
+void
+ArtWriteBegin(ArtWriteState *wstate, Relation index, bool building)
+{
+	Buffer		metaBuffer;
+
+	wstate->index = index;
+	wstate->building = building;
+	wstate->xlog = building ? NULL : GenericXLogStart(index);
+	wstate->nbuffers = 0;
+
+	metaBuffer = ReadBuffer(index, ART_METAPAGE_BLKNO);
+	LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+
+	wstate->buffers[0] = metaBuffer;
+	if (building)
+		wstate->pages[0] = BufferGetPage(metaBuffer);
+	else
+		wstate->pages[0] = GenericXLogRegisterBuffer(wstate->xlog,
+													 metaBuffer, 0);
+	wstate->nbuffers = 1;
+}
+
+static Page
+ArtWriteRegister(ArtWriteState *wstate, Buffer buffer, int flags)
+{
+	int			i = wstate->nbuffers;
+
+	if (i >= MAX_GENERIC_XLOG_PAGES)
+		elog(ERROR, "too many pages modified in art index \"%s\"",
+			 RelationGetRelationName(wstate->index));
+
+	wstate->buffers[i] = buffer;
+	if (wstate->building)
+		wstate->pages[i] = BufferGetPage(buffer);
+	else
+		wstate->pages[i] = GenericXLogRegisterBuffer(wstate->xlog, buffer,
+													 flags);
+	wstate->nbuffers++;
+
+	return wstate->pages[i];
+}
+
+/*
+ * Can ArtWriteGetPage() return the given page without going over the limit
+ * of pages in one WAL record?
+ */
+bool
+ArtWriteCanGetPage(ArtWriteState *wstate, BlockNumber blkno)
+{
+	for (int i = 0; i < wstate->nbuffers; i++)
+	{
+		if (BufferGetBlockNumber(wstate->buffers[i]) == blkno)
+			return true;
+	}
+	return wstate->nbuffers < MAX_GENERIC_XLOG_PAGES;
+}
+
+/*
+ * Return a palloc'd copy of the item at *ptr, as modified so far by this
+ * modification.
+ */
+char *
+ArtWriteReadItem(ArtWriteState *wstate, ItemPointer ptr, Size *size)
+{
+	for (int i = 1; i < wstate->nbuffers; i++)
+	{
+		if (BufferGetBlockNumber(wstate->buffers[i]) ==
+			ItemPointerGetBlockNumber(ptr))
+		{
+			Page		page = wstate->pages[i];
+			ItemId		iid;
+			char	   *item;
+
+			iid = PageGetItemId(page, ItemPointerGetOffsetNumber(ptr));
+			if (!ItemIdIsNormal(iid))
+				elog(ERROR, "item (%u,%u) in art index \"%s\" is not in use",
+					 ItemPointerGetBlockNumber(ptr),
+					 ItemPointerGetOffsetNumber(ptr),
+					 RelationGetRelationName(wstate->index));
+			*size = ItemIdGetLength(iid);
+			item = palloc(*size);
+			memcpy(item, PageGetItem(page, iid), *size);
+			return item;
+		}
+	}
+
+	return ArtReadItem(wstate->index, ptr, size);
+}
+
+/*
+ * Get a modifiable copy of the given page, locking and registering it if
+ * this modification hasn't done so already.
+ */
+Page
+ArtWriteGetPage(ArtWriteState *wstate, BlockNumber blkno)
+{
+	Buffer		buffer;
+	int			i;
+
+	for (i = 0; i < wstate->nbuffers; i++)
+	{
+		if (BufferGetBlockNumber(wstate->buffers[i]) == blkno)
+			return wstate->pages[i];
+	}
+
+	buffer = ReadBuffer(wstate->index, blkno);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+	return ArtWriteRegister(wstate, buffer, 0);
+}
+
+/*
+ * Get a modifiable page with room for 'nitems' new items whose MAXALIGN'd
+ * sizes add up to 'needed' bytes, and return its block number in *blkno.
+ *
+ * We use a page that the free space map says has room, as recorded by
+ * VACUUM, or else the last page of the index, and add a new page when that
+ * is full.
+ */
+Page
+ArtWriteGetTarget(ArtWriteState *wstate, Size needed, int nitems,
+				  BlockNumber *blkno)
+{
+	BlockNumber nblocks;
+	BlockNumber fsmblk;
+	Size		spaceNeeded = needed + nitems * sizeof(ItemIdData);
+	Buffer		buffer;
+	Page		page;
+	int			i;
+
+	/* First, try pages that VACUUM found to have free space */
+	fsmblk = GetPageWithFreeSpace(wstate->index, spaceNeeded);
+	while (fsmblk != InvalidBlockNumber)
+	{
+		Size		freespace;
+
+		for (i = 0; i < wstate->nbuffers; i++)
+		{
+			if (BufferGetBlockNumber(wstate->buffers[i]) == fsmblk)
+				break;
+		}
+
+		if (i < wstate->nbuffers)
+		{
+			page = wstate->pages[i];
+			if (PageGetFreeSpaceForMultipleTuples(page, nitems) >= needed)
+			{
+				*blkno = fsmblk;
+				return page;
+			}
+			freespace = PageGetExactFreeSpace(page);
+		}
+		else
+		{
+			buffer = ReadBuffer(wstate->index, fsmblk);
+			LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+			page = BufferGetPage(buffer);
+			if (!PageIsNew(page) && !ArtPageIsMeta(page) &&
+				PageGetFreeSpaceForMultipleTuples(page, nitems) >= needed)
+			{
+				*blkno = fsmblk;
+				return ArtWriteRegister(wstate, buffer, 0);
+			}
+			freespace = PageIsNew(page) ? 0 : PageGetExactFreeSpace(page);
+			UnlockReleaseBuffer(buffer);
+		}
+
+		/* The FSM was out of date; fix it and try another page */
+		fsmblk = RecordAndGetPageWithFreeSpace(wstate->index, fsmblk,
+											   freespace, spaceNeeded);
+	}
+
+	nblocks = RelationGetNumberOfBlocks(wstate->index);
+	if (nblocks > ART_METAPAGE_BLKNO + 1)
+	{
+		BlockNumber lastblk = nblocks - 1;
+
+		/* Use the last page if it's already part of this modification */
+		for (i = 0; i < wstate->nbuffers; i++)
+		{
+			if (BufferGetBlockNumber(wstate->buffers[i]) == lastblk)
+			{
+				page = wstate->pages[i];
+				if (!PageIsNew(page) &&
+					PageGetFreeSpaceForMultipleTuples(page, nitems) >= needed)
+				{
+					*blkno = lastblk;
+					return page;
+				}
+				break;
+			}
+		}
+
+		/* Otherwise look at it before registering it */
+		if (i >= wstate->nbuffers)
+		{
+			buffer = ReadBuffer(wstate->index, lastblk);
+			LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+			page = BufferGetPage(buffer);
+			if (!PageIsNew(page) &&
+				PageGetFreeSpaceForMultipleTuples(page, nitems) >= needed)
+			{
+				*blkno = lastblk;
+				return ArtWriteRegister(wstate, buffer, 0);
+			}
+			UnlockReleaseBuffer(buffer);
+		}
+	}
+
+	/* Must extend the file */
+	buffer = ExtendBufferedRel(BMR_REL(wstate->index), MAIN_FORKNUM, NULL,
+							   EB_LOCK_FIRST);
+	page = ArtWriteRegister(wstate, buffer, GENERIC_XLOG_FULL_IMAGE);
+	ArtInitPage(page, 0);
+	*blkno = BufferGetBlockNumber(buffer);
+
+	return page;
+}
+
+/*
+ * Finish a modification, WAL-logging it unless we're building the index,
+ * and release all its pages.
+ */
+void
+ArtWriteFinish(ArtWriteState *wstate)
+{
+	int			i;
+
+	ArtPageGetMeta(wstate->pages[0])->changeCount++;
+
+	if (wstate->building)
+	{
+		for (i = 0; i < wstate->nbuffers; i++)
+			MarkBufferDirty(wstate->buffers[i]);
+	}
+	else
+		GenericXLogFinish(wstate->xlog);
+
+	for (i = 0; i < wstate->nbuffers; i++)
+		UnlockReleaseBuffer(wstate->buffers[i]);
+	wstate->nbuffers = 0;
+}
+
+/*
+ * WAL-log the changes made so far as one record, and start a new one, for
+ * callers that modify more pages than fit in one record.  The tree must be
+ * consistent after each record, as it is all that's replayed in between.
+ * Pages other than the metapage are released, but the metapage stays
+ * locked, so that no other modification can come in between.
+ */
+void
+ArtWriteContinue(ArtWriteState *wstate)
+{
+	Buffer		metaBuffer = wstate->buffers[0];
+	int			i;
+
+	ArtPageGetMeta(wstate->pages[0])->changeCount++;
+
+	if (wstate->building)
+	{
+		for (i = 0; i < wstate->nbuffers; i++)
+			MarkBufferDirty(wstate->buffers[i]);
+	}
+	else
+		GenericXLogFinish(wstate->xlog);
+
+	for (i = 1; i < wstate->nbuffers; i++)
+		UnlockReleaseBuffer(wstate->buffers[i]);
+
+	if (wstate->building)
+	{
+		wstate->xlog = NULL;
+		wstate->pages[0] = BufferGetPage(metaBuffer);
+	}
+	else
+	{
+		wstate->xlog = GenericXLogStart(wstate->index);
+		wstate->pages[0] = GenericXLogRegisterBuffer(wstate->xlog,
+													 metaBuffer, 0);
+	}
+	wstate->nbuffers = 1;
+}
+
+/*
+ * Abandon a modification that made no changes, releasing its pages.
+ */
+void
+ArtWriteAbort(ArtWriteState *wstate)
+{
+	int			i;
+
+	if (!wstate->building)
+		GenericXLogAbort(wstate->xlog);
+
+	for (i = 0; i < wstate->nbuffers; i++)
+		UnlockReleaseBuffer(wstate->buffers[i]);
+	wstate->nbuffers = 0;
+}
@@ -0,0 +1,333 @@
+/*-------------------------------------------------------------------------
+ *
+ * artvacuum.c
+ *		Adaptive radix tree VACUUM functions.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/art/artvacuum.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "art.h"
+#include "commands/vacuum.h"
+#include "storage/bufmgr.h"
+#include "storage/freespace.h"
+
+
+/*
+ * Remove the child for key byte 'byte' from the node at *nodeptr.  The node
+ * only gets smaller, so it is rewritten in place.
+ */
+static void
+artRemoveChild(ArtWriteState *wstate, ItemPointer nodeptr, uint8 byte)
+{
+	Page		page;
+	ItemId		iid;
+	ArtNodeData node;
+	char	   *item;
+	Size		size;
+
+	page = ArtWriteGetPage(wstate, ItemPointerGetBlockNumber(nodeptr));
+	iid = PageGetItemId(page, ItemPointerGetOffsetNumber(nodeptr));
+	ArtNodeExpand((char *) PageGetItem(page, iid), &node);
+
+	Assert(ItemPointerIsValid(&node.children[byte]));
+	ItemPointerSetInvalid(&node.children[byte]);
+	node.nchildren--;
+
+	item = ArtNodeForm(&node, &size);
+	if (!PageIndexTupleOverwrite(page, ItemPointerGetOffsetNumber(nodeptr),
+								 item, size))
+		elog(ERROR, "failed to shrink art node in index \"%s\"",
+			 RelationGetRelationName(wstate->index));
+}
+
+/*
+ * Free the space of an item that the tree no longer references, starting a
+ * new WAL record if its page doesn't fit in the current one.
+ */
+static void
+artFreeItem(ArtWriteState *wstate, ItemPointer ptr)
+{
+	Page		page;
+
+	if (!ArtWriteCanGetPage(wstate, ItemPointerGetBlockNumber(ptr)))
+		ArtWriteContinue(wstate);
+	page = ArtWriteGetPage(wstate, ItemPointerGetBlockNumber(ptr));
+	PageIndexTupleDeleteNoCompact(page, ItemPointerGetOffsetNumber(ptr));
+}
+
+/*
+ * Remove an entry from the tree, if present.
+ *
+ * Inner nodes that would be left without children go away along with the
+ * entry: the highest of them is unlinked from its parent, or the tree made
+ * empty if that is the root, which is a single change of a single page.
+ * Only then are the items of the leaf and of the unlinked nodes freed,
+ * possibly in further WAL records.  The tree is consistent after each
+ * record; a crash before the last one only leaks the space of items that
+ * nothing points to.
+ *
+ * Nodes left with a single child are not merged into their parent, so the
+ * tree may have more levels than needed after many deletions.
+ */
+static bool
+artDeleteEntry(ArtWriteState *wstate, const uint8 *entry, int length)
+{
+	ArtMetaPageData *meta = ArtPageGetMeta(wstate->pages[0]);
+	ItemPointerData stack[ART_MAX_ENTRY_LEN];
+	uint8		bytes[ART_MAX_ENTRY_LEN];
+	int			nchildren[ART_MAX_ENTRY_LEN];
+	int			nstack = 0;
+	int			top;
+	ItemPointerData cur;
+	int			depth = 0;
+
+	if (!ItemPointerIsValid(&meta->root))
+		return false;
+
+	cur = meta->root;
+	for (;;)
+	{
+		char	   *item;
+		Size		itemsize;
+		ArtNodeHeader *hdr;
+		ItemPointerData child;
+		bool		found;
+
+		item = ArtWriteReadItem(wstate, &cur, &itemsize);
+
+		if (ArtItemGetKind(item) == ART_LEAF)
+		{
+			ArtLeaf    *leaf = (ArtLeaf *) item;
+
+			found = (leaf->length == length &&
+					 memcmp(leaf->entry, entry, length) == 0);
+			pfree(item);
+			if (!found)
+				return false;
+			break;
+		}
+
+		hdr = (ArtNodeHeader *) item;
+		found = (depth + hdr->prefixlen < length &&
+				 memcmp(ArtNodeGetPrefix(item), entry + depth,
+						hdr->prefixlen) == 0);
+		if (found)
+		{
+			depth += hdr->prefixlen;
+			found = ArtNodeFindChild(item, entry[depth], &child);
+		}
+		if (!found || nstack >= ART_MAX_ENTRY_LEN)
+		{
+			pfree(item);
+			return false;
+		}
+
+		stack[nstack] = cur;
+		bytes[nstack] = entry[depth];
+		nchildren[nstack] = hdr->nchildren;
+		nstack++;
+		pfree(item);
+		cur = child;
+		depth++;
+	}
+
+	/* The root is always an inner node, so the leaf has a parent */
+	Assert(nstack > 0);
+
+	/* Find the highest node that the removal leaves without children */
+	top = nstack;
+	while (top > 0 && nchildren[top - 1] == 1)
+		top--;
+
+	if (top == 0)
+	{
+		/* The root is empty, so the whole tree is */
+		ItemPointerSetInvalid(&meta->root);
+	}
+	else
+	{
+		if (!ArtWriteCanGetPage(wstate,
+								ItemPointerGetBlockNumber(&stack[top - 1])))
+			ArtWriteContinue(wstate);
+		artRemoveChild(wstate, &stack[top - 1], bytes[top - 1]);
+	}
+
+	/* Free the leaf, and the nodes that are no longer referenced */
+	artFreeItem(wstate, &cur);
+	while (nstack > top)
+		artFreeItem(wstate, &stack[--nstack]);
+
+	return true;
+}
+
+/*
+ * Remove a number of entries from the tree, and return how many of them were
+ * present.  The entries are stored ART_MAX_ENTRY_LEN bytes apart.  They are
+ * all removed under one lock of the metapage, and share WAL records as far
+ * as the pages they touch allow.
+ */
+int
+ArtDeleteEntries(Relation index, const uint8 *entries, int nentries)
+{
+	ArtWriteState wstate;
+	int			length;
+	int			ndeleted = 0;
+
+	ArtWriteBegin(&wstate, index, false);
+	length = ArtPageGetMeta(wstate.pages[0])->keyLength + ART_TID_LEN;
+
+	for (int i = 0; i < nentries; i++)
+	{
+		if (artDeleteEntry(&wstate, entries + i * ART_MAX_ENTRY_LEN, length))
+			ndeleted++;
+	}
+
+	if (ndeleted > 0)
+		ArtWriteFinish(&wstate);
+	else
+		ArtWriteAbort(&wstate);
+
+	return ndeleted;
+}
+
+/*
+ * Bulk deletion of all index entries pointing to a set of heap tuples.
+ * The set of target tuples is specified via a callback routine that tells
+ * whether any given heap tuple (identified by ItemPointer) is being deleted.
+ *
+ * Leaves never move, so we can find the dead ones by reading the pages in
+ * physical order, without locking the tree.  The dead leaves of each page
+ * are then removed together by regular descents, holding the metapage lock
+ * for the one page only.
+ * A NULL callback just counts the live entries.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+static IndexBulkDeleteResult *
+artVacuumScan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+			  IndexBulkDeleteCallback callback, void *callback_state)
+{
+	Relation	index = info->index;
+	BlockNumber blkno,
+				npages;
+	uint8	   *dead;
+	int			ndead;
+
+	if (stats == NULL)
+		stats = palloc0_object(IndexBulkDeleteResult);
+
+	/*
+	 * Iterate over the pages. We don't care about concurrently added pages,
+	 * they can't contain entries to delete.
+	 */
+	npages = RelationGetNumberOfBlocks(index);
+	dead = palloc(MaxIndexTuplesPerPage * ART_MAX_ENTRY_LEN);
+
+	for (blkno = ART_METAPAGE_BLKNO + 1; blkno < npages; blkno++)
+	{
+		Buffer		buffer;
+		Page		page;
+		OffsetNumber offnum,
+					maxoff;
+		Size		freespace;
+
+		vacuum_delay_point(false);
+
+		buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+									RBM_NORMAL, info->strategy);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+
+		if (PageIsNew(page))
+		{
+			UnlockReleaseBuffer(buffer);
+			continue;
+		}
+
+		ndead = 0;
+		maxoff = PageGetMaxOffsetNumber(page);
+		for (offnum = FirstOffsetNumber; offnum <= maxoff; offnum++)
+		{
+			ItemId		iid = PageGetItemId(page, offnum);
+			ArtLeaf    *leaf;
+			ItemPointerData tid;
+
+			if (!ItemIdIsNormal(iid))
+				continue;
+			leaf = (ArtLeaf *) PageGetItem(page, iid);
+			if (leaf->kind != ART_LEAF)
+				continue;
+
+			ArtDecodeTid(leaf->entry + leaf->length - ART_TID_LEN, &tid);
+			if (callback && callback(&tid, callback_state))
+			{
+				memcpy(dead + ndead * ART_MAX_ENTRY_LEN, leaf->entry,
+					   leaf->length);
+				ndead++;
+			}
+			else
+				stats->num_index_tuples += 1;
+		}
+		freespace = PageGetExactFreeSpace(page);
+		UnlockReleaseBuffer(buffer);
+
+		if (ndead > 0)
+		{
+			stats->tuples_removed += ArtDeleteEntries(index, dead, ndead);
+
+			/* Update free space with the effect of the deletions */
+			buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+										RBM_NORMAL, info->strategy);
+			LockBuffer(buffer, BUFFER_LOCK_SHARE);
+			freespace = PageGetExactFreeSpace(BufferGetPage(buffer));
+			UnlockReleaseBuffer(buffer);
+		}
+
+		/* Let new items go to this page */
+		RecordPageWithFreeSpace(index, blkno, freespace);
+	}
+
+	pfree(dead);
+
+	FreeSpaceMapVacuum(index);
+
+	stats->num_pages = RelationGetNumberOfBlocks(index);
+
+	return stats;
+}
+
+IndexBulkDeleteResult *
+artbulkdelete(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+			  IndexBulkDeleteCallback callback, void *callback_state)
+{
+	return artVacuumScan(info, stats, callback, callback_state);
+}
+
+/*
+ * Post-VACUUM cleanup.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+IndexBulkDeleteResult *
+artvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
+{
+	if (info->analyze_only)
+		return stats;
+
+	/*
+	 * If artbulkdelete was called, we need not do anything, just return the
+	 * stats from the latest artbulkdelete call.  If it wasn't called, we
+	 * still need to count the entries and record free space.
+	 */
+	if (stats == NULL)
+		stats = artVacuumScan(info, NULL, NULL, NULL);
+
+	return stats;
+}
@@ -0,0 +1,114 @@
+CREATE EXTENSION art;
+
+CREATE TABLE tst (
+	i	int4,
+	b	int8,
+	u	uuid
+);
+
+INSERT INTO tst SELECT i % 1000 - 500, i::int8 * 1000000007,
+	md5(i::text)::uuid FROM generate_series(1,2000) i;
+INSERT INTO tst VALUES (NULL, NULL, NULL);
+CREATE INDEX artidx_i ON tst USING art (i);
+CREATE INDEX artidx_b ON tst USING art (b);
+CREATE INDEX artidx_u ON tst USING art (u);
+
+-- No options are accepted
+CREATE INDEX artidx_bad ON tst USING art (i) WITH (fillfactor = 50);
+
+SET enable_seqscan=on;
+SET enable_bitmapscan=off;
+SET enable_indexscan=off;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i = -500;
+SELECT count(*) FROM tst WHERE i BETWEEN -3 AND 2;
+SELECT count(*) FROM tst WHERE i < -490;
+SELECT count(*) FROM tst WHERE i > 495 OR i <= -499;
+SELECT count(*) FROM tst WHERE b >= 1999000013930 AND b < 2000000014000;
+SELECT count(*) FROM tst WHERE u = md5('1234')::uuid;
+SELECT count(*) FROM tst WHERE u < '10000000-0000-0000-0000-000000000000';
+
+SET enable_seqscan=off;
+SET enable_bitmapscan=on;
+SET enable_indexscan=off;
+
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE i = 7;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE u < '10000000-0000-0000-0000-000000000000';
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i = -500;
+SELECT count(*) FROM tst WHERE i BETWEEN -3 AND 2;
+SELECT count(*) FROM tst WHERE i < -490;
+SELECT count(*) FROM tst WHERE i > 495 OR i <= -499;
+SELECT count(*) FROM tst WHERE b >= 1999000013930 AND b < 2000000014000;
+SELECT count(*) FROM tst WHERE u = md5('1234')::uuid;
+SELECT count(*) FROM tst WHERE u < '10000000-0000-0000-0000-000000000000';
+SELECT count(*) FROM tst WHERE i > 5 AND i < 5;
+SELECT count(*) FROM tst WHERE i = NULL::int4;
+SELECT count(*), count(DISTINCT ctid), sum(i) FROM tst WHERE i >= -400;
+
+SET enable_bitmapscan=off;
+SET enable_indexscan=on;
+
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE i = 7;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM tst WHERE b > 1999000013930;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i = -500;
+SELECT count(*) FROM tst WHERE i BETWEEN -3 AND 2;
+SELECT count(*) FROM tst WHERE i < -490;
+SELECT count(*) FROM tst WHERE b >= 1999000013930 AND b < 2000000014000;
+SELECT count(*) FROM tst WHERE u = md5('1234')::uuid;
+SELECT count(*) FROM tst WHERE u < '10000000-0000-0000-0000-000000000000';
+SELECT count(*) FROM tst WHERE i > 5 AND i < 5;
+SELECT count(*), count(DISTINCT ctid), sum(i) FROM tst WHERE i >= -400;
+SELECT count(*) FROM (SELECT * FROM tst WHERE i >= -400 LIMIT 300) s;
+
+DELETE FROM tst WHERE i % 3 = 0;
+VACUUM tst;
+INSERT INTO tst SELECT i % 1000 - 500, i::int8 * 1000000007,
+	md5(i::text)::uuid FROM generate_series(2001,3000) i;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i = 6;
+SELECT count(*) FROM tst WHERE i BETWEEN -3 AND 2;
+SELECT count(*) FROM tst WHERE b > 1999000013930;
+SELECT count(*) FROM tst WHERE u = md5('2500')::uuid;
+
+DELETE FROM tst;
+VACUUM tst;
+
+SELECT count(*) FROM tst WHERE i = 7;
+
+INSERT INTO tst SELECT i % 1000 - 500, i::int8 * 1000000007,
+	md5(i::text)::uuid FROM generate_series(1,2000) i;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE i BETWEEN -3 AND 2;
+
+VACUUM FULL tst;
+
+SELECT count(*) FROM tst WHERE i = 7;
+SELECT count(*) FROM tst WHERE b >= 1999000013930 AND b < 2000000014000;
+
+-- Try an unlogged table too
+
+CREATE UNLOGGED TABLE tstu (
+	i	int8
+);
+
+INSERT INTO tstu SELECT i FROM generate_series(1,2000) i;
+CREATE INDEX artidxu ON tstu USING art (i);
+
+SELECT count(*) FROM tstu WHERE i = 1234;
+SELECT count(*) FROM tstu WHERE i > 1990;
+
+DROP TABLE tst;
+DROP TABLE tstu;
+
+-- Check opclasses
+SELECT opcname, amvalidate(opc.oid)
+FROM pg_opclass opc JOIN pg_am am ON am.oid = opcmethod
+WHERE amname = 'art'
+ORDER BY 1;
@@ -0,0 +1,75 @@
+/* contrib/columnar/columnar--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION columnar" to load this file. \quit
+
+CREATE FUNCTION columnar_handler(internal)
+RETURNS table_am_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- Access method
+CREATE ACCESS METHOD columnar TYPE TABLE HANDLER columnar_handler;
+COMMENT ON ACCESS METHOD columnar IS 'column-oriented table access method';
+
+-- Metadata of the stripes, keyed by the tablespace and relfilenode of the
+-- table, with the database's default tablespace as zero as in pg_class
+CREATE TABLE stripe (
+	reltablespace oid NOT NULL,
+	relfilenumber oid NOT NULL,
+	stripe_id bigint NOT NULL,
+	row_count bigint NOT NULL,
+	chunk_group_count int NOT NULL,
+	chunk_group_row_limit int NOT NULL,
+	data_size bigint NOT NULL,
+	PRIMARY KEY (reltablespace, relfilenumber, stripe_id)
+);
+
+CREATE TABLE chunk (
+	reltablespace oid NOT NULL,
+	relfilenumber oid NOT NULL,
+	stripe_id bigint NOT NULL,
+	attnum smallint NOT NULL,
+	chunk_group int NOT NULL,
+	row_count int NOT NULL,
+	value_count int NOT NULL,
+	encoding "char" NOT NULL,
+	minimum bytea,
+	maximum bytea,
+	nulls bytea,
+	data bytea NOT NULL,
+	PRIMARY KEY (reltablespace, relfilenumber, stripe_id, attnum, chunk_group)
+);
+
+CREATE TABLE row_mask (
+	reltablespace oid NOT NULL,
+	relfilenumber oid NOT NULL,
+	stripe_id bigint NOT NULL,
+	row_number int NOT NULL,
+	new_tid tid,
+	PRIMARY KEY (reltablespace, relfilenumber, stripe_id, row_number)
+);
+
+REVOKE ALL ON stripe, chunk, row_mask FROM PUBLIC;
+
+CREATE FUNCTION compact(regclass)
+RETURNS bigint
+AS 'MODULE_PATHNAME', 'columnar_compact'
+LANGUAGE C STRICT PARALLEL UNSAFE;
+
+-- Remove the metadata of dropped tables, and of storage that was replaced
+CREATE FUNCTION drop_orphans()
+RETURNS event_trigger
+AS 'MODULE_PATHNAME', 'columnar_drop_orphans'
+LANGUAGE C
+SECURITY DEFINER
+SET search_path = pg_catalog, pg_temp;
+
+CREATE EVENT TRIGGER columnar_drop
+	ON sql_drop
+	EXECUTE FUNCTION drop_orphans();
+
+CREATE EVENT TRIGGER columnar_rewrite
+	ON ddl_command_end
+	WHEN TAG IN ('ALTER TABLE', 'REFRESH MATERIALIZED VIEW')
+	EXECUTE FUNCTION drop_orphans();
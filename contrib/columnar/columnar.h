@@ -0,0 +1,194 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar.h
+ *	  Header for the columnar table access method.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _COLUMNAR_H_
+#define _COLUMNAR_H_
+
+#include "access/htup_details.h"
+#include "access/skey.h"
+#include "executor/tuptable.h"
+#include "nodes/bitmapset.h"
+#include "nodes/pg_list.h"
+#include "port/atomics.h"
+#include "storage/itemptr.h"
+#include "storage/relfilelocator.h"
+#include "utils/relcache.h"
+#include "utils/snapshot.h"
+
+/*
+ * A columnar table consists of two parts:
+ *
+ * - The delta, which is the relation's main fork, stored in the heap format
+ *	 and accessed through the heap AM.  All new rows go there.
+ *
+ * - Stripes, which hold the rows moved out of the delta by compaction.  A
+ *	 stripe is divided into chunk groups of up to chunk_group_row_limit rows,
+ *	 and each column of a chunk group is stored, encoded, as one row of the
+ *	 columnar.chunk table, together with its minimum and maximum values.
+ *	 Stripes are never modified once written; a deleted row is recorded in
+ *	 columnar.row_mask instead.
+ *
+ * The metadata tables are keyed by the relation's tablespace and
+ * relfilenumber, so that anything that gives the relation new storage also
+ * starts it with no stripes.
+ */
+
+/* Limits of the columnar.stripe_row_limit and chunk_group_row_limit GUCs */
+#define COLUMNAR_MAX_STRIPE_ROWS			1000000
+#define COLUMNAR_MIN_CHUNK_GROUP_ROWS		1000
+#define COLUMNAR_MAX_CHUNK_GROUP_ROWS		100000
+
+extern PGDLLIMPORT int columnar_stripe_row_limit;
+extern PGDLLIMPORT int columnar_chunk_group_row_limit;
+
+/*
+ * Rows in stripes are identified by virtual TIDs, whose block numbers lie
+ * above those of any page of the delta.  Each stripe is given a range of
+ * block numbers large enough for the largest possible stripe.
+ */
+#define COLUMNAR_FIRST_STRIPE_BLOCK	((BlockNumber) 0x80000000)
+#define COLUMNAR_BLOCKS_PER_STRIPE \
+	((COLUMNAR_MAX_STRIPE_ROWS + MaxHeapTuplesPerPage - 1) / MaxHeapTuplesPerPage)
+#define COLUMNAR_MAX_STRIPE_ID \
+	((uint64) (MaxBlockNumber - COLUMNAR_FIRST_STRIPE_BLOCK) / \
+	 COLUMNAR_BLOCKS_PER_STRIPE - 1)
+
+static inline bool
+ColumnarTidIsStripeRow(ItemPointer tid)
+{
+	return ItemPointerGetBlockNumberNoCheck(tid) >= COLUMNAR_FIRST_STRIPE_BLOCK;
+}
+
+static inline void
+ColumnarStripeRowTid(ItemPointer tid, uint64 stripe_id, uint32 row)
+{
+	ItemPointerSet(tid,
+				   COLUMNAR_FIRST_STRIPE_BLOCK +
+				   stripe_id * COLUMNAR_BLOCKS_PER_STRIPE +
+				   row / MaxHeapTuplesPerPage,
+				   row % MaxHeapTuplesPerPage + 1);
+}
+
+static inline uint64
+ColumnarTidGetStripe(ItemPointer tid)
+{
+	return (ItemPointerGetBlockNumberNoCheck(tid) - COLUMNAR_FIRST_STRIPE_BLOCK) /
+		COLUMNAR_BLOCKS_PER_STRIPE;
+}
+
+static inline uint32
+ColumnarTidGetRow(ItemPointer tid)
+{
+	uint32		block;
+
+	block = (ItemPointerGetBlockNumberNoCheck(tid) - COLUMNAR_FIRST_STRIPE_BLOCK) %
+		COLUMNAR_BLOCKS_PER_STRIPE;
+	return block * MaxHeapTuplesPerPage +
+		ItemPointerGetOffsetNumberNoCheck(tid) - 1;
+}
+
+/* Encodings of chunk data, stored in columnar.chunk.encoding */
+#define COLUMNAR_ENCODING_PLAIN		'p'
+#define COLUMNAR_ENCODING_RLE		'r'
+#define COLUMNAR_ENCODING_DICT		'd'
+#define COLUMNAR_ENCODING_DELTA		'i'
+
+/* A row of columnar.stripe */
+typedef struct StripeMetadata
+{
+	uint64		stripe_id;
+	int64		row_count;
+	int32		chunk_group_count;
+	int32		chunk_group_row_limit;
+	int64		data_size;		/* total size of encoded chunk data */
+} StripeMetadata;
+
+/* A row of columnar.chunk */
+typedef struct ColumnChunk
+{
+	int32		row_count;		/* rows in the chunk group */
+	int32		value_count;	/* non-null values */
+	char		encoding;
+	bytea	   *minimum;		/* NULL if unknown */
+	bytea	   *maximum;
+	bytea	   *nulls;			/* bitmap of null rows, NULL if none */
+	Datum		data;			/* encoded values, possibly toasted */
+} ColumnChunk;
+
+/* columnar_encoding.c */
+extern bytea *columnar_encode_values(Form_pg_attribute att, Datum *values,
+									 int nvalues, char *encoding);
+extern Datum *columnar_decode_values(Form_pg_attribute att, char encoding,
+									 bytea *data, int nvalues);
+extern bytea *columnar_encode_datum(Form_pg_attribute att, Datum value);
+extern Datum columnar_decode_datum(Form_pg_attribute att, bytea *data);
+
+/* columnar_metadata.c */
+extern List *columnar_read_stripes(const RelFileLocator *locator,
+								   Snapshot snapshot);
+extern StripeMetadata *columnar_read_stripe(const RelFileLocator *locator,
+											uint64 stripe_id,
+											Snapshot snapshot);
+extern uint64 columnar_next_stripe_id(const RelFileLocator *locator);
+extern void columnar_insert_stripe(const RelFileLocator *locator,
+								   StripeMetadata *stripe);
+extern void columnar_insert_chunk(const RelFileLocator *locator,
+								  uint64 stripe_id, AttrNumber attnum,
+								  int32 chunk_group, ColumnChunk *chunk);
+extern bool columnar_read_chunk(const RelFileLocator *locator,
+								uint64 stripe_id, AttrNumber attnum,
+								int32 chunk_group, Snapshot snapshot,
+								ColumnChunk *chunk);
+extern Bitmapset *columnar_read_row_mask(const RelFileLocator *locator,
+										 uint64 stripe_id, Snapshot snapshot);
+extern bool columnar_row_is_masked(const RelFileLocator *locator,
+								   uint64 stripe_id, uint32 row,
+								   Snapshot snapshot, TransactionId *xmin,
+								   CommandId *cmin, ItemPointer new_tid);
+extern void columnar_insert_row_mask(const RelFileLocator *locator,
+									 uint64 stripe_id, uint32 row,
+									 ItemPointer new_tid, CommandId cid);
+extern void columnar_delete_metadata(const RelFileLocator *locator);
+extern void columnar_move_metadata(const RelFileLocator *old_locator,
+								   const RelFileLocator *new_locator);
+extern List *columnar_metadata_locators(void);
+
+/* columnar_reader.c */
+typedef struct ColumnarReadState ColumnarReadState;
+
+extern ColumnarReadState *columnar_begin_read(Relation rel, Snapshot snapshot,
+											  int nkeys, ScanKey keys,
+											  pg_atomic_uint64 *next_stripe);
+extern void columnar_set_pushdown(ColumnarReadState *state, Bitmapset *attrs,
+								  int nhints, ScanKey hints);
+extern int	columnar_set_sample(ColumnarReadState *state, int max_groups);
+extern bool columnar_read_next_group(ColumnarReadState *state);
+extern bool columnar_read_group_row(ColumnarReadState *state, Datum *values,
+									bool *isnull, ItemPointer tid);
+extern bool columnar_read_next_row(ColumnarReadState *state, Datum *values,
+								   bool *isnull, ItemPointer tid);
+extern void columnar_rescan_read(ColumnarReadState *state);
+extern void columnar_end_read(ColumnarReadState *state);
+extern bool columnar_read_row(Relation rel, Snapshot snapshot,
+							  ItemPointer tid, TupleTableSlot *slot);
+extern void columnar_read_totals(Relation rel, Snapshot snapshot,
+								 double *rows, double *pages);
+
+/* columnar_writer.c */
+typedef struct ColumnarWriteState ColumnarWriteState;
+
+extern ColumnarWriteState *columnar_begin_write(Relation rel);
+extern void columnar_write_row(ColumnarWriteState *state, Datum *values,
+							   bool *isnull);
+extern void columnar_end_write(ColumnarWriteState *state);
+
+#endif							/* _COLUMNAR_H_ */
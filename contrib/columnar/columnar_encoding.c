@@ -0,0 +1,663 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_encoding.c
+ *		Encoding of the values of one column of a chunk group.
+ *
+ * The non-null values of a column chunk are stored in one of the following
+ * encodings, whichever is the smallest for the values at hand:
+ *
+ * plain:		the value images, one after the other.
+ * RLE:			a uint32 count of runs, then for each run a uint32 count of
+ *				repetitions followed by the value image.
+ * dictionary:	a uint32 count of distinct values and their images, then a
+ *				code for each value, one byte wide if there are at most 256
+ *				distinct values and two bytes wide otherwise.  Only used if
+ *				there are at most 65536 distinct values.
+ * delta:		for integer-like types passed by value, the difference of
+ *				each value from the previous one as a zigzag varint.
+ *
+ * The image of a fixed-length value is its typlen bytes; variable-length
+ * values are stored as a uint32 length followed by the data, without any
+ * varlena header.  Values are compared by their images, so RLE and
+ * dictionary encoding work for any type.
+ *
+ * Whatever the encoding, the result is then compressed by TOAST when it is
+ * stored in columnar.chunk.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_encoding.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "columnar.h"
+#include "lib/stringinfo.h"
+#include "varatt.h"
+
+/* Longest varint encoding of a uint64 */
+#define MAX_VARINT_LEN		10
+
+/* Most distinct values a dictionary can hold */
+#define MAX_DICT_VALUES		65536
+
+/* A buffer big enough for any value passed by value */
+typedef union
+{
+	char		c;
+	int16		i16;
+	int32		i32;
+	int64		i64;
+	char		bytes[sizeof(Datum)];
+} ByvalImage;
+
+/* Plain encoding of a set of values, with the position of each image */
+typedef struct ValueImages
+{
+	StringInfoData buf;
+	uint32	   *offsets;		/* nvalues + 1 entries */
+	int			nvalues;
+} ValueImages;
+
+static void
+corrupt_chunk(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_DATA_CORRUPTED),
+			 errmsg("invalid columnar chunk data")));
+}
+
+static void
+append_value_image(StringInfo buf, Form_pg_attribute att, Datum value)
+{
+	if (att->attbyval)
+	{
+		ByvalImage	image;
+
+		store_att_byval(&image, value, att->attlen);
+		appendBinaryStringInfo(buf, image.bytes, att->attlen);
+	}
+	else if (att->attlen > 0)
+		appendBinaryStringInfo(buf, DatumGetPointer(value), att->attlen);
+	else
+	{
+		const char *ptr;
+		uint32		len;
+
+		if (att->attlen == -1)
+		{
+			varlena    *v = (varlena *) DatumGetPointer(value);
+
+			/* the caller must have detoasted it */
+			Assert(!VARATT_IS_EXTENDED(v) || VARATT_IS_SHORT(v));
+			ptr = VARDATA_ANY(v);
+			len = VARSIZE_ANY_EXHDR(v);
+		}
+		else
+		{
+			ptr = DatumGetCString(value);
+			len = strlen(ptr) + 1;
+		}
+		appendBinaryStringInfo(buf, (char *) &len, sizeof(uint32));
+		appendBinaryStringInfo(buf, ptr, len);
+	}
+}
+
+/*
+ * Read 'nvalues' value images starting at 'ptr' into 'values', and return
+ * the position after the last one.  Values passed by reference are copied to
+ * memory allocated here, so that they are suitably aligned.
+ */
+static const char *
+read_value_images(Form_pg_attribute att, const char *ptr, const char *end,
+				  int nvalues, Datum *values)
+{
+	if (nvalues == 0)
+		return ptr;
+
+	if (att->attbyval)
+	{
+		if (end - ptr < (size_t) nvalues * att->attlen)
+			corrupt_chunk();
+		for (int i = 0; i < nvalues; i++)
+		{
+			ByvalImage	image;
+
+			memcpy(image.bytes, ptr, att->attlen);
+			values[i] = fetch_att(&image, true, att->attlen);
+			ptr += att->attlen;
+		}
+	}
+	else if (att->attlen > 0)
+	{
+		Size		size = MAXALIGN(att->attlen);
+		char	   *copy;
+
+		if (end - ptr < (size_t) nvalues * att->attlen)
+			corrupt_chunk();
+		copy = palloc(size * nvalues);
+		for (int i = 0; i < nvalues; i++)
+		{
+			memcpy(copy, ptr, att->attlen);
+			values[i] = PointerGetDatum(copy);
+			copy += size;
+			ptr += att->attlen;
+		}
+	}
+	else
+	{
+		const char *p = ptr;
+		Size		total = 0;
+		char	   *copy;
+
+		/* first pass to find out how much memory the values need */
+		for (int i = 0; i < nvalues; i++)
+		{
+			uint32		len;
+
+			if (end - p < sizeof(uint32))
+				corrupt_chunk();
+			memcpy(&len, p, sizeof(uint32));
+			p += sizeof(uint32);
+			if (end - p < len)
+				corrupt_chunk();
+			p += len;
+			total += INTALIGN(len + VARHDRSZ);
+		}
+
+		copy = palloc(total);
+		for (int i = 0; i < nvalues; i++)
+		{
+			uint32		len;
+
+			memcpy(&len, ptr, sizeof(uint32));
+			ptr += sizeof(uint32);
+			if (att->attlen == -1)
+			{
+				SET_VARSIZE(copy, len + VARHDRSZ);
+				memcpy(VARDATA(copy), ptr, len);
+				values[i] = PointerGetDatum(copy);
+				copy += INTALIGN(len + VARHDRSZ);
+			}
+			else
+			{
+				if (len == 0 || ptr[len - 1] != '\0')
+					corrupt_chunk();
+				memcpy(copy, ptr, len);
+				values[i] = CStringGetDatum(copy);
+				copy += INTALIGN(len);
+			}
+			ptr += len;
+		}
+	}
+
+	return ptr;
+}
+
+static void
+build_value_images(ValueImages *images, Form_pg_attribute att, Datum *values,
+				   int nvalues)
+{
+	initStringInfo(&images->buf);
+	images->offsets = palloc_array(uint32, nvalues + 1);
+	images->nvalues = nvalues;
+	for (int i = 0; i < nvalues; i++)
+	{
+		images->offsets[i] = images->buf.len;
+		append_value_image(&images->buf, att, values[i]);
+	}
+	images->offsets[nvalues] = images->buf.len;
+}
+
+static inline uint32
+image_len(ValueImages *images, int i)
+{
+	return images->offsets[i + 1] - images->offsets[i];
+}
+
+static inline bool
+images_equal(ValueImages *images, int i, int j)
+{
+	uint32		len = image_len(images, i);
+
+	return len == image_len(images, j) &&
+		memcmp(images->buf.data + images->offsets[i],
+			   images->buf.data + images->offsets[j], len) == 0;
+}
+
+static int
+image_cmp(const void *a, const void *b, void *arg)
+{
+	ValueImages *images = (ValueImages *) arg;
+	int			i = *(const int *) a;
+	int			j = *(const int *) b;
+	uint32		len_i = image_len(images, i);
+	uint32		len_j = image_len(images, j);
+	int			cmp;
+
+	if (len_i != len_j)
+		return len_i < len_j ? -1 : 1;
+	cmp = memcmp(images->buf.data + images->offsets[i],
+				 images->buf.data + images->offsets[j], len_i);
+	if (cmp != 0)
+		return cmp;
+	/* keep the sort stable, so that codes follow first appearance */
+	return (i > j) - (i < j);
+}
+
+static void
+append_image(StringInfo buf, ValueImages *images, int i)
+{
+	appendBinaryStringInfo(buf, images->buf.data + images->offsets[i],
+						   image_len(images, i));
+}
+
+static void
+append_uint32(StringInfo buf, uint32 value)
+{
+	appendBinaryStringInfo(buf, (char *) &value, sizeof(uint32));
+}
+
+static const char *
+read_uint32(const char *ptr, const char *end, uint32 *value)
+{
+	if (end - ptr < sizeof(uint32))
+		corrupt_chunk();
+	memcpy(value, ptr, sizeof(uint32));
+	return ptr + sizeof(uint32);
+}
+
+/*
+ * Build the RLE encoding of the values into 'buf', unless it would be larger
+ * than 'limit' bytes.
+ */
+static bool
+encode_rle(ValueImages *images, StringInfo buf, Size limit)
+{
+	Size		size = sizeof(uint32);
+	uint32		nruns = 0;
+	int			start;
+
+	for (int i = 0; i < images->nvalues; i++)
+	{
+		if (i == 0 || !images_equal(images, i - 1, i))
+		{
+			nruns++;
+			size += sizeof(uint32) + image_len(images, i);
+			if (size >= limit)
+				return false;
+		}
+	}
+
+	append_uint32(buf, nruns);
+	start = 0;
+	for (int i = 1; i <= images->nvalues; i++)
+	{
+		if (i == images->nvalues || !images_equal(images, start, i))
+		{
+			append_uint32(buf, i - start);
+			append_image(buf, images, start);
+			start = i;
+		}
+	}
+	return true;
+}
+
+/*
+ * Build the dictionary encoding of the values into 'buf', unless it would be
+ * larger than 'limit' bytes or there are too many distinct values.
+ */
+static bool
+encode_dict(ValueImages *images, StringInfo buf, Size limit)
+{
+	int			nvalues = images->nvalues;
+	int		   *order;
+	uint16	   *codes;
+	int		   *dict;
+	int			ndict = 0;
+	int			code_width;
+	Size		size;
+
+	order = palloc_array(int, nvalues);
+	for (int i = 0; i < nvalues; i++)
+		order[i] = i;
+	qsort_arg(order, nvalues, sizeof(int), image_cmp, images);
+
+	codes = palloc_array(uint16, nvalues);
+	dict = palloc_array(int, Min(nvalues, MAX_DICT_VALUES));
+	size = sizeof(uint32);
+	for (int i = 0; i < nvalues; i++)
+	{
+		if (i == 0 || !images_equal(images, order[i - 1], order[i]))
+		{
+			if (ndict == MAX_DICT_VALUES)
+				return false;
+			dict[ndict++] = order[i];
+			size += image_len(images, order[i]);
+		}
+		codes[order[i]] = ndict - 1;
+	}
+
+	code_width = ndict <= 256 ? 1 : 2;
+	size += (Size) nvalues * code_width;
+	if (size >= limit)
+		return false;
+
+	append_uint32(buf, ndict);
+	for (int i = 0; i < ndict; i++)
+		append_image(buf, images, dict[i]);
+	for (int i = 0; i < nvalues; i++)
+	{
+		if (code_width == 1)
+			appendStringInfoCharMacro(buf, (char) codes[i]);
+		else
+			appendBinaryStringInfo(buf, (char *) &codes[i], sizeof(uint16));
+	}
+	return true;
+}
+
+static inline int64
+image_get_int64(const char *ptr, int len)
+{
+	switch (len)
+	{
+		case sizeof(int16):
+			{
+				int16		v;
+
+				memcpy(&v, ptr, sizeof(int16));
+				return v;
+			}
+		case sizeof(int32):
+			{
+				int32		v;
+
+				memcpy(&v, ptr, sizeof(int32));
+				return v;
+			}
+		default:
+			{
+				int64		v;
+
+				Assert(len == sizeof(int64));
+				memcpy(&v, ptr, sizeof(int64));
+				return v;
+			}
+	}
+}
+
+static inline Datum
+int64_get_datum(int64 value, int len)
+{
+	switch (len)
+	{
+		case sizeof(int16):
+			return Int16GetDatum((int16) value);
+		case sizeof(int32):
+			return Int32GetDatum((int32) value);
+		default:
+			return Int64GetDatum(value);
+	}
+}
+
+/*
+ * Build the delta encoding of the values into 'buf', unless it would be
+ * larger than 'limit' bytes.  The arithmetic wraps around, so that any bit
+ * pattern round-trips.
+ */
+static bool
+encode_delta(ValueImages *images, int len, StringInfo buf, Size limit)
+{
+	uint64		prev = 0;
+
+	for (int i = 0; i < images->nvalues; i++)
+	{
+		uint64		value;
+		int64		diff;
+		uint64		zigzag;
+		char		varint[MAX_VARINT_LEN];
+		int			n = 0;
+
+		value = (uint64) image_get_int64(images->buf.data + images->offsets[i],
+										 len);
+		diff = (int64) (value - prev);
+		zigzag = ((uint64) diff << 1) ^ (uint64) (diff >> 63);
+		prev = value;
+
+		do
+		{
+			varint[n] = zigzag & 0x7F;
+			zigzag >>= 7;
+			if (zigzag != 0)
+				varint[n] |= 0x80;
+			n++;
+		} while (zigzag != 0);
+
+		if (buf->len + n >= limit)
+			return false;
+		appendBinaryStringInfo(buf, varint, n);
+	}
+	return true;
+}
+
+static void
+decode_delta(Form_pg_attribute att, const char *ptr, const char *end,
+			 int nvalues, Datum *values)
+{
+	uint64		prev = 0;
+
+	for (int i = 0; i < nvalues; i++)
+	{
+		uint64		zigzag = 0;
+		int64		diff;
+		int			shift = 0;
+
+		for (;;)
+		{
+			uint8		b;
+
+			if (ptr >= end || shift >= 64)
+				corrupt_chunk();
+			b = (uint8) *ptr++;
+			zigzag |= (uint64) (b & 0x7F) << shift;
+			if ((b & 0x80) == 0)
+				break;
+			shift += 7;
+		}
+		diff = (int64) ((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+		prev += (uint64) diff;
+		values[i] = int64_get_datum((int64) prev, att->attlen);
+	}
+	if (ptr != end)
+		corrupt_chunk();
+}
+
+static bytea *
+make_bytea(const char *data, Size len)
+{
+	bytea	   *result = palloc(VARHDRSZ + len);
+
+	SET_VARSIZE(result, VARHDRSZ + len);
+	memcpy(VARDATA(result), data, len);
+	return result;
+}
+
+/*
+ * Encode 'nvalues' non-null values of the column described by 'att', using
+ * whichever encoding gives the smallest result.  The encoding used is
+ * returned in *encoding.  Variable-length values must not be toasted.
+ */
+bytea *
+columnar_encode_values(Form_pg_attribute att, Datum *values, int nvalues,
+					   char *encoding)
+{
+	ValueImages images;
+	StringInfoData best;
+	StringInfoData candidate;
+	bytea	   *result;
+
+	build_value_images(&images, att, values, nvalues);
+	best = images.buf;
+	*encoding = COLUMNAR_ENCODING_PLAIN;
+
+	if (nvalues > 1)
+	{
+		initStringInfo(&candidate);
+		if (encode_rle(&images, &candidate, best.len))
+		{
+			best = candidate;
+			*encoding = COLUMNAR_ENCODING_RLE;
+			initStringInfo(&candidate);
+		}
+		else
+			resetStringInfo(&candidate);
+
+		if (encode_dict(&images, &candidate, best.len))
+		{
+			best = candidate;
+			*encoding = COLUMNAR_ENCODING_DICT;
+			initStringInfo(&candidate);
+		}
+		else
+			resetStringInfo(&candidate);
+
+		if (att->attbyval &&
+			(att->attlen == sizeof(int16) ||
+			 att->attlen == sizeof(int32) ||
+			 att->attlen == sizeof(int64)) &&
+			encode_delta(&images, att->attlen, &candidate, best.len))
+		{
+			best = candidate;
+			*encoding = COLUMNAR_ENCODING_DELTA;
+		}
+	}
+
+	result = make_bytea(best.data, best.len);
+	return result;
+}
+
+/*
+ * Decode 'nvalues' values encoded by columnar_encode_values().  The values
+ * are allocated in the current memory context.
+ */
+Datum *
+columnar_decode_values(Form_pg_attribute att, char encoding, bytea *data,
+					   int nvalues)
+{
+	const char *ptr = VARDATA_ANY(data);
+	const char *end = ptr + VARSIZE_ANY_EXHDR(data);
+	Datum	   *values = palloc_array(Datum, Max(nvalues, 1));
+
+	switch (encoding)
+	{
+		case COLUMNAR_ENCODING_PLAIN:
+			ptr = read_value_images(att, ptr, end, nvalues, values);
+			if (ptr != end)
+				corrupt_chunk();
+			break;
+
+		case COLUMNAR_ENCODING_RLE:
+			{
+				uint32		nruns;
+				int			n = 0;
+
+				ptr = read_uint32(ptr, end, &nruns);
+				for (uint32 run = 0; run < nruns; run++)
+				{
+					uint32		count;
+
+					ptr = read_uint32(ptr, end, &count);
+					if (count == 0 || count > nvalues - n)
+						corrupt_chunk();
+					ptr = read_value_images(att, ptr, end, 1, &values[n]);
+					for (uint32 i = 1; i < count; i++)
+						values[n + i] = values[n];
+					n += count;
+				}
+				if (n != nvalues || ptr != end)
+					corrupt_chunk();
+				break;
+			}
+
+		case COLUMNAR_ENCODING_DICT:
+			{
+				uint32		ndict;
+				Datum	   *dict;
+
+				ptr = read_uint32(ptr, end, &ndict);
+				if (ndict == 0 || ndict > MAX_DICT_VALUES)
+					corrupt_chunk();
+				dict = palloc_array(Datum, ndict);
+				ptr = read_value_images(att, ptr, end, ndict, dict);
+				if (ndict <= 256)
+				{
+					if (end - ptr != nvalues)
+						corrupt_chunk();
+					for (int i = 0; i < nvalues; i++)
+					{
+						uint8		code = (uint8) ptr[i];
+
+						if (code >= ndict)
+							corrupt_chunk();
+						values[i] = dict[code];
+					}
+				}
+				else
+				{
+					if (end - ptr != (Size) nvalues * sizeof(uint16))
+						corrupt_chunk();
+					for (int i = 0; i < nvalues; i++)
+					{
+						uint16		code;
+
+						memcpy(&code, ptr + i * sizeof(uint16), sizeof(uint16));
+						if (code >= ndict)
+							corrupt_chunk();
+						values[i] = dict[code];
+					}
+				}
+				break;
+			}
+
+		case COLUMNAR_ENCODING_DELTA:
+			if (!att->attbyval ||
+				(att->attlen != sizeof(int16) &&
+				 att->attlen != sizeof(int32) &&
+				 att->attlen != sizeof(int64)))
+				corrupt_chunk();
+			decode_delta(att, ptr, end, nvalues, values);
+			break;
+
+		default:
+			corrupt_chunk();
+	}
+
+	return values;
+}
+
+/*
+ * Encode a single value, such as the minimum of a chunk.
+ */
+bytea *
+columnar_encode_datum(Form_pg_attribute att, Datum value)
+{
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	append_value_image(&buf, att, value);
+	return make_bytea(buf.data, buf.len);
+}
+
+Datum
+columnar_decode_datum(Form_pg_attribute att, bytea *data)
+{
+	const char *ptr = VARDATA_ANY(data);
+	const char *end = ptr + VARSIZE_ANY_EXHDR(data);
+	Datum		value;
+
+	if (read_value_images(att, ptr, end, 1, &value) != end)
+		corrupt_chunk();
+	return value;
+}
@@ -0,0 +1,674 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_metadata.c
+ *		Access to the tables holding the stripes of columnar tables.
+ *
+ * The tables live in the extension's schema, and are accessed directly at
+ * the heap and index level, much like system catalogs, so that no
+ * privileges on them are needed.  Changes to them are not decoded by logical
+ * decoding: they are an implementation detail of the tables using the AM,
+ * not user data.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_metadata.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "access/stratnum.h"
+#include "access/table.h"
+#include "access/xact.h"
+#include "catalog/index.h"
+#include "catalog/indexing.h"
+#include "catalog/namespace.h"
+#include "columnar.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "nodes/execnodes.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+/*
+ * All of the tables start with these columns, which identify the storage of
+ * a columnar table.  A relfilenumber is only unique within its tablespace.
+ */
+#define Anum_columnar_reltablespace					1
+#define Anum_columnar_relfilenumber					2
+
+/* Columns of columnar.stripe */
+#define Anum_columnar_stripe_stripe_id				3
+#define Anum_columnar_stripe_row_count				4
+#define Anum_columnar_stripe_chunk_group_count		5
+#define Anum_columnar_stripe_chunk_group_row_limit	6
+#define Anum_columnar_stripe_data_size				7
+#define Natts_columnar_stripe						7
+
+/* Columns of columnar.chunk */
+#define Anum_columnar_chunk_stripe_id				3
+#define Anum_columnar_chunk_attnum					4
+#define Anum_columnar_chunk_chunk_group				5
+#define Anum_columnar_chunk_row_count				6
+#define Anum_columnar_chunk_value_count				7
+#define Anum_columnar_chunk_encoding				8
+#define Anum_columnar_chunk_minimum					9
+#define Anum_columnar_chunk_maximum					10
+#define Anum_columnar_chunk_nulls					11
+#define Anum_columnar_chunk_data					12
+#define Natts_columnar_chunk						12
+
+/* Columns of columnar.row_mask */
+#define Anum_columnar_row_mask_stripe_id			3
+#define Anum_columnar_row_mask_row_number			4
+#define Anum_columnar_row_mask_new_tid				5
+#define Natts_columnar_row_mask						5
+
+/* Each table has a primary key, on the columns listed above its data */
+typedef enum MetadataTable
+{
+	METADATA_STRIPE,
+	METADATA_CHUNK,
+	METADATA_ROW_MASK,
+} MetadataTable;
+
+static const char *const metadata_relnames[] = {
+	[METADATA_STRIPE] = "stripe",
+	[METADATA_CHUNK] = "chunk",
+	[METADATA_ROW_MASK] = "row_mask",
+};
+
+static const char *const metadata_indexnames[] = {
+	[METADATA_STRIPE] = "stripe_pkey",
+	[METADATA_CHUNK] = "chunk_pkey",
+	[METADATA_ROW_MASK] = "row_mask_pkey",
+};
+
+static Oid
+metadata_relid(const char *relname)
+{
+	Oid			nspid;
+	Oid			relid = InvalidOid;
+
+	nspid = get_namespace_oid("columnar", true);
+	if (OidIsValid(nspid))
+		relid = get_relname_relid(relname, nspid);
+	if (!OidIsValid(relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("columnar metadata table \"columnar.%s\" does not exist",
+						relname),
+				 errhint("The columnar extension must be installed in the database.")));
+	return relid;
+}
+
+static Relation
+metadata_open(MetadataTable table, LOCKMODE lockmode)
+{
+	return table_open(metadata_relid(metadata_relnames[table]), lockmode);
+}
+
+static Oid
+metadata_index(MetadataTable table)
+{
+	return metadata_relid(metadata_indexnames[table]);
+}
+
+/*
+ * The tablespace is stored as in pg_class, with the database's default
+ * tablespace as zero, so that ALTER DATABASE SET TABLESPACE leaves it valid.
+ */
+static Oid
+metadata_tablespace(const RelFileLocator *locator)
+{
+	if (locator->spcOid == MyDatabaseTableSpace)
+		return InvalidOid;
+	return locator->spcOid;
+}
+
+/*
+ * Set up the scan keys on the columns identifying the storage of a table.
+ */
+static void
+metadata_init_keys(ScanKey key, const RelFileLocator *locator)
+{
+	ScanKeyInit(&key[0],
+				Anum_columnar_reltablespace,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(metadata_tablespace(locator)));
+	ScanKeyInit(&key[1],
+				Anum_columnar_relfilenumber,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(locator->relNumber));
+}
+
+static void
+metadata_set_keys(Datum *values, const RelFileLocator *locator)
+{
+	values[Anum_columnar_reltablespace - 1] =
+		ObjectIdGetDatum(metadata_tablespace(locator));
+	values[Anum_columnar_relfilenumber - 1] =
+		ObjectIdGetDatum(locator->relNumber);
+}
+
+/*
+ * Insert a tuple into a metadata table and its indexes.
+ */
+static void
+metadata_insert(Relation rel, Datum *values, bool *nulls, CommandId cid)
+{
+	HeapTuple	tuple;
+	CatalogIndexState indstate;
+	TupleTableSlot *slot;
+
+	tuple = heap_form_tuple(RelationGetDescr(rel), values, nulls);
+	heap_insert(rel, tuple, cid, HEAP_INSERT_NO_LOGICAL, NULL);
+
+	indstate = CatalogOpenIndexes(rel);
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(rel), &TTSOpsHeapTuple);
+	ExecStoreHeapTuple(tuple, slot, false);
+	for (int i = 0; i < indstate->ri_NumIndices; i++)
+	{
+		Relation	index = indstate->ri_IndexRelationDescs[i];
+		IndexInfo  *indexInfo = indstate->ri_IndexRelationInfo[i];
+		Datum		idxvalues[INDEX_MAX_KEYS];
+		bool		idxnulls[INDEX_MAX_KEYS];
+
+		if (!indexInfo->ii_ReadyForInserts)
+			continue;
+
+		FormIndexDatum(indexInfo, slot, NULL, idxvalues, idxnulls);
+		index_insert(index, idxvalues, idxnulls, &tuple->t_self, rel,
+					 index->rd_index->indisunique ?
+					 UNIQUE_CHECK_YES : UNIQUE_CHECK_NO,
+					 false, indexInfo);
+	}
+	ExecDropSingleTupleTableSlot(slot);
+	CatalogCloseIndexes(indstate);
+
+	heap_freetuple(tuple);
+}
+
+/*
+ * Delete a tuple from a metadata table.  It's OK if a concurrent transaction
+ * deleted it first, which can happen when dropping orphaned metadata.
+ */
+static void
+metadata_delete(Relation rel, ItemPointer tid)
+{
+	TM_Result	result;
+	TM_FailureData tmfd;
+
+	result = heap_delete(rel, tid, GetCurrentCommandId(true),
+						 TABLE_DELETE_NO_LOGICAL, InvalidSnapshot,
+						 true /* wait for commit */ , &tmfd);
+	switch (result)
+	{
+		case TM_Ok:
+		case TM_Deleted:
+			break;
+
+		case TM_SelfModified:
+			elog(ERROR, "tuple already updated by self");
+			break;
+
+		case TM_Updated:
+			elog(ERROR, "tuple concurrently updated");
+			break;
+
+		default:
+			elog(ERROR, "unrecognized heap_delete status: %u", result);
+			break;
+	}
+}
+
+static StripeMetadata *
+tuple_get_stripe(HeapTuple tuple, TupleDesc tupdesc)
+{
+	StripeMetadata *stripe = palloc_object(StripeMetadata);
+	Datum		values[Natts_columnar_stripe];
+	bool		nulls[Natts_columnar_stripe];
+
+	heap_deform_tuple(tuple, tupdesc, values, nulls);
+	stripe->stripe_id = DatumGetInt64(values[Anum_columnar_stripe_stripe_id - 1]);
+	stripe->row_count = DatumGetInt64(values[Anum_columnar_stripe_row_count - 1]);
+	stripe->chunk_group_count =
+		DatumGetInt32(values[Anum_columnar_stripe_chunk_group_count - 1]);
+	stripe->chunk_group_row_limit =
+		DatumGetInt32(values[Anum_columnar_stripe_chunk_group_row_limit - 1]);
+	stripe->data_size = DatumGetInt64(values[Anum_columnar_stripe_data_size - 1]);
+	return stripe;
+}
+
+/*
+ * Return the stripes of a relation visible to 'snapshot', in stripe_id order.
+ */
+List *
+columnar_read_stripes(const RelFileLocator *locator, Snapshot snapshot)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[2];
+	HeapTuple	tuple;
+	List	   *stripes = NIL;
+
+	rel = metadata_open(METADATA_STRIPE, AccessShareLock);
+	metadata_init_keys(key, locator);
+	scan = systable_beginscan(rel, metadata_index(METADATA_STRIPE), true,
+							  snapshot, 2, key);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+		stripes = lappend(stripes, tuple_get_stripe(tuple, RelationGetDescr(rel)));
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return stripes;
+}
+
+/*
+ * Return a single stripe, or NULL if it isn't visible to 'snapshot'.
+ */
+StripeMetadata *
+columnar_read_stripe(const RelFileLocator *locator, uint64 stripe_id,
+					 Snapshot snapshot)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[3];
+	HeapTuple	tuple;
+	StripeMetadata *stripe = NULL;
+
+	rel = metadata_open(METADATA_STRIPE, AccessShareLock);
+	metadata_init_keys(key, locator);
+	ScanKeyInit(&key[2],
+				Anum_columnar_stripe_stripe_id,
+				BTEqualStrategyNumber, F_INT8EQ,
+				Int64GetDatum((int64) stripe_id));
+	scan = systable_beginscan(rel, metadata_index(METADATA_STRIPE), true,
+							  snapshot, 3, key);
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+		stripe = tuple_get_stripe(tuple, RelationGetDescr(rel));
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return stripe;
+}
+
+/*
+ * Return the id to use for the next stripe of a relation.
+ *
+ * The caller must hold a lock that keeps anyone else from writing stripes
+ * for the relation at the same time.
+ */
+uint64
+columnar_next_stripe_id(const RelFileLocator *locator)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[2];
+	HeapTuple	tuple;
+	uint64		next = 0;
+
+	rel = metadata_open(METADATA_STRIPE, AccessShareLock);
+	metadata_init_keys(key, locator);
+	scan = systable_beginscan(rel, metadata_index(METADATA_STRIPE), true,
+							  SnapshotSelf, 2, key);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		bool		isnull;
+		uint64		stripe_id;
+
+		stripe_id = DatumGetInt64(heap_getattr(tuple,
+											   Anum_columnar_stripe_stripe_id,
+											   RelationGetDescr(rel),
+											   &isnull));
+		next = Max(next, stripe_id + 1);
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	if (next > COLUMNAR_MAX_STRIPE_ID)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("columnar table has run out of stripe identifiers"),
+				 errhint("Rewrite the table with VACUUM FULL.")));
+
+	return next;
+}
+
+void
+columnar_insert_stripe(const RelFileLocator *locator, StripeMetadata *stripe)
+{
+	Relation	rel;
+	Datum		values[Natts_columnar_stripe];
+	bool		nulls[Natts_columnar_stripe] = {0};
+
+	metadata_set_keys(values, locator);
+	values[Anum_columnar_stripe_stripe_id - 1] = Int64GetDatum((int64) stripe->stripe_id);
+	values[Anum_columnar_stripe_row_count - 1] = Int64GetDatum(stripe->row_count);
+	values[Anum_columnar_stripe_chunk_group_count - 1] =
+		Int32GetDatum(stripe->chunk_group_count);
+	values[Anum_columnar_stripe_chunk_group_row_limit - 1] =
+		Int32GetDatum(stripe->chunk_group_row_limit);
+	values[Anum_columnar_stripe_data_size - 1] = Int64GetDatum(stripe->data_size);
+
+	rel = metadata_open(METADATA_STRIPE, RowExclusiveLock);
+	metadata_insert(rel, values, nulls, GetCurrentCommandId(true));
+	table_close(rel, RowExclusiveLock);
+}
+
+void
+columnar_insert_chunk(const RelFileLocator *locator, uint64 stripe_id,
+					  AttrNumber attnum, int32 chunk_group, ColumnChunk *chunk)
+{
+	Relation	rel;
+	Datum		values[Natts_columnar_chunk];
+	bool		nulls[Natts_columnar_chunk] = {0};
+
+	metadata_set_keys(values, locator);
+	values[Anum_columnar_chunk_stripe_id - 1] = Int64GetDatum((int64) stripe_id);
+	values[Anum_columnar_chunk_attnum - 1] = Int16GetDatum(attnum);
+	values[Anum_columnar_chunk_chunk_group - 1] = Int32GetDatum(chunk_group);
+	values[Anum_columnar_chunk_row_count - 1] = Int32GetDatum(chunk->row_count);
+	values[Anum_columnar_chunk_value_count - 1] = Int32GetDatum(chunk->value_count);
+	values[Anum_columnar_chunk_encoding - 1] = CharGetDatum(chunk->encoding);
+	values[Anum_columnar_chunk_minimum - 1] = PointerGetDatum(chunk->minimum);
+	nulls[Anum_columnar_chunk_minimum - 1] = chunk->minimum == NULL;
+	values[Anum_columnar_chunk_maximum - 1] = PointerGetDatum(chunk->maximum);
+	nulls[Anum_columnar_chunk_maximum - 1] = chunk->maximum == NULL;
+	values[Anum_columnar_chunk_nulls - 1] = PointerGetDatum(chunk->nulls);
+	nulls[Anum_columnar_chunk_nulls - 1] = chunk->nulls == NULL;
+	values[Anum_columnar_chunk_data - 1] = chunk->data;
+
+	rel = metadata_open(METADATA_CHUNK, RowExclusiveLock);
+	metadata_insert(rel, values, nulls, GetCurrentCommandId(true));
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Read one column chunk into *chunk.  Returns false if there is none, which
+ * means that the column was added to the table after the stripe was written.
+ *
+ * The chunk data is returned as it is stored, possibly still toasted, so
+ * that the caller can skip detoasting it if the minimum and maximum show
+ * that none of the values are of interest.
+ */
+bool
+columnar_read_chunk(const RelFileLocator *locator, uint64 stripe_id,
+					AttrNumber attnum, int32 chunk_group, Snapshot snapshot,
+					ColumnChunk *chunk)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[5];
+	HeapTuple	tuple;
+	bool		found = false;
+
+	rel = metadata_open(METADATA_CHUNK, AccessShareLock);
+	metadata_init_keys(key, locator);
+	ScanKeyInit(&key[2],
+				Anum_columnar_chunk_stripe_id,
+				BTEqualStrategyNumber, F_INT8EQ,
+				Int64GetDatum((int64) stripe_id));
+	ScanKeyInit(&key[3],
+				Anum_columnar_chunk_attnum,
+				BTEqualStrategyNumber, F_INT2EQ,
+				Int16GetDatum(attnum));
+	ScanKeyInit(&key[4],
+				Anum_columnar_chunk_chunk_group,
+				BTEqualStrategyNumber, F_INT4EQ,
+				Int32GetDatum(chunk_group));
+	scan = systable_beginscan(rel, metadata_index(METADATA_CHUNK), true,
+							  snapshot, 5, key);
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+	{
+		Datum		values[Natts_columnar_chunk];
+		bool		nulls[Natts_columnar_chunk];
+
+		tuple = heap_copytuple(tuple);
+		heap_deform_tuple(tuple, RelationGetDescr(rel), values, nulls);
+
+		chunk->row_count = DatumGetInt32(values[Anum_columnar_chunk_row_count - 1]);
+		chunk->value_count = DatumGetInt32(values[Anum_columnar_chunk_value_count - 1]);
+		chunk->encoding = DatumGetChar(values[Anum_columnar_chunk_encoding - 1]);
+		chunk->minimum = nulls[Anum_columnar_chunk_minimum - 1] ? NULL :
+			DatumGetByteaPP(values[Anum_columnar_chunk_minimum - 1]);
+		chunk->maximum = nulls[Anum_columnar_chunk_maximum - 1] ? NULL :
+			DatumGetByteaPP(values[Anum_columnar_chunk_maximum - 1]);
+		chunk->nulls = nulls[Anum_columnar_chunk_nulls - 1] ? NULL :
+			DatumGetByteaPP(values[Anum_columnar_chunk_nulls - 1]);
+		chunk->data = values[Anum_columnar_chunk_data - 1];
+		found = true;
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return found;
+}
+
+/*
+ * Return the set of rows of a stripe that are deleted according to
+ * 'snapshot'.
+ */
+Bitmapset *
+columnar_read_row_mask(const RelFileLocator *locator, uint64 stripe_id,
+					   Snapshot snapshot)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[3];
+	HeapTuple	tuple;
+	Bitmapset  *mask = NULL;
+
+	rel = metadata_open(METADATA_ROW_MASK, AccessShareLock);
+	metadata_init_keys(key, locator);
+	ScanKeyInit(&key[2],
+				Anum_columnar_row_mask_stripe_id,
+				BTEqualStrategyNumber, F_INT8EQ,
+				Int64GetDatum((int64) stripe_id));
+	scan = systable_beginscan(rel, metadata_index(METADATA_ROW_MASK), true,
+							  snapshot, 3, key);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		bool		isnull;
+		int32		row;
+
+		row = DatumGetInt32(heap_getattr(tuple,
+										 Anum_columnar_row_mask_row_number,
+										 RelationGetDescr(rel), &isnull));
+		mask = bms_add_member(mask, row);
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return mask;
+}
+
+/*
+ * Is a single row of a stripe deleted according to 'snapshot'?  If so, also
+ * return who deleted it and, if it was updated rather than deleted, the TID
+ * of the new version.  *cmin is only set if the deleter is the current
+ * transaction.
+ */
+bool
+columnar_row_is_masked(const RelFileLocator *locator, uint64 stripe_id,
+					   uint32 row, Snapshot snapshot, TransactionId *xmin,
+					   CommandId *cmin, ItemPointer new_tid)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[4];
+	HeapTuple	tuple;
+	bool		found = false;
+
+	rel = metadata_open(METADATA_ROW_MASK, AccessShareLock);
+	metadata_init_keys(key, locator);
+	ScanKeyInit(&key[2],
+				Anum_columnar_row_mask_stripe_id,
+				BTEqualStrategyNumber, F_INT8EQ,
+				Int64GetDatum((int64) stripe_id));
+	ScanKeyInit(&key[3],
+				Anum_columnar_row_mask_row_number,
+				BTEqualStrategyNumber, F_INT4EQ,
+				Int32GetDatum((int32) row));
+	scan = systable_beginscan(rel, metadata_index(METADATA_ROW_MASK), true,
+							  snapshot, 4, key);
+	tuple = systable_getnext(scan);
+	if (HeapTupleIsValid(tuple))
+	{
+		Datum		datum;
+		bool		isnull;
+
+		*xmin = HeapTupleHeaderGetXmin(tuple->t_data);
+		*cmin = TransactionIdIsCurrentTransactionId(*xmin) ?
+			HeapTupleHeaderGetCmin(tuple->t_data) : InvalidCommandId;
+
+		datum = heap_getattr(tuple, Anum_columnar_row_mask_new_tid,
+							 RelationGetDescr(rel), &isnull);
+		if (isnull)
+			ItemPointerSetInvalid(new_tid);
+		else
+			ItemPointerCopy(DatumGetItemPointer(datum), new_tid);
+		found = true;
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return found;
+}
+
+/*
+ * Mark a row of a stripe as deleted, or as updated if 'new_tid' is given.
+ */
+void
+columnar_insert_row_mask(const RelFileLocator *locator, uint64 stripe_id,
+						 uint32 row, ItemPointer new_tid, CommandId cid)
+{
+	Relation	rel;
+	Datum		values[Natts_columnar_row_mask];
+	bool		nulls[Natts_columnar_row_mask] = {0};
+
+	metadata_set_keys(values, locator);
+	values[Anum_columnar_row_mask_stripe_id - 1] = Int64GetDatum((int64) stripe_id);
+	values[Anum_columnar_row_mask_row_number - 1] = Int32GetDatum((int32) row);
+	if (new_tid != NULL)
+		values[Anum_columnar_row_mask_new_tid - 1] = ItemPointerGetDatum(new_tid);
+	else
+		nulls[Anum_columnar_row_mask_new_tid - 1] = true;
+
+	rel = metadata_open(METADATA_ROW_MASK, RowExclusiveLock);
+	metadata_insert(rel, values, nulls, cid);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Delete all metadata of one table, or move it to 'new_locator' if that is
+ * given.
+ */
+static void
+metadata_delete_or_move(MetadataTable table, const RelFileLocator *locator,
+						const RelFileLocator *new_locator)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	ScanKeyData key[2];
+	HeapTuple	tuple;
+
+	rel = metadata_open(table, RowExclusiveLock);
+	metadata_init_keys(key, locator);
+	scan = systable_beginscan(rel, metadata_index(table), true,
+							  SnapshotSelf, 2, key);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		if (new_locator != NULL)
+		{
+			TupleDesc	tupdesc = RelationGetDescr(rel);
+			Datum	   *values = palloc_array(Datum, tupdesc->natts);
+			bool	   *nulls = palloc_array(bool, tupdesc->natts);
+
+			/*
+			 * The relfilenumber is part of the primary key, so this can't be
+			 * a HOT update; simplest to just insert a new tuple.
+			 */
+			heap_deform_tuple(tuple, tupdesc, values, nulls);
+			metadata_set_keys(values, new_locator);
+			metadata_insert(rel, values, nulls, GetCurrentCommandId(true));
+			pfree(values);
+			pfree(nulls);
+		}
+		metadata_delete(rel, &tuple->t_self);
+	}
+	systable_endscan(scan);
+	table_close(rel, RowExclusiveLock);
+}
+
+void
+columnar_delete_metadata(const RelFileLocator *locator)
+{
+	metadata_delete_or_move(METADATA_STRIPE, locator, NULL);
+	metadata_delete_or_move(METADATA_CHUNK, locator, NULL);
+	metadata_delete_or_move(METADATA_ROW_MASK, locator, NULL);
+}
+
+void
+columnar_move_metadata(const RelFileLocator *old_locator,
+					   const RelFileLocator *new_locator)
+{
+	metadata_delete_or_move(METADATA_STRIPE, old_locator, new_locator);
+	metadata_delete_or_move(METADATA_CHUNK, old_locator, new_locator);
+	metadata_delete_or_move(METADATA_ROW_MASK, old_locator, new_locator);
+}
+
+/*
+ * Return the distinct storage, as RelFileLocators, of the tables that have
+ * committed stripes or stripes written by the current transaction.
+ */
+List *
+columnar_metadata_locators(void)
+{
+	Relation	rel;
+	SysScanDesc scan;
+	HeapTuple	tuple;
+	List	   *result = NIL;
+	RelFileLocator *last = NULL;
+
+	rel = metadata_open(METADATA_STRIPE, AccessShareLock);
+	scan = systable_beginscan(rel, metadata_index(METADATA_STRIPE), true,
+							  SnapshotSelf, 0, NULL);
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		bool		isnull;
+		RelFileLocator locator;
+
+		locator.spcOid = DatumGetObjectId(heap_getattr(tuple,
+													   Anum_columnar_reltablespace,
+													   RelationGetDescr(rel),
+													   &isnull));
+		if (!OidIsValid(locator.spcOid))
+			locator.spcOid = MyDatabaseTableSpace;
+		locator.dbOid = MyDatabaseId;
+		locator.relNumber = DatumGetObjectId(heap_getattr(tuple,
+														  Anum_columnar_relfilenumber,
+														  RelationGetDescr(rel),
+														  &isnull));
+
+		/* the index returns the rows of each table together */
+		if (last == NULL || !RelFileLocatorEquals(*last, locator))
+		{
+			last = palloc_object(RelFileLocator);
+			*last = locator;
+			result = lappend(result, last);
+		}
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return result;
+}
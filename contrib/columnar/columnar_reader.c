@@ -0,0 +1,689 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_reader.c
+ *		Reading rows from the stripes of a columnar table.
+ *
+ * Stripes are read one chunk group at a time.  Only the columns that the
+ * scan needs are fetched and decoded, and a chunk group is skipped without
+ * decoding anything if the minimum and maximum values of a column show that
+ * none of its rows can satisfy the scan's keys.
+ *
+ * In a parallel scan, the participants take stripes one at a time from a
+ * counter in shared memory.  All of them see the same list of stripes,
+ * since they use the same snapshot.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_reader.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/sysattr.h"
+#include "columnar.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+
+struct ColumnarReadState
+{
+	Relation	rel;
+	TupleDesc	tupdesc;
+	RelFileLocator locator;
+	Snapshot	snapshot;
+	bool	   *needed;			/* per attribute, is it read? */
+
+	/* Keys that the returned rows must satisfy */
+	int			nkeys;
+	ScanKey		keys;
+
+	/*
+	 * Keys, from the above or from hints, that can be checked against the
+	 * minimum and maximum of a chunk, with the btree comparison function for
+	 * the column type and the key's argument type.
+	 */
+	int			nprune;
+	ScanKey    *prune_keys;
+	FmgrInfo   *prune_cmp;
+
+	/* Stripes to read, and which one is next */
+	List	   *stripes;
+	int			next_stripe;
+	pg_atomic_uint64 *shared_next_stripe;	/* used instead in parallel scans */
+	bool		done;
+
+	/* If sampling, read every sample_stride'th chunk group only */
+	int			sample_stride;
+	uint64		groups_seen;
+
+	/* Current stripe, and its deleted rows */
+	StripeMetadata *stripe;
+	Bitmapset  *mask;
+
+	/* Current chunk group, and the decoded values of the needed columns */
+	int32		chunk_group;
+	uint32		group_first_row;	/* row number of its first row */
+	int32		group_rows;
+	int32		group_pos;		/* next row to return */
+	Datum	  **values;			/* per attribute, NULL if not read */
+	bool	  **isnull;
+	ColumnChunk *chunks;		/* per attribute, read for the chunk group */
+	bool	   *chunk_found;
+	bool	   *chunk_read;
+
+	MemoryContext stripe_cxt;	/* reset for each stripe */
+	MemoryContext group_cxt;	/* reset for each chunk group */
+};
+
+static void
+add_prune_key(ColumnarReadState *state, ScanKey key)
+{
+	Form_pg_attribute att;
+	TypeCacheEntry *typentry;
+	Oid			cmp_proc;
+
+	if (key->sk_attno <= 0 || key->sk_attno > state->tupdesc->natts)
+		return;
+	if (key->sk_flags != 0 || !OidIsValid(key->sk_subtype))
+		return;
+	if (key->sk_strategy < BTLessStrategyNumber ||
+		key->sk_strategy > BTGreaterStrategyNumber)
+		return;
+
+	att = TupleDescAttr(state->tupdesc, key->sk_attno - 1);
+	if (att->attisdropped)
+		return;
+
+	/* the minimum and maximum are by the column's collation */
+	if (OidIsValid(att->attcollation) && key->sk_collation != att->attcollation)
+		return;
+
+	typentry = lookup_type_cache(att->atttypid, TYPECACHE_BTREE_OPFAMILY);
+	if (!OidIsValid(typentry->btree_opf))
+		return;
+	cmp_proc = get_opfamily_proc(typentry->btree_opf, att->atttypid,
+								 key->sk_subtype, BTORDER_PROC);
+	if (!OidIsValid(cmp_proc))
+		return;
+
+	state->prune_keys[state->nprune] = key;
+	fmgr_info_cxt(cmp_proc, &state->prune_cmp[state->nprune],
+				  GetMemoryChunkContext(state));
+	state->nprune++;
+}
+
+/*
+ * Start reading the stripes of 'rel' visible to 'snapshot'.  'keys' are
+ * scan keys that the returned rows must satisfy, as for table_beginscan();
+ * they may be used to skip chunk groups, too.  'next_stripe' is the stripe
+ * counter in shared memory for a parallel scan, or NULL.
+ *
+ * All columns are read, unless columnar_set_pushdown() says otherwise.
+ */
+ColumnarReadState *
+columnar_begin_read(Relation rel, Snapshot snapshot, int nkeys, ScanKey keys,
+					pg_atomic_uint64 *next_stripe)
+{
+	ColumnarReadState *state = palloc0_object(ColumnarReadState);
+	int			natts = RelationGetDescr(rel)->natts;
+
+	state->rel = rel;
+	state->tupdesc = RelationGetDescr(rel);
+	state->locator = rel->rd_locator;
+	state->snapshot = snapshot;
+	state->nkeys = nkeys;
+	state->keys = keys;
+	state->shared_next_stripe = next_stripe;
+	state->chunk_group = -1;
+
+	state->needed = palloc_array(bool, natts);
+	for (int i = 0; i < natts; i++)
+		state->needed[i] = !TupleDescAttr(state->tupdesc, i)->attisdropped;
+
+	state->prune_keys = palloc_array(ScanKey, nkeys);
+	state->prune_cmp = palloc_array(FmgrInfo, nkeys);
+	for (int i = 0; i < nkeys; i++)
+		add_prune_key(state, &keys[i]);
+
+	state->values = palloc0_array(Datum *, natts);
+	state->isnull = palloc0_array(bool *, natts);
+	state->chunks = palloc0_array(ColumnChunk, natts);
+	state->chunk_found = palloc0_array(bool, natts);
+	state->chunk_read = palloc0_array(bool, natts);
+
+	state->stripe_cxt = AllocSetContextCreate(CurrentMemoryContext,
+											  "columnar stripe",
+											  ALLOCSET_DEFAULT_SIZES);
+	state->group_cxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "columnar chunk group",
+											 ALLOCSET_DEFAULT_SIZES);
+
+	state->stripes = columnar_read_stripes(&state->locator, snapshot);
+
+	return state;
+}
+
+/*
+ * Limit the columns read to 'attrs', in the format of pull_varattnos(), and
+ * use 'hints' to skip chunk groups.  See scan_set_pushdown in tableam.h.
+ */
+void
+columnar_set_pushdown(ColumnarReadState *state, Bitmapset *attrs,
+					  int nhints, ScanKey hints)
+{
+	int			natts = state->tupdesc->natts;
+
+	if (attrs != NULL)
+	{
+		for (int i = 0; i < natts; i++)
+			state->needed[i] =
+				!TupleDescAttr(state->tupdesc, i)->attisdropped &&
+				bms_is_member(i + 1 - FirstLowInvalidHeapAttributeNumber, attrs);
+
+		/* the scan keys are checked here, so we need their columns too */
+		for (int i = 0; i < state->nkeys; i++)
+		{
+			AttrNumber	attno = state->keys[i].sk_attno;
+
+			if (attno > 0 && attno <= natts)
+				state->needed[attno - 1] = true;
+		}
+	}
+
+	state->prune_keys = repalloc_array(state->prune_keys, ScanKey,
+									   state->nkeys + nhints);
+	state->prune_cmp = repalloc_array(state->prune_cmp, FmgrInfo,
+									  state->nkeys + nhints);
+	for (int i = 0; i < nhints; i++)
+		add_prune_key(state, &hints[i]);
+}
+
+/*
+ * Read only about 'max_groups' chunk groups, spread evenly over all of the
+ * stripes, for ANALYZE.  Returns the number of chunk groups that each one
+ * read stands for.
+ */
+int
+columnar_set_sample(ColumnarReadState *state, int max_groups)
+{
+	uint64		total = 0;
+	ListCell   *lc;
+
+	foreach(lc, state->stripes)
+		total += ((StripeMetadata *) lfirst(lc))->chunk_group_count;
+
+	state->sample_stride = Max(1, (total + max_groups - 1) / max_groups);
+
+	return state->sample_stride;
+}
+
+static bool
+advance_stripe(ColumnarReadState *state)
+{
+	uint64		idx;
+	MemoryContext oldcxt;
+
+	MemoryContextReset(state->stripe_cxt);
+	state->stripe = NULL;
+	state->mask = NULL;
+
+	if (state->shared_next_stripe)
+		idx = pg_atomic_fetch_add_u64(state->shared_next_stripe, 1);
+	else
+		idx = state->next_stripe++;
+
+	if (idx >= list_length(state->stripes))
+	{
+		state->done = true;
+		return false;
+	}
+
+	state->stripe = list_nth(state->stripes, idx);
+	state->chunk_group = -1;
+
+	oldcxt = MemoryContextSwitchTo(state->stripe_cxt);
+	state->mask = columnar_read_row_mask(&state->locator,
+										 state->stripe->stripe_id,
+										 state->snapshot);
+	MemoryContextSwitchTo(oldcxt);
+
+	return true;
+}
+
+static ColumnChunk *
+get_chunk(ColumnarReadState *state, int attidx)
+{
+	if (!state->chunk_read[attidx])
+	{
+		state->chunk_found[attidx] =
+			columnar_read_chunk(&state->locator,
+								state->stripe->stripe_id,
+								attidx + 1,
+								state->chunk_group,
+								state->snapshot,
+								&state->chunks[attidx]);
+		state->chunk_read[attidx] = true;
+		if (state->chunk_found[attidx] &&
+			state->chunks[attidx].row_count != state->group_rows)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid columnar chunk data")));
+	}
+
+	return state->chunk_found[attidx] ? &state->chunks[attidx] : NULL;
+}
+
+/*
+ * Can any row of the current chunk group satisfy the prune keys?
+ */
+static bool
+chunk_group_may_match(ColumnarReadState *state)
+{
+	for (int k = 0; k < state->nprune; k++)
+	{
+		ScanKey		key = state->prune_keys[k];
+		int			attidx = key->sk_attno - 1;
+		Form_pg_attribute att = TupleDescAttr(state->tupdesc, attidx);
+		ColumnChunk *chunk;
+		Datum		min;
+		Datum		max;
+		int32		cmp;
+
+		chunk = get_chunk(state, attidx);
+		if (chunk == NULL)
+			continue;			/* column added later; never mind */
+
+		/* all the operators used for keys are strict */
+		if (chunk->value_count == 0)
+			return false;
+
+		if (chunk->minimum == NULL || chunk->maximum == NULL)
+			continue;
+		min = columnar_decode_datum(att, chunk->minimum);
+		max = columnar_decode_datum(att, chunk->maximum);
+
+		switch (key->sk_strategy)
+		{
+			case BTLessStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  min, key->sk_argument));
+				if (cmp >= 0)
+					return false;
+				break;
+			case BTLessEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  min, key->sk_argument));
+				if (cmp > 0)
+					return false;
+				break;
+			case BTEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  min, key->sk_argument));
+				if (cmp > 0)
+					return false;
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  max, key->sk_argument));
+				if (cmp < 0)
+					return false;
+				break;
+			case BTGreaterEqualStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  max, key->sk_argument));
+				if (cmp < 0)
+					return false;
+				break;
+			case BTGreaterStrategyNumber:
+				cmp = DatumGetInt32(FunctionCall2Coll(&state->prune_cmp[k],
+													  key->sk_collation,
+													  max, key->sk_argument));
+				if (cmp <= 0)
+					return false;
+				break;
+		}
+	}
+
+	return true;
+}
+
+static void
+decode_chunk(ColumnarReadState *state, int attidx)
+{
+	Form_pg_attribute att = TupleDescAttr(state->tupdesc, attidx);
+	int			nrows = state->group_rows;
+	ColumnChunk *chunk = get_chunk(state, attidx);
+	Datum	   *values = palloc_array(Datum, nrows);
+	bool	   *isnull = palloc_array(bool, nrows);
+
+	if (chunk == NULL)
+	{
+		bool		missing_isnull;
+		Datum		missing;
+
+		/* the column was added after the stripe was written */
+		missing = getmissingattr(state->tupdesc, attidx + 1, &missing_isnull);
+		for (int i = 0; i < nrows; i++)
+		{
+			values[i] = missing;
+			isnull[i] = missing_isnull;
+		}
+	}
+	else
+	{
+		Datum	   *decoded = NULL;
+		uint8	   *nulls = NULL;
+		int			j = 0;
+
+		if (chunk->value_count > 0)
+			decoded = columnar_decode_values(att, chunk->encoding,
+											 DatumGetByteaPP(chunk->data),
+											 chunk->value_count);
+		if (chunk->nulls != NULL)
+		{
+			if (VARSIZE_ANY_EXHDR(chunk->nulls) < (nrows + 7) / 8)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("invalid columnar chunk data")));
+			nulls = (uint8 *) VARDATA_ANY(chunk->nulls);
+		}
+
+		for (int i = 0; i < nrows; i++)
+		{
+			isnull[i] = nulls != NULL && (nulls[i / 8] & (1 << (i % 8))) != 0;
+			if (isnull[i])
+				values[i] = (Datum) 0;
+			else
+			{
+				if (j >= chunk->value_count)
+					ereport(ERROR,
+							(errcode(ERRCODE_DATA_CORRUPTED),
+							 errmsg("invalid columnar chunk data")));
+				values[i] = decoded[j++];
+			}
+		}
+		if (j != chunk->value_count)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid columnar chunk data")));
+	}
+
+	state->values[attidx] = values;
+	state->isnull[attidx] = isnull;
+}
+
+/*
+ * Load the current chunk group of the current stripe.  Returns false if it
+ * can be skipped.
+ */
+static bool
+load_chunk_group(ColumnarReadState *state)
+{
+	int			natts = state->tupdesc->natts;
+	int32		limit = state->stripe->chunk_group_row_limit;
+	MemoryContext oldcxt;
+	bool		result = true;
+
+	MemoryContextReset(state->group_cxt);
+	oldcxt = MemoryContextSwitchTo(state->group_cxt);
+
+	state->group_first_row = (uint32) state->chunk_group * limit;
+	state->group_rows = Min(limit,
+							state->stripe->row_count - state->group_first_row);
+	state->group_pos = 0;
+	for (int i = 0; i < natts; i++)
+	{
+		state->values[i] = NULL;
+		state->isnull[i] = NULL;
+		state->chunk_read[i] = false;
+	}
+
+	if (!chunk_group_may_match(state))
+		result = false;
+	else
+	{
+		for (int i = 0; i < natts; i++)
+		{
+			if (state->needed[i])
+				decode_chunk(state, i);
+		}
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return result;
+}
+
+/*
+ * Move to the next chunk group to read.  Returns false at the end of the
+ * scan.
+ */
+bool
+columnar_read_next_group(ColumnarReadState *state)
+{
+	while (!state->done)
+	{
+		if (state->stripe == NULL ||
+			state->chunk_group + 1 >= state->stripe->chunk_group_count)
+		{
+			advance_stripe(state);
+			continue;
+		}
+
+		state->chunk_group++;
+		if (state->sample_stride > 1 &&
+			state->groups_seen++ % state->sample_stride != 0)
+			continue;
+
+		if (load_chunk_group(state))
+			return true;
+	}
+
+	return false;
+}
+
+static bool
+row_matches_keys(ColumnarReadState *state, Datum *values, bool *isnull)
+{
+	for (int i = 0; i < state->nkeys; i++)
+	{
+		ScanKey		key = &state->keys[i];
+		int			attidx = key->sk_attno - 1;
+
+		if (isnull[attidx] || (key->sk_flags & SK_ISNULL))
+			return false;
+		if (!DatumGetBool(FunctionCall2Coll(&key->sk_func, key->sk_collation,
+											values[attidx], key->sk_argument)))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Return the next row of the current chunk group.  Columns that are not
+ * read are returned as NULL.  Returns false at the end of the chunk group.
+ */
+bool
+columnar_read_group_row(ColumnarReadState *state, Datum *values, bool *isnull,
+						ItemPointer tid)
+{
+	int			natts = state->tupdesc->natts;
+
+	if (state->stripe == NULL)
+		return false;
+
+	while (state->group_pos < state->group_rows)
+	{
+		int32		pos = state->group_pos++;
+		uint32		row = state->group_first_row + pos;
+
+		if (bms_is_member(row, state->mask))
+			continue;
+
+		for (int i = 0; i < natts; i++)
+		{
+			if (state->values[i] == NULL)
+			{
+				values[i] = (Datum) 0;
+				isnull[i] = true;
+			}
+			else
+			{
+				values[i] = state->values[i][pos];
+				isnull[i] = state->isnull[i][pos];
+			}
+		}
+
+		if (state->nkeys > 0 && !row_matches_keys(state, values, isnull))
+			continue;
+
+		ColumnarStripeRowTid(tid, state->stripe->stripe_id, row);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Return the next row.  The values stay valid until the next call.
+ */
+bool
+columnar_read_next_row(ColumnarReadState *state, Datum *values, bool *isnull,
+					   ItemPointer tid)
+{
+	for (;;)
+	{
+		if (columnar_read_group_row(state, values, isnull, tid))
+			return true;
+		if (!columnar_read_next_group(state))
+			return false;
+	}
+}
+
+void
+columnar_rescan_read(ColumnarReadState *state)
+{
+	MemoryContextReset(state->group_cxt);
+	MemoryContextReset(state->stripe_cxt);
+	state->stripe = NULL;
+	state->mask = NULL;
+	state->next_stripe = 0;
+	state->done = false;
+	state->groups_seen = 0;
+}
+
+void
+columnar_end_read(ColumnarReadState *state)
+{
+	MemoryContextDelete(state->group_cxt);
+	MemoryContextDelete(state->stripe_cxt);
+	pfree(state);
+}
+
+/*
+ * Fetch the row of a stripe with the given TID, if it's visible to
+ * 'snapshot', and store it in 'slot'.
+ */
+bool
+columnar_read_row(Relation rel, Snapshot snapshot, ItemPointer tid,
+				  TupleTableSlot *slot)
+{
+	RelFileLocator *locator = &rel->rd_locator;
+	uint64		stripe_id = ColumnarTidGetStripe(tid);
+	uint32		row = ColumnarTidGetRow(tid);
+	ColumnarReadState *state;
+	StripeMetadata *stripe;
+	int32		pos;
+
+	stripe = columnar_read_stripe(locator, stripe_id, snapshot);
+	if (stripe == NULL || row >= stripe->row_count)
+		return false;
+
+	/* even SnapshotAny sees rows that have been deleted */
+	if (snapshot->snapshot_type != SNAPSHOT_ANY)
+	{
+		TransactionId xmin;
+		CommandId	cmin;
+		ItemPointerData new_tid;
+
+		if (columnar_row_is_masked(locator, stripe_id, row, snapshot,
+								   &xmin, &cmin, &new_tid))
+			return false;
+	}
+
+	state = palloc0_object(ColumnarReadState);
+	state->rel = rel;
+	state->tupdesc = RelationGetDescr(rel);
+	state->locator = *locator;
+	state->snapshot = snapshot;
+	state->needed = palloc_array(bool, state->tupdesc->natts);
+	for (int i = 0; i < state->tupdesc->natts; i++)
+		state->needed[i] = !TupleDescAttr(state->tupdesc, i)->attisdropped;
+	state->values = palloc0_array(Datum *, state->tupdesc->natts);
+	state->isnull = palloc0_array(bool *, state->tupdesc->natts);
+	state->chunks = palloc0_array(ColumnChunk, state->tupdesc->natts);
+	state->chunk_found = palloc0_array(bool, state->tupdesc->natts);
+	state->chunk_read = palloc0_array(bool, state->tupdesc->natts);
+	state->group_cxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "columnar chunk group",
+											 ALLOCSET_DEFAULT_SIZES);
+	state->stripe = stripe;
+	state->chunk_group = row / stripe->chunk_group_row_limit;
+	load_chunk_group(state);
+
+	ExecClearTuple(slot);
+	pos = row - state->group_first_row;
+	for (int i = 0; i < state->tupdesc->natts; i++)
+	{
+		if (state->values[i] == NULL)
+		{
+			slot->tts_values[i] = (Datum) 0;
+			slot->tts_isnull[i] = true;
+		}
+		else
+		{
+			slot->tts_values[i] = state->values[i][pos];
+			slot->tts_isnull[i] = state->isnull[i][pos];
+		}
+	}
+	ExecStoreVirtualTuple(slot);
+	ExecMaterializeSlot(slot);
+	slot->tts_tableOid = RelationGetRelid(rel);
+	slot->tts_tid = *tid;
+
+	MemoryContextDelete(state->group_cxt);
+
+	return true;
+}
+
+/*
+ * Estimate the number of rows and the size in pages of the stripes.
+ */
+void
+columnar_read_totals(Relation rel, Snapshot snapshot, double *rows,
+					 double *pages)
+{
+	List	   *stripes;
+	ListCell   *lc;
+
+	*rows = 0;
+	*pages = 0;
+	stripes = columnar_read_stripes(&rel->rd_locator, snapshot);
+	foreach(lc, stripes)
+	{
+		StripeMetadata *stripe = lfirst(lc);
+
+		*rows += stripe->row_count;
+		*pages += (double) stripe->data_size / BLCKSZ;
+	}
+	list_free_deep(stripes);
+}
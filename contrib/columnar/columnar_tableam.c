@@ -0,0 +1,1160 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_tableam.c
+ *		Table access method callbacks of the columnar table AM.
+ *
+ * The delta is handled entirely by the heap AM, whose callbacks are called
+ * with the columnar relation.  Scans read the stripes first and then the
+ * delta.  Rows in stripes are deleted by recording them in the row mask, and
+ * updated by deleting them and inserting the new version into the delta.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_tableam.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/heapam.h"
+#include "access/heaptoast.h"
+#include "access/relscan.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_publication.h"
+#include "columnar.h"
+#include "commands/defrem.h"
+#include "commands/event_trigger.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "optimizer/plancat.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "storage/lock.h"
+#include "storage/lmgr.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+PG_MODULE_MAGIC_EXT(
+					.name = "columnar",
+					.version = PG_VERSION
+);
+
+/* GUC variables */
+int			columnar_stripe_row_limit = 150000;
+int			columnar_chunk_group_row_limit = 10000;
+
+/* Number of chunk groups that ANALYZE reads from the stripes */
+#define COLUMNAR_ANALYZE_CHUNK_GROUPS	30
+
+typedef struct ColumnarScanDescData
+{
+	TableScanDescData rs_base;	/* AM independent part of the descriptor */
+
+	TableScanDesc heapscan;		/* scan of the delta */
+	ColumnarReadState *reader;	/* reader of the stripes, if any */
+	bool		in_delta;		/* done with the stripes? */
+
+	/* State for ANALYZE, which samples the stripes after the delta */
+	Snapshot	analyze_snapshot;
+	BlockNumber analyze_blocks; /* delta blocks sampled */
+	double		analyze_weight; /* rows that each stripe row stands for */
+} ColumnarScanDescData;
+
+typedef struct ColumnarScanDescData *ColumnarScanDesc;
+
+static const TableAmRoutine columnar_methods;
+static const TableAmRoutine *heap_methods;
+
+PG_FUNCTION_INFO_V1(columnar_handler);
+PG_FUNCTION_INFO_V1(columnar_compact);
+PG_FUNCTION_INFO_V1(columnar_drop_orphans);
+
+
+/* ------------------------------------------------------------------------
+ * Slot related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static const TupleTableSlotOps *
+columnar_slot_callbacks(Relation relation)
+{
+	/* rows of the delta are stored in buffers; rows of stripes are virtual */
+	return &TTSOpsBufferHeapTuple;
+}
+
+
+/* ------------------------------------------------------------------------
+ * Scan related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+/* The counter of the next stripe to read follows heap's parallel scan state */
+static inline pg_atomic_uint64 *
+parallel_next_stripe(ParallelTableScanDesc pscan)
+{
+	return (pg_atomic_uint64 *)
+		((char *) pscan + MAXALIGN(sizeof(ParallelBlockTableScanDescData)));
+}
+
+static TableScanDesc
+columnar_beginscan(Relation relation, Snapshot snapshot,
+				   int nkeys, ScanKeyData *key,
+				   ParallelTableScanDesc parallel_scan,
+				   uint32 flags)
+{
+	ColumnarScanDesc scan = palloc0_object(ColumnarScanDescData);
+
+	scan->heapscan = heap_methods->scan_begin(relation, snapshot, nkeys, key,
+											  parallel_scan, flags);
+
+	scan->rs_base.rs_rd = relation;
+	scan->rs_base.rs_snapshot = scan->heapscan->rs_snapshot;
+	scan->rs_base.rs_nkeys = nkeys;
+	scan->rs_base.rs_key = scan->heapscan->rs_key;
+	scan->rs_base.rs_flags = flags;
+	scan->rs_base.rs_parallel = parallel_scan;
+	scan->rs_base.rs_instrument = scan->heapscan->rs_instrument;
+
+	if (flags & SO_TYPE_SEQSCAN)
+		scan->reader = columnar_begin_read(relation, snapshot, nkeys,
+										   scan->rs_base.rs_key,
+										   parallel_scan ?
+										   parallel_next_stripe(parallel_scan) :
+										   NULL);
+
+	return (TableScanDesc) scan;
+}
+
+static void
+columnar_endscan(TableScanDesc sscan)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (scan->reader)
+		columnar_end_read(scan->reader);
+	if (scan->analyze_snapshot)
+		UnregisterSnapshot(scan->analyze_snapshot);
+	heap_methods->scan_end(scan->heapscan);
+	pfree(scan);
+}
+
+static void
+columnar_rescan(TableScanDesc sscan, ScanKeyData *key, bool set_params,
+				bool allow_strat, bool allow_sync, bool allow_pagemode)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	/* this also copies the new keys into the array the reader uses */
+	heap_methods->scan_rescan(scan->heapscan, key, set_params, allow_strat,
+							  allow_sync, allow_pagemode);
+	scan->rs_base.rs_flags = scan->heapscan->rs_flags;
+
+	if (scan->reader)
+		columnar_rescan_read(scan->reader);
+	scan->in_delta = false;
+}
+
+static bool
+columnar_getnextslot(TableScanDesc sscan, ScanDirection direction,
+					 TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (scan->reader && !scan->in_delta)
+	{
+		ItemPointerData tid;
+
+		if (!ScanDirectionIsForward(direction))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("backward scans are not supported on columnar tables")));
+
+		ExecClearTuple(slot);
+		if (columnar_read_next_row(scan->reader, slot->tts_values,
+								   slot->tts_isnull, &tid))
+		{
+			ExecStoreVirtualTuple(slot);
+			slot->tts_tableOid = RelationGetRelid(sscan->rs_rd);
+			slot->tts_tid = tid;
+			pgstat_count_heap_getnext(sscan->rs_rd);
+			return true;
+		}
+		scan->in_delta = true;
+	}
+
+	return heap_methods->scan_getnextslot(scan->heapscan, direction, slot);
+}
+
+static void
+columnar_scan_set_pushdown(TableScanDesc sscan, Bitmapset *attrs,
+						   int nkeys, ScanKeyData *keys)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (scan->reader)
+		columnar_set_pushdown(scan->reader, attrs, nkeys, keys);
+}
+
+
+/* ------------------------------------------------------------------------
+ * Parallel scan callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static Size
+columnar_parallelscan_estimate(Relation rel)
+{
+	return MAXALIGN(sizeof(ParallelBlockTableScanDescData)) +
+		sizeof(pg_atomic_uint64);
+}
+
+static Size
+columnar_parallelscan_initialize(Relation rel, ParallelTableScanDesc pscan)
+{
+	table_block_parallelscan_initialize(rel, pscan);
+	pg_atomic_init_u64(parallel_next_stripe(pscan), 0);
+
+	return columnar_parallelscan_estimate(rel);
+}
+
+static void
+columnar_parallelscan_reinitialize(Relation rel, ParallelTableScanDesc pscan)
+{
+	table_block_parallelscan_reinitialize(rel, pscan);
+	pg_atomic_write_u64(parallel_next_stripe(pscan), 0);
+}
+
+
+/* ------------------------------------------------------------------------
+ * Index scan callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static void
+indexes_not_supported(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("indexes are not supported on columnar tables")));
+}
+
+static IndexFetchTableData *
+columnar_index_fetch_begin(Relation rel, uint32 flags)
+{
+	indexes_not_supported();
+	return NULL;				/* keep compiler quiet */
+}
+
+static void
+columnar_index_fetch_reset(IndexFetchTableData *scan)
+{
+	indexes_not_supported();
+}
+
+static void
+columnar_index_fetch_end(IndexFetchTableData *scan)
+{
+	indexes_not_supported();
+}
+
+static bool
+columnar_index_fetch_tuple(struct IndexFetchTableData *scan,
+						   ItemPointer tid,
+						   Snapshot snapshot,
+						   TupleTableSlot *slot,
+						   bool *call_again, bool *all_dead)
+{
+	indexes_not_supported();
+	return false;				/* keep compiler quiet */
+}
+
+
+/* ------------------------------------------------------------------------
+ * Callbacks for non-modifying operations on individual tuples
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_fetch_row_version(Relation relation, ItemPointer tid,
+						   Snapshot snapshot, TupleTableSlot *slot)
+{
+	if (!ColumnarTidIsStripeRow(tid))
+		return heap_methods->tuple_fetch_row_version(relation, tid, snapshot,
+													 slot);
+
+	return columnar_read_row(relation, snapshot, tid, slot);
+}
+
+static bool
+columnar_tuple_tid_valid(TableScanDesc sscan, ItemPointer tid)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (ColumnarTidIsStripeRow(tid))
+		return ItemPointerIsValid(tid);
+
+	return heap_methods->tuple_tid_valid(scan->heapscan, tid);
+}
+
+static void
+columnar_get_latest_tid(TableScanDesc sscan, ItemPointer tid)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	/*
+	 * The new version of an updated stripe row is in the delta, but we don't
+	 * follow that link here, as there's no way to tell whether the row was
+	 * updated or deleted and re-inserted.
+	 */
+	if (ColumnarTidIsStripeRow(tid))
+		return;
+
+	heap_methods->tuple_get_latest_tid(scan->heapscan, tid);
+}
+
+/*
+ * Is the row of a stripe with the given TID visible to 'snapshot'?
+ */
+static bool
+stripe_row_is_visible(Relation rel, ItemPointer tid, Snapshot snapshot)
+{
+	RelFileLocator *locator = &rel->rd_locator;
+	uint64		stripe_id = ColumnarTidGetStripe(tid);
+	uint32		row = ColumnarTidGetRow(tid);
+	StripeMetadata *stripe;
+	TransactionId xmin;
+	CommandId	cmin;
+	ItemPointerData new_tid;
+	bool		result;
+
+	stripe = columnar_read_stripe(locator, stripe_id, snapshot);
+	result = stripe != NULL && row < stripe->row_count &&
+		!columnar_row_is_masked(locator, stripe_id, row, snapshot,
+								&xmin, &cmin, &new_tid);
+	if (stripe)
+		pfree(stripe);
+
+	return result;
+}
+
+static bool
+columnar_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+								  Snapshot snapshot)
+{
+	if (!ColumnarTidIsStripeRow(&slot->tts_tid))
+		return heap_methods->tuple_satisfies_snapshot(rel, slot, snapshot);
+
+	return stripe_row_is_visible(rel, &slot->tts_tid, snapshot);
+}
+
+static TransactionId
+columnar_index_delete_tuples(Relation rel, TM_IndexDeleteOp *delstate)
+{
+	indexes_not_supported();
+	return InvalidTransactionId;	/* keep compiler quiet */
+}
+
+
+/* ----------------------------------------------------------------------------
+ *  Functions for manipulations of physical tuples
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+columnar_tuple_insert(Relation relation, TupleTableSlot *slot, CommandId cid,
+					  uint32 options, BulkInsertState bistate)
+{
+	heap_methods->tuple_insert(relation, slot, cid, options, bistate);
+}
+
+static void
+columnar_tuple_insert_speculative(Relation relation, TupleTableSlot *slot,
+								  CommandId cid, uint32 options,
+								  BulkInsertState bistate, uint32 specToken)
+{
+	heap_methods->tuple_insert_speculative(relation, slot, cid, options,
+										   bistate, specToken);
+}
+
+static void
+columnar_tuple_complete_speculative(Relation relation, TupleTableSlot *slot,
+									uint32 specToken, bool succeeded)
+{
+	heap_methods->tuple_complete_speculative(relation, slot, specToken,
+											 succeeded);
+}
+
+static void
+columnar_multi_insert(Relation relation, TupleTableSlot **slots, int nslots,
+					  CommandId cid, uint32 options, BulkInsertState bistate)
+{
+	heap_methods->multi_insert(relation, slots, nslots, cid, options, bistate);
+}
+
+/*
+ * Lock the stripe that the row with the given TID belongs to.  Rows of
+ * stripes have no header to record a locker in, so all of the rows of a
+ * stripe are locked together, with a heavyweight lock on the stripe's first
+ * TID.  The lock is held until the end of the transaction.
+ */
+static bool
+lock_stripe(Relation rel, ItemPointer tid, LOCKMODE lockmode,
+			LockWaitPolicy wait_policy)
+{
+	ItemPointerData stripe_tid;
+
+	ColumnarStripeRowTid(&stripe_tid, ColumnarTidGetStripe(tid), 0);
+
+	switch (wait_policy)
+	{
+		case LockWaitBlock:
+			LockTuple(rel, &stripe_tid, lockmode);
+			break;
+		case LockWaitSkip:
+			if (!ConditionalLockTuple(rel, &stripe_tid, lockmode, false))
+				return false;
+			break;
+		case LockWaitError:
+			if (!ConditionalLockTuple(rel, &stripe_tid, lockmode,
+									  log_lock_failures))
+				ereport(ERROR,
+						(errcode(ERRCODE_LOCK_NOT_AVAILABLE),
+						 errmsg("could not obtain lock on row in relation \"%s\"",
+								RelationGetRelationName(rel))));
+			break;
+	}
+
+	return true;
+}
+
+/*
+ * Check whether the row of a stripe has been deleted or updated, including
+ * by transactions that our snapshot doesn't see.  The caller must hold the
+ * stripe lock.
+ */
+static TM_Result
+check_stripe_row(Relation rel, ItemPointer tid, TM_FailureData *tmfd)
+{
+	TransactionId xmin;
+	CommandId	cmin;
+	ItemPointerData new_tid;
+
+	if (!columnar_row_is_masked(&rel->rd_locator,
+								ColumnarTidGetStripe(tid),
+								ColumnarTidGetRow(tid),
+								SnapshotSelf, &xmin, &cmin, &new_tid))
+		return TM_Ok;
+
+	tmfd->xmax = xmin;
+	tmfd->traversed = false;
+	tmfd->ctid = ItemPointerIsValid(&new_tid) ? new_tid : *tid;
+	if (TransactionIdIsCurrentTransactionId(xmin))
+	{
+		tmfd->cmax = cmin;
+		return TM_SelfModified;
+	}
+	tmfd->cmax = InvalidCommandId;
+
+	return ItemPointerIsValid(&new_tid) ? TM_Updated : TM_Deleted;
+}
+
+/*
+ * Changes to the rows of stripes are recorded in the row mask, which logical
+ * decoding knows nothing about.  They must not be made while the table
+ * publishes them, as subscribers would quietly miss them.
+ */
+static void
+get_stripe_row_pubactions(Relation rel, bool *pubupdate, bool *pubdelete)
+{
+	PublicationDesc pubdesc;
+
+	*pubupdate = false;
+	*pubdelete = false;
+	if (!RelationIsLogicallyLogged(rel))
+		return;
+
+	RelationBuildPublicationDesc(rel, &pubdesc);
+	*pubupdate = pubdesc.pubactions.pubupdate;
+	*pubdelete = pubdesc.pubactions.pubdelete;
+}
+
+/*
+ * Delete the row of a stripe, or update it if 'slot' holds its new version.
+ */
+static TM_Result
+modify_stripe_row(Relation rel, ItemPointer tid, TupleTableSlot *slot,
+				  CommandId cid, bool wait, bool logical,
+				  TM_FailureData *tmfd)
+{
+	TM_Result	result;
+	bool		pubupdate;
+	bool		pubdelete;
+
+	get_stripe_row_pubactions(rel, &pubupdate, &pubdelete);
+	if (slot && pubupdate)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot update rows in stripes of table \"%s\" because it publishes updates",
+						RelationGetRelationName(rel))));
+	if (!slot && pubdelete)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot delete rows in stripes of table \"%s\" because it publishes deletes",
+						RelationGetRelationName(rel))));
+
+	if (!lock_stripe(rel, tid, ExclusiveLock,
+					 wait ? LockWaitBlock : LockWaitSkip))
+	{
+		tmfd->ctid = *tid;
+		tmfd->xmax = InvalidTransactionId;
+		tmfd->cmax = InvalidCommandId;
+		tmfd->traversed = false;
+		return TM_BeingModified;
+	}
+
+	result = check_stripe_row(rel, tid, tmfd);
+	if (result != TM_Ok)
+		return result;
+
+	if (slot)
+		heap_methods->tuple_insert(rel, slot, cid,
+								   logical ? 0 : TABLE_INSERT_NO_LOGICAL,
+								   NULL);
+
+	columnar_insert_row_mask(&rel->rd_locator,
+							 ColumnarTidGetStripe(tid), ColumnarTidGetRow(tid),
+							 slot ? &slot->tts_tid : NULL, cid);
+
+	return TM_Ok;
+}
+
+static TM_Result
+columnar_tuple_delete(Relation relation, ItemPointer tid, CommandId cid,
+					  uint32 options, Snapshot snapshot, Snapshot crosscheck,
+					  bool wait, TM_FailureData *tmfd)
+{
+	if (!ColumnarTidIsStripeRow(tid))
+		return heap_methods->tuple_delete(relation, tid, cid, options,
+										  snapshot, crosscheck, wait, tmfd);
+
+	return modify_stripe_row(relation, tid, NULL, cid, wait, false, tmfd);
+}
+
+static TM_Result
+columnar_tuple_update(Relation relation, ItemPointer otid,
+					  TupleTableSlot *slot, CommandId cid, uint32 options,
+					  Snapshot snapshot, Snapshot crosscheck, bool wait,
+					  TM_FailureData *tmfd, LockTupleMode *lockmode,
+					  TU_UpdateIndexes *update_indexes,
+					  Bitmapset **unchanged_attrs)
+{
+	if (!ColumnarTidIsStripeRow(otid))
+		return heap_methods->tuple_update(relation, otid, slot, cid, options,
+										  snapshot, crosscheck, wait, tmfd,
+										  lockmode, update_indexes,
+										  unchanged_attrs);
+
+	*lockmode = LockTupleExclusive;
+	*update_indexes = TU_None;
+	if (unchanged_attrs)
+		*unchanged_attrs = NULL;
+
+	/*
+	 * The deletion of the old version can't be decoded, so don't let the new
+	 * version be decoded as an insertion either.
+	 */
+	return modify_stripe_row(relation, otid, slot, cid, wait, false, tmfd);
+}
+
+static TM_Result
+columnar_tuple_lock(Relation relation, ItemPointer tid, Snapshot snapshot,
+					TupleTableSlot *slot, CommandId cid, LockTupleMode mode,
+					LockWaitPolicy wait_policy, uint8 flags,
+					TM_FailureData *tmfd)
+{
+	LOCKMODE	lockmode;
+	TM_Result	result;
+
+	if (!ColumnarTidIsStripeRow(tid))
+		return heap_methods->tuple_lock(relation, tid, snapshot, slot, cid,
+										mode, wait_policy, flags, tmfd);
+
+	if (mode == LockTupleKeyShare || mode == LockTupleShare)
+		lockmode = ShareLock;
+	else
+		lockmode = ExclusiveLock;
+
+	if (!lock_stripe(relation, tid, lockmode, wait_policy))
+		return TM_WouldBlock;
+
+	result = check_stripe_row(relation, tid, tmfd);
+
+	/* follow an update to the new version in the delta */
+	if (result == TM_Updated && (flags & TUPLE_LOCK_FLAG_FIND_LAST_VERSION))
+	{
+		ItemPointerData new_tid = tmfd->ctid;
+
+		result = heap_methods->tuple_lock(relation, &new_tid, snapshot, slot,
+										  cid, mode, wait_policy, flags, tmfd);
+		tmfd->traversed = true;
+		return result;
+	}
+	if (result != TM_Ok)
+		return result;
+
+	if (!columnar_read_row(relation, SnapshotAny, tid, slot))
+		elog(ERROR, "failed to fetch columnar row (%u,%u) in relation \"%s\"",
+			 ItemPointerGetBlockNumber(tid), ItemPointerGetOffsetNumber(tid),
+			 RelationGetRelationName(relation));
+	tmfd->traversed = false;
+
+	return TM_Ok;
+}
+
+
+/* ------------------------------------------------------------------------
+ * DDL related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static void
+columnar_relation_set_new_filelocator(Relation rel,
+									  const RelFileLocator *newrlocator,
+									  char persistence,
+									  TransactionId *freezeXid,
+									  MultiXactId *minmulti)
+{
+	/*
+	 * The metadata is WAL-logged and kept across a crash, while an unlogged
+	 * relation is not, so the two could not be kept consistent.
+	 */
+	if (persistence != RELPERSISTENCE_PERMANENT)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("unlogged and temporary columnar tables are not supported")));
+
+	heap_methods->relation_set_new_filelocator(rel, newrlocator, persistence,
+											   freezeXid, minmulti);
+
+	/* the old storage is dropped at commit, and the new one starts empty */
+	if (!RelFileLocatorEquals(rel->rd_locator, *newrlocator))
+		columnar_delete_metadata(&rel->rd_locator);
+	columnar_delete_metadata(newrlocator);
+}
+
+static void
+columnar_relation_nontransactional_truncate(Relation rel)
+{
+	heap_methods->relation_nontransactional_truncate(rel);
+	columnar_delete_metadata(&rel->rd_locator);
+}
+
+static void
+columnar_relation_copy_data(Relation rel, const RelFileLocator *newrlocator)
+{
+	heap_methods->relation_copy_data(rel, newrlocator);
+	columnar_move_metadata(&rel->rd_locator, newrlocator);
+}
+
+/*
+ * VACUUM FULL and CLUSTER write all of the live rows of the old table into
+ * stripes of the new one, leaving its delta empty.
+ */
+static void
+columnar_relation_copy_for_cluster(Relation OldTable, Relation NewTable,
+								   Relation OldIndex, bool use_sort,
+								   TransactionId OldestXmin,
+								   Snapshot snapshot,
+								   TransactionId *xid_cutoff,
+								   MultiXactId *multi_cutoff,
+								   double *num_tuples,
+								   double *tups_vacuumed,
+								   double *tups_recently_dead)
+{
+	Snapshot	read_snapshot;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ColumnarWriteState *writer;
+
+	if (snapshot != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("concurrent repacking of columnar tables is not supported")));
+
+	Assert(OldIndex == NULL);
+
+	*num_tuples = 0;
+	*tups_vacuumed = 0;
+	*tups_recently_dead = 0;
+
+	/*
+	 * Unlike for heap tables, rows that are deleted but still visible to
+	 * someone are not kept.  Nobody else can be using the table while we
+	 * hold AccessExclusiveLock on it, though.
+	 */
+	read_snapshot = RegisterSnapshot(GetLatestSnapshot());
+	slot = table_slot_create(OldTable, NULL);
+	scan = table_beginscan(OldTable, read_snapshot, 0, NULL, SO_NONE);
+	writer = columnar_begin_write(NewTable);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		slot_getallattrs(slot);
+		columnar_write_row(writer, slot->tts_values, slot->tts_isnull);
+		*num_tuples += 1;
+	}
+
+	columnar_end_write(writer);
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+	UnregisterSnapshot(read_snapshot);
+
+	/* the old storage is dropped, without a DROP event */
+	columnar_delete_metadata(&OldTable->rd_locator);
+}
+
+static void
+columnar_vacuum_rel(Relation rel, const VacuumParams *params,
+					BufferAccessStrategy bstrategy)
+{
+	heap_methods->relation_vacuum(rel, params, bstrategy);
+}
+
+/*
+ * ANALYZE samples the delta as for a heap table, and then some chunk groups
+ * of the stripes.  ANALYZE extrapolates the number of rows it sees in the
+ * delta blocks it samples to the whole delta, so each row of a stripe is
+ * counted with the weight that makes the total come out right.
+ */
+static bool
+columnar_scan_analyze_next_block(TableScanDesc sscan, ReadStream *stream)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (scan->analyze_snapshot == NULL)
+	{
+		Relation	rel = sscan->rs_rd;
+		BlockNumber nblocks;
+		int			stride;
+
+		if (heap_methods->scan_analyze_next_block(scan->heapscan, stream))
+		{
+			scan->analyze_blocks++;
+			return true;
+		}
+
+		scan->analyze_snapshot = RegisterSnapshot(GetTransactionSnapshot());
+		scan->reader = columnar_begin_read(rel, scan->analyze_snapshot,
+										   0, NULL, NULL);
+		stride = columnar_set_sample(scan->reader,
+									 COLUMNAR_ANALYZE_CHUNK_GROUPS);
+
+		nblocks = RelationGetNumberOfBlocks(rel);
+		scan->analyze_weight = stride;
+		if (scan->analyze_blocks > 0 && nblocks > 0)
+			scan->analyze_weight *= (double) scan->analyze_blocks / nblocks;
+	}
+
+	return columnar_read_next_group(scan->reader);
+}
+
+static bool
+columnar_scan_analyze_next_tuple(TableScanDesc sscan,
+								 double *liverows, double *deadrows,
+								 TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+	ItemPointerData tid;
+
+	if (scan->reader == NULL)
+		return heap_methods->scan_analyze_next_tuple(scan->heapscan,
+													 liverows, deadrows,
+													 slot);
+
+	ExecClearTuple(slot);
+	if (!columnar_read_group_row(scan->reader, slot->tts_values,
+								 slot->tts_isnull, &tid))
+		return false;
+
+	ExecStoreVirtualTuple(slot);
+	slot->tts_tableOid = RelationGetRelid(sscan->rs_rd);
+	slot->tts_tid = tid;
+	*liverows += scan->analyze_weight;
+
+	return true;
+}
+
+static double
+columnar_index_build_range_scan(Relation tableRelation,
+								Relation indexRelation,
+								IndexInfo *indexInfo,
+								bool allow_sync,
+								bool anyvisible,
+								bool progress,
+								BlockNumber start_blockno,
+								BlockNumber numblocks,
+								IndexBuildCallback callback,
+								void *callback_state,
+								TableScanDesc scan)
+{
+	indexes_not_supported();
+	return 0;					/* keep compiler quiet */
+}
+
+static void
+columnar_index_validate_scan(Relation tableRelation,
+							 Relation indexRelation,
+							 IndexInfo *indexInfo,
+							 Snapshot snapshot,
+							 ValidateIndexState *state)
+{
+	indexes_not_supported();
+}
+
+
+/* ------------------------------------------------------------------------
+ * Miscellaneous callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_relation_needs_toast_table(Relation rel)
+{
+	return heap_methods->relation_needs_toast_table(rel);
+}
+
+static Oid
+columnar_relation_toast_am(Relation rel)
+{
+	/* the TOAST table is an ordinary heap table */
+	return HEAP_TABLE_AM_OID;
+}
+
+
+/* ------------------------------------------------------------------------
+ * Planner related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static void
+columnar_estimate_rel_size(Relation rel, int32 *attr_widths,
+						   BlockNumber *pages, double *tuples,
+						   double *allvisfrac)
+{
+	BlockNumber curpages = RelationGetNumberOfBlocks(rel);
+	int32		tuple_width;
+	double		density;
+	double		stripe_rows;
+	double		stripe_pages;
+	Snapshot	snapshot;
+
+	/*
+	 * reltuples counts the rows of the stripes as well as those of the
+	 * delta, so estimate the delta from the row width alone.
+	 */
+	tuple_width = get_rel_data_width(rel, attr_widths);
+	tuple_width += MAXALIGN(SizeofHeapTupleHeader);
+	tuple_width += sizeof(ItemIdData);
+	density = (BLCKSZ - SizeOfPageHeaderData) / tuple_width;
+
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	columnar_read_totals(rel, snapshot, &stripe_rows, &stripe_pages);
+	UnregisterSnapshot(snapshot);
+
+	*pages = curpages + (BlockNumber) ceil(stripe_pages);
+	*tuples = rint(curpages * density) + stripe_rows;
+	*allvisfrac = 0;
+}
+
+
+/* ------------------------------------------------------------------------
+ * Executor related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_scan_sample_next_block(TableScanDesc scan,
+								SampleScanState *scanstate)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("TABLESAMPLE is not supported on columnar tables")));
+	return false;				/* keep compiler quiet */
+}
+
+static bool
+columnar_scan_sample_next_tuple(TableScanDesc scan,
+								SampleScanState *scanstate,
+								TupleTableSlot *slot)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("TABLESAMPLE is not supported on columnar tables")));
+	return false;				/* keep compiler quiet */
+}
+
+
+/* ------------------------------------------------------------------------
+ * Definition of the columnar table access method.
+ * ------------------------------------------------------------------------
+ */
+
+static const TableAmRoutine columnar_methods = {
+	.type = T_TableAmRoutine,
+
+	.slot_callbacks = columnar_slot_callbacks,
+
+	.scan_begin = columnar_beginscan,
+	.scan_end = columnar_endscan,
+	.scan_rescan = columnar_rescan,
+	.scan_getnextslot = columnar_getnextslot,
+	.scan_set_pushdown = columnar_scan_set_pushdown,
+
+	.scan_set_tidrange = NULL,
+	.scan_getnextslot_tidrange = NULL,
+
+	.parallelscan_estimate = columnar_parallelscan_estimate,
+	.parallelscan_initialize = columnar_parallelscan_initialize,
+	.parallelscan_reinitialize = columnar_parallelscan_reinitialize,
+
+	.index_fetch_begin = columnar_index_fetch_begin,
+	.index_fetch_reset = columnar_index_fetch_reset,
+	.index_fetch_end = columnar_index_fetch_end,
+	.index_fetch_tuple = columnar_index_fetch_tuple,
+
+	.tuple_fetch_row_version = columnar_fetch_row_version,
+	.tuple_tid_valid = columnar_tuple_tid_valid,
+	.tuple_get_latest_tid = columnar_get_latest_tid,
+	.tuple_satisfies_snapshot = columnar_tuple_satisfies_snapshot,
+	.index_delete_tuples = columnar_index_delete_tuples,
+
+	.tuple_insert = columnar_tuple_insert,
+	.tuple_insert_speculative = columnar_tuple_insert_speculative,
+	.tuple_complete_speculative = columnar_tuple_complete_speculative,
+	.multi_insert = columnar_multi_insert,
+	.tuple_delete = columnar_tuple_delete,
+	.tuple_update = columnar_tuple_update,
+	.tuple_lock = columnar_tuple_lock,
+
+	.relation_set_new_filelocator = columnar_relation_set_new_filelocator,
+	.relation_nontransactional_truncate = columnar_relation_nontransactional_truncate,
+	.relation_copy_data = columnar_relation_copy_data,
+	.relation_copy_for_cluster = columnar_relation_copy_for_cluster,
+	.relation_vacuum = columnar_vacuum_rel,
+	.scan_analyze_next_block = columnar_scan_analyze_next_block,
+	.scan_analyze_next_tuple = columnar_scan_analyze_next_tuple,
+	.index_build_range_scan = columnar_index_build_range_scan,
+	.index_validate_scan = columnar_index_validate_scan,
+
+	.relation_size = table_block_relation_size,
+	.relation_needs_toast_table = columnar_relation_needs_toast_table,
+	.relation_toast_am = columnar_relation_toast_am,
+	.relation_fetch_toast_slice = heap_fetch_toast_slice,
+
+	.relation_estimate_size = columnar_estimate_rel_size,
+
+	.scan_bitmap_next_tuple = NULL,
+	.scan_sample_next_block = columnar_scan_sample_next_block,
+	.scan_sample_next_tuple = columnar_scan_sample_next_tuple
+};
+
+Datum
+columnar_handler(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&columnar_methods);
+}
+
+void
+_PG_init(void)
+{
+	heap_methods = GetHeapamTableAmRoutine();
+
+	DefineCustomIntVariable("columnar.stripe_row_limit",
+							"Sets the maximum number of rows in a stripe.",
+							NULL,
+							&columnar_stripe_row_limit,
+							150000,
+							COLUMNAR_MIN_CHUNK_GROUP_ROWS,
+							COLUMNAR_MAX_STRIPE_ROWS,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("columnar.chunk_group_row_limit",
+							"Sets the maximum number of rows in a chunk group.",
+							"Minimum and maximum values are kept for each column "
+							"of a chunk group, so that scans can skip it.",
+							&columnar_chunk_group_row_limit,
+							10000,
+							COLUMNAR_MIN_CHUNK_GROUP_ROWS,
+							COLUMNAR_MAX_CHUNK_GROUP_ROWS,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	MarkGUCPrefixReserved("columnar");
+}
+
+
+/* ------------------------------------------------------------------------
+ * SQL-callable functions
+ * ------------------------------------------------------------------------
+ */
+
+/*
+ * columnar.compact(regclass) returns bigint
+ *
+ * Move all rows of the delta into new stripes, and return their number.
+ */
+Datum
+columnar_compact(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	AclResult	aclresult;
+	Relation	rel;
+	Snapshot	snapshot;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ColumnarWriteState *writer;
+	CommandId	cid = GetCurrentCommandId(true);
+	int64		nrows = 0;
+	bool		pubupdate;
+	bool		pubdelete;
+
+	aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_MAINTAIN);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult, get_relkind_objtype(get_rel_relkind(relid)),
+					   get_rel_name(relid));
+
+	/* keep out writers, but not readers */
+	rel = table_open(relid, ExclusiveLock);
+
+	if (rel->rd_tableam != &columnar_methods)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a columnar table",
+						RelationGetRelationName(rel))));
+
+	/* the rows could no longer be updated or deleted */
+	get_stripe_row_pubactions(rel, &pubupdate, &pubdelete);
+	if (pubupdate || pubdelete)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot compact table \"%s\" because it publishes updates or deletes",
+						RelationGetRelationName(rel))));
+
+	/* see the rows of all transactions that finished before we got the lock */
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+	slot = table_slot_create(rel, NULL);
+	scan = heap_methods->scan_begin(rel, snapshot, 0, NULL, NULL,
+									SO_TYPE_SEQSCAN | SO_ALLOW_STRAT |
+									SO_ALLOW_PAGEMODE);
+	writer = columnar_begin_write(rel);
+
+	while (heap_methods->scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		TM_FailureData tmfd;
+		TM_Result	result;
+
+		CHECK_FOR_INTERRUPTS();
+
+		slot_getallattrs(slot);
+		columnar_write_row(writer, slot->tts_values, slot->tts_isnull);
+
+		/* the rows don't change, so subscribers need not hear about it */
+		result = heap_delete(rel, &slot->tts_tid, cid, TABLE_DELETE_NO_LOGICAL,
+							 InvalidSnapshot, true, &tmfd);
+		if (result != TM_Ok)
+			elog(ERROR, "unexpected heap_delete status: %u", result);
+		nrows++;
+	}
+
+	columnar_end_write(writer);
+	heap_methods->scan_end(scan);
+	ExecDropSingleTupleTableSlot(slot);
+	UnregisterSnapshot(snapshot);
+
+	table_close(rel, NoLock);
+
+	PG_RETURN_INT64(nrows);
+}
+
+/*
+ * Event trigger function that removes the metadata of columnar tables that
+ * no longer exist, or whose storage has been replaced.
+ */
+Datum
+columnar_drop_orphans(PG_FUNCTION_ARGS)
+{
+	List	   *locators;
+	List	   *live = NIL;
+	Oid			amoid;
+	Relation	classrel;
+	TableScanDesc scan;
+	HeapTuple	tuple;
+	ListCell   *lc;
+
+	if (!CALLED_AS_EVENT_TRIGGER(fcinfo))
+		elog(ERROR, "not fired by event trigger manager");
+
+	locators = columnar_metadata_locators();
+	if (locators == NIL)
+		PG_RETURN_VOID();
+
+	amoid = get_table_am_oid("columnar", false);
+	classrel = table_open(RelationRelationId, AccessShareLock);
+	scan = table_beginscan_catalog(classrel, 0, NULL);
+	while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	{
+		Form_pg_class classform = (Form_pg_class) GETSTRUCT(tuple);
+
+		if (classform->relam == amoid)
+		{
+			RelFileLocator *locator = palloc_object(RelFileLocator);
+
+			locator->spcOid = OidIsValid(classform->reltablespace) ?
+				classform->reltablespace : MyDatabaseTableSpace;
+			locator->dbOid = MyDatabaseId;
+			locator->relNumber = classform->relfilenode;
+			live = lappend(live, locator);
+		}
+	}
+	table_endscan(scan);
+	table_close(classrel, AccessShareLock);
+
+	foreach(lc, locators)
+	{
+		RelFileLocator *locator = lfirst(lc);
+		bool		found = false;
+
+		foreach_ptr(RelFileLocator, other, live)
+		{
+			if (RelFileLocatorEquals(*locator, *other))
+			{
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			columnar_delete_metadata(locator);
+	}
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,248 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_writer.c
+ *		Writing rows into new stripes of a columnar table.
+ *
+ * Rows are buffered until a chunk group is full, and each column of the
+ * chunk group is then encoded and stored along with its minimum and maximum
+ * values.  The stripe itself is recorded once it is full or the writer is
+ * done, so that a stripe is never visible with only some of its chunks.
+ *
+ * The caller must hold a lock that keeps anyone else from writing stripes
+ * for the relation at the same time.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_writer.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/detoast.h"
+#include "columnar.h"
+#include "utils/datum.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+#include "varatt.h"
+
+struct ColumnarWriteState
+{
+	Relation	rel;
+	TupleDesc	tupdesc;
+	RelFileLocator locator;
+	int32		stripe_row_limit;
+	int32		chunk_group_row_limit;
+
+	/* the stripe being written */
+	StripeMetadata stripe;
+	bool		stripe_started;
+
+	/* rows buffered for the current chunk group, column by column */
+	int32		group_rows;
+	Datum	  **values;
+	bool	  **isnull;
+
+	/* per attribute, btree comparison function for the minimum and maximum */
+	FmgrInfo  **cmp;
+
+	MemoryContext group_cxt;	/* reset for each chunk group */
+};
+
+ColumnarWriteState *
+columnar_begin_write(Relation rel)
+{
+	ColumnarWriteState *state = palloc0_object(ColumnarWriteState);
+	int			natts = RelationGetDescr(rel)->natts;
+
+	state->rel = rel;
+	state->tupdesc = RelationGetDescr(rel);
+	state->locator = rel->rd_locator;
+	state->stripe_row_limit = columnar_stripe_row_limit;
+	state->chunk_group_row_limit = Min(columnar_chunk_group_row_limit,
+									   columnar_stripe_row_limit);
+
+	state->values = palloc_array(Datum *, natts);
+	state->isnull = palloc_array(bool *, natts);
+	state->cmp = palloc0_array(FmgrInfo *, natts);
+	for (int i = 0; i < natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(state->tupdesc, i);
+		TypeCacheEntry *typentry;
+
+		state->values[i] = palloc_array(Datum, state->chunk_group_row_limit);
+		state->isnull[i] = palloc_array(bool, state->chunk_group_row_limit);
+
+		if (att->attisdropped)
+			continue;
+		typentry = lookup_type_cache(att->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+			state->cmp[i] = &typentry->cmp_proc_finfo;
+	}
+
+	state->group_cxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "columnar write chunk group",
+											 ALLOCSET_DEFAULT_SIZES);
+
+	return state;
+}
+
+static void
+flush_chunk_group(ColumnarWriteState *state)
+{
+	int			natts = state->tupdesc->natts;
+	int32		nrows = state->group_rows;
+	MemoryContext oldcxt;
+
+	Assert(nrows > 0);
+
+	if (!state->stripe_started)
+	{
+		state->stripe.stripe_id = columnar_next_stripe_id(&state->locator);
+		state->stripe.row_count = 0;
+		state->stripe.chunk_group_count = 0;
+		state->stripe.chunk_group_row_limit = state->chunk_group_row_limit;
+		state->stripe.data_size = 0;
+		state->stripe_started = true;
+	}
+
+	oldcxt = MemoryContextSwitchTo(state->group_cxt);
+
+	for (int i = 0; i < natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(state->tupdesc, i);
+		ColumnChunk chunk = {0};
+		Datum	   *values = palloc_array(Datum, nrows);
+		int			nvalues = 0;
+		uint8	   *nulls = NULL;
+		bytea	   *data;
+		Datum		min = (Datum) 0;
+		Datum		max = (Datum) 0;
+
+		if (att->attisdropped)
+			continue;
+
+		for (int r = 0; r < nrows; r++)
+		{
+			Datum		value = state->values[i][r];
+
+			if (state->isnull[i][r])
+			{
+				if (nulls == NULL)
+					nulls = palloc0((nrows + 7) / 8);
+				nulls[r / 8] |= 1 << (r % 8);
+				continue;
+			}
+			values[nvalues++] = value;
+
+			if (state->cmp[i] == NULL)
+				continue;
+			if (nvalues == 1)
+				min = max = value;
+			else if (DatumGetInt32(FunctionCall2Coll(state->cmp[i],
+													 att->attcollation,
+													 value, min)) < 0)
+				min = value;
+			else if (DatumGetInt32(FunctionCall2Coll(state->cmp[i],
+													 att->attcollation,
+													 value, max)) > 0)
+				max = value;
+		}
+
+		data = columnar_encode_values(att, values, nvalues, &chunk.encoding);
+
+		chunk.row_count = nrows;
+		chunk.value_count = nvalues;
+		chunk.data = PointerGetDatum(data);
+		if (nulls != NULL)
+		{
+			chunk.nulls = palloc(VARHDRSZ + (nrows + 7) / 8);
+			SET_VARSIZE(chunk.nulls, VARHDRSZ + (nrows + 7) / 8);
+			memcpy(VARDATA(chunk.nulls), nulls, (nrows + 7) / 8);
+		}
+		if (state->cmp[i] != NULL && nvalues > 0)
+		{
+			chunk.minimum = columnar_encode_datum(att, min);
+			chunk.maximum = columnar_encode_datum(att, max);
+		}
+
+		columnar_insert_chunk(&state->locator, state->stripe.stripe_id,
+							  i + 1, state->stripe.chunk_group_count, &chunk);
+		state->stripe.data_size += VARSIZE(data);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextReset(state->group_cxt);
+
+	state->stripe.row_count += nrows;
+	state->stripe.chunk_group_count++;
+	state->group_rows = 0;
+}
+
+static void
+flush_stripe(ColumnarWriteState *state)
+{
+	if (state->group_rows > 0)
+		flush_chunk_group(state);
+	if (state->stripe_started)
+	{
+		columnar_insert_stripe(&state->locator, &state->stripe);
+		state->stripe_started = false;
+		state->stripe.row_count = 0;
+	}
+}
+
+/*
+ * Add a row to the stripe being written.
+ */
+void
+columnar_write_row(ColumnarWriteState *state, Datum *values, bool *isnull)
+{
+	int			natts = state->tupdesc->natts;
+	int32		r = state->group_rows;
+	MemoryContext oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(state->group_cxt);
+	for (int i = 0; i < natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(state->tupdesc, i);
+
+		state->isnull[i][r] = isnull[i] || att->attisdropped;
+		if (state->isnull[i][r])
+			state->values[i][r] = (Datum) 0;
+		else if (att->attlen == -1 &&
+				 VARATT_IS_EXTENDED(DatumGetPointer(values[i])))
+			state->values[i][r] =
+				PointerGetDatum(detoast_attr((varlena *) DatumGetPointer(values[i])));
+		else
+			state->values[i][r] = datumCopy(values[i], att->attbyval,
+											att->attlen);
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	/*
+	 * Only the last chunk group of a stripe may be smaller than the limit,
+	 * so that readers can find the chunk group of a row by division.
+	 */
+	state->group_rows++;
+	if (state->group_rows == state->chunk_group_row_limit ||
+		state->stripe.row_count + state->group_rows >= state->stripe_row_limit)
+	{
+		flush_chunk_group(state);
+		if (state->stripe.row_count >= state->stripe_row_limit)
+			flush_stripe(state);
+	}
+}
+
+/*
+ * Write out whatever is buffered, and clean up.
+ */
+void
+columnar_end_write(ColumnarWriteState *state)
+{
+	flush_stripe(state);
+	MemoryContextDelete(state->group_cxt);
+	pfree(state);
+}
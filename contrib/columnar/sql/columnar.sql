@@ -0,0 +1,92 @@
+CREATE EXTENSION columnar;
+
+SET columnar.stripe_row_limit = 5000;
+SET columnar.chunk_group_row_limit = 1000;
+
+CREATE TABLE col (a int, b text, c float8) USING columnar;
+INSERT INTO col SELECT i, 'row ' || (i % 10), i / 2.0
+	FROM generate_series(1, 12000) i;
+INSERT INTO col VALUES (NULL, NULL, NULL);
+
+SELECT count(*), sum(a), count(b), count(DISTINCT b), sum(c) FROM col;
+
+-- Move the rows into stripes
+SELECT columnar.compact('col');
+SELECT columnar.compact('col');
+SELECT count(*), sum(row_count), sum(chunk_group_count)
+	FROM columnar.stripe WHERE relfilenumber = pg_relation_filenode('col');
+
+SELECT count(*), sum(a), count(b), count(DISTINCT b), sum(c) FROM col;
+SELECT count(*) FROM col WHERE a BETWEEN 2500 AND 2600;
+SELECT a, b, c FROM col WHERE a = 4321;
+SELECT count(*) FROM col WHERE a IS NULL;
+SELECT count(*) FROM col WHERE b = 'row 3';
+SELECT b FROM col WHERE a > 11995 ORDER BY a;
+
+-- New rows go to the delta
+INSERT INTO col VALUES (20000, 'new', 0);
+SELECT count(*), max(a) FROM col;
+
+-- Rows in stripes and in the delta can be deleted and updated
+DELETE FROM col WHERE a % 1000 = 0;
+UPDATE col SET b = 'updated' WHERE a IN (1, 2);
+SELECT count(*), sum(a) FROM col;
+SELECT a, b FROM col WHERE b = 'updated' ORDER BY a;
+UPDATE col SET b = 'again' WHERE a = 1;
+SELECT a, b FROM col WHERE a <= 3 ORDER BY a;
+
+-- VACUUM FULL writes all rows into new stripes
+VACUUM FULL col;
+SELECT count(*), sum(a) FROM col;
+SELECT count(*), sum(row_count)
+	FROM columnar.stripe WHERE relfilenumber = pg_relation_filenode('col');
+SELECT count(DISTINCT relfilenumber) FROM columnar.stripe;
+SELECT count(*) FROM columnar.row_mask;
+
+ANALYZE col;
+SELECT reltuples FROM pg_class WHERE relname = 'col';
+
+-- Parallel scans divide the stripes among the workers
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SELECT count(*), sum(a) FROM col;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
+-- Moving the table to another tablespace moves its stripes along
+SET allow_in_place_tablespaces = true;
+CREATE TABLESPACE regress_columnar_tblspc LOCATION '';
+ALTER TABLE col SET TABLESPACE regress_columnar_tblspc;
+SELECT count(*), sum(a) FROM col;
+SELECT count(*), sum(row_count) FROM columnar.stripe
+	WHERE reltablespace = (SELECT oid FROM pg_tablespace
+						   WHERE spcname = 'regress_columnar_tblspc')
+	  AND relfilenumber = pg_relation_filenode('col');
+ALTER TABLE col SET TABLESPACE pg_default;
+SELECT count(*), sum(a) FROM col;
+SELECT reltablespace, count(*) FROM columnar.stripe GROUP BY reltablespace;
+DROP TABLESPACE regress_columnar_tblspc;
+RESET allow_in_place_tablespaces;
+
+-- Unsupported features
+CREATE INDEX ON col (a);
+CREATE UNLOGGED TABLE ucol (a int) USING columnar;
+SELECT count(*) FROM col TABLESAMPLE SYSTEM (10);
+CREATE TABLE h (a int);
+SELECT columnar.compact('h');
+DROP TABLE h;
+
+-- The metadata goes away with the table's storage
+TRUNCATE col;
+SELECT count(*) FROM col;
+SELECT count(*) FROM columnar.stripe;
+INSERT INTO col VALUES (1, 'one', 1);
+SELECT columnar.compact('col');
+SELECT * FROM col;
+DROP TABLE col;
+SELECT count(*) FROM columnar.stripe;
+SELECT count(*) FROM columnar.chunk;
@@ -60,3 +60,23 @@ SHOW block_size \gset
 SELECT bt_page_items(decode(repeat('00', :block_size), 'hex'));
 
 DROP TABLE test1;
+
+-- An UPDATE that assigns every column but changes only one indexed value
+-- must still tell the other index that its key is logically unchanged, so
+-- that bottom-up deletion removes the old row versions from its leaf pages
+-- instead of splitting them.  Without the hint both indexes would grow the
+-- same way, as deduplication is disabled.
+\x
+CREATE TABLE test_bottomup (id int, a int, b int)
+  WITH (autovacuum_enabled = off);
+INSERT INTO test_bottomup SELECT g, g, g * 100 FROM generate_series(1, 100) g;
+CREATE INDEX test_bottomup_a ON test_bottomup (a) WITH (deduplicate_items = off);
+CREATE INDEX test_bottomup_b ON test_bottomup (b) WITH (deduplicate_items = off);
+SELECT 'UPDATE test_bottomup SET id = id, a = a, b = b + 1'
+  FROM generate_series(1, 20)
+\gexec
+SELECT (SELECT count(*) FROM bt_multi_page_stats('test_bottomup_a', 1, -1)
+        WHERE type = 'l') <
+       (SELECT count(*) FROM bt_multi_page_stats('test_bottomup_b', 1, -1)
+        WHERE type = 'l') AS fewer_leaf_pages;
+DROP TABLE test_bottomup;
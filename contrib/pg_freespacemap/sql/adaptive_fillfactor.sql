@@ -0,0 +1,30 @@
+-- Test that adaptive_fillfactor holds back free space from the FSM for
+-- updates of the rows already on a page.  fsm_plain goes through the same
+-- steps without the option, so its FSM shows the page's actual free space.
+CREATE TABLE fsm_adaptive (i int, t text)
+  WITH (adaptive_fillfactor = true, autovacuum_enabled = off);
+CREATE TABLE fsm_plain (i int, t text) WITH (autovacuum_enabled = off);
+INSERT INTO fsm_adaptive SELECT g, repeat('x', 100) FROM generate_series(1, 40) g;
+INSERT INTO fsm_plain SELECT g, repeat('x', 100) FROM generate_series(1, 40) g;
+
+-- HOT-update a quarter of the rows, and prune the old versions.
+UPDATE fsm_adaptive SET t = repeat('y', 100) WHERE i % 4 = 0;
+UPDATE fsm_plain SET t = repeat('y', 100) WHERE i % 4 = 0;
+VACUUM fsm_adaptive;
+VACUUM fsm_plain;
+
+-- The space reserved for the heap-only tuples is not recorded.
+SELECT pg_freespace('fsm_adaptive', 0) < pg_freespace('fsm_plain', 0) - 1000
+  AS space_reserved;
+SELECT pg_freespace('fsm_adaptive', 0) AS adaptive_avail \gset
+
+-- A row that only fits in the reserved space goes to a new page, and the
+-- FSM entry of the first page is left as it was.
+INSERT INTO fsm_adaptive VALUES (41, repeat('z', 1500));
+INSERT INTO fsm_plain VALUES (41, repeat('z', 1500));
+SELECT (ctid::text::point)[0] AS blkno FROM fsm_adaptive WHERE i = 41;
+SELECT (ctid::text::point)[0] AS blkno FROM fsm_plain WHERE i = 41;
+SELECT pg_freespace('fsm_adaptive', 0) = :adaptive_avail AS fsm_unchanged;
+
+DROP TABLE fsm_adaptive;
+DROP TABLE fsm_plain;
@@ -26,8 +26,28 @@ static varlena *toast_fetch_datum(varlena *attr);
 static varlena *toast_fetch_datum_slice(varlena *attr,
 										int32 sliceoffset,
 										int32 slicelength);
+static varlena *toast_fetch_datum_range(varlena *attr, int32 offset,
+										int32 length);
+static varlena *toast_fetch_segmented_header(varlena *attr);
+static varlena *toast_fetch_segmented_slice(varlena *attr,
+											int32 sliceoffset,
+											int32 slicelength);
 static varlena *toast_decompress_datum(varlena *attr);
 static varlena *toast_decompress_datum_slice(varlena *attr, int32 slicelength);
+static varlena *toast_decompress_segmented(varlena *attr, int32 sliceoffset,
+										   int32 slicelength);
+static varlena *toast_decompress_segments(const toast_segmented_header *hdr,
+										  int32 rawsize, const char *data,
+										  uint32 dataoff, uint32 datalen,
+										  int32 sliceoffset,
+										  int32 slicelength);
+static void toast_check_segmented_header(const toast_segmented_header *hdr,
+										 int32 rawsize, int32 size);
+
+#define SEGMENTED_DATA_CORRUPT() \
+	ereport(ERROR, \
+			(errcode(ERRCODE_DATA_CORRUPTED), \
+			 errmsg_internal("compressed segmented data is corrupt")))
 
 /* ----------
  * detoast_external_attr -
@@ -233,6 +253,11 @@ detoast_attr_slice(varlena *attr,
 		if (!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
 			return toast_fetch_datum_slice(attr, sliceoffset, slicelength);
 
+		/* segmented values: fetch only the segments covering the slice */
+		if (VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer) ==
+			TOAST_SEGMENTED_COMPRESSION_ID)
+			return toast_fetch_segmented_slice(attr, sliceoffset, slicelength);
+
 		/*
 		 * For compressed values, we need to fetch enough slices to decompress
 		 * at least the requested part (when a prefix is requested).
@@ -290,6 +315,15 @@ detoast_attr_slice(varlena *attr,
 	{
 		varlena    *tmp = preslice;
 
+		/* segmented values can be decompressed from any offset */
+		if (TOAST_COMPRESS_METHOD(tmp) == TOAST_SEGMENTED_COMPRESSION_ID)
+		{
+			result = toast_decompress_segmented(tmp, sliceoffset, slicelength);
+			if (tmp != attr)
+				pfree(tmp);
+			return result;
+		}
+
 		/* Decompress enough to encompass the slice and the offset */
 		if (slicelimit >= 0)
 			preslice = toast_decompress_datum_slice(tmp, slicelimit);
@@ -332,6 +366,42 @@ detoast_attr_slice(varlena *attr,
 	return result;
 }
 
+/* ----------
+ * detoast_attr_slice_is_cheap -
+ *
+ *	Public entry point to check whether detoast_attr_slice can return any
+ *	slice of a toasted value for about the cost of the slice, rather than
+ *	of the whole value.  That's the case for external values that are not
+ *	compressed, and for values compressed in segments.  Values that aren't
+ *	toasted at all are cheap to slice too, but there's nothing to gain
+ *	from it, so we return false for them.
+ * ----------
+ */
+bool
+detoast_attr_slice_is_cheap(varlena *attr)
+{
+	if (VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		varatt_external toast_pointer;
+
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+		return !VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer) ||
+			VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer) ==
+			TOAST_SEGMENTED_COMPRESSION_ID;
+	}
+	else if (VARATT_IS_EXTERNAL_INDIRECT(attr))
+	{
+		varatt_indirect redirect;
+
+		VARATT_EXTERNAL_GET_POINTER(redirect, attr);
+		return detoast_attr_slice_is_cheap(redirect.pointer);
+	}
+	else if (VARATT_IS_COMPRESSED(attr))
+		return TOAST_COMPRESS_METHOD(attr) == TOAST_SEGMENTED_COMPRESSION_ID;
+
+	return false;
+}
+
 /* ----------
  * toast_fetch_datum -
  *
@@ -462,6 +532,160 @@ toast_fetch_datum_slice(varlena *attr, int32 sliceoffset,
 	return result;
 }
 
+/* ----------
+ * toast_fetch_datum_range -
+ *
+ *	Fetch length bytes of the stored form of an external datum, starting
+ *	offset bytes into it.  Unlike toast_fetch_datum_slice, this works for
+ *	any offset into compressed datums too; the result is a plain varlena
+ *	holding the raw bytes, which only make sense to the caller.
+ * ----------
+ */
+static varlena *
+toast_fetch_datum_range(varlena *attr, int32 offset, int32 length)
+{
+	Relation	toastrel;
+	varlena    *result;
+	varatt_external toast_pointer;
+	int32		attrsize;
+
+	Assert(VARATT_IS_EXTERNAL_ONDISK(attr));
+
+	/* Must copy to access aligned fields */
+	VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+
+	attrsize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
+	Assert(offset >= 0 && length >= 0 && length <= attrsize - offset);
+
+	result = (varlena *) palloc(length + VARHDRSZ);
+	SET_VARSIZE(result, length + VARHDRSZ);
+
+	if (length == 0)
+		return result;
+
+	toastrel = table_open(toast_pointer.va_toastrelid, AccessShareLock);
+
+	table_relation_fetch_toast_slice(toastrel, toast_pointer.va_valueid,
+									 attrsize, offset, length, result);
+
+	table_close(toastrel, AccessShareLock);
+
+	return result;
+}
+
+/* ----------
+ * toast_fetch_segmented_header -
+ *
+ *	Fetch the start of an external segmented datum, up to the end of its
+ *	toast_segmented_header.  The result is laid out like the start of the
+ *	compressed datum itself.
+ * ----------
+ */
+static varlena *
+toast_fetch_segmented_header(varlena *attr)
+{
+	varlena    *result;
+	varatt_external toast_pointer;
+	toast_segmented_header *hdr;
+	int32		rawsize;
+	int32		nsegments;
+
+	VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+	rawsize = toast_pointer.va_rawsize - VARHDRSZ;
+
+	/*
+	 * Guess the number of segments from the current segment size; if the
+	 * value was written with another one, fetch again once we know.
+	 */
+	nsegments = (rawsize + TOAST_SEGMENT_SIZE - 1) / TOAST_SEGMENT_SIZE;
+	result = toast_fetch_datum_slice(attr, 0, TOAST_SEGMENTED_HDRSZ(nsegments));
+	hdr = (toast_segmented_header *) ((char *) result + VARHDRSZ_COMPRESSED);
+	toast_check_segmented_header(hdr, rawsize,
+								 VARSIZE(result) - VARHDRSZ_COMPRESSED);
+
+	if (hdr->nsegments != nsegments)
+	{
+		nsegments = hdr->nsegments;
+		if (TOAST_SEGMENTED_HDRSZ(nsegments) >
+			VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer))
+			SEGMENTED_DATA_CORRUPT();
+		pfree(result);
+		result = toast_fetch_datum_slice(attr, 0,
+										 TOAST_SEGMENTED_HDRSZ(nsegments));
+	}
+
+	if (VARSIZE(result) - VARHDRSZ_COMPRESSED < TOAST_SEGMENTED_HDRSZ(nsegments))
+		SEGMENTED_DATA_CORRUPT();
+
+	return result;
+}
+
+/* ----------
+ * toast_fetch_segmented_slice -
+ *
+ *	Reconstruct a slice of an external segmented datum, fetching and
+ *	decompressing only the segments that cover it.
+ * ----------
+ */
+static varlena *
+toast_fetch_segmented_slice(varlena *attr, int32 sliceoffset,
+							int32 slicelength)
+{
+	varlena    *hdrbuf;
+	varlena    *segments;
+	varlena    *result;
+	varatt_external toast_pointer;
+	toast_segmented_header *hdr;
+	int32		rawsize;
+	uint32		first;
+	uint32		last;
+	uint32		base;
+	uint32		start;
+	uint32		end;
+
+	VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+	rawsize = toast_pointer.va_rawsize - VARHDRSZ;
+
+	if (sliceoffset >= rawsize)
+		slicelength = 0;
+	else if (slicelength < 0 || slicelength > rawsize - sliceoffset)
+		slicelength = rawsize - sliceoffset;
+
+	if (slicelength == 0)
+	{
+		result = (varlena *) palloc(VARHDRSZ);
+		SET_VARSIZE(result, VARHDRSZ);
+		return result;
+	}
+
+	hdrbuf = toast_fetch_segmented_header(attr);
+	hdr = (toast_segmented_header *) ((char *) hdrbuf + VARHDRSZ_COMPRESSED);
+
+	first = sliceoffset / hdr->segsize;
+	last = (sliceoffset + slicelength - 1) / hdr->segsize;
+
+	/*
+	 * The stored form starts with va_tcinfo, and the segments follow the
+	 * header.
+	 */
+	base = sizeof(uint32) + TOAST_SEGMENTED_HDRSZ(hdr->nsegments);
+	start = TOAST_SEGMENT_START(hdr, first);
+	end = hdr->segend[last];
+	if (end < start ||
+		end > VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer) - base)
+		SEGMENTED_DATA_CORRUPT();
+
+	segments = toast_fetch_datum_range(attr, base + start, end - start);
+	result = toast_decompress_segments(hdr, rawsize, VARDATA(segments),
+									   start, end - start,
+									   sliceoffset, slicelength);
+
+	pfree(segments);
+	pfree(hdrbuf);
+
+	return result;
+}
+
 /* ----------
  * toast_decompress_datum -
  *
@@ -485,6 +709,10 @@ toast_decompress_datum(varlena *attr)
 			return pglz_decompress_datum(attr);
 		case TOAST_LZ4_COMPRESSION_ID:
 			return lz4_decompress_datum(attr);
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return zstd_decompress_datum(attr);
+		case TOAST_SEGMENTED_COMPRESSION_ID:
+			return toast_decompress_segmented(attr, 0, -1);
 		default:
 			elog(ERROR, "invalid compression method id %d", cmid);
 			return NULL;		/* keep compiler quiet */
@@ -528,12 +756,170 @@ toast_decompress_datum_slice(varlena *attr, int32 slicelength)
 			return pglz_decompress_datum_slice(attr, slicelength);
 		case TOAST_LZ4_COMPRESSION_ID:
 			return lz4_decompress_datum_slice(attr, slicelength);
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return zstd_decompress_datum_slice(attr, slicelength);
+		case TOAST_SEGMENTED_COMPRESSION_ID:
+			return toast_decompress_segmented(attr, 0, slicelength);
 		default:
 			elog(ERROR, "invalid compression method id %d", cmid);
 			return NULL;		/* keep compiler quiet */
 	}
 }
 
+/* ----------
+ * toast_decompress_segmented -
+ *
+ * Decompress a slice of a segmented compressed datum, which need not be a
+ * prefix.  If slicelength < 0, decompress everything beyond sliceoffset.
+ */
+static varlena *
+toast_decompress_segmented(varlena *attr, int32 sliceoffset, int32 slicelength)
+{
+	toast_segmented_header *hdr;
+	int32		rawsize = TOAST_COMPRESS_EXTSIZE(attr);
+	int32		size = VARSIZE(attr) - VARHDRSZ_COMPRESSED;
+	Size		hdrsize;
+
+	Assert(TOAST_COMPRESS_METHOD(attr) == TOAST_SEGMENTED_COMPRESSION_ID);
+
+	hdr = (toast_segmented_header *) ((char *) attr + VARHDRSZ_COMPRESSED);
+	toast_check_segmented_header(hdr, rawsize, size);
+	hdrsize = TOAST_SEGMENTED_HDRSZ(hdr->nsegments);
+	if ((Size) size < hdrsize)
+		SEGMENTED_DATA_CORRUPT();
+
+	return toast_decompress_segments(hdr, rawsize, (char *) hdr + hdrsize,
+									 0, size - hdrsize,
+									 sliceoffset, slicelength);
+}
+
+/* ----------
+ * toast_decompress_segments -
+ *
+ * Decompress a slice of a segmented datum, whose header is hdr and whose
+ * decompressed size is rawsize.  data holds datalen bytes of the segments,
+ * starting dataoff bytes after the header, and must cover the slice.
+ */
+static varlena *
+toast_decompress_segments(const toast_segmented_header *hdr, int32 rawsize,
+						  const char *data, uint32 dataoff, uint32 datalen,
+						  int32 sliceoffset, int32 slicelength)
+{
+	varlena    *result;
+	int32		sliceend;
+	uint32		first;
+	uint32		last;
+
+	if (sliceoffset >= rawsize)
+		slicelength = 0;
+	else if (slicelength < 0 || slicelength > rawsize - sliceoffset)
+		slicelength = rawsize - sliceoffset;
+	sliceend = sliceoffset + slicelength;
+
+	result = (varlena *) palloc(slicelength + VARHDRSZ);
+	SET_VARSIZE(result, slicelength + VARHDRSZ);
+
+	if (slicelength == 0)
+		return result;
+
+	first = sliceoffset / hdr->segsize;
+	last = (sliceend - 1) / hdr->segsize;
+
+	for (uint32 i = first; i <= last; i++)
+	{
+		int32		rawstart = i * hdr->segsize;
+		int32		seglen = Min((int32) hdr->segsize, rawsize - rawstart);
+		int32		from = Max(sliceoffset, rawstart) - rawstart;
+		int32		to = Min(sliceend, rawstart + seglen) - rawstart;
+		uint32		start = TOAST_SEGMENT_START(hdr, i);
+		uint32		end = hdr->segend[i];
+		const varlena *segment;
+		char	   *dest = VARDATA(result) + rawstart + from - sliceoffset;
+
+		if (start < dataoff || end < start + VARHDRSZ ||
+			end - dataoff > datalen)
+			SEGMENTED_DATA_CORRUPT();
+		segment = (const varlena *) (data + start - dataoff);
+		if (VARSIZE(segment) != end - start)
+			SEGMENTED_DATA_CORRUPT();
+
+		if (VARATT_IS_COMPRESSED(segment))
+		{
+			varlena    *raw;
+
+			if (TOAST_COMPRESS_METHOD(segment) != hdr->cmid ||
+				TOAST_COMPRESS_EXTSIZE(segment) != seglen)
+				SEGMENTED_DATA_CORRUPT();
+
+			/* only the part of the segment up to the slice end is needed */
+			raw = toast_decompress_datum_slice((varlena *) segment, to);
+			if (VARSIZE(raw) - VARHDRSZ < to)
+				SEGMENTED_DATA_CORRUPT();
+			memcpy(dest, VARDATA(raw) + from, to - from);
+			pfree(raw);
+		}
+		else
+		{
+			if (VARSIZE(segment) - VARHDRSZ != seglen)
+				SEGMENTED_DATA_CORRUPT();
+			memcpy(dest, VARDATA(segment) + from, to - from);
+		}
+	}
+
+	return result;
+}
+
+/* ----------
+ * toast_check_segmented_header -
+ *
+ * Check that a toast_segmented_header is consistent with the decompressed
+ * size of its datum, given the number of bytes available from its start.
+ * Its segment ends are checked as they are used.
+ */
+static void
+toast_check_segmented_header(const toast_segmented_header *hdr,
+							 int32 rawsize, int32 size)
+{
+	if (size < TOAST_SEGMENTED_HDRSZ(0) ||
+		hdr->segsize == 0 || hdr->segsize > VARLENA_EXTSIZE_MASK ||
+		hdr->cmid >= TOAST_SEGMENTED_COMPRESSION_ID ||
+		hdr->nsegments != (rawsize + (uint64) hdr->segsize - 1) / hdr->segsize)
+		SEGMENTED_DATA_CORRUPT();
+}
+
+/* ----------
+ * toast_segmented_compression_id -
+ *
+ *	Return the method that the segments of a segmented datum are compressed
+ *	with.  The datum is either stored externally or compressed in line.
+ * ----------
+ */
+ToastCompressionId
+toast_segmented_compression_id(varlena *attr)
+{
+	toast_segmented_header *hdr;
+	ToastCompressionId cmid;
+
+	if (VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		varlena    *hdrbuf = toast_fetch_segmented_header(attr);
+
+		hdr = (toast_segmented_header *) ((char *) hdrbuf + VARHDRSZ_COMPRESSED);
+		cmid = hdr->cmid;
+		pfree(hdrbuf);
+	}
+	else
+	{
+		Assert(TOAST_COMPRESS_METHOD(attr) == TOAST_SEGMENTED_COMPRESSION_ID);
+		hdr = (toast_segmented_header *) ((char *) attr + VARHDRSZ_COMPRESSED);
+		toast_check_segmented_header(hdr, TOAST_COMPRESS_EXTSIZE(attr),
+									 VARSIZE(attr) - VARHDRSZ_COMPRESSED);
+		cmid = hdr->cmid;
+	}
+
+	return cmid;
+}
+
 /* ----------
  * toast_raw_datum_size -
  *
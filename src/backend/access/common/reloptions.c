@@ -79,6 +79,10 @@
  * so the ANALYZE will not be affected by in-flight changes. Changing those
  * values has no effect until the next ANALYZE, so no need for stronger lock.
  *
+ * compression_level can be set at ShareUpdateExclusiveLock because it only
+ * affects how values are compressed from then on; values compressed at any
+ * level can be decompressed the same way.
+ *
  * Planner-related parameters can be set at ShareUpdateExclusiveLock because
  * they only affect planning and not the correctness of the execution. Plans
  * cannot be changed in mid-flight, so changes here could not easily result in
@@ -90,10 +94,11 @@
  * the same as max_parallel_workers_per_gather which is a USERSET parameter
  * that doesn't affect existing plans or queries.
  *
- * vacuum_truncate can be set at ShareUpdateExclusiveLock because it
- * is only used during VACUUM, which uses a ShareUpdateExclusiveLock,
- * so the VACUUM will not be affected by in-flight changes. Changing its
- * value has no effect until the next VACUUM, so no need for stronger lock.
+ * vacuum_truncate and compress_frozen_pages can be set at
+ * ShareUpdateExclusiveLock because they are only used during VACUUM, which
+ * uses a ShareUpdateExclusiveLock, so the VACUUM will not be affected by
+ * in-flight changes.  Changing their values has no effect until the next
+ * VACUUM, so no need for stronger lock.
  */
 
 static relopt_bool boolRelOpts[] =
@@ -116,6 +121,24 @@ static relopt_bool boolRelOpts[] =
 		},
 		true
 	},
+	{
+		{
+			"adaptive_fillfactor",
+			"Enables reserving free space on pages of this table for HOT updates, based on past updates",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		false
+	},
+	{
+		{
+			"compress_frozen_pages",
+			"Enables compression of all-frozen pages of this table on disk",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		false
+	},
 	{
 		{
 			"user_catalog_table",
@@ -134,6 +157,15 @@ static relopt_bool boolRelOpts[] =
 		},
 		true
 	},
+	{
+		{
+			"deferred_cleanup",
+			"Defers pending list cleanup on this GIN index to autovacuum",
+			RELOPT_KIND_GIN,
+			AccessExclusiveLock
+		},
+		false
+	},
 	{
 		{
 			"security_barrier",
@@ -413,6 +445,15 @@ static relopt_int intRelOpts[] =
 		},
 		-1, 0, 1024
 	},
+	{
+		{
+			"compression_level",
+			"Compression level used when compressing values of this column, for compression methods that support levels.",
+			RELOPT_KIND_ATTRIBUTE,
+			ShareUpdateExclusiveLock
+		},
+		0, 0, 22
+	},
 
 	/* list terminator */
 	{{NULL}}
@@ -2025,7 +2066,11 @@ default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 		{"vacuum_truncate", RELOPT_TYPE_TERNARY,
 		offsetof(StdRdOptions, vacuum_truncate)},
 		{"vacuum_max_eager_freeze_failure_rate", RELOPT_TYPE_REAL,
-		offsetof(StdRdOptions, vacuum_max_eager_freeze_failure_rate)}
+		offsetof(StdRdOptions, vacuum_max_eager_freeze_failure_rate)},
+		{"compress_frozen_pages", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, compress_frozen_pages)},
+		{"adaptive_fillfactor", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, adaptive_fillfactor)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate, kind,
@@ -2215,7 +2260,8 @@ attribute_reloptions(Datum reloptions, bool validate)
 {
 	static const relopt_parse_elt tab[] = {
 		{"n_distinct", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct)},
-		{"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)}
+		{"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)},
+		{"compression_level", RELOPT_TYPE_INT, offsetof(AttributeOpts, compression_level)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate,
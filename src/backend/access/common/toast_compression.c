@@ -16,9 +16,13 @@
 #ifdef USE_LZ4
 #include <lz4.h>
 #endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "access/detoast.h"
 #include "access/toast_compression.h"
+#include "access/toast_internals.h"
 #include "common/pg_lzcompress.h"
 #include "varatt.h"
 
@@ -245,10 +249,175 @@ lz4_decompress_datum_slice(const varlena *value, int32 slicelength)
 #endif
 }
 
+#ifdef USE_ZSTD
+/*
+ * zstd contexts are fairly expensive to set up, so each backend keeps one of
+ * each around for its whole life instead of creating one per datum.  They
+ * are allocated with malloc by the library, and never freed.
+ */
+static ZSTD_CCtx *zstd_cctx = NULL;
+static ZSTD_DCtx *zstd_dctx = NULL;
+
+static ZSTD_DCtx *
+zstd_get_dctx(void)
+{
+	if (zstd_dctx == NULL)
+	{
+		zstd_dctx = ZSTD_createDCtx();
+		if (zstd_dctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+	return zstd_dctx;
+}
+#endif
+
+/*
+ * Compress a varlena using zstd, at the given compression level.  A level of
+ * 0 selects the library's default level.
+ *
+ * Returns the compressed varlena, or NULL if compression fails.
+ */
+varlena *
+zstd_compress_datum(const varlena *value, int level)
+{
+#ifndef USE_ZSTD
+	NO_COMPRESSION_SUPPORT("zstd");
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize;
+	size_t		len;
+	size_t		max_size;
+	varlena    *tmp = NULL;
+
+	if (zstd_cctx == NULL)
+	{
+		zstd_cctx = ZSTD_createCCtx();
+		if (zstd_cctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+
+	valsize = VARSIZE_ANY_EXHDR(value);
+
+	/*
+	 * Like for LZ4, allocate room for the worst case, and give up if the
+	 * result doesn't end up any smaller than the input.
+	 */
+	max_size = ZSTD_compressBound(valsize);
+	tmp = (varlena *) palloc(max_size + VARHDRSZ_COMPRESSED);
+
+	len = ZSTD_compressCCtx(zstd_cctx,
+							(char *) tmp + VARHDRSZ_COMPRESSED, max_size,
+							VARDATA_ANY(value), valsize,
+							level);
+	if (ZSTD_isError(len))
+		elog(ERROR, "zstd compression failed: %s", ZSTD_getErrorName(len));
+
+	/* data is incompressible so just free the memory and return NULL */
+	if (len > valsize)
+	{
+		pfree(tmp);
+		return NULL;
+	}
+
+	SET_VARSIZE_COMPRESSED(tmp, len + VARHDRSZ_COMPRESSED);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using zstd.
+ */
+varlena *
+zstd_decompress_datum(const varlena *value)
+{
+#ifndef USE_ZSTD
+	NO_COMPRESSION_SUPPORT("zstd");
+	return NULL;				/* keep compiler quiet */
+#else
+	size_t		rawsize;
+	varlena    *result;
+
+	/* allocate memory for the uncompressed data */
+	result = (varlena *) palloc(VARDATA_COMPRESSED_GET_EXTSIZE(value) + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = ZSTD_decompressDCtx(zstd_get_dctx(),
+								  VARDATA(result),
+								  VARDATA_COMPRESSED_GET_EXTSIZE(value),
+								  (const char *) value + VARHDRSZ_COMPRESSED,
+								  VARSIZE(value) - VARHDRSZ_COMPRESSED);
+	if (ZSTD_isError(rawsize))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed zstd data is corrupt")));
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Decompress part of a varlena that was compressed using zstd.
+ *
+ * The streaming decoder stops as soon as the output buffer is full, so only
+ * as much of the frame as is needed for the slice gets decoded.
+ */
+varlena *
+zstd_decompress_datum_slice(const varlena *value, int32 slicelength)
+{
+#ifndef USE_ZSTD
+	NO_COMPRESSION_SUPPORT("zstd");
+	return NULL;				/* keep compiler quiet */
+#else
+	ZSTD_DCtx  *dctx = zstd_get_dctx();
+	ZSTD_inBuffer in;
+	ZSTD_outBuffer out;
+	varlena    *result;
+
+	/* allocate memory for the uncompressed data */
+	result = (varlena *) palloc(slicelength + VARHDRSZ);
+
+	in.src = (const char *) value + VARHDRSZ_COMPRESSED;
+	in.size = VARSIZE(value) - VARHDRSZ_COMPRESSED;
+	in.pos = 0;
+	out.dst = VARDATA(result);
+	out.size = slicelength;
+	out.pos = 0;
+
+	ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+	while (out.pos < out.size && in.pos < in.size)
+	{
+		size_t		ret;
+
+		ret = ZSTD_decompressStream(dctx, &out, &in);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed zstd data is corrupt")));
+
+		/* end of frame */
+		if (ret == 0)
+			break;
+	}
+
+	SET_VARSIZE(result, out.pos + VARHDRSZ);
+
+	return result;
+#endif
+}
+
 /*
  * Extract compression ID from a varlena.
  *
- * Returns TOAST_INVALID_COMPRESSION_ID if the varlena is not compressed.
+ * For a value compressed in segments, this is the method the segments are
+ * compressed with.  Returns TOAST_INVALID_COMPRESSION_ID if the varlena is
+ * not compressed.
  */
 ToastCompressionId
 toast_get_compression_id(varlena *attr)
@@ -272,6 +441,9 @@ toast_get_compression_id(varlena *attr)
 	else if (VARATT_IS_COMPRESSED(attr))
 		cmid = VARDATA_COMPRESSED_GET_COMPRESS_METHOD(attr);
 
+	if (cmid == TOAST_SEGMENTED_COMPRESSION_ID)
+		cmid = toast_segmented_compression_id(attr);
+
 	return cmid;
 }
 
@@ -293,6 +465,13 @@ CompressionNameToMethod(const char *compression)
 #endif
 		return TOAST_LZ4_COMPRESSION;
 	}
+	else if (strcmp(compression, "zstd") == 0)
+	{
+#ifndef USE_ZSTD
+		NO_COMPRESSION_SUPPORT("zstd");
+#endif
+		return TOAST_ZSTD_COMPRESSION;
+	}
 
 	return InvalidCompressionMethod;
 }
@@ -309,6 +488,8 @@ GetCompressionMethodName(char method)
 			return "pglz";
 		case TOAST_LZ4_COMPRESSION:
 			return "lz4";
+		case TOAST_ZSTD_COMPRESSION:
+			return "zstd";
 		default:
 			elog(ERROR, "invalid compression method %c", method);
 			return NULL;		/* keep compiler quiet */
@@ -26,6 +26,11 @@
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 
+static varlena *toast_compress_with_method(const varlena *value, char cmethod,
+										   int cmlevel,
+										   ToastCompressionId *cmid);
+static varlena *toast_compress_segmented(const varlena *value, char cmethod,
+										 int cmlevel);
 static bool toastrel_valueid_exists(Relation toastrel, Oid valueid);
 static bool toastid_valueid_exists(Oid toastrelid, Oid valueid);
 
@@ -34,6 +39,9 @@ static bool toastid_valueid_exists(Oid toastrelid, Oid valueid);
  *
  *	Create a compressed version of a varlena datum
  *
+ *	cmlevel is the compression level to use, for methods that have one;
+ *	0 means the method's default level.
+ *
  *	If we fail (ie, compressed result is actually bigger than original)
  *	then return NULL.  We must not use compressed data if it'd expand
  *	the tuple!
@@ -43,7 +51,7 @@ static bool toastid_valueid_exists(Oid toastrelid, Oid valueid);
  * ----------
  */
 Datum
-toast_compress_datum(Datum value, char cmethod)
+toast_compress_datum(Datum value, char cmethod, int cmlevel)
 {
 	varlena    *tmp = NULL;
 	int32		valsize;
@@ -59,21 +67,19 @@ toast_compress_datum(Datum value, char cmethod)
 		cmethod = default_toast_compression;
 
 	/*
-	 * Call appropriate compression routine for the compression method.
+	 * Large values are compressed in segments, so that slices of them can be
+	 * read back cheaply.  Otherwise, call the appropriate compression routine
+	 * for the compression method.
 	 */
-	switch (cmethod)
+	if (valsize > TOAST_SEGMENTED_THRESHOLD)
 	{
-		case TOAST_PGLZ_COMPRESSION:
-			tmp = pglz_compress_datum((const varlena *) DatumGetPointer(value));
-			cmid = TOAST_PGLZ_COMPRESSION_ID;
-			break;
-		case TOAST_LZ4_COMPRESSION:
-			tmp = lz4_compress_datum((const varlena *) DatumGetPointer(value));
-			cmid = TOAST_LZ4_COMPRESSION_ID;
-			break;
-		default:
-			elog(ERROR, "invalid compression method %c", cmethod);
+		tmp = toast_compress_segmented((const varlena *) DatumGetPointer(value),
+									   cmethod, cmlevel);
+		cmid = TOAST_SEGMENTED_COMPRESSION_ID;
 	}
+	else
+		tmp = toast_compress_with_method((const varlena *) DatumGetPointer(value),
+										 cmethod, cmlevel, &cmid);
 
 	if (tmp == NULL)
 		return PointerGetDatum(NULL);
@@ -103,6 +109,113 @@ toast_compress_datum(Datum value, char cmethod)
 	}
 }
 
+/*
+ * Compress a varlena with the given method.  The method id is returned in
+ * *cmid, but not stored in the result; that's up to the caller.
+ */
+static varlena *
+toast_compress_with_method(const varlena *value, char cmethod, int cmlevel,
+						   ToastCompressionId *cmid)
+{
+	switch (cmethod)
+	{
+		case TOAST_PGLZ_COMPRESSION:
+			*cmid = TOAST_PGLZ_COMPRESSION_ID;
+			return pglz_compress_datum(value);
+		case TOAST_LZ4_COMPRESSION:
+			*cmid = TOAST_LZ4_COMPRESSION_ID;
+			return lz4_compress_datum(value);
+		case TOAST_ZSTD_COMPRESSION:
+			*cmid = TOAST_ZSTD_COMPRESSION_ID;
+			return zstd_compress_datum(value, cmlevel);
+		default:
+			elog(ERROR, "invalid compression method %c", cmethod);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/*
+ * Compress a large varlena in segments of TOAST_SEGMENT_SIZE bytes, in the
+ * format described in toast_internals.h.  The toast_compress_header of the
+ * result is left for the caller to fill in.
+ *
+ * Returns NULL if the first segment does not compress: like pglz, which
+ * gives up when the start of its input does not compress, we assume the
+ * rest of the value won't either rather than compress all of it in vain.
+ */
+static varlena *
+toast_compress_segmented(const varlena *value, char cmethod, int cmlevel)
+{
+	const char *rawdata = VARDATA_ANY(value);
+	int32		valsize = VARSIZE_ANY_EXHDR(value);
+	int32		nsegments = (valsize + TOAST_SEGMENT_SIZE - 1) / TOAST_SEGMENT_SIZE;
+	varlena    *result;
+	varlena    *segment;
+	toast_segmented_header *hdr;
+	char	   *data;
+	uint32		dataoff = 0;
+
+	/*
+	 * Each segment takes at most its raw size plus a varlena header and
+	 * alignment padding, since incompressible segments are stored plain.
+	 */
+	result = (varlena *) palloc(VARHDRSZ_COMPRESSED +
+								TOAST_SEGMENTED_HDRSZ(nsegments) +
+								valsize + nsegments * (VARHDRSZ + ALIGNOF_INT));
+	hdr = (toast_segmented_header *) ((char *) result + VARHDRSZ_COMPRESSED);
+	data = (char *) hdr + TOAST_SEGMENTED_HDRSZ(nsegments);
+	memset(hdr, 0, TOAST_SEGMENTED_HDRSZ(nsegments));
+	hdr->segsize = TOAST_SEGMENT_SIZE;
+	hdr->nsegments = nsegments;
+
+	/* the compression routines want their input as a varlena */
+	segment = (varlena *) palloc(TOAST_SEGMENT_SIZE + VARHDRSZ);
+
+	for (int i = 0; i < nsegments; i++)
+	{
+		int32		seglen = Min(TOAST_SEGMENT_SIZE, valsize - i * TOAST_SEGMENT_SIZE);
+		ToastCompressionId cmid = TOAST_INVALID_COMPRESSION_ID;
+		varlena    *tmp;
+
+		SET_VARSIZE(segment, seglen + VARHDRSZ);
+		memcpy(VARDATA(segment), rawdata + i * TOAST_SEGMENT_SIZE, seglen);
+		tmp = toast_compress_with_method(segment, cmethod, cmlevel, &cmid);
+		hdr->cmid = cmid;
+
+		dataoff = INTALIGN(dataoff);
+		if (tmp != NULL && VARSIZE(tmp) < VARSIZE(segment))
+		{
+			TOAST_COMPRESS_SET_SIZE_AND_COMPRESS_METHOD(tmp, seglen, cmid);
+			memcpy(data + dataoff, tmp, VARSIZE(tmp));
+			dataoff += VARSIZE(tmp);
+		}
+		else if (i == 0)
+		{
+			if (tmp != NULL)
+				pfree(tmp);
+			pfree(segment);
+			pfree(result);
+			return NULL;
+		}
+		else
+		{
+			memcpy(data + dataoff, segment, VARSIZE(segment));
+			dataoff += VARSIZE(segment);
+		}
+		hdr->segend[i] = dataoff;
+
+		if (tmp != NULL)
+			pfree(tmp);
+	}
+
+	pfree(segment);
+
+	SET_VARSIZE_COMPRESSED(result, VARHDRSZ_COMPRESSED +
+						   TOAST_SEGMENTED_HDRSZ(nsegments) + dataoff);
+
+	return result;
+}
+
 /* ----------
  * toast_save_datum -
  *
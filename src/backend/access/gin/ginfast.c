@@ -20,8 +20,10 @@
 
 #include "access/gin_private.h"
 #include "access/ginxlog.h"
+#include "access/table.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "catalog/index.h"
 #include "catalog/pg_am.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
@@ -32,6 +34,7 @@
 #include "storage/predicate.h"
 #include "utils/acl.h"
 #include "utils/fmgrprotos.h"
+#include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
@@ -228,6 +231,7 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	bool		separateList = false;
 	bool		needCleanup = false;
 	int			cleanupSize;
+	BlockNumber nPendingPages;
 	bool		needWal;
 
 	if (collector->ntuples == 0)
@@ -456,13 +460,39 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	 * ginInsertCleanup() should not be called inside our CRIT_SECTION.
 	 */
 	cleanupSize = GinGetPendingListCleanupSize(index);
-	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * (Size) 1024)
+	nPendingPages = metadata->nPendingPages;
+	if (nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * (Size) 1024)
 		needCleanup = true;
 
 	END_CRIT_SECTION();
 
 	UnlockReleaseBuffer(metabuffer);
 
+	/*
+	 * If the index asks for it, hand the cleanup over to autovacuum instead
+	 * of doing it in the foreground.  We only file a request when this
+	 * insertion appended new pages to the list, so that the work item queue
+	 * isn't hammered by every insertion until autovacuum gets to the index.
+	 * If the list keeps growing regardless (autovacuum can't keep up, or the
+	 * request could not be recorded), fall back to cleaning it ourselves once
+	 * it reaches twice the configured size, so that searches don't have to
+	 * scan an unbounded pending list.
+	 */
+	if (needCleanup && GinGetDeferCleanup(index) && AutoVacuumingActive() &&
+		nPendingPages * GIN_PAGE_FREESIZE <= 2 * cleanupSize * (Size) 1024)
+	{
+		if (separateList &&
+			!AutoVacuumRequestWork(AVW_GINCleanPendingList,
+								   RelationGetRelid(index),
+								   InvalidBlockNumber))
+			ereport(LOG,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("request for GIN pending list cleanup for index \"%s\" was not recorded",
+							RelationGetRelationName(index))));
+		else
+			needCleanup = false;
+	}
+
 	/*
 	 * Since it could contend with concurrent cleanup process we cleanup
 	 * pending list not forcibly.
@@ -1031,7 +1061,12 @@ Datum
 gin_clean_pending_list(PG_FUNCTION_ARGS)
 {
 	Oid			indexoid = PG_GETARG_OID(0);
-	Relation	indexRel = index_open(indexoid, RowExclusiveLock);
+	Oid			heapoid;
+	Relation	indexRel;
+	Relation	heapRel;
+	Oid			save_userid;
+	int			save_sec_context;
+	int			save_nestlevel;
 	IndexBulkDeleteResult stats;
 
 	if (RecoveryInProgress())
@@ -1040,6 +1075,43 @@ gin_clean_pending_list(PG_FUNCTION_ARGS)
 				 errmsg("recovery is in progress"),
 				 errhint("GIN pending list cannot be cleaned up during recovery.")));
 
+	/*
+	 * We must lock table before index to avoid deadlocks.  However, if the
+	 * passed indexoid isn't an index then IndexGetRelation() will fail.
+	 * Rather than emitting a not-very-helpful error message, postpone
+	 * complaining, expecting that the is-it-an-index test below will fail.
+	 */
+	heapoid = IndexGetRelation(indexoid, true);
+	if (OidIsValid(heapoid))
+	{
+		heapRel = table_open(heapoid, RowExclusiveLock);
+
+		/*
+		 * Autovacuum calls us when a pending list cleanup has been deferred
+		 * to it.  For its benefit, switch to the table owner's userid, so
+		 * that any index functions are run as that user.  Also lock down
+		 * security-restricted operations and arrange to make GUC variable
+		 * changes local to this command.  This is harmless, albeit
+		 * unnecessary, when called from SQL, because we fail shortly if the
+		 * user does not own the index.
+		 */
+		GetUserIdAndSecContext(&save_userid, &save_sec_context);
+		SetUserIdAndSecContext(heapRel->rd_rel->relowner,
+							   save_sec_context | SECURITY_RESTRICTED_OPERATION);
+		save_nestlevel = NewGUCNestLevel();
+		RestrictSearchPath();
+	}
+	else
+	{
+		heapRel = NULL;
+		/* Set these just to suppress "uninitialized variable" warnings */
+		save_userid = InvalidOid;
+		save_sec_context = -1;
+		save_nestlevel = -1;
+	}
+
+	indexRel = index_open(indexoid, RowExclusiveLock);
+
 	/* Must be a GIN index */
 	if (indexRel->rd_rel->relkind != RELKIND_INDEX ||
 		indexRel->rd_rel->relam != GIN_AM_OID)
@@ -1059,10 +1131,21 @@ gin_clean_pending_list(PG_FUNCTION_ARGS)
 				 errmsg("cannot access temporary indexes of other sessions")));
 
 	/* User must own the index (comparable to privileges needed for VACUUM) */
-	if (!object_ownercheck(RelationRelationId, indexoid, GetUserId()))
+	if (heapRel != NULL && !object_ownercheck(RelationRelationId, indexoid, save_userid))
 		aclcheck_error(ACLCHECK_NOT_OWNER, OBJECT_INDEX,
 					   RelationGetRelationName(indexRel));
 
+	/*
+	 * Since we did the IndexGetRelation call above without any lock, it's
+	 * barely possible that a race against an index drop/recreation could have
+	 * netted us the wrong table.  Recheck.
+	 */
+	if (heapRel == NULL || heapoid != IndexGetRelation(indexoid, false))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_TABLE),
+				 errmsg("could not open parent table of index \"%s\"",
+						RelationGetRelationName(indexRel))));
+
 	memset(&stats, 0, sizeof(stats));
 
 	/*
@@ -1085,7 +1168,14 @@ gin_clean_pending_list(PG_FUNCTION_ARGS)
 				 errmsg("index \"%s\" is not valid",
 						RelationGetRelationName(indexRel))));
 
+	/* Roll back any GUC changes executed by index functions */
+	AtEOXact_GUC(false, save_nestlevel);
+
+	/* Restore userid and security context */
+	SetUserIdAndSecContext(save_userid, save_sec_context);
+
 	index_close(indexRel, RowExclusiveLock);
+	table_close(heapRel, RowExclusiveLock);
 
 	PG_RETURN_INT64((int64) stats.pages_deleted);
 }
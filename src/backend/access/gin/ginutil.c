@@ -559,7 +559,8 @@ ginoptions(Datum reloptions, bool validate)
 	static const relopt_parse_elt tab[] = {
 		{"fastupdate", RELOPT_TYPE_BOOL, offsetof(GinOptions, useFastUpdate)},
 		{"gin_pending_list_limit", RELOPT_TYPE_INT, offsetof(GinOptions,
-															 pendingListCleanupSize)}
+															 pendingListCleanupSize)},
+		{"deferred_cleanup", RELOPT_TYPE_BOOL, offsetof(GinOptions, deferCleanup)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate,
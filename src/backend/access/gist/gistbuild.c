@@ -15,6 +15,10 @@
  * The sorted method is used if the operator classes for all columns have
  * a 'sortsupport' defined. Otherwise, we resort to the second strategy.
  *
+ * The sorted method can use parallel workers to scan the heap and sort
+ * their share of the input, much like a parallel B-tree build.  The leader
+ * merges the per-worker runs and builds the index pages alone.
+ *
  * The second strategy can optionally use buffers at different levels of
  * the tree to reduce I/O, see "Buffering build algorithm" in the README
  * for a more detailed explanation. It initially calls insert over and
@@ -36,17 +40,32 @@
 
 #include "access/genam.h"
 #include "access/gist_private.h"
+#include "access/parallel.h"
+#include "access/table.h"
 #include "access/tableam.h"
 #include "access/xloginsert.h"
+#include "catalog/index.h"
+#include "executor/instrument.h"
 #include "miscadmin.h"
 #include "nodes/execnodes.h"
 #include "optimizer/optimizer.h"
+#include "pgstat.h"
 #include "storage/bufmgr.h"
 #include "storage/bulk_write.h"
-
+#include "storage/condition_variable.h"
+#include "storage/proc.h"
+#include "tcop/tcopprot.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/tuplesort.h"
+#include "utils/wait_event.h"
+
+/* Magic numbers for parallel state sharing */
+#define PARALLEL_KEY_GIST_SHARED		UINT64CONST(0xC000000000000001)
+#define PARALLEL_KEY_TUPLESORT			UINT64CONST(0xC000000000000002)
+#define PARALLEL_KEY_QUERY_TEXT			UINT64CONST(0xC000000000000003)
+#define PARALLEL_KEY_WAL_USAGE			UINT64CONST(0xC000000000000004)
+#define PARALLEL_KEY_BUFFER_USAGE		UINT64CONST(0xC000000000000005)
 
 /* Step of index tuples for check whether to switch to buffering build mode */
 #define BUFFERING_MODE_SWITCH_CHECK_STEP 256
@@ -110,6 +129,95 @@ typedef struct
 	BulkWriteState *bulkstate;
 } GISTBuildState;
 
+/*
+ * Status for sorted index builds performed in parallel.  This is allocated
+ * in a dynamic shared memory segment.
+ */
+typedef struct GistShared
+{
+	/*
+	 * These fields are not modified during the build.  They primarily exist
+	 * for the benefit of worker processes that need to create state
+	 * corresponding to that used by the leader.
+	 */
+	Oid			heaprelid;
+	Oid			indexrelid;
+	bool		isconcurrent;
+	int			scantuplesortstates;
+
+	/* Query ID, for report in worker processes */
+	int64		queryid;
+
+	/*
+	 * workersdonecv is used to monitor the progress of workers.  All parallel
+	 * participants must indicate that they are done before leader can merge
+	 * the sorted runs and write the index pages.
+	 */
+	ConditionVariable workersdonecv;
+
+	/*
+	 * mutex protects all fields before heapdesc.
+	 *
+	 * nparticipantsdone is number of worker processes finished.
+	 *
+	 * reltuples is the total number of input heap tuples.
+	 *
+	 * indtuples is the total number of tuples that made it into the index.
+	 */
+	slock_t		mutex;
+
+	int			nparticipantsdone;
+	double		reltuples;
+	double		indtuples;
+
+	/*
+	 * ParallelTableScanDescData data follows. Can't directly embed here, as
+	 * implementations of the parallel table scan desc interface might need
+	 * stronger alignment.
+	 */
+} GistShared;
+
+/*
+ * Return pointer to a GistShared's parallel table scan.
+ *
+ * c.f. shm_toc_allocate as to why BUFFERALIGN is used, rather than just
+ * MAXALIGN.
+ */
+#define ParallelTableScanFromGistShared(shared) \
+	(ParallelTableScanDesc) ((char *) (shared) + BUFFERALIGN(sizeof(GistShared)))
+
+/*
+ * Status for leader in parallel index build.
+ */
+typedef struct GistLeader
+{
+	/* parallel context itself */
+	ParallelContext *pcxt;
+
+	/*
+	 * nparticipanttuplesorts is the exact number of worker processes
+	 * successfully launched, plus one leader process if it participates as a
+	 * worker (only DISABLE_LEADER_PARTICIPATION builds avoid leader
+	 * participating as a worker).
+	 */
+	int			nparticipanttuplesorts;
+
+	/*
+	 * Leader process convenience pointers to shared state (leader avoids TOC
+	 * lookups).
+	 *
+	 * gistshared is the shared state for entire build.  sharedsort is the
+	 * shared, tuplesort-managed state passed to each process tuplesort.
+	 * snapshot is the snapshot used by the scan iff an MVCC snapshot is
+	 * required.
+	 */
+	GistShared *gistshared;
+	Sharedsort *sharedsort;
+	Snapshot	snapshot;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+} GistLeader;
+
 #define GIST_SORTED_BUILD_PAGE_NUM 4
 
 /*
@@ -140,6 +248,19 @@ static void gist_indexsortbuild_levelstate_add(GISTBuildState *state,
 static void gist_indexsortbuild_levelstate_flush(GISTBuildState *state,
 												 GistSortedBuildLevelState *levelstate);
 
+static GistLeader *_gist_begin_parallel(Relation heap, Relation index,
+										bool isconcurrent, int request);
+static void _gist_end_parallel(GistLeader *gistleader);
+static Size _gist_parallel_estimate_shared(Relation heap, Snapshot snapshot);
+static double _gist_parallel_heapscan(GistLeader *gistleader,
+									  GISTBuildState *buildstate);
+static void _gist_leader_participate_as_worker(GistLeader *gistleader,
+											   Relation heap, Relation index);
+static void _gist_parallel_scan_and_sort(GistShared *gistshared,
+										 Sharedsort *sharedsort,
+										 Relation heap, Relation index,
+										 int sortmem);
+
 static void gistInitBuffering(GISTBuildState *buildstate);
 static int	calculatePagesPerBuffer(GISTBuildState *buildstate, int levelStep);
 static void gistBuildCallback(Relation index,
@@ -261,19 +382,58 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 
 	if (buildstate.buildMode == GIST_SORTED_BUILD)
 	{
+		GistLeader *gistleader = NULL;
+
 		/*
-		 * Sort all data, build the index from bottom up.
+		 * Attempt to launch parallel workers to scan the table and sort their
+		 * share of it.  Only the sorted build can be parallelized; the other
+		 * strategies insert into the index as they go.
 		 */
-		buildstate.sortstate = tuplesort_begin_index_gist(heap,
-														  index,
-														  maintenance_work_mem,
-														  NULL,
-														  TUPLESORT_NONE);
+		if (indexInfo->ii_ParallelWorkers > 0)
+			gistleader = _gist_begin_parallel(heap, index,
+											  indexInfo->ii_Concurrent,
+											  indexInfo->ii_ParallelWorkers);
 
-		/* Scan the table, adding all tuples to the tuplesort */
-		reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
-										   gistSortedBuildCallback,
-										   &buildstate, NULL);
+		if (gistleader)
+		{
+			SortCoordinate coordinate;
+
+			coordinate = palloc0_object(SortCoordinateData);
+			coordinate->isWorker = false;
+			coordinate->nParticipants = gistleader->nparticipanttuplesorts;
+			coordinate->sharedsort = gistleader->sharedsort;
+
+			/*
+			 * Begin leader tuplesort.  As with parallel B-tree builds, the
+			 * leader receives the same share of maintenance_work_mem as a
+			 * serial sort would, relying on the workers' Tuplesortstates
+			 * having released their memory by the time the merge starts.
+			 */
+			buildstate.sortstate = tuplesort_begin_index_gist(heap,
+															  index,
+															  maintenance_work_mem,
+															  coordinate,
+															  TUPLESORT_NONE);
+
+			/* Wait for the workers (and ourselves) to finish scanning */
+			reltuples = _gist_parallel_heapscan(gistleader, &buildstate);
+		}
+		else
+		{
+			/*
+			 * Sort all data, build the index from bottom up.
+			 */
+			buildstate.sortstate = tuplesort_begin_index_gist(heap,
+															  index,
+															  maintenance_work_mem,
+															  NULL,
+															  TUPLESORT_NONE);
+
+			/* Scan the table, adding all tuples to the tuplesort */
+			reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+											   gistSortedBuildCallback,
+											   &buildstate, NULL);
+		}
 
 		/*
 		 * Perform the sort and build index pages.
@@ -283,6 +443,9 @@ gistbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 		gist_indexsortbuild(&buildstate);
 
 		tuplesort_end(buildstate.sortstate);
+
+		if (gistleader)
+			_gist_end_parallel(gistleader);
 	}
 	else
 	{
@@ -609,6 +772,450 @@ gist_indexsortbuild_levelstate_flush(GISTBuildState *state,
 }
 
 
+/*-------------------------------------------------------------------------
+ * Routines for parallel sorted build
+ *-------------------------------------------------------------------------
+ */
+
+/*
+ * Create parallel context, and launch workers for leader.
+ *
+ * isconcurrent indicates if operation is CREATE INDEX CONCURRENTLY.
+ *
+ * request is the target number of parallel worker processes to launch.
+ *
+ * Returns the GistLeader, which caller must use to shut down parallel mode
+ * by passing it to _gist_end_parallel() at the very end of its index build.
+ * If not even a single worker process can be launched, returns NULL, and
+ * caller should proceed with a serial index build.
+ */
+static GistLeader *
+_gist_begin_parallel(Relation heap, Relation index, bool isconcurrent,
+					 int request)
+{
+	ParallelContext *pcxt;
+	int			scantuplesortstates;
+	Snapshot	snapshot;
+	Size		estgistshared;
+	Size		estsort;
+	GistShared *gistshared;
+	Sharedsort *sharedsort;
+	GistLeader *gistleader = palloc0_object(GistLeader);
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	bool		leaderparticipates = true;
+	int			querylen;
+
+#ifdef DISABLE_LEADER_PARTICIPATION
+	leaderparticipates = false;
+#endif
+
+	/*
+	 * Enter parallel mode, and create context for parallel build of gist
+	 * index
+	 */
+	EnterParallelMode();
+	Assert(request > 0);
+	pcxt = CreateParallelContext("postgres", "_gist_parallel_build_main",
+								 request);
+
+	scantuplesortstates = leaderparticipates ? request + 1 : request;
+
+	/*
+	 * Prepare for scan of the base relation.  In a normal index build, we use
+	 * SnapshotAny because we must retrieve all tuples and do our own time
+	 * qual checks (because we have to index RECENTLY_DEAD tuples).  In a
+	 * concurrent build, we take a regular MVCC snapshot and index whatever's
+	 * live according to that.
+	 */
+	if (!isconcurrent)
+		snapshot = SnapshotAny;
+	else
+		snapshot = RegisterSnapshot(GetTransactionSnapshot());
+
+	/*
+	 * Estimate size for our own PARALLEL_KEY_GIST_SHARED workspace.
+	 */
+	estgistshared = _gist_parallel_estimate_shared(heap, snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, estgistshared);
+	estsort = tuplesort_estimate_shared(scantuplesortstates);
+	shm_toc_estimate_chunk(&pcxt->estimator, estsort);
+
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+	/*
+	 * Estimate space for WalUsage and BufferUsage -- PARALLEL_KEY_WAL_USAGE
+	 * and PARALLEL_KEY_BUFFER_USAGE.
+	 *
+	 * If there are no extensions loaded that care, we could skip this.  We
+	 * have no way of knowing whether anyone's looking at pgWalUsage or
+	 * pgBufferUsage, so do it unconditionally.
+	 */
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/* Finally, estimate PARALLEL_KEY_QUERY_TEXT space */
+	if (debug_query_string)
+	{
+		querylen = strlen(debug_query_string);
+		shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+	else
+		querylen = 0;			/* keep compiler quiet */
+
+	/* Everyone's had a chance to ask for space, so now create the DSM */
+	InitializeParallelDSM(pcxt);
+
+	/* If no DSM segment was available, back out (do serial build) */
+	if (pcxt->seg == NULL)
+	{
+		if (IsMVCCSnapshot(snapshot))
+			UnregisterSnapshot(snapshot);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return NULL;
+	}
+
+	/* Store shared build state, for which we reserved space */
+	gistshared = (GistShared *) shm_toc_allocate(pcxt->toc, estgistshared);
+	/* Initialize immutable state */
+	gistshared->heaprelid = RelationGetRelid(heap);
+	gistshared->indexrelid = RelationGetRelid(index);
+	gistshared->isconcurrent = isconcurrent;
+	gistshared->scantuplesortstates = scantuplesortstates;
+	gistshared->queryid = pgstat_get_my_query_id();
+	ConditionVariableInit(&gistshared->workersdonecv);
+	SpinLockInit(&gistshared->mutex);
+
+	/* Initialize mutable state */
+	gistshared->nparticipantsdone = 0;
+	gistshared->reltuples = 0.0;
+	gistshared->indtuples = 0.0;
+
+	table_parallelscan_initialize(heap,
+								  ParallelTableScanFromGistShared(gistshared),
+								  snapshot);
+
+	/*
+	 * Store shared tuplesort-private state, for which we reserved space.
+	 * Then, initialize opaque state using tuplesort routine.
+	 */
+	sharedsort = (Sharedsort *) shm_toc_allocate(pcxt->toc, estsort);
+	tuplesort_initialize_shared(sharedsort, scantuplesortstates,
+								pcxt->seg);
+
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_GIST_SHARED, gistshared);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_TUPLESORT, sharedsort);
+
+	/* Store query string for workers */
+	if (debug_query_string)
+	{
+		char	   *sharedquery;
+
+		sharedquery = (char *) shm_toc_allocate(pcxt->toc, querylen + 1);
+		memcpy(sharedquery, debug_query_string, querylen + 1);
+		shm_toc_insert(pcxt->toc, PARALLEL_KEY_QUERY_TEXT, sharedquery);
+	}
+
+	/*
+	 * Allocate space for each worker's WalUsage and BufferUsage; no need to
+	 * initialize.
+	 */
+	walusage = shm_toc_allocate(pcxt->toc,
+								mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_WAL_USAGE, walusage);
+	bufferusage = shm_toc_allocate(pcxt->toc,
+								   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BUFFER_USAGE, bufferusage);
+
+	/* Launch workers, saving status for leader/caller */
+	LaunchParallelWorkers(pcxt);
+	gistleader->pcxt = pcxt;
+	gistleader->nparticipanttuplesorts = pcxt->nworkers_launched;
+	if (leaderparticipates)
+		gistleader->nparticipanttuplesorts++;
+	gistleader->gistshared = gistshared;
+	gistleader->sharedsort = sharedsort;
+	gistleader->snapshot = snapshot;
+	gistleader->walusage = walusage;
+	gistleader->bufferusage = bufferusage;
+
+	/* If no workers were successfully launched, back out (do serial build) */
+	if (pcxt->nworkers_launched == 0)
+	{
+		_gist_end_parallel(gistleader);
+		return NULL;
+	}
+
+	/* Join heap scan ourselves */
+	if (leaderparticipates)
+		_gist_leader_participate_as_worker(gistleader, heap, index);
+
+	/*
+	 * Caller needs to wait for all launched workers when we return.  Make
+	 * sure that the failure-to-start case will not hang forever.
+	 */
+	WaitForParallelWorkersToAttach(pcxt);
+
+	return gistleader;
+}
+
+/*
+ * Shut down workers, destroy parallel context, and end parallel mode.
+ */
+static void
+_gist_end_parallel(GistLeader *gistleader)
+{
+	int			i;
+
+	/* Shutdown worker processes */
+	WaitForParallelWorkersToFinish(gistleader->pcxt);
+
+	/*
+	 * Next, accumulate WAL usage.  (This must wait for the workers to finish,
+	 * or we might get incomplete data.)
+	 */
+	for (i = 0; i < gistleader->pcxt->nworkers_launched; i++)
+		InstrAccumParallelQuery(&gistleader->bufferusage[i], &gistleader->walusage[i]);
+
+	/* Free last reference to MVCC snapshot, if one was used */
+	if (IsMVCCSnapshot(gistleader->snapshot))
+		UnregisterSnapshot(gistleader->snapshot);
+	DestroyParallelContext(gistleader->pcxt);
+	ExitParallelMode();
+}
+
+/*
+ * Returns size of shared memory required to store state for a parallel
+ * gist index build based on the snapshot its parallel scan will use.
+ */
+static Size
+_gist_parallel_estimate_shared(Relation heap, Snapshot snapshot)
+{
+	/* c.f. shm_toc_allocate as to why BUFFERALIGN is used */
+	return add_size(BUFFERALIGN(sizeof(GistShared)),
+					table_parallelscan_estimate(heap, snapshot));
+}
+
+/*
+ * Within leader, wait for end of heap scan.
+ *
+ * When called, parallel heap scan started by _gist_begin_parallel() will
+ * already be underway within worker processes (when leader participates
+ * as a worker, we should end up here just as workers are finishing).
+ *
+ * Fills in the number of index tuples in buildstate, and returns the total
+ * number of heap tuples scanned.
+ */
+static double
+_gist_parallel_heapscan(GistLeader *gistleader, GISTBuildState *buildstate)
+{
+	GistShared *gistshared = gistleader->gistshared;
+	double		reltuples;
+
+	for (;;)
+	{
+		SpinLockAcquire(&gistshared->mutex);
+		if (gistshared->nparticipantsdone == gistleader->nparticipanttuplesorts)
+		{
+			reltuples = gistshared->reltuples;
+			buildstate->indtuples = (int64) gistshared->indtuples;
+
+			SpinLockRelease(&gistshared->mutex);
+			break;
+		}
+		SpinLockRelease(&gistshared->mutex);
+
+		ConditionVariableSleep(&gistshared->workersdonecv,
+							   WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN);
+	}
+
+	ConditionVariableCancelSleep();
+
+	return reltuples;
+}
+
+/*
+ * Within leader, participate as a parallel worker.
+ */
+static void
+_gist_leader_participate_as_worker(GistLeader *gistleader, Relation heap,
+								   Relation index)
+{
+	int			sortmem;
+
+	/*
+	 * Might as well use reliable figure when doling out maintenance_work_mem
+	 * (when requested number of workers were not launched, this will be
+	 * somewhat higher than it is for other workers).
+	 */
+	sortmem = maintenance_work_mem / gistleader->nparticipanttuplesorts;
+
+	/* Perform work common to all participants */
+	_gist_parallel_scan_and_sort(gistleader->gistshared,
+								 gistleader->sharedsort,
+								 heap, index, sortmem);
+}
+
+/*
+ * Perform a worker's portion of a parallel sort.
+ *
+ * This scans the worker's share of the table, forms compressed index
+ * tuples, and sorts them into a run that the leader will merge.  The
+ * participant uses its own GISTSTATE and temporary memory context.
+ *
+ * sortmem is the amount of working memory to use within each worker,
+ * expressed in KBs.
+ *
+ * When this returns, workers are done, and need only release resources.
+ */
+static void
+_gist_parallel_scan_and_sort(GistShared *gistshared, Sharedsort *sharedsort,
+							 Relation heap, Relation index, int sortmem)
+{
+	GISTBuildState buildstate;
+	SortCoordinate coordinate;
+	TableScanDesc scan;
+	double		reltuples;
+	IndexInfo  *indexInfo;
+
+	/* Initialize local tuplesort coordination state */
+	coordinate = palloc0_object(SortCoordinateData);
+	coordinate->isWorker = true;
+	coordinate->nParticipants = -1;
+	coordinate->sharedsort = sharedsort;
+
+	memset(&buildstate, 0, sizeof(buildstate));
+	buildstate.indexrel = index;
+	buildstate.heaprel = heap;
+	buildstate.buildMode = GIST_SORTED_BUILD;
+	buildstate.giststate = initGISTstate(index);
+	buildstate.giststate->tempCxt = createTempGistContext();
+
+	/* Begin "partial" tuplesort */
+	buildstate.sortstate = tuplesort_begin_index_gist(heap, index, sortmem,
+													  coordinate,
+													  TUPLESORT_NONE);
+
+	/* Join parallel scan */
+	indexInfo = BuildIndexInfo(index);
+	indexInfo->ii_Concurrent = gistshared->isconcurrent;
+
+	scan = table_beginscan_parallel(heap,
+									ParallelTableScanFromGistShared(gistshared),
+									SO_NONE);
+
+	reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+									   gistSortedBuildCallback, &buildstate,
+									   scan);
+
+	/* Sort the tuples produced by this participant */
+	tuplesort_performsort(buildstate.sortstate);
+
+	/*
+	 * Done.  Record ambuild statistics.
+	 */
+	SpinLockAcquire(&gistshared->mutex);
+	gistshared->nparticipantsdone++;
+	gistshared->reltuples += reltuples;
+	gistshared->indtuples += buildstate.indtuples;
+	SpinLockRelease(&gistshared->mutex);
+
+	/* Notify leader */
+	ConditionVariableSignal(&gistshared->workersdonecv);
+
+	tuplesort_end(buildstate.sortstate);
+
+	MemoryContextDelete(buildstate.giststate->tempCxt);
+	freeGISTstate(buildstate.giststate);
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void
+_gist_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+	char	   *sharedquery;
+	GistShared *gistshared;
+	Sharedsort *sharedsort;
+	Relation	heapRel;
+	Relation	indexRel;
+	LOCKMODE	heapLockmode;
+	LOCKMODE	indexLockmode;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	int			sortmem;
+
+	/*
+	 * The only possible status flag that can be set to the parallel worker is
+	 * PROC_IN_SAFE_IC.
+	 */
+	Assert((MyProc->statusFlags == 0) ||
+		   (MyProc->statusFlags == PROC_IN_SAFE_IC));
+
+	/* Set debug_query_string for individual workers first */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_KEY_QUERY_TEXT, true);
+	debug_query_string = sharedquery;
+
+	/* Report the query string from leader */
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	/* Look up gist shared state */
+	gistshared = shm_toc_lookup(toc, PARALLEL_KEY_GIST_SHARED, false);
+
+	/* Open relations using lock modes known to be obtained by index.c */
+	if (!gistshared->isconcurrent)
+	{
+		heapLockmode = ShareLock;
+		indexLockmode = AccessExclusiveLock;
+	}
+	else
+	{
+		heapLockmode = ShareUpdateExclusiveLock;
+		indexLockmode = RowExclusiveLock;
+	}
+
+	/* Track query ID */
+	pgstat_report_query_id(gistshared->queryid, false);
+
+	/* Open relations within worker */
+	heapRel = table_open(gistshared->heaprelid, heapLockmode);
+	indexRel = index_open(gistshared->indexrelid, indexLockmode);
+
+	/* Look up shared state private to tuplesort.c */
+	sharedsort = shm_toc_lookup(toc, PARALLEL_KEY_TUPLESORT, false);
+	tuplesort_attach_shared(sharedsort, seg);
+
+	/* Prepare to track buffer usage during parallel execution */
+	InstrStartParallelQuery();
+
+	/*
+	 * Might as well use reliable figure when doling out maintenance_work_mem
+	 * (when requested number of workers were not launched, this will be
+	 * somewhat higher than it is for other workers).
+	 */
+	sortmem = maintenance_work_mem / gistshared->scantuplesortstates;
+
+	_gist_parallel_scan_and_sort(gistshared, sharedsort,
+								 heapRel, indexRel, sortmem);
+
+	/* Report WAL/buffer usage during parallel execution */
+	bufferusage = shm_toc_lookup(toc, PARALLEL_KEY_BUFFER_USAGE, false);
+	walusage = shm_toc_lookup(toc, PARALLEL_KEY_WAL_USAGE, false);
+	InstrEndParallelQuery(&bufferusage[ParallelWorkerNumber],
+						  &walusage[ParallelWorkerNumber]);
+
+	index_close(indexRel, indexLockmode);
+	table_close(heapRel, heapLockmode);
+}
+
+
 /*-------------------------------------------------------------------------
  * Routines for non-sorted build
  *-------------------------------------------------------------------------
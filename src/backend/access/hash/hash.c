@@ -81,8 +81,9 @@ hashhandler(PG_FUNCTION_ARGS)
 		.amconsistentordering = false,
 		.amcanbackward = true,
 		.amcanunique = false,
-		.amcanmulticol = false,
+		.amcanmulticol = true,
 		.amoptionalkey = false,
+		.amrequireallkeys = true,
 		.amsearcharray = false,
 		.amsearchnulls = false,
 		.amstorage = false,
@@ -235,8 +236,8 @@ hashbuildCallback(Relation index,
 				  void *state)
 {
 	HashBuildState *buildstate = (HashBuildState *) state;
-	Datum		index_values[1];
-	bool		index_isnull[1];
+	Datum		index_values[INDEX_MAX_KEYS];
+	bool		index_isnull[INDEX_MAX_KEYS];
 	IndexTuple	itup;
 
 	/* convert data to a hash key; on failure, do not insert anything */
@@ -274,8 +275,8 @@ hashinsert(Relation rel, Datum *values, bool *isnull,
 		   bool indexUnchanged,
 		   IndexInfo *indexInfo)
 {
-	Datum		index_values[1];
-	bool		index_isnull[1];
+	Datum		index_values[INDEX_MAX_KEYS];
+	bool		index_isnull[INDEX_MAX_KEYS];
 	IndexTuple	itup;
 
 	/* convert data to a hash key; on failure, do not insert anything */
@@ -290,6 +290,9 @@ _hash_first(IndexScanDesc scan, ScanDirection dir)
 {
 	Relation	rel = scan->indexRelation;
 	HashScanOpaque so = (HashScanOpaque) scan->opaque;
+	int			nkeyatts = IndexRelationGetNumberOfKeyAttributes(rel);
+	ScanKey		colkeys[INDEX_MAX_KEYS];
+	uint32		colhashes[INDEX_MAX_KEYS];
 	ScanKey		cur;
 	uint32		hashkey;
 	Bucket		bucket;
@@ -313,20 +316,41 @@ _hash_first(IndexScanDesc scan, ScanDirection dir)
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("hash indexes do not support whole-index scans")));
 
-	/* There may be more than one index qual, but we hash only the first */
-	cur = &scan->keyData[0];
-
-	/* We support only single-column hash indexes */
-	Assert(cur->sk_attno == 1);
-	/* And there's only one operator strategy, too */
-	Assert(cur->sk_strategy == HTEqualStrategyNumber);
-
 	/*
-	 * If the constant in the index qual is NULL, assume it cannot match any
-	 * items in the index.
+	 * There may be more than one index qual per column, but we hash only the
+	 * first one we find for each.  The planner guarantees that there is at
+	 * least one qual for every key column, since the hash key is computed
+	 * over all of them.
 	 */
-	if (cur->sk_flags & SK_ISNULL)
-		return false;
+	memset(colkeys, 0, sizeof(colkeys));
+	for (int i = 0; i < scan->numberOfKeys; i++)
+	{
+		cur = &scan->keyData[i];
+
+		/* There's only one operator strategy */
+		Assert(cur->sk_strategy == HTEqualStrategyNumber);
+		Assert(cur->sk_attno >= 1 && cur->sk_attno <= nkeyatts);
+
+		if (colkeys[cur->sk_attno - 1] == NULL)
+			colkeys[cur->sk_attno - 1] = cur;
+	}
+
+	for (int i = 0; i < nkeyatts; i++)
+	{
+		cur = colkeys[i];
+
+		if (cur == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("hash index scans require a qualification on every index column")));
+
+		/*
+		 * If the constant in the index qual is NULL, assume it cannot match
+		 * any items in the index.
+		 */
+		if (cur->sk_flags & SK_ISNULL)
+			return false;
+	}
 
 	/*
 	 * Okay to compute the hash key.  We want to do this before acquiring any
@@ -338,12 +362,19 @@ _hash_first(IndexScanDesc scan, ScanDirection dir)
 	 * We support the convention that sk_subtype == InvalidOid means the
 	 * opclass input type; this is a hack to simplify life for ScanKeyInit().
 	 */
-	if (cur->sk_subtype == rel->rd_opcintype[0] ||
-		cur->sk_subtype == InvalidOid)
-		hashkey = _hash_datum2hashkey(rel, cur->sk_argument);
-	else
-		hashkey = _hash_datum2hashkey_type(rel, cur->sk_argument,
-										   cur->sk_subtype);
+	for (int i = 0; i < nkeyatts; i++)
+	{
+		cur = colkeys[i];
+
+		if (cur->sk_subtype == rel->rd_opcintype[i] ||
+			cur->sk_subtype == InvalidOid)
+			colhashes[i] = _hash_datum2hashkey(rel, i + 1, cur->sk_argument);
+		else
+			colhashes[i] = _hash_datum2hashkey_type(rel, i + 1,
+													cur->sk_argument,
+													cur->sk_subtype);
+	}
+	hashkey = _hash_combine_hashkeys(colhashes, nkeyatts);
 
 	so->hashso_sk_hash = hashkey;
 
@@ -17,6 +17,7 @@
 #include "access/hash.h"
 #include "access/reloptions.h"
 #include "access/relscan.h"
+#include "common/hashfn.h"
 #include "port/pg_bitutils.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
@@ -75,37 +76,37 @@ _hash_checkqual(IndexScanDesc scan, IndexTuple itup)
 /*
  * _hash_datum2hashkey -- given a Datum, call the index's hash function
  *
- * The Datum is assumed to be of the index's column type, so we can use the
- * "primary" hash function that's tracked for us by the generic index code.
+ * The Datum is assumed to be of the type of index column attno, so we can
+ * use the "primary" hash function that's tracked for us by the generic
+ * index code.
  */
 uint32
-_hash_datum2hashkey(Relation rel, Datum key)
+_hash_datum2hashkey(Relation rel, AttrNumber attno, Datum key)
 {
 	FmgrInfo   *procinfo;
 	Oid			collation;
 
-	/* XXX assumes index has only one attribute */
-	procinfo = index_getprocinfo(rel, 1, HASHSTANDARD_PROC);
-	collation = rel->rd_indcollation[0];
+	procinfo = index_getprocinfo(rel, attno, HASHSTANDARD_PROC);
+	collation = rel->rd_indcollation[attno - 1];
 
 	return DatumGetUInt32(FunctionCall1Coll(procinfo, collation, key));
 }
 
 /*
  * _hash_datum2hashkey_type -- given a Datum of a specified type,
- *			hash it in a fashion compatible with this index
+ *			hash it in a fashion compatible with index column attno
  *
  * This is much more expensive than _hash_datum2hashkey, so use it only in
  * cross-type situations.
  */
 uint32
-_hash_datum2hashkey_type(Relation rel, Datum key, Oid keytype)
+_hash_datum2hashkey_type(Relation rel, AttrNumber attno, Datum key,
+						 Oid keytype)
 {
 	RegProcedure hash_proc;
 	Oid			collation;
 
-	/* XXX assumes index has only one attribute */
-	hash_proc = get_opfamily_proc(rel->rd_opfamily[0],
+	hash_proc = get_opfamily_proc(rel->rd_opfamily[attno - 1],
 								  keytype,
 								  keytype,
 								  HASHSTANDARD_PROC);
@@ -113,11 +114,35 @@ _hash_datum2hashkey_type(Relation rel, Datum key, Oid keytype)
 		elog(ERROR, "missing support function %d(%u,%u) for index \"%s\"",
 			 HASHSTANDARD_PROC, keytype, keytype,
 			 RelationGetRelationName(rel));
-	collation = rel->rd_indcollation[0];
+	collation = rel->rd_indcollation[attno - 1];
 
 	return DatumGetUInt32(OidFunctionCall1Coll(hash_proc, collation, key));
 }
 
+/*
+ * _hash_combine_hashkeys -- combine per-column hash codes into the hash key
+ *
+ * The hash key of a multi-column index tuple is computed from the hash codes
+ * of all its key columns, so that rows are spread across buckets by their
+ * full key.  For a single-column index this is just the column's hash code,
+ * which keeps the on-disk format of such indexes unchanged.
+ */
+uint32
+_hash_combine_hashkeys(const uint32 *colhashes, int ncols)
+{
+	uint32		hashkey = 0;
+
+	for (int i = 0; i < ncols; i++)
+	{
+		if (i == 0)
+			hashkey = colhashes[i];
+		else
+			hashkey = hash_combine(hashkey, colhashes[i]);
+	}
+
+	return hashkey;
+}
+
 /*
  * _hash_hashkey2bucket -- determine which bucket the hashkey maps to.
  */
@@ -310,27 +335,41 @@ _hash_get_indextuple_hashkey(IndexTuple itup)
  * Returns true if successful, false if not (because there are null values).
  * On a false result, the given data need not be indexed.
  *
- * Note: callers know that the index-column arrays are always of length 1.
- * In principle, there could be more than one input column, though we do not
- * currently support that.
+ * The first index column holds the hash key computed over all the key
+ * columns (see _hash_combine_hashkeys); that is the value used to choose
+ * the bucket and to order entries within a page.  Any further index columns
+ * hold the hash codes of the corresponding key columns, so that every index
+ * column has a value.  Callers must supply index-column arrays with one
+ * entry per index key column.
  */
 bool
 _hash_convert_tuple(Relation index,
 					const Datum *user_values, const bool *user_isnull,
 					Datum *index_values, bool *index_isnull)
 {
-	uint32		hashkey;
+	int			nkeyatts = IndexRelationGetNumberOfKeyAttributes(index);
+	uint32		colhashes[INDEX_MAX_KEYS];
 
 	/*
 	 * We do not insert null values into hash indexes.  This is okay because
-	 * the only supported search operator is '=', and we assume it is strict.
+	 * the only supported search operator is '=', we assume it is strict, and
+	 * scans must supply a qual for every key column.
 	 */
-	if (user_isnull[0])
-		return false;
+	for (int i = 0; i < nkeyatts; i++)
+	{
+		if (user_isnull[i])
+			return false;
+	}
+
+	for (int i = 0; i < nkeyatts; i++)
+	{
+		colhashes[i] = _hash_datum2hashkey(index, i + 1, user_values[i]);
+		index_values[i] = UInt32GetDatum(colhashes[i]);
+		index_isnull[i] = false;
+	}
 
-	hashkey = _hash_datum2hashkey(index, user_values[0]);
-	index_values[0] = UInt32GetDatum(hashkey);
-	index_isnull[0] = false;
+	index_values[0] = UInt32GetDatum(_hash_combine_hashkeys(colhashes,
+															nkeyatts));
 	return true;
 }
 
@@ -3201,7 +3201,7 @@ TM_Result
 heap_update(Relation relation, const ItemPointerData *otid, HeapTuple newtup,
 			CommandId cid, uint32 options pg_attribute_unused(), Snapshot crosscheck, bool wait,
 			TM_FailureData *tmfd, LockTupleMode *lockmode,
-			TU_UpdateIndexes *update_indexes)
+			TU_UpdateIndexes *update_indexes, Bitmapset **unchanged_attrs_out)
 {
 	TM_Result	result;
 	TransactionId xid = GetCurrentTransactionId();
@@ -3349,6 +3349,8 @@ heap_update(Relation relation, const ItemPointerData *otid, HeapTuple newtup,
 		tmfd->xmax = InvalidTransactionId;
 		tmfd->cmax = InvalidCommandId;
 		*update_indexes = TU_None;
+		if (unchanged_attrs_out)
+			*unchanged_attrs_out = NULL;
 
 		bms_free(hot_attrs);
 		bms_free(sum_attrs);
@@ -3650,6 +3652,8 @@ l2:
 		if (vmbuffer != InvalidBuffer)
 			ReleaseBuffer(vmbuffer);
 		*update_indexes = TU_None;
+		if (unchanged_attrs_out)
+			*unchanged_attrs_out = NULL;
 
 		bms_free(hot_attrs);
 		bms_free(sum_attrs);
@@ -4173,8 +4177,12 @@ l2:
 	bms_free(sum_attrs);
 	bms_free(key_attrs);
 	bms_free(id_attrs);
+	if (unchanged_attrs_out)
+		*unchanged_attrs_out = bms_del_members(interesting_attrs,
+											   modified_attrs);
+	else
+		bms_free(interesting_attrs);
 	bms_free(modified_attrs);
-	bms_free(interesting_attrs);
 
 	return TM_Ok;
 }
@@ -4458,7 +4466,7 @@ simple_heap_update(Relation relation, const ItemPointerData *otid, HeapTuple tup
 						 GetCurrentCommandId(true), 0,
 						 InvalidSnapshot,
 						 true /* wait for commit */ ,
-						 &tmfd, &lockmode, update_indexes);
+						 &tmfd, &lockmode, update_indexes, NULL);
 	switch (result)
 	{
 		case TM_SelfModified:
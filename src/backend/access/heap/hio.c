@@ -697,8 +697,16 @@ loop:
 			MarkBufferDirty(buffer);
 		}
 
-		pageFreeSpace = PageGetHeapFreeSpace(page);
-		if (targetFreeSpace <= pageFreeSpace)
+		/*
+		 * With adaptive_fillfactor, the space held back for updates of the
+		 * rows already on this page is not available to other tuples, and is
+		 * not advertised in the FSM either.  An updated row from this very
+		 * page may use it, though.
+		 */
+		pageFreeSpace = HeapPageGetFSMFreeSpace(relation, buffer);
+		if (targetFreeSpace <= pageFreeSpace ||
+			(otherBuffer != InvalidBuffer && otherBlock == targetBlock &&
+			 targetFreeSpace <= PageGetHeapFreeSpace(page)))
 		{
 			/* use this page as future insert target, too */
 			RelationSetTargetBlock(relation, targetBlock);
@@ -882,3 +890,56 @@ loop:
 
 	return buffer;
 }
+
+/*
+ * HeapPageGetFSMFreeSpace - free space of a page to record in the FSM
+ *
+ * Normally this is just the page's free space.  If the relation has the
+ * adaptive_fillfactor option set, we hold some of it back from the FSM, so
+ * that inserts and updates of rows on other pages leave it for later updates
+ * of the rows on this page, which can then be HOT updates.
+ *
+ * How much to hold back is learned from the updates the page has seen: a
+ * heap-only tuple is a row version created by a HOT update, and we reserve
+ * room for one more version of each such row.  This is capped at a quarter
+ * of the page, and reduced by the space that the fillfactor already keeps
+ * free.
+ *
+ * Caller must hold at least a share lock on the buffer.
+ */
+Size
+HeapPageGetFSMFreeSpace(Relation relation, Buffer buffer)
+{
+	Page		page = BufferGetPage(buffer);
+	Size		freespace = PageGetHeapFreeSpace(page);
+	Size		reserve = 0;
+	Size		saveFreeSpace;
+	OffsetNumber offnum,
+				maxoff;
+
+	if (!RelationUsesAdaptiveFillFactor(relation) || freespace == 0)
+		return freespace;
+
+	maxoff = PageGetMaxOffsetNumber(page);
+	for (offnum = FirstOffsetNumber;
+		 offnum <= maxoff;
+		 offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+
+		if (!ItemIdIsNormal(itemid))
+			continue;
+
+		if (HeapTupleHeaderIsHeapOnly((HeapTupleHeader) PageGetItem(page, itemid)))
+			reserve += MAXALIGN(ItemIdGetLength(itemid)) + sizeof(ItemIdData);
+	}
+
+	reserve = Min(reserve, BLCKSZ / 4);
+	saveFreeSpace = RelationGetTargetPageFreeSpace(relation,
+												   HEAP_DEFAULT_FILLFACTOR);
+	if (reserve <= saveFreeSpace)
+		return freespace;
+	reserve -= saveFreeSpace;
+
+	return freespace > reserve ? freespace - reserve : 0;
+}
@@ -16,6 +16,7 @@
 
 #include "access/heapam.h"
 #include "access/heapam_xlog.h"
+#include "access/hio.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
 #include "access/transam.h"
@@ -27,6 +28,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/bufmgr.h"
+#include "storage/freespace.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 
@@ -275,6 +277,7 @@ heap_page_prune_opt(Relation relation, Buffer buffer, Buffer *vmbuffer,
 	TransactionId prune_xid;
 	GlobalVisState *vistest;
 	Size		minfree;
+	Size		freespace = 0;
 
 	/*
 	 * We can't write WAL in recovery mode, so there's no point trying to
@@ -376,16 +379,34 @@ heap_page_prune_opt(Relation relation, Buffer buffer, Buffer *vmbuffer,
 			if (presult.ndeleted > presult.nnewlpdead)
 				pgstat_update_heap_dead_tuples(relation,
 											   presult.ndeleted - presult.nnewlpdead);
+
+			if (presult.ndeleted > 0 &&
+				PageGetHeapFreeSpace(page) >= BLCKSZ / 2)
+				freespace = HeapPageGetFSMFreeSpace(relation, buffer);
 		}
 
 		/* And release buffer lock */
 		LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
 
 		/*
-		 * We avoid reuse of any free space created on the page by unrelated
-		 * UPDATEs/INSERTs by opting to not update the FSM at this point.  The
-		 * free space should be reused by UPDATEs to *this* page.
+		 * We mostly avoid reuse of any free space created on the page by
+		 * unrelated UPDATEs/INSERTs by opting to not update the FSM at this
+		 * point.  The free space should be reused by UPDATEs to *this* page.
+		 *
+		 * However, when pruning left the page more than half empty, as
+		 * happens when most of its rows were deleted or updated onto other
+		 * pages, there is more room than updates of the remaining rows are
+		 * likely to need.  Make it available right away instead of leaving
+		 * it unused until the next VACUUM, so that tables with a lot of
+		 * churn, such as queue tables, don't keep growing in between.
 		 */
+		if (freespace > 0)
+		{
+			BlockNumber blkno = BufferGetBlockNumber(buffer);
+
+			RecordPageWithFreeSpace(relation, blkno, freespace);
+			FreeSpaceMapVacuumRange(relation, blkno, blkno + 1);
+		}
 	}
 }
 
@@ -131,6 +131,7 @@
 
 #include "access/genam.h"
 #include "access/heapam.h"
+#include "access/hio.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
 #include "access/tidstore.h"
@@ -271,6 +272,8 @@ typedef struct LVRelState
 	bool		do_index_vacuuming;
 	bool		do_index_cleanup;
 	bool		do_rel_truncate;
+	/* Mark all-frozen pages to be written in compressed form? */
+	bool		compress_frozen_pages;
 
 	/* VACUUM operation's cutoffs for freezing and pruning */
 	struct VacuumCutoffs cutoffs;
@@ -440,6 +443,8 @@ static int	lazy_scan_prune(LVRelState *vacrel, Buffer buf,
 static bool lazy_scan_noprune(LVRelState *vacrel, Buffer buf,
 							  BlockNumber blkno, Page page,
 							  bool *has_lpdead_items);
+static void lazy_mark_compressible(LVRelState *vacrel, Buffer buf,
+								   Page page, bool all_frozen);
 static void lazy_vacuum(LVRelState *vacrel);
 static bool lazy_vacuum_all_indexes(LVRelState *vacrel);
 static void lazy_vacuum_heap_rel(LVRelState *vacrel);
@@ -825,6 +830,7 @@ heap_vacuum_rel(Relation rel, const VacuumParams *params,
 	}
 
 	vacrel->skipwithvm = skipwithvm;
+	vacrel->compress_frozen_pages = RelationCompressesFrozenPages(rel);
 
 	/*
 	 * Set up eager scan tracking state. This must happen after determining
@@ -1547,7 +1553,7 @@ lazy_scan_heap(LVRelState *vacrel)
 			|| !vacrel->do_index_vacuuming
 			|| !has_lpdead_items)
 		{
-			Size		freespace = PageGetHeapFreeSpace(page);
+			Size		freespace = HeapPageGetFSMFreeSpace(vacrel->rel, buf);
 
 			UnlockReleaseBuffer(buf);
 			RecordPageWithFreeSpace(vacrel->rel, blkno, freespace);
@@ -2131,9 +2137,52 @@ lazy_scan_prune(LVRelState *vacrel,
 	/* Did we find LP_DEAD items? */
 	*has_lpdead_items = (presult.lpdead_items > 0);
 
+	if (vacrel->compress_frozen_pages || PageIsCompressible(page))
+	{
+		Buffer		vmbuf = vmbuffer;
+		bool		all_frozen;
+
+		all_frozen = (visibilitymap_get_status(rel, blkno, &vmbuf) &
+					  VISIBILITYMAP_ALL_FROZEN) != 0;
+		Assert(vmbuf == vmbuffer);
+		lazy_mark_compressible(vacrel, buf, page, all_frozen);
+	}
+
 	return presult.ndeleted;
 }
 
+/*
+ *	lazy_mark_compressible() -- set or clear PD_COMPRESSIBLE on a heap page.
+ *
+ * When compress_frozen_pages is enabled, all-frozen pages are marked so that
+ * they are written to disk in compressed form (see PageCompress()); other
+ * pages lose the mark.  Whether a page is compressed on disk doesn't affect
+ * its contents once read, so the mark is set like a hint bit.
+ *
+ * Writing the compressed image rewrites the whole block, so a torn write
+ * must be recoverable from a full-page image in WAL.  MarkBufferDirtyHint()
+ * only guarantees one when hint bit changes are WAL-logged, i.e. with data
+ * checksums or wal_log_hints; otherwise pages are not marked at all.
+ *
+ * Caller must hold an exclusive lock on the buffer.
+ */
+static void
+lazy_mark_compressible(LVRelState *vacrel, Buffer buf, Page page,
+					   bool all_frozen)
+{
+	bool		compressible = vacrel->compress_frozen_pages && all_frozen &&
+		XLogHintBitIsNeeded();
+
+	if (compressible == PageIsCompressible(page))
+		return;
+
+	if (compressible)
+		PageSetCompressible(page);
+	else
+		PageClearCompressible(page);
+	MarkBufferDirtyHint(buf, true);
+}
+
 /*
  *	lazy_scan_noprune() -- lazy_scan_prune() without pruning or freezing
  *
@@ -2681,7 +2730,6 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	{
 		BlockNumber blkno;
 		Buffer		buf;
-		Page		page;
 		TidStoreIterResult *iter_result;
 		Size		freespace;
 		OffsetNumber offsets[MaxOffsetNumber];
@@ -2714,8 +2762,7 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 							  num_offsets, vmbuffer);
 
 		/* Now that we've vacuumed the page, record its available space */
-		page = BufferGetPage(buf);
-		freespace = PageGetHeapFreeSpace(page);
+		freespace = HeapPageGetFSMFreeSpace(vacrel->rel, buf);
 
 		UnlockReleaseBuffer(buf);
 		RecordPageWithFreeSpace(vacrel->rel, blkno, freespace);
@@ -2870,6 +2917,9 @@ lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno, Buffer buffer,
 			vacrel->new_all_visible_all_frozen_pages++;
 	}
 
+	lazy_mark_compressible(vacrel, buffer, page,
+						   (vmflags & VISIBILITYMAP_ALL_FROZEN) != 0);
+
 	/* Revert to the previous phase information for error traceback */
 	restore_vacuum_error_info(vacrel, &saved_err_info);
 }
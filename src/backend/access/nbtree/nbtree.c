@@ -36,6 +36,7 @@
 #include "utils/fmgrprotos.h"
 #include "utils/index_selfuncs.h"
 #include "utils/memutils.h"
+#include "utils/spccache.h"
 #include "utils/wait_event.h"
 
 
@@ -95,6 +96,7 @@ typedef struct BTParallelScanDescData
 typedef struct BTParallelScanDescData *BTParallelScanDesc;
 
 
+static void _bt_prefetch_heap(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_start_prim_scan(IndexScanDesc scan);
 static void _bt_parallel_serialize_arrays(Relation rel, BTParallelScanDesc btscan,
 										  BTScanOpaque so);
@@ -223,6 +225,52 @@ btinsert(Relation rel, Datum *values, bool *isnull,
 	return result;
 }
 
+/*
+ * _bt_prefetch_heap() -- Prefetch heap blocks for upcoming items.
+ *
+ * Called by btgettuple after it has positioned the scan on a new item.
+ * Issues prefetch requests for the heap blocks referenced by the next
+ * prefetchMaximum items on the current leaf page (in the scan direction),
+ * picking up where the previous call left off.  Consecutive items pointing
+ * to the same heap block only get one request.  We never look beyond the
+ * current leaf page, since its items are all we have in hand.
+ */
+static void
+_bt_prefetch_heap(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTScanPos	pos = &so->currPos;
+	int			step = ScanDirectionIsForward(dir) ? 1 : -1;
+	int			stop;
+
+	/* Start over whenever the scan moves to another page or direction */
+	if (so->prefetchPage != pos->currPage || so->prefetchDir != dir)
+	{
+		so->prefetchPage = pos->currPage;
+		so->prefetchDir = dir;
+		so->prefetchItem = pos->itemIndex + step;
+		so->prefetchBlock =
+			ItemPointerGetBlockNumber(&pos->items[pos->itemIndex].heapTid);
+	}
+
+	if (ScanDirectionIsForward(dir))
+		stop = Min(pos->itemIndex + so->prefetchMaximum, pos->lastItem);
+	else
+		stop = Max(pos->itemIndex - so->prefetchMaximum, pos->firstItem);
+
+	for (; so->prefetchItem * step <= stop * step; so->prefetchItem += step)
+	{
+		BlockNumber blkno;
+
+		blkno = ItemPointerGetBlockNumber(&pos->items[so->prefetchItem].heapTid);
+		if (blkno != so->prefetchBlock)
+		{
+			PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+			so->prefetchBlock = blkno;
+		}
+	}
+}
+
 /*
  *	btgettuple() -- Get the next tuple in the scan.
  */
@@ -277,7 +325,11 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 
 		/* If we have a tuple, return it ... */
 		if (res)
+		{
+			if (so->prefetchMaximum > 0)
+				_bt_prefetch_heap(scan, dir);
 			break;
+		}
 		/* ... otherwise see if we need another primitive index scan */
 	} while (so->numArrayKeys && _bt_start_prim_scan(scan));
 
@@ -420,6 +472,21 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 				   IsMVCCLikeSnapshot(scan->xs_snapshot) &&
 				   scan->heapRelation != NULL);
 
+	/*
+	 * Plain index scans prefetch the heap blocks of upcoming items on the
+	 * current leaf page, so that the heap fetches that follow each
+	 * btgettuple call don't all have to wait for synchronous reads.  There
+	 * is no point in doing so during index-only scans, which mostly avoid
+	 * heap access altogether.
+	 */
+	so->prefetchMaximum = 0;
+#ifdef USE_PREFETCH
+	if (!scan->xs_want_itup && scan->heapRelation != NULL)
+		so->prefetchMaximum =
+			get_tablespace_io_concurrency(scan->heapRelation->rd_rel->reltablespace);
+#endif
+	so->prefetchPage = InvalidBlockNumber;
+
 	so->markItemIndex = -1;
 	so->needPrimScan = false;
 	so->scanBehind = false;
@@ -17,7 +17,9 @@
 #include "access/detoast.h"
 #include "access/toast_helper.h"
 #include "access/toast_internals.h"
+#include "catalog/catalog.h"
 #include "catalog/pg_type_d.h"
+#include "utils/attoptcache.h"
 #include "varatt.h"
 
 
@@ -229,8 +231,31 @@ toast_tuple_try_compression(ToastTupleContext *ttc, int attribute)
 	Datum	   *value = &ttc->ttc_values[attribute];
 	Datum		new_value;
 	ToastAttrInfo *attr = &ttc->ttc_attr[attribute];
+	char		cmethod = attr->tai_compression;
+	int			cmlevel = 0;
 
-	new_value = toast_compress_datum(*value, attr->tai_compression);
+	/*
+	 * zstd takes its compression level from the column's compression_level
+	 * option.  Only look that up when it can matter, and never for system
+	 * catalogs, which may be toasted before the attribute option cache is
+	 * usable.
+	 */
+	if (!CompressionMethodIsValid(cmethod))
+		cmethod = default_toast_compression;
+	if (cmethod == TOAST_ZSTD_COMPRESSION && !IsCatalogRelation(ttc->ttc_rel))
+	{
+		AttributeOpts *aopt;
+
+		aopt = get_attribute_options(RelationGetRelid(ttc->ttc_rel),
+									 attribute + 1);
+		if (aopt != NULL)
+		{
+			cmlevel = aopt->compression_level;
+			pfree(aopt);
+		}
+	}
+
+	new_value = toast_compress_datum(*value, cmethod, cmlevel);
 
 	if (DatumGetPointer(new_value) != NULL)
 	{
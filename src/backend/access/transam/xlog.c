@@ -85,6 +85,7 @@
 #include "replication/snapbuild.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
+#include "storage/aio.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
@@ -129,6 +130,7 @@ bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
 int			wal_compression = WAL_COMPRESSION_NONE;
+int			wal_record_compression = WAL_COMPRESSION_NONE;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		wal_init_zero = true;
@@ -142,6 +144,7 @@ int			wal_retrieve_retry_interval = 5000;
 int			max_slot_wal_keep_size_mb = -1;
 int			wal_decode_buffer_size = 512 * 1024;
 bool		track_wal_io_timing = false;
+int			wal_io_concurrency = 0;
 
 #ifdef WAL_DEBUG
 bool		XLOG_DEBUG = false;
@@ -656,6 +659,37 @@ static int	openLogFile = -1;
 static XLogSegNo openLogSegNo = 0;
 static TimeLineID openLogTLI = 0;
 
+/*
+ * Writes to openLogFile that XLogWrite() has started through the AIO
+ * subsystem, when wal_io_concurrency > 0, and not yet waited for.  They form
+ * a FIFO queue in walWriteIOs[], the oldest one at walWriteIOsHead.
+ * XLogWrite() completes all of them before it fsyncs or closes the segment,
+ * and before it returns, so none are ever in flight while WALWriteLock is not
+ * held.
+ */
+typedef struct XLogWriteIO
+{
+	PgAioWaitRef wref;
+	PgAioReturn ret;
+	char	   *from;
+	Size		nbytes;
+	uint32		startoffset;
+} XLogWriteIO;
+
+static XLogWriteIO walWriteIOs[MAX_WAL_IO_CONCURRENCY];
+static int	walWriteIOsHead = 0;
+static int	walWriteIOsCount = 0;
+
+/*
+ * aioLogFile is the FD an IO worker uses to execute WAL writes started by
+ * other processes, and aioLogSegNo, aioLogTLI and aioLogFlags identify the
+ * segment and the sync bits it was opened with.
+ */
+static int	aioLogFile = -1;
+static XLogSegNo aioLogSegNo = 0;
+static TimeLineID aioLogTLI = 0;
+static int	aioLogFlags = 0;
+
 /*
  * Local copies of equivalent fields in the control file.  When running
  * crash recovery, LocalMinRecoveryPoint is set to InvalidXLogRecPtr as we
@@ -706,6 +740,13 @@ static void KeepLogSeg(XLogRecPtr recptr, XLogSegNo *logSegNo);
 static void AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli,
 								  bool opportunistic);
 static void XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible);
+static void XLogWritePages(char *from, Size nbytes, uint32 startoffset,
+						   TimeLineID tli);
+static void XLogStartWritePages(char *from, Size nbytes, uint32 startoffset,
+								TimeLineID tli);
+static void XLogWaitWriteIO(TimeLineID tli);
+static void XLogWaitAllWriteIOs(TimeLineID tli);
+static void XLogFlushGroup(XLogRecPtr upto, TimeLineID tli);
 static bool InstallXLogFileSegment(XLogSegNo *segno, char *tmppath,
 								   bool find_free, XLogSegNo max_segno,
 								   TimeLineID tli);
@@ -1068,7 +1109,7 @@ XLogInsertRecord(XLogRecData *rdata,
 		/* We also need temporary space to decode the record. */
 		record = (XLogRecord *) recordBuf.data;
 		decoded = (DecodedXLogRecord *)
-			palloc(DecodeXLogRecordRequiredSpace(record->xl_tot_len));
+			palloc(DecodeXLogRecordRequiredSpace(XLogRecordRawLength(record)));
 
 		if (!debug_reader)
 			debug_reader = XLogReaderAllocate(wal_segment_size, NULL,
@@ -2383,9 +2424,11 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 		{
 			/*
 			 * Switch to new logfile segment.  We cannot have any pending
-			 * pages here (since we dump what we have at segment end).
+			 * pages or writes in progress here (since we dump what we have
+			 * at segment end).
 			 */
 			Assert(npages == 0);
+			Assert(walWriteIOsCount == 0);
 			if (openLogFile >= 0)
 				XLogFileClose();
 			XLByteToPrevSeg(LogwrtResult.Write, openLogSegNo,
@@ -2434,51 +2477,14 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 		{
 			char	   *from;
 			Size		nbytes;
-			Size		nleft;
-			ssize_t		written;
-			instr_time	start;
 
 			/* OK to write the page(s) */
 			from = XLogCtl->pages + startidx * (Size) XLOG_BLCKSZ;
 			nbytes = npages * (Size) XLOG_BLCKSZ;
-			nleft = nbytes;
-			do
-			{
-				errno = 0;
-
-				/*
-				 * Measure I/O timing to write WAL data, for pg_stat_io.
-				 */
-				start = pgstat_prepare_io_time(track_wal_io_timing);
-
-				pgstat_report_wait_start(WAIT_EVENT_WAL_WRITE);
-				written = pg_pwrite(openLogFile, from, nleft, startoffset);
-				pgstat_report_wait_end();
-
-				pgstat_count_io_op_time(IOOBJECT_WAL, IOCONTEXT_NORMAL,
-										IOOP_WRITE, start, 1, written);
-
-				if (written <= 0)
-				{
-					char		xlogfname[MAXFNAMELEN];
-					int			save_errno;
-
-					if (errno == EINTR)
-						continue;
-
-					save_errno = errno;
-					XLogFileName(xlogfname, tli, openLogSegNo,
-								 wal_segment_size);
-					errno = save_errno;
-					ereport(PANIC,
-							(errcode_for_file_access(),
-							 errmsg("could not write to log file \"%s\" at offset %u, length %zu: %m",
-									xlogfname, startoffset, nleft)));
-				}
-				nleft -= written;
-				from += written;
-				startoffset += written;
-			} while (nleft > 0);
+			if (wal_io_concurrency > 0)
+				XLogStartWritePages(from, nbytes, startoffset, tli);
+			else
+				XLogWritePages(from, nbytes, startoffset, tli);
 
 			npages = 0;
 
@@ -2497,6 +2503,7 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 			 */
 			if (finishing_seg)
 			{
+				XLogWaitAllWriteIOs(tli);
 				issue_xlog_fsync(openLogFile, openLogSegNo, tli);
 
 				/* signal that we need to wakeup walsenders later */
@@ -2541,6 +2548,12 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 
 	Assert(npages == 0);
 
+	/*
+	 * Writes still in progress must complete before we can flush them, or
+	 * advertise them as written.
+	 */
+	XLogWaitAllWriteIOs(tli);
+
 	/*
 	 * If asked to flush, do so
 	 */
@@ -2621,6 +2634,296 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 #endif
 }
 
+/*
+ * Write 'nbytes' of WAL at 'from' to the open log file at 'startoffset',
+ * waiting for the write to finish.
+ */
+static void
+XLogWritePages(char *from, Size nbytes, uint32 startoffset, TimeLineID tli)
+{
+	Size		nleft = nbytes;
+	ssize_t		written;
+	instr_time	start;
+
+	do
+	{
+		errno = 0;
+
+		/*
+		 * Measure I/O timing to write WAL data, for pg_stat_io.
+		 */
+		start = pgstat_prepare_io_time(track_wal_io_timing);
+
+		pgstat_report_wait_start(WAIT_EVENT_WAL_WRITE);
+		written = pg_pwrite(openLogFile, from, nleft, startoffset);
+		pgstat_report_wait_end();
+
+		pgstat_count_io_op_time(IOOBJECT_WAL, IOCONTEXT_NORMAL,
+								IOOP_WRITE, start, 1, written);
+
+		if (written <= 0)
+		{
+			char		xlogfname[MAXFNAMELEN];
+			int			save_errno;
+
+			if (errno == EINTR)
+				continue;
+
+			save_errno = errno;
+			XLogFileName(xlogfname, tli, openLogSegNo, wal_segment_size);
+			errno = save_errno;
+			ereport(PANIC,
+					(errcode_for_file_access(),
+					 errmsg("could not write to log file \"%s\" at offset %u, length %zu: %m",
+							xlogfname, startoffset, nleft)));
+		}
+		nleft -= written;
+		from += written;
+		startoffset += written;
+	} while (nleft > 0);
+}
+
+/*
+ * Like XLogWritePages(), but start the write through the AIO subsystem and
+ * return without waiting for it.
+ *
+ * The write is split into IOs of at most io_combine_limit blocks, so that
+ * even a single large batch of pages keeps several IOs in flight.  Once
+ * wal_io_concurrency IOs are in flight, we wait for the oldest one to finish
+ * before starting another.
+ */
+static void
+XLogStartWritePages(char *from, Size nbytes, uint32 startoffset,
+					TimeLineID tli)
+{
+	Size		maxbytes = (Size) io_combine_limit * BLCKSZ;
+	int			open_flags = get_sync_bit(wal_sync_method);
+
+	while (nbytes > 0)
+	{
+		XLogWriteIO *io;
+		PgAioHandle *ioh;
+		PgAioTargetData *td;
+		struct iovec *iov;
+		Size		len = Min(nbytes, maxbytes);
+
+		if (walWriteIOsCount >= wal_io_concurrency)
+			XLogWaitWriteIO(tli);
+
+		io = &walWriteIOs[(walWriteIOsHead + walWriteIOsCount) %
+						  MAX_WAL_IO_CONCURRENCY];
+		io->from = from;
+		io->nbytes = len;
+		io->startoffset = startoffset;
+
+		ioh = pgaio_io_acquire(NULL, &io->ret);
+
+		pgaio_io_set_target(ioh, PGAIO_TID_WAL);
+		td = pgaio_io_get_target_data(ioh);
+		td->wal.segno = openLogSegNo;
+		td->wal.tli = tli;
+		td->wal.offset = startoffset;
+		td->wal.nbytes = len;
+		td->wal.open_flags = open_flags;
+
+		pgaio_io_register_callbacks(ioh, PGAIO_HCB_WAL_WRITEV, 0);
+		pgaio_io_get_wref(ioh, &io->wref);
+
+		pgaio_io_get_iovec(ioh, &iov);
+		iov[0].iov_base = from;
+		iov[0].iov_len = len;
+		pgaio_io_start_writev(ioh, openLogFile, 1, startoffset);
+
+		walWriteIOsCount++;
+
+		from += len;
+		startoffset += len;
+		nbytes -= len;
+	}
+}
+
+/*
+ * Wait for the oldest WAL write started by XLogStartWritePages().
+ *
+ * A short write is completed synchronously, like XLogWritePages() does, and
+ * a failed write is a PANIC, just like in XLogWritePages().
+ */
+static void
+XLogWaitWriteIO(TimeLineID tli)
+{
+	XLogWriteIO *io = &walWriteIOs[walWriteIOsHead];
+	PgAioResult result;
+	instr_time	start;
+
+	Assert(walWriteIOsCount > 0);
+
+	start = pgstat_prepare_io_time(track_wal_io_timing);
+	pgaio_wref_wait(&io->wref);
+
+	walWriteIOsHead = (walWriteIOsHead + 1) % MAX_WAL_IO_CONCURRENCY;
+	walWriteIOsCount--;
+
+	result = io->ret.result;
+	switch (result.status)
+	{
+		case PGAIO_RS_OK:
+			pgstat_count_io_op_time(IOOBJECT_WAL, IOCONTEXT_NORMAL,
+									IOOP_WRITE, start, 1, io->nbytes);
+			break;
+		case PGAIO_RS_PARTIAL:
+			pgstat_count_io_op_time(IOOBJECT_WAL, IOCONTEXT_NORMAL,
+									IOOP_WRITE, start, 1, result.result);
+			XLogWritePages(io->from + result.result,
+						   io->nbytes - result.result,
+						   io->startoffset + result.result, tli);
+			break;
+		default:
+			pgaio_result_report(result, &io->ret.target_data, PANIC);
+			pg_unreachable();
+	}
+}
+
+/*
+ * Wait for all WAL writes started by XLogStartWritePages().
+ */
+static void
+XLogWaitAllWriteIOs(TimeLineID tli)
+{
+	while (walWriteIOsCount > 0)
+		XLogWaitWriteIO(tli);
+}
+
+/*
+ * Callback for the WAL AIO target, to reopen the segment in an IO worker.
+ *
+ * IO workers execute the writes of all backends, which mostly go to the
+ * same segment, so we keep the most recently used one open.
+ */
+static void
+XLogAioReopen(PgAioHandle *ioh)
+{
+	PgAioTargetData *td = pgaio_io_get_target_data(ioh);
+	PgAioOpData *od = pgaio_io_get_op_data(ioh);
+
+	Assert(pgaio_io_get_op(ioh) == PGAIO_OP_WRITEV);
+
+	if (aioLogFile < 0 ||
+		aioLogSegNo != td->wal.segno ||
+		aioLogTLI != td->wal.tli ||
+		aioLogFlags != td->wal.open_flags)
+	{
+		char		path[MAXPGPATH];
+
+		if (aioLogFile >= 0)
+		{
+			close(aioLogFile);
+			aioLogFile = -1;
+			ReleaseExternalFD();
+		}
+
+		XLogFilePath(path, td->wal.tli, td->wal.segno, wal_segment_size);
+		aioLogFile = BasicOpenFile(path, O_RDWR | PG_BINARY | O_CLOEXEC |
+								   td->wal.open_flags);
+		if (aioLogFile < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", path)));
+		ReserveExternalFD();
+
+		aioLogSegNo = td->wal.segno;
+		aioLogTLI = td->wal.tli;
+		aioLogFlags = td->wal.open_flags;
+	}
+
+	od->write.fd = aioLogFile;
+	Assert(od->write.offset == td->wal.offset);
+}
+
+/*
+ * Callback for the WAL AIO target, describing the target of the IO.
+ */
+static char *
+XLogAioDescribeIdentity(const PgAioTargetData *td)
+{
+	char		xlogfname[MAXFNAMELEN];
+
+	XLogFileName(xlogfname, td->wal.tli, td->wal.segno, wal_segment_size);
+
+	return psprintf(_("offset %u in log file \"%s\""),
+					td->wal.offset, xlogfname);
+}
+
+/*
+ * AIO completion callback for XLogStartWritePages().
+ */
+static PgAioResult
+XLogAioWritevComplete(PgAioHandle *ioh, PgAioResult prior_result,
+					  uint8 cb_data)
+{
+	PgAioTargetData *td = pgaio_io_get_target_data(ioh);
+	PgAioResult result = prior_result;
+
+	if (prior_result.result <= 0)
+	{
+		/* track the error number, if any, in error_data */
+		result.status = PGAIO_RS_ERROR;
+		result.id = PGAIO_HCB_WAL_WRITEV;
+		result.error_data = prior_result.result < 0 ? -prior_result.result : 0;
+		result.result = 0;
+
+		return result;
+	}
+
+	if (result.status != PGAIO_RS_ERROR &&
+		result.result < td->wal.nbytes)
+	{
+		/* short writes are retried by XLogWaitWriteIO() */
+		result.status = PGAIO_RS_PARTIAL;
+		result.id = PGAIO_HCB_WAL_WRITEV;
+	}
+
+	return result;
+}
+
+/*
+ * AIO error reporting callback for XLogStartWritePages().
+ */
+static void
+XLogAioWritevReport(PgAioResult result, const PgAioTargetData *td,
+					int elevel)
+{
+	char		xlogfname[MAXFNAMELEN];
+
+	XLogFileName(xlogfname, td->wal.tli, td->wal.segno, wal_segment_size);
+
+	if (result.error_data != 0)
+	{
+		/* for errcode_for_file_access() and %m */
+		errno = result.error_data;
+
+		ereport(elevel,
+				(errcode_for_file_access(),
+				 errmsg("could not write to log file \"%s\" at offset %u, length %u: %m",
+						xlogfname, td->wal.offset, td->wal.nbytes)));
+	}
+	else
+		ereport(elevel,
+				(errcode(ERRCODE_IO_ERROR),
+				 errmsg("could not write to log file \"%s\" at offset %u, length %u: no data written",
+						xlogfname, td->wal.offset, td->wal.nbytes)));
+}
+
+const PgAioTargetInfo aio_wal_target_info = {
+	.name = "wal",
+	.reopen = XLogAioReopen,
+	.describe_identity = XLogAioDescribeIdentity,
+};
+
+const PgAioHandleCallbacks aio_wal_writev_cb = {
+	.complete_shared = XLogAioWritevComplete,
+	.report = XLogAioWritevReport,
+};
+
 /*
  * Record the LSN for an asynchronous transaction commit/abort
  * and nudge the WALWriter if there is work for it to do.
@@ -2733,9 +3036,12 @@ UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force)
 	 * process as it should not update its own reference of minRecoveryPoint
 	 * until it has finished crash recovery to make sure that all WAL
 	 * available is replayed in this case.  This also saves from extra locks
-	 * taken on the control file from the startup process.
+	 * taken on the control file from the startup process.  WAL redo workers
+	 * are InRecovery too, but they never initialize their local copy, so
+	 * they must read the control file's value below.
 	 */
-	if (!XLogRecPtrIsValid(LocalMinRecoveryPoint) && InRecovery)
+	if (!XLogRecPtrIsValid(LocalMinRecoveryPoint) && InRecovery &&
+		AmStartupProcess())
 	{
 		updateMinRecoveryPoint = false;
 		return;
@@ -2866,20 +3172,25 @@ XLogFlush(XLogRecPtr record)
 		insertpos = WaitXLogInsertionsToFinish(WriteRqstPtr);
 
 		/*
-		 * Try to get the write lock. If we can't get it immediately, wait
-		 * until it's released, and recheck if we still need to do the flush
-		 * or if the backend that held the lock did it for us already. This
-		 * helps to maintain a good rate of group committing when the system
-		 * is bottlenecked by the speed of fsyncing.
+		 * Try to get the write lock. If we can't get it immediately, somebody
+		 * else is writing or flushing WAL right now.  Rather than queueing up
+		 * on the lock and having every waiter recheck the flush position one
+		 * by one when it is released, join the group of processes waiting for
+		 * the next flush, whose leader will flush for all of them at once.
+		 * This helps to maintain a good rate of group committing when the
+		 * system is bottlenecked by the speed of fsyncing.
 		 */
-		if (!LWLockAcquireOrWait(WALWriteLock, LW_EXCLUSIVE))
+		if (!LWLockConditionalAcquire(WALWriteLock, LW_EXCLUSIVE))
 		{
+			XLogFlushGroup(insertpos, insertTLI);
+
 			/*
-			 * The lock is now free, but we didn't acquire it yet. Before we
-			 * do, loop back to check if someone else flushed the record for
-			 * us already.
+			 * The group's flush covered everything up to insertpos, which is
+			 * at least our request, unless the request is past the end of WAL
+			 * (see below).
 			 */
-			continue;
+			RefreshXLogWriteResult(LogwrtResult);
+			break;
 		}
 
 		/* Got the lock; recheck whether request is satisfied */
@@ -2976,6 +3287,161 @@ XLogFlush(XLogRecPtr record)
 	Assert(!XLogNeedsFlush(record));
 }
 
+/*
+ * Flush WAL up to 'upto' as a member of a group of processes that all need
+ * WAL flushed.
+ *
+ * When WALWriteLock is busy, processes that need WAL flushed add themselves
+ * to a list in shared memory.  The first one to add itself becomes the
+ * leader: it waits for WALWriteLock and, once it has it, takes the whole list
+ * and writes and flushes WAL far enough to satisfy every member with a single
+ * XLogWrite() call, while the followers sleep on their semaphores.  Processes
+ * arriving while the leader is flushing start a new group, whose leader waits
+ * for the lock in turn.  This is the same scheme as ProcArrayGroupClearXid()
+ * and TransactionGroupUpdateXidStatus() use.
+ *
+ * 'upto' must be a position up to which all WAL insertions are known to have
+ * finished, as returned by WaitXLogInsertionsToFinish().  That way the leader
+ * never needs to wait for insertions while holding WALWriteLock.
+ *
+ * Must be called in a critical section.
+ */
+static void
+XLogFlushGroup(XLogRecPtr upto, TimeLineID tli)
+{
+	PROC_HDR   *procglobal = ProcGlobal;
+	uint32		nextidx;
+	uint32		wakeidx;
+	XLogRecPtr	flushpos;
+
+	Assert(CritSectionCount > 0);
+
+	/* Add ourselves to the list of processes needing a WAL flush. */
+	MyProc->walFlushGroupMember = true;
+	MyProc->walFlushGroupMemberLsn = upto;
+	nextidx = pg_atomic_read_u32(&procglobal->walFlushGroupFirst);
+	while (true)
+	{
+		pg_atomic_write_u32(&MyProc->walFlushGroupNext, nextidx);
+
+		if (pg_atomic_compare_exchange_u32(&procglobal->walFlushGroupFirst,
+										   &nextidx,
+										   (uint32) MyProcNumber))
+			break;
+	}
+
+	/*
+	 * If the list was not empty, the leader will flush WAL for us.  It is
+	 * impossible to have followers without a leader because the first process
+	 * that has added itself to the list will always have nextidx as
+	 * INVALID_PROC_NUMBER.
+	 */
+	if (nextidx != INVALID_PROC_NUMBER)
+	{
+		int			extraWaits = 0;
+
+		/* Sleep until the leader has flushed WAL for us. */
+		pgstat_report_wait_start(WAIT_EVENT_WAL_FLUSH_GROUP_UPDATE);
+		for (;;)
+		{
+			/* acts as a read barrier */
+			PGSemaphoreLock(MyProc->sem);
+			if (!MyProc->walFlushGroupMember)
+				break;
+			extraWaits++;
+		}
+		pgstat_report_wait_end();
+
+		Assert(pg_atomic_read_u32(&MyProc->walFlushGroupNext) == INVALID_PROC_NUMBER);
+
+		/* Fix semaphore count for any absorbed wakeups */
+		while (extraWaits-- > 0)
+			PGSemaphoreUnlock(MyProc->sem);
+		return;
+	}
+
+	/* We are the leader.  Acquire the lock on behalf of everyone. */
+	LWLockAcquire(WALWriteLock, LW_EXCLUSIVE);
+
+	/*
+	 * Sleep before closing the group, to give further processes the
+	 * opportunity to join it, the same way as XLogFlush() does.
+	 */
+	if (CommitDelay > 0 && enableFsync &&
+		MinimumActiveBackends(CommitSiblings))
+	{
+		pgstat_report_wait_start(WAIT_EVENT_COMMIT_DELAY);
+		pg_usleep(CommitDelay);
+		pgstat_report_wait_end();
+	}
+
+	/*
+	 * Now that we've got the lock, clear the list of processes waiting for
+	 * group WAL flush, saving a pointer to the head of the list.  Trying to
+	 * pop elements one at a time could lead to an ABA problem.
+	 */
+	nextidx = pg_atomic_exchange_u32(&procglobal->walFlushGroupFirst,
+									 INVALID_PROC_NUMBER);
+
+	/* Remember head of list so we can perform wakeups after dropping lock. */
+	wakeidx = nextidx;
+
+	/* Find the furthest position any member needs flushed. */
+	flushpos = upto;
+	while (nextidx != INVALID_PROC_NUMBER)
+	{
+		PGPROC	   *nextproc = GetPGProcByNumber(nextidx);
+
+		if (flushpos < nextproc->walFlushGroupMemberLsn)
+			flushpos = nextproc->walFlushGroupMemberLsn;
+
+		/* Move to next proc in list. */
+		nextidx = pg_atomic_read_u32(&nextproc->walFlushGroupNext);
+	}
+
+	/*
+	 * All insertions up to flushpos are known to have finished, so it's safe
+	 * to write that far without waiting for anyone.  Like XLogFlush(), try to
+	 * write and flush any later additions to WAL as well; this doesn't wait
+	 * either, see the comments there.
+	 */
+	flushpos = WaitXLogInsertionsToFinish(flushpos);
+
+	RefreshXLogWriteResult(LogwrtResult);
+	if (LogwrtResult.Flush < flushpos)
+	{
+		XLogwrtRqst WriteRqst;
+
+		WriteRqst.Write = flushpos;
+		WriteRqst.Flush = flushpos;
+		XLogWrite(WriteRqst, tli, false);
+	}
+
+	/* We're done with the lock now. */
+	LWLockRelease(WALWriteLock);
+
+	/*
+	 * Now that we've released the lock, go back and wake everybody up.  We
+	 * don't do this under the lock so as to keep lock hold times to a
+	 * minimum.
+	 */
+	while (wakeidx != INVALID_PROC_NUMBER)
+	{
+		PGPROC	   *nextproc = GetPGProcByNumber(wakeidx);
+
+		wakeidx = pg_atomic_read_u32(&nextproc->walFlushGroupNext);
+		pg_atomic_write_u32(&nextproc->walFlushGroupNext, INVALID_PROC_NUMBER);
+
+		/* ensure all previous writes are visible before follower continues. */
+		pg_write_barrier();
+
+		nextproc->walFlushGroupMember = false;
+
+		if (nextproc != MyProc)
+			PGSemaphoreUnlock(nextproc->sem);
+	}
+}
+
 /*
  * Write & flush xlog, but without specifying exactly where to.
  *
@@ -3180,8 +3646,10 @@ XLogNeedsFlush(XLogRecPtr record)
 		 * here too.  This triggers a quick exit path for the startup process,
 		 * which cannot update its local copy of minRecoveryPoint as long as
 		 * it has not replayed all WAL available when doing crash recovery.
+		 * As in UpdateMinRecoveryPoint(), WAL redo workers don't take it.
 		 */
-		if (!XLogRecPtrIsValid(LocalMinRecoveryPoint) && InRecovery)
+		if (!XLogRecPtrIsValid(LocalMinRecoveryPoint) && InRecovery &&
+			AmStartupProcess())
 		{
 			updateMinRecoveryPoint = false;
 			return false;
@@ -64,6 +64,34 @@
 /* Buffer size required to store a compressed version of backup block image */
 #define COMPRESS_BUFSIZE	Max(Max(PGLZ_MAX_BLCKSZ, LZ4_MAX_BLCKSZ), ZSTD_MAX_BLCKSZ)
 
+/*
+ * Range of record data lengths (not counting the XLogRecord header) that
+ * wal_record_compression is applied to.  Smaller records don't have enough
+ * redundancy to gain anything, and the upper limit bounds the size of the
+ * buffers we need to preallocate.  Bulk records larger than that are mostly
+ * full-page images anyway, which are handled by wal_compression.
+ */
+#define RECORD_COMPRESS_MIN_LEN		128
+#define RECORD_COMPRESS_MAX_LEN		(2 * BLCKSZ)
+
+#ifdef USE_LZ4
+#define	LZ4_MAX_RECORD_LEN		LZ4_COMPRESSBOUND(RECORD_COMPRESS_MAX_LEN)
+#else
+#define LZ4_MAX_RECORD_LEN		0
+#endif
+
+#ifdef USE_ZSTD
+#define ZSTD_MAX_RECORD_LEN		ZSTD_COMPRESSBOUND(RECORD_COMPRESS_MAX_LEN)
+#else
+#define ZSTD_MAX_RECORD_LEN		0
+#endif
+
+#define PGLZ_MAX_RECORD_LEN		PGLZ_MAX_OUTPUT(RECORD_COMPRESS_MAX_LEN)
+
+/* Buffer size required to store a compressed version of record data */
+#define RECORD_COMPRESS_BUFSIZE \
+	Max(Max(PGLZ_MAX_RECORD_LEN, LZ4_MAX_RECORD_LEN), ZSTD_MAX_RECORD_LEN)
+
 /*
  * For each block reference registered with XLogRegisterBuffer, we fill in
  * a registered_buffer struct.
@@ -125,6 +153,17 @@ static char *hdr_scratch = NULL;
 	 SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin + \
 	 SizeOfXLogTransactionId)
 
+/*
+ * Working space for wal_record_compression: the record data is flattened
+ * into 'record_raw_buf' and compressed into 'record_compressed_buf', which
+ * 'record_compressed_rdt' then points to.  Like the other working areas,
+ * these are allocated at initialization because records are assembled in
+ * critical sections.
+ */
+static char *record_raw_buf = NULL;
+static char *record_compressed_buf = NULL;
+static XLogRecData record_compressed_rdt;
+
 /*
  * An array of XLogRecData structs, to hold registered data.
  */
@@ -137,6 +176,7 @@ static bool begininsert_called = false;
 /* Memory context to hold the registered buffer and data references. */
 static MemoryContext xloginsert_cxt;
 
+static uint64 XLogCompressRecord(uint64 total_len, uint8 *info);
 static XLogRecData *XLogRecordAssemble(RmgrId rmid, uint8 info,
 									   XLogRecPtr RedoRecPtr, bool doPageWrites,
 									   XLogRecPtr *fpw_lsn, int *num_fpi,
@@ -969,6 +1009,17 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	hdr_rdt.len = (scratch - hdr_scratch);
 	total_len += hdr_rdt.len;
 
+	/*
+	 * Compress the record data as a whole, if requested.  Records carrying
+	 * full-page images are left alone: the images are either compressed
+	 * already by wal_compression, or are deliberately not compressed.
+	 */
+	if ((WalCompression) wal_record_compression != WAL_COMPRESSION_NONE &&
+		*num_fpi == 0 &&
+		total_len - SizeOfXLogRecord >= RECORD_COMPRESS_MIN_LEN &&
+		total_len - SizeOfXLogRecord <= RECORD_COMPRESS_MAX_LEN)
+		total_len = XLogCompressRecord(total_len, &info);
+
 	/*
 	 * Calculate CRC of the data
 	 *
@@ -1010,6 +1061,101 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	return &hdr_rdt;
 }
 
+/*
+ * Replace the data of the record being assembled with a compressed version
+ * of it.
+ *
+ * On entry, hdr_rdt holds the XLogRecord header and the fragment headers,
+ * and the rest of the record data is chained after it.  If compression
+ * shrinks the data, hdr_rdt is changed to hold the XLogRecord header and an
+ * XLogRecordCompressHeader followed by the compressed data, XLR_COMPRESSED is
+ * added to *info and the new total length is returned.  Otherwise the record
+ * is left untouched and 'total_len' is returned as is.
+ *
+ * The rdata chains themselves are not modified, so this can be repeated if
+ * the record needs to be assembled again.
+ */
+static uint64
+XLogCompressRecord(uint64 total_len, uint8 *info)
+{
+	uint32		raw_len = (uint32) (total_len - SizeOfXLogRecord);
+	int32		len = -1;
+	uint8		method = 0;
+	char	   *ptr;
+	XLogRecData *rdt;
+
+	Assert(raw_len <= RECORD_COMPRESS_MAX_LEN);
+
+	/* Collect the data into one contiguous chunk */
+	ptr = record_raw_buf;
+	memcpy(ptr, hdr_scratch + SizeOfXLogRecord,
+		   hdr_rdt.len - SizeOfXLogRecord);
+	ptr += hdr_rdt.len - SizeOfXLogRecord;
+	for (rdt = hdr_rdt.next; rdt != NULL; rdt = rdt->next)
+	{
+		memcpy(ptr, rdt->data, rdt->len);
+		ptr += rdt->len;
+	}
+	Assert(ptr - record_raw_buf == raw_len);
+
+	switch ((WalCompression) wal_record_compression)
+	{
+		case WAL_COMPRESSION_PGLZ:
+			method = XLR_COMPRESS_PGLZ;
+			len = pglz_compress(record_raw_buf, raw_len, record_compressed_buf,
+								PGLZ_strategy_default);
+			break;
+
+		case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			method = XLR_COMPRESS_LZ4;
+			len = LZ4_compress_default(record_raw_buf, record_compressed_buf,
+									   raw_len, RECORD_COMPRESS_BUFSIZE);
+			if (len <= 0)
+				len = -1;		/* failure */
+#else
+			elog(ERROR, "LZ4 is not supported by this build");
+#endif
+			break;
+
+		case WAL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			method = XLR_COMPRESS_ZSTD;
+			len = ZSTD_compress(record_compressed_buf, RECORD_COMPRESS_BUFSIZE,
+								record_raw_buf, raw_len, ZSTD_CLEVEL_DEFAULT);
+			if (ZSTD_isError(len))
+				len = -1;		/* failure */
+#else
+			elog(ERROR, "zstd is not supported by this build");
+#endif
+			break;
+
+		case WAL_COMPRESSION_NONE:
+			Assert(false);		/* cannot happen */
+			break;
+			/* no default case, so that compiler will warn */
+	}
+
+	/* Not worth it unless we save more than the extra header costs */
+	if (len < 0 || len + SizeOfXLogRecordCompressHeader >= raw_len)
+		return total_len;
+
+	ptr = hdr_scratch + SizeOfXLogRecord;
+	*(ptr++) = (char) method;
+	memcpy(ptr, &raw_len, sizeof(uint32));
+	ptr += sizeof(uint32);
+	hdr_rdt.len = (ptr - hdr_scratch);
+
+	record_compressed_rdt.data = record_compressed_buf;
+	record_compressed_rdt.len = len;
+	record_compressed_rdt.next = NULL;
+	hdr_rdt.next = &record_compressed_rdt;
+
+	*info |= XLR_COMPRESSED;
+
+	return hdr_rdt.len + len;
+}
+
 /*
  * Create a compressed version of a backup block image.
  *
@@ -1438,4 +1584,16 @@ InitXLogInsert(void)
 	if (hdr_scratch == NULL)
 		hdr_scratch = MemoryContextAllocZero(xloginsert_cxt,
 											 HEADER_SCRATCH_SIZE);
+
+	/*
+	 * And the buffers used by wal_record_compression.  Allocate them even if
+	 * it's currently disabled, as it can be enabled at any time.
+	 */
+	if (record_raw_buf == NULL)
+	{
+		record_raw_buf = MemoryContextAlloc(xloginsert_cxt,
+											RECORD_COMPRESS_MAX_LEN);
+		record_compressed_buf = MemoryContextAlloc(xloginsert_cxt,
+												   RECORD_COMPRESS_BUFSIZE);
+	}
 }
@@ -171,6 +171,8 @@ XLogReaderFree(XLogReaderState *state)
 	pfree(state->errormsg_buf);
 	if (state->readRecordBuf)
 		pfree(state->readRecordBuf);
+	if (state->decompressBuf)
+		pfree(state->decompressBuf);
 	pfree(state->readBuf);
 	pfree(state);
 }
@@ -882,6 +884,33 @@ restart:
 		state->NextRecPtr -= XLogSegmentOffset(state->NextRecPtr, state->segcxt.ws_segsize);
 	}
 
+	/*
+	 * The data of a compressed record takes more space once decoded than its
+	 * xl_tot_len says, so the space found above might not be enough.  Now
+	 * that the record has been validated we can trust the raw length stored
+	 * in it; look for space again based on that.
+	 */
+	if ((record->xl_info & XLR_COMPRESSED) != 0)
+	{
+		size_t		raw_len = XLogRecordRawLength(record);
+
+		if (raw_len > XLogRecordMaxSize)
+		{
+			report_invalid_record(state,
+								  "invalid decompressed record length at %X/%08X: %zu",
+								  LSN_FORMAT_ARGS(RecPtr), raw_len);
+			goto err;
+		}
+		if (decoded && decoded->oversized)
+			pfree(decoded);
+		decoded = XLogReadRecordAlloc(state, raw_len,
+									  false /* allow_oversized */ );
+		if (decoded == NULL)
+			decoded = XLogReadRecordAlloc(state, raw_len,
+										  true /* allow_oversized */ );
+		Assert(decoded != NULL);
+	}
+
 	/*
 	 * If we got here without a DecodedXLogRecord, it means we needed to
 	 * validate total_len before trusting it, but by now we've done that.
@@ -1685,9 +1714,138 @@ DecodeXLogRecordRequiredSpace(size_t xl_tot_len)
 	return size;
 }
 
+/*
+ * Returns the length a record would have if its data wasn't compressed,
+ * i.e. its xl_tot_len unless XLR_COMPRESSED is set.  The whole record must be
+ * available in memory.
+ */
+size_t
+XLogRecordRawLength(const XLogRecord *record)
+{
+	uint32		raw_len;
+
+	if ((record->xl_info & XLR_COMPRESSED) == 0 ||
+		record->xl_tot_len < SizeOfXLogRecord + SizeOfXLogRecordCompressHeader)
+		return record->xl_tot_len;
+
+	memcpy(&raw_len,
+		   ((const char *) record) + SizeOfXLogRecord + sizeof(uint8),
+		   sizeof(uint32));
+
+	return SizeOfXLogRecord + (size_t) raw_len;
+}
+
+/*
+ * Decompress the data of a record that has XLR_COMPRESSED set into
+ * state->decompressBuf.  On success, returns a pointer to the decompressed
+ * data and sets *raw_len to its length.  On failure, returns NULL with an
+ * error in state->errormsg_buf.
+ */
+static char *
+DecompressXLogRecord(XLogReaderState *state, XLogRecord *record,
+					 uint32 *raw_len)
+{
+	char	   *ptr = ((char *) record) + SizeOfXLogRecord;
+	uint32		remaining = record->xl_tot_len - SizeOfXLogRecord;
+	uint8		method;
+	bool		decomp_success = true;
+
+	if (remaining < SizeOfXLogRecordCompressHeader)
+	{
+		report_invalid_record(state,
+							  "record with invalid length at %X/%08X",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr));
+		return NULL;
+	}
+	method = *(uint8 *) ptr;
+	memcpy(raw_len, ptr + sizeof(uint8), sizeof(uint32));
+	ptr += SizeOfXLogRecordCompressHeader;
+	remaining -= SizeOfXLogRecordCompressHeader;
+
+	if (*raw_len > XLogRecordMaxSize - SizeOfXLogRecord)
+	{
+		report_invalid_record(state,
+							  "invalid decompressed record length at %X/%08X: %u",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr), *raw_len);
+		return NULL;
+	}
+
+	/* Enlarge the buffer, if needed */
+	if (state->decompressBufSize < *raw_len)
+	{
+		uint32		newSize = Max(*raw_len, BLCKSZ);
+
+		if (state->decompressBuf)
+			pfree(state->decompressBuf);
+		state->decompressBuf = palloc_extended(newSize, MCXT_ALLOC_NO_OOM);
+		if (state->decompressBuf == NULL)
+		{
+			state->decompressBufSize = 0;
+			report_invalid_record(state,
+								  "out of memory while decompressing record at %X/%08X",
+								  LSN_FORMAT_ARGS(state->ReadRecPtr));
+			return NULL;
+		}
+		state->decompressBufSize = newSize;
+	}
+
+	if (method == XLR_COMPRESS_PGLZ)
+	{
+		if (pglz_decompress(ptr, remaining, state->decompressBuf,
+							*raw_len, true) != (int32) *raw_len)
+			decomp_success = false;
+	}
+	else if (method == XLR_COMPRESS_LZ4)
+	{
+#ifdef USE_LZ4
+		if (LZ4_decompress_safe(ptr, state->decompressBuf,
+								remaining, *raw_len) != (int) *raw_len)
+			decomp_success = false;
+#else
+		report_invalid_record(state, "could not decompress record at %X/%08X compressed with %s not supported by build",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr),
+							  "LZ4");
+		return NULL;
+#endif
+	}
+	else if (method == XLR_COMPRESS_ZSTD)
+	{
+#ifdef USE_ZSTD
+		size_t		decomp_result = ZSTD_decompress(state->decompressBuf,
+													*raw_len,
+													ptr, remaining);
+
+		if (ZSTD_isError(decomp_result) || decomp_result != *raw_len)
+			decomp_success = false;
+#else
+		report_invalid_record(state, "could not decompress record at %X/%08X compressed with %s not supported by build",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr),
+							  "zstd");
+		return NULL;
+#endif
+	}
+	else
+	{
+		report_invalid_record(state, "could not decompress record at %X/%08X compressed with unknown method %u",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr),
+							  method);
+		return NULL;
+	}
+
+	if (!decomp_success)
+	{
+		report_invalid_record(state, "could not decompress record at %X/%08X",
+							  LSN_FORMAT_ARGS(state->ReadRecPtr));
+		return NULL;
+	}
+
+	return state->decompressBuf;
+}
+
 /*
  * Decode a record.  "decoded" must point to a MAXALIGNed memory area that has
- * space for at least DecodeXLogRecordRequiredSpace(record) bytes.  On
+ * space for at least DecodeXLogRecordRequiredSpace(XLogRecordRawLength(record))
+ * bytes.  On
  * success, decoded->size contains the actual space occupied by the decoded
  * record, which may turn out to be less.
  *
@@ -1731,9 +1889,19 @@ DecodeXLogRecord(XLogReaderState *state,
 	decoded->main_data = NULL;
 	decoded->main_data_len = 0;
 	decoded->max_block_id = -1;
-	ptr = (char *) record;
-	ptr += SizeOfXLogRecord;
-	remaining = record->xl_tot_len - SizeOfXLogRecord;
+	if ((record->xl_info & XLR_COMPRESSED) != 0)
+	{
+		/* Decode from the decompressed data instead */
+		ptr = DecompressXLogRecord(state, record, &remaining);
+		if (ptr == NULL)
+			goto err;
+	}
+	else
+	{
+		ptr = (char *) record;
+		ptr += SizeOfXLogRecord;
+		remaining = record->xl_tot_len - SizeOfXLogRecord;
+	}
 
 	/* Decode the headers */
 	datatotal = 0;
@@ -1985,7 +2153,7 @@ DecodeXLogRecord(XLogReaderState *state,
 
 	/* Report the actual size we used. */
 	decoded->size = MAXALIGN(out - (char *) decoded);
-	Assert(DecodeXLogRecordRequiredSpace(record->xl_tot_len) >=
+	Assert(DecodeXLogRecordRequiredSpace(XLogRecordRawLength(record)) >=
 		   decoded->size);
 
 	return true;
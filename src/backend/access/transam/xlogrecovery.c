@@ -38,6 +38,7 @@
 #include "access/xlogprefetcher.h"
 #include "access/xlogreader.h"
 #include "access/xlogrecovery.h"
+#include "access/xlogredoworker.h"
 #include "access/xlogutils.h"
 #include "access/xlogwait.h"
 #include "backup/basebackup.h"
@@ -302,6 +303,15 @@ static bool backupEndRequired = false;
  */
 bool		reachedConsistency = false;
 
+/*
+ * Range of records handed over to WAL redo workers, that have not been
+ * reported as replayed yet.  See SyncRedoWorkers().
+ */
+static XLogRecPtr pendingReplayStartRecPtr = InvalidXLogRecPtr;
+static XLogRecPtr pendingReplayReadRecPtr = InvalidXLogRecPtr;
+static XLogRecPtr pendingReplayEndRecPtr = InvalidXLogRecPtr;
+static TimeLineID pendingReplayTLI = 0;
+
 /* Buffers dedicated to consistency checks of size BLCKSZ */
 static char *replay_image_masked = NULL;
 static char *primary_image_masked = NULL;
@@ -337,6 +347,9 @@ static bool recoveryStopAfter;
 
 /* prototypes for local functions */
 static void ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record, TimeLineID *replayTLI);
+static void FinishReplayedRecord(XLogRecPtr ReadRecPtr, XLogRecPtr EndRecPtr,
+								 TimeLineID replayTLI, bool switchedTLI);
+static void SyncRedoWorkers(void);
 
 static void EnableStandbyMode(void);
 static void readRecoverySignalFile(void);
@@ -1700,6 +1713,8 @@ PerformWalRecovery(void)
 				errmsg("redo starts at %X/%08X",
 					   LSN_FORMAT_ARGS(xlogreader->ReadRecPtr)));
 
+		XLogRedoWorkersStart();
+
 		/* Prepare to report progress of the redo phase. */
 		if (!StandbyMode)
 			begin_startup_progress_phase();
@@ -1809,6 +1824,10 @@ PerformWalRecovery(void)
 		 * end of main redo apply loop
 		 */
 
+		/* Let the WAL redo workers finish, if any */
+		SyncRedoWorkers();
+		XLogRedoWorkersStop();
+
 		if (reachedRecoveryTarget)
 		{
 			if (!reachedConsistency)
@@ -1941,7 +1960,11 @@ ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record, TimeLineID *repl
 
 	/*
 	 * Update shared replayEndRecPtr before replaying this record, so that
-	 * XLogFlush will update minRecoveryPoint correctly.
+	 * XLogFlush will update minRecoveryPoint correctly.  This is also done
+	 * before the record is handed over to a WAL redo worker: pages replayed
+	 * by the workers carry LSNs up to the last record handed over, which may
+	 * be past lastReplayedEndRecPtr until the next sync, and minRecoveryPoint
+	 * must cover them when they are written out.
 	 */
 	SpinLockAcquire(&XLogRecoveryCtl->info_lck);
 	XLogRecoveryCtl->replayEndRecPtr = xlogreader->EndRecPtr;
@@ -1955,6 +1978,32 @@ ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record, TimeLineID *repl
 		TransactionIdIsValid(record->xl_xid))
 		RecordKnownAssignedTransactionIds(record->xl_xid);
 
+	/*
+	 * Hand the record over to a WAL redo worker, if possible.  It's reported
+	 * as replayed once the workers have caught up, see SyncRedoWorkers().
+	 */
+	if (XLogRedoWorkerDispatch(xlogreader))
+	{
+		Assert(!switchedTLI);
+
+		error_context_stack = errcallback.previous;
+
+		if (!XLogRecPtrIsValid(pendingReplayStartRecPtr))
+			pendingReplayStartRecPtr = xlogreader->ReadRecPtr;
+		pendingReplayReadRecPtr = xlogreader->ReadRecPtr;
+		pendingReplayEndRecPtr = xlogreader->EndRecPtr;
+		pendingReplayTLI = *replayTLI;
+
+		/* Don't let the reported replay position fall too far behind */
+		if (pendingReplayEndRecPtr - pendingReplayStartRecPtr >= wal_segment_size)
+			SyncRedoWorkers();
+		return;
+	}
+
+	/* Otherwise, the workers must catch up before we replay it ourselves */
+	SyncRedoWorkers();
+	XLogRedoWorkersPrepareRecord(xlogreader);
+
 	/*
 	 * Some XLOG record types that are related to recovery are processed
 	 * directly here, rather than in xlog_redo()
@@ -1976,14 +2025,39 @@ ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record, TimeLineID *repl
 	/* Pop the error context stack */
 	error_context_stack = errcallback.previous;
 
+	FinishReplayedRecord(xlogreader->ReadRecPtr, xlogreader->EndRecPtr,
+						 *replayTLI, switchedTLI);
+
+	/* Is this a timeline switch? */
+	if (switchedTLI)
+	{
+		/*
+		 * Before we continue on the new timeline, clean up any (possibly
+		 * bogus) future WAL segments on the old timeline.
+		 */
+		RemoveNonParentXlogFiles(xlogreader->EndRecPtr, *replayTLI);
+
+		/* Reset the prefetcher. */
+		XLogPrefetchReconfigure();
+	}
+}
+
+/*
+ * Subroutine of ApplyWalRecord and SyncRedoWorkers, to report a WAL record
+ * as replayed.
+ */
+static void
+FinishReplayedRecord(XLogRecPtr ReadRecPtr, XLogRecPtr EndRecPtr,
+					 TimeLineID replayTLI, bool switchedTLI)
+{
 	/*
 	 * Update lastReplayedEndRecPtr after this record has been successfully
 	 * replayed.
 	 */
 	SpinLockAcquire(&XLogRecoveryCtl->info_lck);
-	XLogRecoveryCtl->lastReplayedReadRecPtr = xlogreader->ReadRecPtr;
-	XLogRecoveryCtl->lastReplayedEndRecPtr = xlogreader->EndRecPtr;
-	XLogRecoveryCtl->lastReplayedTLI = *replayTLI;
+	XLogRecoveryCtl->lastReplayedReadRecPtr = ReadRecPtr;
+	XLogRecoveryCtl->lastReplayedEndRecPtr = EndRecPtr;
+	XLogRecoveryCtl->lastReplayedTLI = replayTLI;
 	SpinLockRelease(&XLogRecoveryCtl->info_lck);
 
 	/* ------
@@ -2024,19 +2098,29 @@ ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record, TimeLineID *repl
 
 	/* Allow read-only connections if we're consistent now */
 	CheckRecoveryConsistency();
+}
 
-	/* Is this a timeline switch? */
-	if (switchedTLI)
-	{
-		/*
-		 * Before we continue on the new timeline, clean up any (possibly
-		 * bogus) future WAL segments on the old timeline.
-		 */
-		RemoveNonParentXlogFiles(xlogreader->EndRecPtr, *replayTLI);
+/*
+ * Wait for the WAL redo workers to replay the records handed over to them,
+ * and report those records as replayed.
+ */
+static void
+SyncRedoWorkers(void)
+{
+	if (!XLogRedoWorkersSync())
+		return;
 
-		/* Reset the prefetcher. */
-		XLogPrefetchReconfigure();
-	}
+	FinishReplayedRecord(pendingReplayReadRecPtr, pendingReplayEndRecPtr,
+						 pendingReplayTLI, false);
+	pendingReplayStartRecPtr = InvalidXLogRecPtr;
+
+	/* Wake up processes waiting for the replay position, as in the main loop */
+	WaitLSNWakeup(WAIT_LSN_TYPE_STANDBY_REPLAY,
+				  XLogRecoveryCtl->lastReplayedEndRecPtr);
+	WaitLSNWakeup(WAIT_LSN_TYPE_STANDBY_WRITE,
+				  XLogRecoveryCtl->lastReplayedEndRecPtr);
+	WaitLSNWakeup(WAIT_LSN_TYPE_STANDBY_FLUSH,
+				  XLogRecoveryCtl->lastReplayedEndRecPtr);
 }
 
 /*
@@ -2909,6 +2993,9 @@ recoveryPausesHere(bool endOfRecovery)
 	if (LocalPromoteIsTriggered)
 		return;
 
+	/* Make everything replayed so far visible while we're paused */
+	SyncRedoWorkers();
+
 	if (endOfRecovery)
 		ereport(LOG,
 				(errmsg("pausing at the end of recovery"),
@@ -3005,6 +3092,9 @@ recoveryApplyDelay(XLogReaderState *record)
 	if (msecs <= 0)
 		return false;
 
+	/* Make everything replayed so far visible while we wait */
+	SyncRedoWorkers();
+
 	while (true)
 	{
 		ResetLatch(&XLogRecoveryCtl->recoveryWakeupLatch);
@@ -3710,6 +3800,9 @@ WaitForWALToBecomeAvailable(XLogRecPtr RecPtr, bool randAccess,
 						elog(LOG, "waiting for WAL to become available at %X/%08X",
 							 LSN_FORMAT_ARGS(RecPtr));
 
+						/* Report everything replayed so far before sleeping */
+						SyncRedoWorkers();
+
 						/* Do background tasks that might benefit us later. */
 						KnownAssignedTransactionIdsIdleMaintenance();
 
@@ -3970,8 +4063,10 @@ WaitForWALToBecomeAvailable(XLogRecPtr RecPtr, bool randAccess,
 					 * far and are about to start waiting for more WAL, let's
 					 * tell the upstream server our replay location now so
 					 * that pg_stat_replication doesn't show stale
-					 * information.
+					 * information.  That includes the records handed over to
+					 * WAL redo workers.
 					 */
+					SyncRedoWorkers();
 					if (!streaming_reply_sent)
 					{
 						WalRcvRequestApplyReply();
@@ -0,0 +1,783 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogredoworker.c
+ *		Parallel WAL redo.
+ *
+ * With recovery_parallel_workers > 0, the startup process launches that
+ * many WAL redo workers at the start of redo, and hands the replay of some
+ * WAL records over to them, so that changes to different data blocks are
+ * replayed concurrently.
+ *
+ * Only records that are known to change nothing but the blocks they
+ * reference are handed over; see RecordIsDispatchable().  Every block is
+ * assigned to one worker by hashing its identity, and a record is handed
+ * over only if all of its blocks are assigned to the same worker.  Each
+ * worker replays its records in WAL order, so each block still sees its
+ * changes in the same order as in serial replay.
+ *
+ * All other records are replayed by the startup process itself, after
+ * waiting for the workers to finish everything they were given so far (a
+ * "sync").  That covers everything that affects more than individual data
+ * blocks: transaction status, hot standby conflicts, relation drops and
+ * truncations, and so on.  The startup process only reports handed-over
+ * records as replayed at a sync, so that anyone waiting for a record to be
+ * replayed sees its effects.  It also syncs periodically, and before it
+ * waits for more WAL to arrive.
+ *
+ * A page replayed by a worker may be written out before the record that
+ * changed it is reported as replayed.  That's safe because the startup
+ * process advances replayEndRecPtr before handing a record over, and
+ * minRecoveryPoint is always advanced to replayEndRecPtr, by whichever
+ * process writes the page, workers included.
+ *
+ * Records are passed to the workers in decoded form, through a shm_mq per
+ * worker.  At each sync, workers pass the references to invalid pages they
+ * have found (see xlogutils.c) back to the startup process, which is the
+ * only one that can resolve them.
+ *
+ * Relation sizes are cached during recovery (see smgrnblocks_cached()), and
+ * that cache is not kept up to date across processes.  XLogReadBufferExtended
+ * rechecks the size whenever a block seems to be beyond the end of the
+ * relation, and serializes relation extension by redo workers.  Before the
+ * startup process replays a record that may remove or truncate relation
+ * files, all processes close their files and forget the cached sizes.
+ *
+ * Portions Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/backend/access/transam/xlogredoworker.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/heapam_xlog.h"
+#include "access/nbtxlog.h"
+#include "access/rmgr.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogrecovery.h"
+#include "access/xlogredoworker.h"
+#include "access/xlogutils.h"
+#include "catalog/pg_control.h"
+#include "common/hashfn.h"
+#include "miscadmin.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shm_toc.h"
+#include "storage/smgr.h"
+#include "tcop/tcopprot.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+/* Magic number for the parallel redo shared memory segment */
+#define REDO_WORKER_MAGIC			0x52454457
+
+/* Size of the queues to and from each worker */
+#define REDO_WORKER_QUEUE_SIZE		(1024 * 1024)
+#define REDO_WORKER_REPLY_SIZE		(16 * 1024)
+
+/*
+ * Number of consecutive blocks of a relation fork that are assigned to the
+ * same worker.  This lets records that touch neighbouring blocks, like
+ * non-HOT updates, be handed over more often.
+ */
+#define REDO_WORKER_BLOCK_RANGE		16
+
+/* Messages from the startup process to a worker */
+typedef enum RedoMessageType
+{
+	REDO_MESSAGE_RECORD,		/* a record to replay */
+	REDO_MESSAGE_SYNC,			/* report back when done */
+} RedoMessageType;
+
+typedef struct RedoMessage
+{
+	RedoMessageType type;
+	bool		reachedConsistency;
+	uint32		storageGeneration;
+	XLogRecPtr	ReadRecPtr;
+	XLogRecPtr	EndRecPtr;
+	/* address of the record in the startup process, to relocate pointers */
+	const DecodedXLogRecord *origin;
+	/* for REDO_MESSAGE_RECORD, the DecodedXLogRecord follows */
+} RedoMessage;
+
+/* Messages from a worker to the startup process */
+typedef enum RedoReplyType
+{
+	REDO_REPLY_INVALID_PAGE,	/* reference to an invalid page */
+	REDO_REPLY_SYNC_DONE,		/* all records replayed */
+} RedoReplyType;
+
+typedef struct RedoReply
+{
+	RedoReplyType type;
+	RelFileLocator locator;
+	ForkNumber	forkno;
+	BlockNumber blkno;
+	bool		present;
+} RedoReply;
+
+/* Startup process's state for each worker */
+typedef struct RedoWorkerState
+{
+	BackgroundWorkerHandle *handle;
+	shm_mq_handle *input;		/* records to replay */
+	shm_mq_handle *reply;		/* replies at sync */
+	bool		pending;		/* records sent since the last sync? */
+} RedoWorkerState;
+
+/* GUC variable */
+int			recovery_parallel_workers = 0;
+
+bool		ParallelRedoActive = false;
+
+static dsm_segment *redo_segment = NULL;
+static RedoWorkerState *redo_workers = NULL;
+static int	nredo_workers = 0;
+
+/*
+ * Incremented whenever the startup process replays a record that may remove
+ * or truncate relation files.  Workers then close all their files.
+ */
+static uint32 storage_generation = 0;
+
+static void redo_worker_failed(void);
+static void redo_worker_error_callback(void *arg);
+
+
+/*
+ * Launch the WAL redo workers.
+ *
+ * If the workers cannot be started, recovery continues without them.
+ */
+void
+XLogRedoWorkersStart(void)
+{
+	int			nworkers = recovery_parallel_workers;
+	shm_toc_estimator e;
+	Size		segsize;
+	shm_toc    *toc;
+	BackgroundWorker worker;
+	bool		failed = false;
+	int			i;
+
+	Assert(redo_workers == NULL);
+
+	/* Background workers can only be used under the postmaster */
+	if (nworkers == 0 || !IsUnderPostmaster)
+		return;
+
+	/*
+	 * Estimate how much shared memory we need.  We need a queue of records
+	 * and a queue of replies for each worker.
+	 */
+	shm_toc_initialize_estimator(&e);
+	for (i = 0; i < nworkers; i++)
+	{
+		shm_toc_estimate_chunk(&e, REDO_WORKER_QUEUE_SIZE);
+		shm_toc_estimate_chunk(&e, REDO_WORKER_REPLY_SIZE);
+	}
+	shm_toc_estimate_keys(&e, 2 * nworkers);
+	segsize = shm_toc_estimate(&e);
+
+	/* The segment stays mapped until the end of redo */
+	redo_segment = dsm_create(segsize, 0);
+	dsm_pin_mapping(redo_segment);
+	toc = shm_toc_create(REDO_WORKER_MAGIC, dsm_segment_address(redo_segment),
+						 segsize);
+
+	redo_workers = MemoryContextAllocZero(TopMemoryContext,
+										  sizeof(RedoWorkerState) * nworkers);
+
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	sprintf(worker.bgw_library_name, "postgres");
+	sprintf(worker.bgw_function_name, "RedoWorkerMain");
+	snprintf(worker.bgw_type, BGW_MAXLEN, "WAL redo worker");
+	worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(redo_segment));
+	worker.bgw_notify_pid = MyProcPid;
+
+	for (i = 0; i < nworkers; i++)
+	{
+		RedoWorkerState *w = &redo_workers[i];
+		shm_mq	   *input;
+		shm_mq	   *reply;
+
+		input = shm_mq_create(shm_toc_allocate(toc, REDO_WORKER_QUEUE_SIZE),
+							  REDO_WORKER_QUEUE_SIZE);
+		shm_toc_insert(toc, 2 * i, input);
+		shm_mq_set_sender(input, MyProc);
+
+		reply = shm_mq_create(shm_toc_allocate(toc, REDO_WORKER_REPLY_SIZE),
+							  REDO_WORKER_REPLY_SIZE);
+		shm_toc_insert(toc, 2 * i + 1, reply);
+		shm_mq_set_receiver(reply, MyProc);
+
+		snprintf(worker.bgw_name, BGW_MAXLEN, "WAL redo worker %d", i);
+		memcpy(worker.bgw_extra, &i, sizeof(int));
+		if (!RegisterDynamicBackgroundWorker(&worker, &w->handle))
+		{
+			ereport(WARNING,
+					(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+					 errmsg("out of background worker slots"),
+					 errhint("You might need to increase \"%s\".", "max_worker_processes")));
+			break;
+		}
+
+		w->input = shm_mq_attach(input, redo_segment, w->handle);
+		w->reply = shm_mq_attach(reply, redo_segment, w->handle);
+		nredo_workers++;
+	}
+
+	/* Make sure the workers are running, before handing records to them */
+	for (i = 0; i < nredo_workers; i++)
+	{
+		pid_t		pid;
+
+		if (WaitForBackgroundWorkerStartup(redo_workers[i].handle, &pid) != BGWH_STARTED)
+			failed = true;
+	}
+
+	if (failed || nredo_workers == 0)
+	{
+		ereport(LOG,
+				(errmsg("could not start WAL redo workers, continuing redo without them")));
+		XLogRedoWorkersStop();
+		return;
+	}
+
+	ParallelRedoActive = true;
+
+	ereport(LOG,
+			(errmsg_plural("using %d WAL redo worker",
+						   "using %d WAL redo workers",
+						   nredo_workers, nredo_workers)));
+}
+
+/*
+ * Shut down the WAL redo workers.
+ *
+ * The caller must have synced with them first, if they have been handed any
+ * records.
+ */
+void
+XLogRedoWorkersStop(void)
+{
+	if (redo_workers == NULL)
+		return;
+
+	/* Detaching from the queues makes the workers exit */
+	dsm_detach(redo_segment);
+	redo_segment = NULL;
+
+	for (int i = 0; i < nredo_workers; i++)
+	{
+		Assert(!redo_workers[i].pending);
+		WaitForBackgroundWorkerShutdown(redo_workers[i].handle);
+		pfree(redo_workers[i].handle);
+	}
+
+	pfree(redo_workers);
+	redo_workers = NULL;
+	nredo_workers = 0;
+	ParallelRedoActive = false;
+}
+
+/*
+ * Can the replay of this record be handed over to a worker?
+ *
+ * That's the case for records that change nothing but the blocks they
+ * reference, and whose replay needs no cleanup locks and causes no hot
+ * standby conflicts.  It's fine for such records to be replayed out of
+ * order with respect to records on other blocks.
+ */
+static bool
+RecordIsDispatchable(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	/* Consistency checks are done by the startup process */
+	if ((XLogRecGetInfo(record) & XLR_CHECK_CONSISTENCY) != 0)
+		return false;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_XLOG_ID:
+			return (info == XLOG_FPI || info == XLOG_FPI_FOR_HINT);
+
+		case RM_HEAP_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP_INSERT:
+				case XLOG_HEAP_DELETE:
+				case XLOG_HEAP_UPDATE:
+				case XLOG_HEAP_HOT_UPDATE:
+				case XLOG_HEAP_CONFIRM:
+				case XLOG_HEAP_LOCK:
+					return true;
+			}
+			return false;
+
+		case RM_HEAP2_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP2_MULTI_INSERT:
+				case XLOG_HEAP2_LOCK_UPDATED:
+					return true;
+			}
+			return false;
+
+		case RM_BTREE_ID:
+			switch (info)
+			{
+				case XLOG_BTREE_INSERT_LEAF:
+				case XLOG_BTREE_INSERT_UPPER:
+				case XLOG_BTREE_INSERT_POST:
+				case XLOG_BTREE_DEDUP:
+					return true;
+			}
+			return false;
+
+		case RM_GENERIC_ID:
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Does the replay of this record remove or truncate relation files?
+ */
+static bool
+RecordChangesStorage(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_SMGR_ID:
+		case RM_DBASE_ID:
+		case RM_TBLSPC_ID:
+			return true;
+
+		case RM_XACT_ID:
+			if ((info & XLOG_XACT_OPMASK) == XLOG_XACT_COMMIT ||
+				(info & XLOG_XACT_OPMASK) == XLOG_XACT_COMMIT_PREPARED)
+			{
+				xl_xact_parsed_commit parsed;
+
+				ParseCommitRecord(XLogRecGetInfo(record),
+								  (xl_xact_commit *) XLogRecGetData(record),
+								  &parsed);
+				return parsed.nrels > 0;
+			}
+			if ((info & XLOG_XACT_OPMASK) == XLOG_XACT_ABORT ||
+				(info & XLOG_XACT_OPMASK) == XLOG_XACT_ABORT_PREPARED)
+			{
+				xl_xact_parsed_abort parsed;
+
+				ParseAbortRecord(XLogRecGetInfo(record),
+								 (xl_xact_abort *) XLogRecGetData(record),
+								 &parsed);
+				return parsed.nrels > 0;
+			}
+			return false;
+	}
+
+	return false;
+}
+
+/*
+ * Which worker replays changes to the given block?
+ */
+static int
+RedoWorkerForBlock(RelFileLocator rlocator, ForkNumber forknum,
+				   BlockNumber blkno)
+{
+	uint32		hash;
+
+	hash = hash_bytes((const unsigned char *) &rlocator, sizeof(RelFileLocator));
+	hash = hash_combine(hash, hash_uint32((uint32) forknum));
+	hash = hash_combine(hash, hash_uint32(blkno / REDO_WORKER_BLOCK_RANGE));
+
+	return hash % nredo_workers;
+}
+
+/*
+ * Hand the replay of a record over to a worker, if possible.
+ *
+ * Returns true if the record was handed over.  The caller must not report it
+ * as replayed until after the next XLogRedoWorkersSync().  If false is
+ * returned, the caller must replay the record itself, see
+ * XLogRedoWorkersPrepareRecord().
+ */
+bool
+XLogRedoWorkerDispatch(XLogReaderState *record)
+{
+	int			worker = -1;
+	RedoMessage msg;
+	shm_mq_iovec iov[2];
+
+	if (redo_workers == NULL || !RecordIsDispatchable(record))
+		return false;
+
+	for (int block_id = 0; block_id <= XLogRecMaxBlockId(record); block_id++)
+	{
+		RelFileLocator rlocator;
+		ForkNumber	forknum;
+		BlockNumber blkno;
+		int			w;
+
+		if (!XLogRecGetBlockTagExtended(record, block_id,
+										&rlocator, &forknum, &blkno, NULL))
+			continue;
+
+		w = RedoWorkerForBlock(rlocator, forknum, blkno);
+		if (worker >= 0 && w != worker)
+			return false;
+		worker = w;
+	}
+
+	/* Nothing to parallelize if there are no blocks */
+	if (worker < 0)
+		return false;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = REDO_MESSAGE_RECORD;
+	msg.reachedConsistency = reachedConsistency;
+	msg.storageGeneration = storage_generation;
+	msg.ReadRecPtr = record->ReadRecPtr;
+	msg.EndRecPtr = record->EndRecPtr;
+	msg.origin = record->record;
+
+	iov[0].data = (const char *) &msg;
+	iov[0].len = sizeof(msg);
+	iov[1].data = (const char *) record->record;
+	iov[1].len = record->record->size;
+
+	/* No need to wake up the worker for every record */
+	if (shm_mq_sendv(redo_workers[worker].input, iov, 2, false, false) != SHM_MQ_SUCCESS)
+		redo_worker_failed();
+
+	redo_workers[worker].pending = true;
+
+	return true;
+}
+
+/*
+ * Wait for the workers to replay all the records handed over to them.
+ *
+ * Returns true if there were any such records.
+ */
+bool
+XLogRedoWorkersSync(void)
+{
+	RedoMessage msg;
+	bool		synced = false;
+
+	if (redo_workers == NULL)
+		return false;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = REDO_MESSAGE_SYNC;
+
+	/* Ask all the workers first, so they finish up in parallel */
+	for (int i = 0; i < nredo_workers; i++)
+	{
+		if (!redo_workers[i].pending)
+			continue;
+
+		if (shm_mq_send(redo_workers[i].input, sizeof(msg), &msg,
+						false, true) != SHM_MQ_SUCCESS)
+			redo_worker_failed();
+	}
+
+	for (int i = 0; i < nredo_workers; i++)
+	{
+		if (!redo_workers[i].pending)
+			continue;
+
+		for (;;)
+		{
+			RedoReply	reply;
+			Size		nbytes;
+			void	   *data;
+
+			if (shm_mq_receive(redo_workers[i].reply, &nbytes, &data,
+							   false) != SHM_MQ_SUCCESS)
+				redo_worker_failed();
+
+			Assert(nbytes == sizeof(reply));
+			memcpy(&reply, data, sizeof(reply));
+
+			if (reply.type == REDO_REPLY_SYNC_DONE)
+				break;
+
+			Assert(reply.type == REDO_REPLY_INVALID_PAGE);
+			XLogRememberInvalidPage(reply.locator, reply.forkno, reply.blkno,
+									reply.present);
+		}
+
+		redo_workers[i].pending = false;
+		synced = true;
+	}
+
+	return synced;
+}
+
+/*
+ * Prepare for the startup process to replay a record itself.
+ *
+ * The caller must have synced with the workers already.
+ */
+void
+XLogRedoWorkersPrepareRecord(XLogReaderState *record)
+{
+	if (redo_workers == NULL || !RecordChangesStorage(record))
+		return;
+
+	/*
+	 * Forget the sizes of relations extended by the workers, and make the
+	 * workers close all their files when they next replay something, like
+	 * smgr invalidation does for regular backends.
+	 */
+	smgrreleaseall();
+	storage_generation++;
+}
+
+/*
+ * A worker has exited, or cannot be attached to.
+ */
+static void
+redo_worker_failed(void)
+{
+	/*
+	 * The workers are terminated by the postmaster at shutdown.  If that's
+	 * what happened, exit the same way as when we're not waiting for them.
+	 */
+	ProcessStartupProcInterrupts();
+
+	ereport(FATAL,
+			(errcode(ERRCODE_INTERNAL_ERROR),
+			 errmsg("WAL redo worker exited unexpectedly")));
+}
+
+/*
+ * Pass a reference to an invalid page on to the startup process.
+ */
+static void
+redo_worker_forward_invalid_page(RelFileLocator locator, ForkNumber forkno,
+								 BlockNumber blkno, bool present, void *arg)
+{
+	shm_mq_handle *mqh = (shm_mq_handle *) arg;
+	RedoReply	reply;
+
+	memset(&reply, 0, sizeof(reply));
+	reply.type = REDO_REPLY_INVALID_PAGE;
+	reply.locator = locator;
+	reply.forkno = forkno;
+	reply.blkno = blkno;
+	reply.present = present;
+
+	/* If the startup process is gone, there's nothing left for us to do */
+	if (shm_mq_send(mqh, sizeof(reply), &reply, false, true) != SHM_MQ_SUCCESS)
+		proc_exit(0);
+}
+
+/*
+ * Make the pointers in a copy of a decoded record point into the copy.
+ */
+static void
+redo_worker_relocate(DecodedXLogRecord *decoded,
+					 const DecodedXLogRecord *origin)
+{
+#define RELOCATE(ptr) \
+	((char *) decoded + ((uintptr_t) (ptr) - (uintptr_t) origin))
+
+	decoded->next = NULL;
+	decoded->oversized = false;
+
+	if (decoded->main_data_len > 0)
+		decoded->main_data = RELOCATE(decoded->main_data);
+	else
+		decoded->main_data = NULL;
+
+	for (int block_id = 0; block_id <= decoded->max_block_id; block_id++)
+	{
+		DecodedBkpBlock *blk = &decoded->blocks[block_id];
+
+		if (!blk->in_use)
+			continue;
+
+		/* The startup process's hint is no use to us */
+		blk->prefetch_buffer = InvalidBuffer;
+
+		blk->bkp_image = blk->has_image ? RELOCATE(blk->bkp_image) : NULL;
+		blk->data = blk->has_data ? RELOCATE(blk->data) : NULL;
+	}
+
+#undef RELOCATE
+}
+
+/*
+ * Error context callback for errors occurring in a WAL redo worker.
+ */
+static void
+redo_worker_error_callback(void *arg)
+{
+	XLogReaderState *record = (XLogReaderState *) arg;
+	RmgrData	rmgr = GetRmgr(XLogRecGetRmid(record));
+	const char *id;
+
+	id = rmgr.rm_identify(XLogRecGetInfo(record));
+	if (id == NULL)
+		id = psprintf("UNKNOWN (%X)", XLogRecGetInfo(record) & ~XLR_INFO_MASK);
+
+	errcontext("WAL redo at %X/%08X for %s/%s",
+			   LSN_FORMAT_ARGS(record->ReadRecPtr), rmgr.rm_name, id);
+}
+
+/*
+ * Main entry point for a WAL redo worker.
+ */
+void
+RedoWorkerMain(Datum main_arg)
+{
+	dsm_segment *seg;
+	shm_toc    *toc;
+	shm_mq	   *mq;
+	shm_mq_handle *input;
+	shm_mq_handle *reply;
+	XLogReaderState *reader;
+	MemoryContext redo_context;
+	DecodedXLogRecord *decoded = NULL;
+	Size		decoded_size = 0;
+	uint32		generation = 0;
+	int			index;
+
+	memcpy(&index, MyBgworkerEntry->bgw_extra, sizeof(int));
+
+	/* Establish signal handlers */
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "WAL redo worker");
+
+	/* Attach to the queues set up by the startup process */
+	seg = dsm_attach(DatumGetUInt32(main_arg));
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	toc = shm_toc_attach(REDO_WORKER_MAGIC, dsm_segment_address(seg));
+	if (toc == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("invalid magic number in dynamic shared memory segment")));
+
+	mq = shm_toc_lookup(toc, 2 * index, false);
+	shm_mq_set_receiver(mq, MyProc);
+	input = shm_mq_attach(mq, seg, NULL);
+
+	mq = shm_toc_lookup(toc, 2 * index + 1, false);
+	shm_mq_set_sender(mq, MyProc);
+	reply = shm_mq_attach(mq, seg, NULL);
+
+	/* We're replaying WAL, like the startup process */
+	InRecovery = true;
+	ParallelRedoActive = true;
+	RmgrStartup();
+
+	reader = XLogReaderAllocate(wal_segment_size, NULL, XL_ROUTINE(), NULL);
+	if (reader == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "WAL redo worker",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	for (;;)
+	{
+		RedoMessage msg;
+		Size		nbytes;
+		void	   *data;
+		Size		size;
+		ErrorContextCallback errcallback;
+		MemoryContext oldcontext;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* The startup process detaches at the end of redo */
+		if (shm_mq_receive(input, &nbytes, &data, false) != SHM_MQ_SUCCESS)
+			break;
+
+		Assert(nbytes >= sizeof(msg));
+		memcpy(&msg, data, sizeof(msg));
+
+		if (msg.type == REDO_MESSAGE_SYNC)
+		{
+			RedoReply	done;
+
+			XLogForwardInvalidPages(redo_worker_forward_invalid_page, reply);
+
+			memset(&done, 0, sizeof(done));
+			done.type = REDO_REPLY_SYNC_DONE;
+			if (shm_mq_send(reply, sizeof(done), &done, false, true) != SHM_MQ_SUCCESS)
+				break;
+			continue;
+		}
+
+		Assert(msg.type == REDO_MESSAGE_RECORD);
+
+		if (msg.storageGeneration != generation)
+		{
+			/* Relation files may have been removed or truncated */
+			smgrreleaseall();
+			generation = msg.storageGeneration;
+		}
+		reachedConsistency = msg.reachedConsistency;
+
+		/* Make a copy of the record, with its pointers relocated */
+		size = nbytes - sizeof(msg);
+		if (size > decoded_size)
+		{
+			if (decoded)
+				pfree(decoded);
+			decoded = MemoryContextAlloc(TopMemoryContext, size);
+			decoded_size = size;
+		}
+		memcpy(decoded, (char *) data + sizeof(msg), size);
+		redo_worker_relocate(decoded, msg.origin);
+
+		reader->record = decoded;
+		reader->ReadRecPtr = msg.ReadRecPtr;
+		reader->EndRecPtr = msg.EndRecPtr;
+
+		/* Setup error traceback support for ereport() */
+		errcallback.callback = redo_worker_error_callback;
+		errcallback.arg = reader;
+		errcallback.previous = error_context_stack;
+		error_context_stack = &errcallback;
+
+		oldcontext = MemoryContextSwitchTo(redo_context);
+		GetRmgr(XLogRecGetRmid(reader)).rm_redo(reader);
+		MemoryContextSwitchTo(oldcontext);
+		MemoryContextReset(redo_context);
+
+		error_context_stack = errcallback.previous;
+
+		reader->record = NULL;
+	}
+}
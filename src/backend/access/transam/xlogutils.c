@@ -22,9 +22,11 @@
 #include "access/timeline.h"
 #include "access/xlogrecovery.h"
 #include "access/xlog_internal.h"
+#include "access/xlogredoworker.h"
 #include "access/xlogutils.h"
 #include "miscadmin.h"
 #include "storage/fd.h"
+#include "storage/lwlock.h"
 #include "storage/smgr.h"
 #include "utils/hsearch.h"
 #include "utils/rel.h"
@@ -261,6 +263,44 @@ XLogCheckInvalidPages(void)
 	invalid_page_tab = NULL;
 }
 
+/*
+ * Remember a reference to an invalid page found by another process.
+ *
+ * This is used by the startup process to collect the invalid-page entries
+ * of WAL redo workers, see xlogredoworker.c.
+ */
+void
+XLogRememberInvalidPage(RelFileLocator locator, ForkNumber forkno,
+						BlockNumber blkno, bool present)
+{
+	log_invalid_page(locator, forkno, blkno, present);
+}
+
+/*
+ * Pass all invalid-page entries to 'callback', and forget them.
+ *
+ * This is used by WAL redo workers to hand their entries over to the
+ * startup process, which is the only one that can resolve them.
+ */
+void
+XLogForwardInvalidPages(XLogInvalidPageCallback callback, void *arg)
+{
+	HASH_SEQ_STATUS status;
+	xl_invalid_page *hentry;
+
+	if (invalid_page_tab == NULL)
+		return;					/* nothing to do */
+
+	hash_seq_init(&status, invalid_page_tab);
+
+	while ((hentry = (xl_invalid_page *) hash_seq_search(&status)) != NULL)
+		callback(hentry->key.locator, hentry->key.forkno, hentry->key.blkno,
+				 hentry->present, arg);
+
+	hash_destroy(invalid_page_tab);
+	invalid_page_tab = NULL;
+}
+
 
 /*
  * XLogReadBufferForRedo
@@ -464,6 +504,7 @@ XLogReadBufferExtended(RelFileLocator rlocator, ForkNumber forknum,
 	BlockNumber lastblock;
 	Buffer		buffer;
 	SMgrRelation smgr;
+	bool		extension_locked = false;
 
 	Assert(blkno != P_NEW);
 
@@ -491,24 +532,39 @@ XLogReadBufferExtended(RelFileLocator rlocator, ForkNumber forknum,
 
 	lastblock = smgrnblocks(smgr, forknum);
 
+	/*
+	 * During parallel redo, other processes may have extended the relation
+	 * since we cached its size.  Serialize with them, and look again.
+	 */
+	if (blkno >= lastblock && ParallelRedoActive)
+	{
+		LWLockAcquire(RedoWorkerExtensionLock, LW_EXCLUSIVE);
+		extension_locked = true;
+		smgr->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+		lastblock = smgrnblocks(smgr, forknum);
+	}
+
 	if (blkno < lastblock)
 	{
 		/* page exists in file */
 		buffer = ReadBufferWithoutRelcache(rlocator, forknum, blkno,
 										   mode, NULL, true);
 	}
-	else
+	else if (mode == RBM_NORMAL || mode == RBM_NORMAL_NO_LOG)
 	{
 		/* hm, page doesn't exist in file */
 		if (mode == RBM_NORMAL)
-		{
 			log_invalid_page(rlocator, forknum, blkno, false);
-			return InvalidBuffer;
-		}
-		if (mode == RBM_NORMAL_NO_LOG)
-			return InvalidBuffer;
+		buffer = InvalidBuffer;
+	}
+	else
+	{
 		/* OK to extend the file */
-		/* we do this in recovery only - no rel-extension lock needed */
+
+		/*
+		 * We do this in recovery only - no rel-extension lock needed.  Redo
+		 * workers are serialized by RedoWorkerExtensionLock instead.
+		 */
 		Assert(InRecovery);
 		buffer = ExtendBufferedRelTo(BMR_SMGR(smgr, RELPERSISTENCE_PERMANENT),
 									 forknum,
@@ -519,6 +575,12 @@ XLogReadBufferExtended(RelFileLocator rlocator, ForkNumber forknum,
 									 mode);
 	}
 
+	if (extension_locked)
+		LWLockRelease(RedoWorkerExtensionLock);
+
+	if (!BufferIsValid(buffer))
+		return InvalidBuffer;
+
 recent_buffer_fast_path:
 	if (mode == RBM_NORMAL)
 	{
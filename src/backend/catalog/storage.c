@@ -531,6 +531,10 @@ RelationCopyStorage(SMgrRelation src, SMgrRelation dst,
 			pgstat_report_checksum_failures_in_db(rloc.locator.dbOid, 1);
 		}
 
+		/* Pages written in compressed form are copied as plain pages. */
+		if (verified && PageIsCompressed((Page) buf))
+			verified = PageDecompress((Page) buf);
+
 		if (!verified)
 		{
 			/*
@@ -1386,6 +1386,9 @@ acquire_sample_rows(Relation onerel, int elevel,
 	 * scan is the same as in the pages we did scan.  Since what we scanned is
 	 * a random sample of the pages in the relation, this should be a good
 	 * assumption.
+	 *
+	 * If no pages were sampled, any rows counted must have come from storage
+	 * of the table AM outside of its blocks, and are taken as they are.
 	 */
 	if (bs.m > 0)
 	{
@@ -1394,8 +1397,8 @@ acquire_sample_rows(Relation onerel, int elevel,
 	}
 	else
 	{
-		*totalrows = 0.0;
-		*totaldeadrows = 0.0;
+		*totalrows = floor(liverows + 0.5);
+		*totaldeadrows = floor(deadrows + 0.5);
 	}
 
 	/*
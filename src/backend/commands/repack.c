@@ -2663,7 +2663,7 @@ apply_concurrent_insert(Relation rel, TupleTableSlot *slot,
 						  chgcxt->cc_estate,
 						  0,
 						  slot,
-						  NIL, NULL);
+						  NULL, NIL, NULL);
 	pgstat_progress_incr_param(PROGRESS_REPACK_HEAP_TUPLES_INSERTED, 1);
 }
 
@@ -2690,7 +2690,7 @@ apply_concurrent_update(Relation rel, TupleTableSlot *spilled_tuple,
 							 InvalidSnapshot,
 							 InvalidSnapshot,
 							 false,
-							 &tmfd, &lockmode, &update_indexes);
+							 &tmfd, &lockmode, &update_indexes, NULL);
 	if (res != TM_Ok)
 		ereport(ERROR,
 				errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
@@ -2707,7 +2707,7 @@ apply_concurrent_update(Relation rel, TupleTableSlot *spilled_tuple,
 							  chgcxt->cc_estate,
 							  flags,
 							  spilled_tuple,
-							  NIL, NULL);
+							  NULL, NIL, NULL);
 	}
 
 	pgstat_progress_incr_param(PROGRESS_REPACK_HEAP_TUPLES_UPDATED, 1);
@@ -140,6 +140,8 @@ static bool check_exclusion_or_unique_constraint(Relation heap, Relation index,
 static bool index_recheck_constraint(Relation index, const Oid *constr_procs,
 									 const Datum *existing_values, const bool *existing_isnull,
 									 const Datum *new_values);
+static bool index_unchanged_by_values(IndexInfo *indexInfo,
+									  Bitmapset *unchangedAttrs);
 static bool index_unchanged_by_update(ResultRelInfo *resultRelInfo,
 									  EState *estate, IndexInfo *indexInfo,
 									  Relation indexRelation);
@@ -288,6 +290,13 @@ ExecCloseIndices(ResultRelInfo *resultRelInfo)
  *		(When that flag is not set we already know not to pass the
  *		hint to any index.)
  *
+ *		If EIIT_UNCHANGED_ATTRS is also set, 'unchangedAttrs' holds the
+ *		indexed columns whose values the update left unchanged, as
+ *		reported by table_tuple_update().  That lets us pass the hint
+ *		for an index whose columns were assigned to but kept their
+ *		values, as happens when an application sets every column of
+ *		the row.
+ *
  *		If EIIT_ONLY_SUMMARIZING is set, an equivalent optimization to
  *		HOT has been applied and any updated columns are indexed
  *		only by summarizing indexes (or in more general terms a
@@ -312,6 +321,7 @@ ExecInsertIndexTuples(ResultRelInfo *resultRelInfo,
 					  EState *estate,
 					  uint32 flags,
 					  TupleTableSlot *slot,
+					  Bitmapset *unchangedAttrs,
 					  List *arbiterIndexes,
 					  bool *specConflict)
 {
@@ -440,11 +450,17 @@ ExecInsertIndexTuples(ResultRelInfo *resultRelInfo,
 		 * index.  If we're being called as part of an UPDATE statement,
 		 * consider if the 'indexUnchanged' = true hint should be passed.
 		 */
-		indexUnchanged = ((flags & EIIT_IS_UPDATE) &&
-						  index_unchanged_by_update(resultRelInfo,
-													estate,
-													indexInfo,
-													indexRelation));
+		if (!(flags & EIIT_IS_UPDATE))
+			indexUnchanged = false;
+		else if ((flags & EIIT_UNCHANGED_ATTRS) &&
+				 indexInfo->ii_Expressions == NIL)
+			indexUnchanged = index_unchanged_by_values(indexInfo,
+													   unchangedAttrs);
+		else
+			indexUnchanged = index_unchanged_by_update(resultRelInfo,
+													   estate,
+													   indexInfo,
+													   indexRelation);
 
 		satisfiesConstraint =
 			index_insert(indexRelation, /* index relation */
@@ -1008,6 +1024,31 @@ index_recheck_constraint(Relation index, const Oid *constr_procs,
 	return true;
 }
 
+/*
+ * Check if ExecInsertIndexTuples() should pass indexUnchanged hint, given
+ * the indexed columns that the table AM found unchanged by this UPDATE.
+ *
+ * Unlike index_unchanged_by_update(), this looks at the values of this one
+ * row rather than at the columns the statement assigns to, so the result is
+ * not cached.  Only used for indexes without expressions.
+ */
+static bool
+index_unchanged_by_values(IndexInfo *indexInfo, Bitmapset *unchangedAttrs)
+{
+	/* As there, only key columns matter */
+	for (int attr = 0; attr < indexInfo->ii_NumIndexKeyAttrs; attr++)
+	{
+		int			keycol = indexInfo->ii_IndexAttrNumbers[attr];
+
+		Assert(keycol > 0);
+		if (!bms_is_member(keycol - FirstLowInvalidHeapAttributeNumber,
+						   unchangedAttrs))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * Check if ExecInsertIndexTuples() should pass indexUnchanged hint.
  *
@@ -859,7 +859,7 @@ ExecSimpleRelationInsert(ResultRelInfo *resultRelInfo,
 				flags = 0;
 			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 												   estate, flags,
-												   slot, conflictindexes,
+												   slot, NULL, conflictindexes,
 												   &conflict);
 		}
 
@@ -896,6 +896,90 @@ ExecSimpleRelationInsert(ResultRelInfo *resultRelInfo,
 	}
 }
 
+/*
+ * Insert multiple tuples, given in the 'slots' array, into the table.
+ *
+ * This is like calling ExecSimpleRelationInsert() for each slot, but the
+ * tuples are stored with a single table_multi_insert() call, and only then
+ * inserted into the indexes.  The slots must be of the type used by the
+ * table.
+ *
+ * The caller must make sure that the relation has no BEFORE ROW or INSTEAD
+ * OF ROW INSERT triggers, which could see the effects of the insertions in
+ * the wrong order, like CopyFrom() does.
+ */
+void
+ExecSimpleRelationMultiInsert(ResultRelInfo *resultRelInfo, EState *estate,
+							  TupleTableSlot **slots, int nslots)
+{
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	List	   *conflictindexes = resultRelInfo->ri_onConflictArbiterIndexes;
+	MemoryContext oldcontext;
+
+	/* For now we support only tables. */
+	Assert(rel->rd_rel->relkind == RELKIND_RELATION);
+	Assert(resultRelInfo->ri_TrigDesc == NULL ||
+		   (!resultRelInfo->ri_TrigDesc->trig_insert_before_row &&
+			!resultRelInfo->ri_TrigDesc->trig_insert_instead_row));
+
+	CheckCmdReplicaIdentity(rel, CMD_INSERT);
+
+	for (int i = 0; i < nslots; i++)
+	{
+		/* Compute stored generated columns */
+		if (rel->rd_att->constr &&
+			rel->rd_att->constr->has_generated_stored)
+			ExecComputeStoredGenerated(resultRelInfo, estate, slots[i],
+									   CMD_INSERT);
+
+		/* Check the constraints of the tuple */
+		if (rel->rd_att->constr)
+			ExecConstraints(resultRelInfo, slots[i], estate);
+		if (rel->rd_rel->relispartition)
+			ExecPartitionCheck(resultRelInfo, slots[i], estate, true);
+	}
+
+	/*
+	 * OK, store the tuples.  table_multi_insert may leak memory, so switch to
+	 * short-lived memory context before calling it.
+	 */
+	oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+	table_multi_insert(rel, slots, nslots, GetCurrentCommandId(true), 0, NULL);
+	MemoryContextSwitchTo(oldcontext);
+
+	/* Create index entries for the tuples, and check for conflicts */
+	for (int i = 0; i < nslots; i++)
+	{
+		List	   *recheckIndexes = NIL;
+		bool		conflict = false;
+
+		if (resultRelInfo->ri_NumIndices > 0)
+		{
+			uint32		flags;
+
+			if (conflictindexes != NIL)
+				flags = EIIT_NO_DUPE_ERROR;
+			else
+				flags = 0;
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
+												   estate, flags,
+												   slots[i], NULL,
+												   conflictindexes, &conflict);
+		}
+
+		/* See ExecSimpleRelationInsert() */
+		if (conflict)
+			CheckAndReportConflict(resultRelInfo, estate, CT_INSERT_EXISTS,
+								   recheckIndexes, NULL, slots[i]);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, slots[i],
+							 recheckIndexes, NULL);
+
+		list_free(recheckIndexes);
+	}
+}
+
 /*
  * Find the searchslot tuple and update it with data in the slot,
  * update the indexes, and execute any constraints and per-row triggers.
@@ -963,7 +1047,7 @@ ExecSimpleRelationUpdate(ResultRelInfo *resultRelInfo,
 				flags |= EIIT_ONLY_SUMMARIZING;
 			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 												   estate, flags,
-												   slot, conflictindexes,
+												   slot, NULL, conflictindexes,
 												   &conflict);
 		}
 
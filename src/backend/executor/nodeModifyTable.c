@@ -129,6 +129,7 @@ typedef struct UpdateContext
 {
 	bool		crossPartUpdate;	/* was it a cross-partition update? */
 	TU_UpdateIndexes updateIndexes; /* Which index updates are required? */
+	Bitmapset  *unchangedAttrs;	/* indexed columns the update left alone */
 
 	/*
 	 * Lock mode to acquire on the latest tuple version before performing
@@ -1239,7 +1240,7 @@ ExecInsert(ModifyTableContext *context,
 			/* insert index entries for tuple */
 			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 												   estate, EIIT_NO_DUPE_ERROR,
-												   slot, arbiterIndexes,
+												   slot, NULL, arbiterIndexes,
 												   &specConflict);
 
 			/* adjust the tuple's state accordingly */
@@ -1278,7 +1279,7 @@ ExecInsert(ModifyTableContext *context,
 			/* insert index entries for tuple */
 			if (resultRelInfo->ri_NumIndices > 0)
 				recheckIndexes = ExecInsertIndexTuples(resultRelInfo, estate,
-													   0, slot, NIL,
+													   0, slot, NULL, NIL,
 													   NULL);
 		}
 	}
@@ -2598,7 +2599,8 @@ lreplace:
 								estate->es_crosscheck_snapshot,
 								true /* wait for commit */ ,
 								&context->tmfd, &updateCxt->lockmode,
-								&updateCxt->updateIndexes);
+								&updateCxt->updateIndexes,
+								&updateCxt->unchangedAttrs);
 
 	return result;
 }
@@ -2623,12 +2625,19 @@ ExecUpdateEpilogue(ModifyTableContext *context, UpdateContext *updateCxt,
 	{
 		uint32		flags = EIIT_IS_UPDATE;
 
+		/* Without the table AM's report, judge by the assigned columns */
+		if (updateCxt->unchangedAttrs != NULL)
+			flags |= EIIT_UNCHANGED_ATTRS;
+
 		if (updateCxt->updateIndexes == TU_Summarizing)
 			flags |= EIIT_ONLY_SUMMARIZING;
 		recheckIndexes = ExecInsertIndexTuples(resultRelInfo, context->estate,
-											   flags, slot, NIL,
-											   NULL);
+											   flags, slot,
+											   updateCxt->unchangedAttrs,
+											   NIL, NULL);
 	}
+	bms_free(updateCxt->unchangedAttrs);
+	updateCxt->unchangedAttrs = NULL;
 
 	/* Compute temporal leftovers in FOR PORTION OF */
 	if (((ModifyTable *) context->mtstate->ps.plan)->forPortionOf)
@@ -28,12 +28,16 @@
 #include "postgres.h"
 
 #include "access/relscan.h"
+#include "access/skey.h"
 #include "access/tableam.h"
 #include "executor/execParallel.h"
 #include "executor/execScan.h"
 #include "executor/executor.h"
 #include "executor/nodeSeqscan.h"
+#include "optimizer/optimizer.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
+#include "utils/typcache.h"
 
 static TupleTableSlot *SeqNext(SeqScanState *node);
 
@@ -81,6 +85,10 @@ SeqNext(SeqScanState *node)
 		scandesc = table_beginscan(node->ss.ss_currentRelation,
 								   estate->es_snapshot,
 								   0, NULL, flags);
+		if (node->pushdown)
+			table_scan_set_pushdown(scandesc, node->pushdown_attrs,
+									node->pushdown_nkeys,
+									node->pushdown_keys);
 		node->ss.ss_currentScanDesc = scandesc;
 	}
 
@@ -105,6 +113,100 @@ SeqRecheck(SeqScanState *node, TupleTableSlot *slot)
 	return true;
 }
 
+/*
+ * SeqScanInitPushdown -- work out what to pass to table_scan_set_pushdown()
+ *
+ * The columns are those referenced by the target list or the quals; a
+ * whole-row reference needs them all.  The keys are built from the quals of
+ * the form "column op constant" where op is a btree comparison operator of
+ * the column type's default opfamily, which are the ones an AM can check
+ * against per-block minimum and maximum values.
+ */
+static void
+SeqScanInitPushdown(SeqScanState *scanstate, SeqScan *node)
+{
+	Index		scanrelid = node->scan.scanrelid;
+	Bitmapset  *attrs = NULL;
+	ListCell   *lc;
+
+	pull_varattnos((Node *) node->scan.plan.targetlist, scanrelid, &attrs);
+	pull_varattnos((Node *) node->scan.plan.qual, scanrelid, &attrs);
+	if (bms_is_member(InvalidAttrNumber - FirstLowInvalidHeapAttributeNumber,
+					  attrs))
+		attrs = NULL;
+
+	scanstate->pushdown = true;
+	scanstate->pushdown_attrs = attrs;
+	scanstate->pushdown_nkeys = 0;
+	scanstate->pushdown_keys =
+		palloc_array(ScanKeyData, list_length(node->scan.plan.qual));
+
+	foreach(lc, node->scan.plan.qual)
+	{
+		OpExpr	   *op = (OpExpr *) lfirst(lc);
+		Oid			opno;
+		Node	   *leftop;
+		Node	   *rightop;
+		Var		   *var;
+		Const	   *con;
+		TypeCacheEntry *typentry;
+		int			strategy;
+		Oid			lefttype;
+		Oid			righttype;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+			continue;
+
+		opno = op->opno;
+		leftop = linitial(op->args);
+		rightop = lsecond(op->args);
+		if (leftop && IsA(leftop, RelabelType))
+			leftop = (Node *) ((RelabelType *) leftop)->arg;
+		if (rightop && IsA(rightop, RelabelType))
+			rightop = (Node *) ((RelabelType *) rightop)->arg;
+
+		if (IsA(rightop, Var) && IsA(leftop, Const))
+		{
+			/* "constant op column", so commute the operator */
+			opno = get_commutator(opno);
+			if (!OidIsValid(opno))
+				continue;
+			var = (Var *) rightop;
+			con = (Const *) leftop;
+		}
+		else if (IsA(leftop, Var) && IsA(rightop, Const))
+		{
+			var = (Var *) leftop;
+			con = (Const *) rightop;
+		}
+		else
+			continue;
+
+		if (var->varno != scanrelid || var->varlevelsup != 0 ||
+			var->varattno <= 0 || con->constisnull)
+			continue;
+
+		typentry = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+		if (!OidIsValid(typentry->btree_opf))
+			continue;
+		if (!op_in_opfamily(opno, typentry->btree_opf))
+			continue;
+		get_op_opfamily_properties(opno, typentry->btree_opf, false,
+								   &strategy, &lefttype, &righttype);
+		if (lefttype != var->vartype || righttype != con->consttype)
+			continue;
+
+		ScanKeyEntryInitialize(&scanstate->pushdown_keys[scanstate->pushdown_nkeys++],
+							   0,
+							   var->varattno,
+							   strategy,
+							   righttype,
+							   op->inputcollid,
+							   get_opcode(opno),
+							   con->constvalue);
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecSeqScan(node)
  *
@@ -268,6 +370,13 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	scanstate->ss.ps.qual =
 		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
 
+	/*
+	 * If the table AM can skip data that we don't need, work out which
+	 * columns we need and which of our quals it can make use of.
+	 */
+	if (scanstate->ss.ss_currentRelation->rd_tableam->scan_set_pushdown)
+		SeqScanInitPushdown(scanstate, node);
+
 	/*
 	 * When EvalPlanQual() is not in use, assign ExecProcNode for this node
 	 * based on the presence of qual and projection. Each ExecSeqScan*()
@@ -409,6 +518,11 @@ ExecSeqScanInitializeDSM(SeqScanState *node,
 
 	node->ss.ss_currentScanDesc =
 		table_beginscan_parallel(node->ss.ss_currentRelation, pscan, flags);
+	if (node->pushdown)
+		table_scan_set_pushdown(node->ss.ss_currentScanDesc,
+								node->pushdown_attrs,
+								node->pushdown_nkeys,
+								node->pushdown_keys);
 }
 
 /* ----------------------------------------------------------------
@@ -449,6 +563,11 @@ ExecSeqScanInitializeWorker(SeqScanState *node,
 	pscan = shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, false);
 	node->ss.ss_currentScanDesc =
 		table_beginscan_parallel(node->ss.ss_currentRelation, pscan, flags);
+	if (node->pushdown)
+		table_scan_set_pushdown(node->ss.ss_currentScanDesc,
+								node->pushdown_attrs,
+								node->pushdown_nkeys,
+								node->pushdown_keys);
 }
 
 /*
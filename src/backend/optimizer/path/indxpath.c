@@ -862,6 +862,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	outer_relids = bms_copy(rel->lateral_relids);
 	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
+		int			nprevclauses = list_length(index_clauses);
 		ListCell   *lc;
 
 		foreach(lc, clauses->indexclauses[indexcol])
@@ -899,6 +900,14 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 		 */
 		if (index_clauses == NIL && !index->amoptionalkey)
 			return NIL;
+
+		/*
+		 * Likewise, an index with amrequireallkeys = true can only be scanned
+		 * if every key column has at least one index clause.
+		 */
+		if (index->amrequireallkeys &&
+			list_length(index_clauses) == nprevclauses)
+			return NIL;
 	}
 
 	/* We do not want the index's rel itself listed in outer_relids */
@@ -4050,13 +4059,14 @@ check_index_predicates(PlannerInfo *root, RelOptInfo *rel)
 			continue;
 
 		/*
-		 * If index is !amoptionalkey, also leave indrestrictinfo as set
-		 * above.  Otherwise we risk removing all quals for the first index
-		 * key and then not being able to generate an indexscan at all.  It
-		 * would be better to be more selective, but we've not yet identified
-		 * which if any of the quals match the first index key.
+		 * If index is !amoptionalkey or amrequireallkeys, also leave
+		 * indrestrictinfo as set above.  Otherwise we risk removing all quals
+		 * for a required index key and then not being able to generate an
+		 * indexscan at all.  It would be better to be more selective, but
+		 * we've not yet identified which if any of the quals match which
+		 * index keys.
 		 */
-		if (!index->amoptionalkey)
+		if (!index->amoptionalkey || index->amrequireallkeys)
 			continue;
 
 		/* Else compute indrestrictinfo as the non-implied quals */
@@ -886,6 +886,13 @@ use_physical_tlist(PlannerInfo *root, Path *path, int flags)
 	if (rel->reloptkind != RELOPT_BASEREL)
 		return false;
 
+	/*
+	 * Nor if the table AM can skip reading columns that the scan doesn't
+	 * need; a physical tlist would ask it for all of them.
+	 */
+	if (rel->amflags & AMFLAG_HAS_PUSHDOWN)
+		return false;
+
 	/*
 	 * Also, don't do it to a CustomPath; the premise that we're extracting
 	 * columns from a simple physical tuple is unlikely to hold for those.
@@ -307,6 +307,7 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 				amroutine = indexRelation->rd_indam;
 				info->amcanorderbyop = amroutine->amcanorderbyop;
 				info->amoptionalkey = amroutine->amoptionalkey;
+				info->amrequireallkeys = amroutine->amrequireallkeys;
 				info->amsearcharray = amroutine->amsearcharray;
 				info->amsearchnulls = amroutine->amsearchnulls;
 				info->amcanparallel = amroutine->amcanparallel;
@@ -408,6 +409,7 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 			{
 				info->amcanorderbyop = false;
 				info->amoptionalkey = false;
+				info->amrequireallkeys = false;
 				info->amsearcharray = false;
 				info->amsearchnulls = false;
 				info->amcanparallel = false;
@@ -559,6 +561,9 @@ get_relation_info(PlannerInfo *root, Oid relationObjectId, bool inhparent,
 		relation->rd_tableam->scan_set_tidrange != NULL &&
 		relation->rd_tableam->scan_getnextslot_tidrange != NULL)
 		rel->amflags |= AMFLAG_HAS_TID_RANGE;
+	if (relation->rd_tableam &&
+		relation->rd_tableam->scan_set_pushdown != NULL)
+		rel->amflags |= AMFLAG_HAS_PUSHDOWN;
 
 	/*
 	 * Collect info about relation's partitioning scheme, if any. Only
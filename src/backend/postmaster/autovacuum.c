@@ -134,6 +134,7 @@ int			autovacuum_anl_thresh;
 double		autovacuum_anl_scale;
 int			autovacuum_freeze_max_age;
 int			autovacuum_multixact_freeze_max_age;
+int			autovacuum_freeze_trigger_age = -1;
 double		autovacuum_freeze_score_weight = 1.0;
 double		autovacuum_multixact_freeze_score_weight = 1.0;
 double		autovacuum_vacuum_score_weight = 1.0;
@@ -2723,6 +2724,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
 									ObjectIdGetDatum(workitem->avw_relation),
 									Int64GetDatum((int64) workitem->avw_blockNumber));
 				break;
+			case AVW_GINCleanPendingList:
+				DirectFunctionCall1(gin_clean_pending_list,
+									ObjectIdGetDatum(workitem->avw_relation));
+				break;
 			default:
 				elog(WARNING, "unrecognized work item found: type %d",
 					 workitem->avw_type);
@@ -2896,6 +2901,14 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 			? avopts->freeze_table_age
 			: default_freeze_table_age;
 
+		/*
+		 * A vacuum started because of autovacuum_freeze_trigger_age must be
+		 * aggressive, or it might not advance relfrozenxid at all.
+		 */
+		if (autovacuum_freeze_trigger_age >= 0)
+			freeze_table_age = Min(freeze_table_age,
+								   autovacuum_freeze_trigger_age);
+
 		multixact_freeze_min_age = (avopts &&
 									avopts->multixact_freeze_min_age >= 0)
 			? avopts->multixact_freeze_min_age
@@ -3012,7 +3025,10 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
  *
  * We also force vacuum if the table's relfrozenxid is more than freeze_max_age
  * transactions back, and if its relminmxid is more than
- * multixact_freeze_max_age multixacts back.
+ * multixact_freeze_max_age multixacts back.  Before that, once relfrozenxid
+ * is more than autovacuum_freeze_trigger_age transactions back, the table is
+ * vacuumed like any other that needs it, so that it gets frozen by a vacuum
+ * that can be canceled and that doesn't run while autovacuum is disabled.
  *
  * A table whose autovacuum_enabled option is false is
  * automatically skipped (unless we have to vacuum it due to freeze_max_age).
@@ -3239,6 +3255,15 @@ relation_needs_vacanalyze(Oid relid,
 	if (force_vacuum)
 		*dovacuum = true;
 
+	/*
+	 * Start freezing the table well before it needs an anti-wraparound
+	 * vacuum, if so configured.  The threshold is capped at freeze_max_age,
+	 * which might have been reduced for this table.
+	 */
+	if (av_enabled && autovacuum_freeze_trigger_age >= 0 &&
+		xid_age > Min(autovacuum_freeze_trigger_age, freeze_max_age))
+		*dovacuum = true;
+
 	/*
 	 * If we found stats for the table, and autovacuum is currently enabled,
 	 * make a threshold-based decision whether to vacuum and/or analyze.  If
@@ -3429,6 +3454,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
 			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
 					 "autovacuum: BRIN summarize");
 			break;
+		case AVW_GINCleanPendingList:
+			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+					 "autovacuum: GIN pending list cleanup");
+			break;
 	}
 
 	/*
@@ -3465,7 +3494,8 @@ AutoVacuumingActive(void)
 
 /*
  * Request one work item to the next autovacuum run processing our database.
- * Return false if the request can't be recorded.
+ * Return false if the request can't be recorded.  A request identical to one
+ * that is still queued is folded into it.
  */
 bool
 AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
@@ -3476,6 +3506,25 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 
 	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
+	/*
+	 * If an identical request is already queued and not yet being processed,
+	 * there's no need to record another one.
+	 */
+	for (i = 0; i < NUM_WORKITEMS; i++)
+	{
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
+
+		if (workitem->avw_used && !workitem->avw_active &&
+			workitem->avw_type == type &&
+			workitem->avw_database == MyDatabaseId &&
+			workitem->avw_relation == relationId &&
+			workitem->avw_blockNumber == blkno)
+		{
+			LWLockRelease(AutovacuumLock);
+			return true;
+		}
+	}
+
 	/*
 	 * Locate an unused work item and fill it with the given data.
 	 */
@@ -13,6 +13,7 @@
 #include "postgres.h"
 
 #include "access/parallel.h"
+#include "access/xlogredoworker.h"
 #include "commands/repack.h"
 #include "libpq/pqsignal.h"
 #include "miscadmin.h"
@@ -147,6 +148,10 @@ static const struct
 		.fn_name = "ParallelWorkerMain",
 		.fn_addr = ParallelWorkerMain
 	},
+	{
+		.fn_name = "RedoWorkerMain",
+		.fn_addr = RedoWorkerMain
+	},
 	{
 		.fn_name = "RepackWorkerMain",
 		.fn_addr = RepackWorkerMain
@@ -2277,6 +2277,9 @@ process_pm_child_exit(void)
 		 */
 		if (StartupPMChild && pid == StartupPMChild->pid)
 		{
+			/* It may have been waiting for WAL redo workers */
+			if (StartupPMChild->bgworker_notify)
+				BackgroundWorkerStopNotifications(pid);
 			ReleasePostmasterChildSlot(StartupPMChild);
 			StartupPMChild = NULL;
 
@@ -608,9 +608,16 @@ libpqrcv_startstreaming(WalReceiverConn *conn,
 		appendStringInfoChar(&cmd, ')');
 	}
 	else
+	{
 		appendStringInfo(&cmd, " TIMELINE %u",
 						 options->proto.physical.startpointTLI);
 
+		if (options->proto.physical.compression != PG_COMPRESSION_NONE &&
+			PQserverVersion(conn->streamConn) >= 190000)
+			appendStringInfo(&cmd, " (compression '%s')",
+							 get_compress_algorithm_name(options->proto.physical.compression));
+	}
+
 	/* Start streaming. */
 	res = libpqsrv_exec(conn->streamConn,
 						cmd.data,
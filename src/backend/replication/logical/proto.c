@@ -18,6 +18,7 @@
 #include "libpq/pqformat.h"
 #include "replication/logicalproto.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/syscache.h"
 
 /*
@@ -36,8 +37,12 @@ static void logicalrep_write_tuple(StringInfo out, Relation rel,
 								   TupleTableSlot *slot,
 								   bool binary, Bitmapset *columns,
 								   PublishGencolsType include_gencols_type);
+static void logicalrep_write_column(StringInfo out, Form_pg_attribute att,
+									Datum value, bool isnull, bool binary);
 static void logicalrep_read_attrs(StringInfo in, LogicalRepRelation *rel);
 static void logicalrep_read_tuple(StringInfo in, LogicalRepTupleData *tuple);
+static void logicalrep_read_column(StringInfo in, StringInfo value,
+								   char *status);
 
 static void logicalrep_write_namespace(StringInfo out, Oid nspid);
 static const char *logicalrep_read_namespace(StringInfo in);
@@ -443,6 +448,210 @@ logicalrep_read_insert(StringInfo in, LogicalRepTupleData *newtup)
 	return relid;
 }
 
+/*
+ * Add an INSERT to a batch of inserts, to be sent with
+ * logicalrep_write_insert_batch().
+ *
+ * All tuples of a batch must be for the same relation, sent with the same
+ * column list and transaction ID.  Values are encoded as by
+ * logicalrep_write_tuple(), except that a value that is the same as the
+ * previous tuple's value for the column is sent as
+ * LOGICALREP_COLUMN_REPEATED.
+ */
+void
+logicalrep_insert_batch_add(LogicalRepInsertBatch *batch, TransactionId xid,
+							Relation rel, TupleTableSlot *newslot,
+							bool binary, Bitmapset *columns,
+							PublishGencolsType include_gencols_type)
+{
+	TupleDesc	desc = RelationGetDescr(rel);
+	MemoryContext oldcontext;
+	int			col = 0;
+
+	if (batch->ntuples == 0)
+	{
+		int			ncols = 0;
+
+		for (int i = 0; i < desc->natts; i++)
+		{
+			if (logicalrep_should_publish_column(TupleDescAttr(desc, i),
+												 columns,
+												 include_gencols_type))
+				ncols++;
+		}
+
+		oldcontext = MemoryContextSwitchTo(batch->context);
+		batch->relid = RelationGetRelid(rel);
+		batch->xid = xid;
+		batch->ncols = ncols;
+		batch->colbufs = palloc_array(StringInfoData, ncols);
+		batch->lastvalue = palloc_array(int, ncols);
+		batch->lastlen = palloc_array(int, ncols);
+		for (int i = 0; i < ncols; i++)
+			initStringInfo(&batch->colbufs[i]);
+		batch->size = 0;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	Assert(batch->relid == RelationGetRelid(rel));
+	Assert(batch->xid == xid);
+
+	slot_getallattrs(newslot);
+
+	for (int i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(desc, i);
+		StringInfo	buf;
+		int			start;
+
+		if (!logicalrep_should_publish_column(att, columns,
+											  include_gencols_type))
+			continue;
+
+		if (col >= batch->ncols)
+			elog(ERROR, "number of columns of relation \"%s\" changed in insert batch",
+				 RelationGetRelationName(rel));
+
+		buf = &batch->colbufs[col];
+		start = buf->len;
+
+		/* the buffer lives in the batch's context, but may be enlarged */
+		oldcontext = MemoryContextSwitchTo(batch->context);
+		logicalrep_write_column(buf, att, newslot->tts_values[i],
+								newslot->tts_isnull[i], binary);
+		MemoryContextSwitchTo(oldcontext);
+
+		/*
+		 * If the value is the same as the previous tuple's, replace it with
+		 * a single byte.  NULL and unchanged values are a single byte
+		 * already.
+		 */
+		if (batch->ntuples > 0 &&
+			buf->data[start] != LOGICALREP_COLUMN_NULL &&
+			buf->data[start] != LOGICALREP_COLUMN_UNCHANGED &&
+			buf->len - start == batch->lastlen[col] &&
+			memcmp(buf->data + start, buf->data + batch->lastvalue[col],
+				   batch->lastlen[col]) == 0)
+		{
+			buf->len = start;
+			appendStringInfoChar(buf, LOGICALREP_COLUMN_REPEATED);
+		}
+		else
+		{
+			batch->lastvalue[col] = start;
+			batch->lastlen[col] = buf->len - start;
+		}
+
+		batch->size += buf->len - start;
+		col++;
+	}
+
+	if (col != batch->ncols)
+		elog(ERROR, "number of columns of relation \"%s\" changed in insert batch",
+			 RelationGetRelationName(rel));
+
+	batch->ntuples++;
+}
+
+/*
+ * Write an INSERT BATCH message holding the tuples added to the batch, and
+ * reset it.
+ */
+void
+logicalrep_write_insert_batch(StringInfo out, LogicalRepInsertBatch *batch)
+{
+	Assert(batch->ntuples > 0);
+
+	pq_sendbyte(out, LOGICAL_REP_MSG_INSERT_BATCH);
+
+	/* transaction ID (if not valid, we're not streaming) */
+	if (TransactionIdIsValid(batch->xid))
+		pq_sendint32(out, batch->xid);
+
+	/* use Oid as relation identifier */
+	pq_sendint32(out, batch->relid);
+
+	pq_sendint32(out, batch->ntuples);
+	pq_sendint16(out, batch->ncols);
+
+	/* the values, column by column */
+	for (int i = 0; i < batch->ncols; i++)
+		pq_sendbytes(out, batch->colbufs[i].data, batch->colbufs[i].len);
+
+	MemoryContextReset(batch->context);
+	batch->ntuples = 0;
+	batch->ncols = 0;
+	batch->colbufs = NULL;
+	batch->lastvalue = NULL;
+	batch->lastlen = NULL;
+	batch->size = 0;
+}
+
+/*
+ * Read INSERT BATCH from stream.
+ *
+ * Fills the new tuples, returning an array of *ntuples tuples.
+ */
+LogicalRepRelId
+logicalrep_read_insert_batch(StringInfo in, int *ntuples,
+							 LogicalRepTupleData **newtups)
+{
+	LogicalRepRelId relid;
+	LogicalRepTupleData *tuples;
+	int			ntup;
+	int			ncols;
+
+	/* read the relation id */
+	relid = pq_getmsgint(in, 4);
+
+	ntup = pq_getmsgint(in, 4);
+	ncols = pq_getmsgint(in, 2);
+
+	if (ntup <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg_internal("invalid number of tuples %d in insert batch",
+								 ntup)));
+
+	tuples = palloc_array(LogicalRepTupleData, ntup);
+	for (int j = 0; j < ntup; j++)
+	{
+		/* Allocate space for per-column values; zero out unused StringInfos */
+		tuples[j].colvalues = palloc0_array(StringInfoData, ncols);
+		tuples[j].colstatus = palloc_array(char, ncols);
+		tuples[j].ncols = ncols;
+	}
+
+	/* Read the data, column by column */
+	for (int i = 0; i < ncols; i++)
+	{
+		for (int j = 0; j < ntup; j++)
+		{
+			LogicalRepTupleData *tuple = &tuples[j];
+
+			logicalrep_read_column(in, &tuple->colvalues[i],
+								   &tuple->colstatus[i]);
+
+			if (tuple->colstatus[i] == LOGICALREP_COLUMN_REPEATED)
+			{
+				if (j == 0)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("repeated value in first tuple of insert batch")));
+
+				/* share the previous tuple's value */
+				tuple->colvalues[i] = tuples[j - 1].colvalues[i];
+				tuple->colstatus[i] = tuples[j - 1].colstatus[i];
+			}
+		}
+	}
+
+	*ntuples = ntup;
+	*newtups = tuples;
+
+	return relid;
+}
+
 /*
  * Write UPDATE to the output stream.
  */
@@ -798,63 +1007,75 @@ logicalrep_write_tuple(StringInfo out, Relation rel, TupleTableSlot *slot,
 	/* Write the values */
 	for (i = 0; i < desc->natts; i++)
 	{
-		HeapTuple	typtup;
-		Form_pg_type typclass;
 		Form_pg_attribute att = TupleDescAttr(desc, i);
 
 		if (!logicalrep_should_publish_column(att, columns,
 											  include_gencols_type))
 			continue;
 
-		if (isnull[i])
-		{
-			pq_sendbyte(out, LOGICALREP_COLUMN_NULL);
-			continue;
-		}
+		logicalrep_write_column(out, att, values[i], isnull[i], binary);
+	}
+}
 
-		if (att->attlen == -1 && VARATT_IS_EXTERNAL_ONDISK(DatumGetPointer(values[i])))
-		{
-			/*
-			 * Unchanged toasted datum.  (Note that we don't promise to detect
-			 * unchanged data in general; this is just a cheap check to avoid
-			 * sending large values unnecessarily.)
-			 */
-			pq_sendbyte(out, LOGICALREP_COLUMN_UNCHANGED);
-			continue;
-		}
+/*
+ * Write the value of one column of a tuple, in the most efficient format
+ * possible.
+ */
+static void
+logicalrep_write_column(StringInfo out, Form_pg_attribute att, Datum value,
+						bool isnull, bool binary)
+{
+	HeapTuple	typtup;
+	Form_pg_type typclass;
 
-		typtup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(att->atttypid));
-		if (!HeapTupleIsValid(typtup))
-			elog(ERROR, "cache lookup failed for type %u", att->atttypid);
-		typclass = (Form_pg_type) GETSTRUCT(typtup);
+	if (isnull)
+	{
+		pq_sendbyte(out, LOGICALREP_COLUMN_NULL);
+		return;
+	}
 
+	if (att->attlen == -1 && VARATT_IS_EXTERNAL_ONDISK(DatumGetPointer(value)))
+	{
 		/*
-		 * Send in binary if requested and type has suitable send function.
+		 * Unchanged toasted datum.  (Note that we don't promise to detect
+		 * unchanged data in general; this is just a cheap check to avoid
+		 * sending large values unnecessarily.)
 		 */
-		if (binary && OidIsValid(typclass->typsend))
-		{
-			bytea	   *outputbytes;
-			int			len;
-
-			pq_sendbyte(out, LOGICALREP_COLUMN_BINARY);
-			outputbytes = OidSendFunctionCall(typclass->typsend, values[i]);
-			len = VARSIZE(outputbytes) - VARHDRSZ;
-			pq_sendint(out, len, 4);	/* length */
-			pq_sendbytes(out, VARDATA(outputbytes), len);	/* data */
-			pfree(outputbytes);
-		}
-		else
-		{
-			char	   *outputstr;
+		pq_sendbyte(out, LOGICALREP_COLUMN_UNCHANGED);
+		return;
+	}
 
-			pq_sendbyte(out, LOGICALREP_COLUMN_TEXT);
-			outputstr = OidOutputFunctionCall(typclass->typoutput, values[i]);
-			pq_sendcountedtext(out, outputstr, strlen(outputstr));
-			pfree(outputstr);
-		}
+	typtup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(att->atttypid));
+	if (!HeapTupleIsValid(typtup))
+		elog(ERROR, "cache lookup failed for type %u", att->atttypid);
+	typclass = (Form_pg_type) GETSTRUCT(typtup);
+
+	/*
+	 * Send in binary if requested and type has suitable send function.
+	 */
+	if (binary && OidIsValid(typclass->typsend))
+	{
+		bytea	   *outputbytes;
+		int			len;
+
+		pq_sendbyte(out, LOGICALREP_COLUMN_BINARY);
+		outputbytes = OidSendFunctionCall(typclass->typsend, value);
+		len = VARSIZE(outputbytes) - VARHDRSZ;
+		pq_sendint(out, len, 4);	/* length */
+		pq_sendbytes(out, VARDATA(outputbytes), len);	/* data */
+		pfree(outputbytes);
+	}
+	else
+	{
+		char	   *outputstr;
 
-		ReleaseSysCache(typtup);
+		pq_sendbyte(out, LOGICALREP_COLUMN_TEXT);
+		outputstr = OidOutputFunctionCall(typclass->typoutput, value);
+		pq_sendcountedtext(out, outputstr, strlen(outputstr));
+		pfree(outputstr);
 	}
+
+	ReleaseSysCache(typtup);
 }
 
 /*
@@ -876,44 +1097,50 @@ logicalrep_read_tuple(StringInfo in, LogicalRepTupleData *tuple)
 
 	/* Read the data */
 	for (i = 0; i < natts; i++)
+		logicalrep_read_column(in, &tuple->colvalues[i],
+							   &tuple->colstatus[i]);
+}
+
+/*
+ * Read the value of one column of a tuple from stream.
+ */
+static void
+logicalrep_read_column(StringInfo in, StringInfo value, char *status)
+{
+	char	   *buff;
+	char		kind;
+	int			len;
+
+	kind = pq_getmsgbyte(in);
+	*status = kind;
+
+	switch (kind)
 	{
-		char	   *buff;
-		char		kind;
-		int			len;
-		StringInfo	value = &tuple->colvalues[i];
+		case LOGICALREP_COLUMN_NULL:
+			/* nothing more to do */
+			break;
+		case LOGICALREP_COLUMN_UNCHANGED:
+			/* we don't receive the value of an unchanged column */
+			break;
+		case LOGICALREP_COLUMN_TEXT:
+		case LOGICALREP_COLUMN_BINARY:
+			len = pq_getmsgint(in, 4);	/* read length */
+
+			/* and data */
+			buff = palloc(len + 1);
+			pq_copymsgbytes(in, buff, len);
 
-		kind = pq_getmsgbyte(in);
-		tuple->colstatus[i] = kind;
+			/*
+			 * NUL termination is required for LOGICALREP_COLUMN_TEXT mode as
+			 * input functions require that.  For LOGICALREP_COLUMN_BINARY
+			 * it's not technically required, but it's harmless.
+			 */
+			buff[len] = '\0';
 
-		switch (kind)
-		{
-			case LOGICALREP_COLUMN_NULL:
-				/* nothing more to do */
-				break;
-			case LOGICALREP_COLUMN_UNCHANGED:
-				/* we don't receive the value of an unchanged column */
-				break;
-			case LOGICALREP_COLUMN_TEXT:
-			case LOGICALREP_COLUMN_BINARY:
-				len = pq_getmsgint(in, 4);	/* read length */
-
-				/* and data */
-				buff = palloc(len + 1);
-				pq_copymsgbytes(in, buff, len);
-
-				/*
-				 * NUL termination is required for LOGICALREP_COLUMN_TEXT mode
-				 * as input functions require that.  For
-				 * LOGICALREP_COLUMN_BINARY it's not technically required, but
-				 * it's harmless.
-				 */
-				buff[len] = '\0';
-
-				initStringInfoFromString(value, buff, len);
-				break;
-			default:
-				elog(ERROR, "unrecognized data representation type '%c'", kind);
-		}
+			initStringInfoFromString(value, buff, len);
+			break;
+		default:
+			elog(ERROR, "unrecognized data representation type '%c'", kind);
 	}
 }
 
@@ -1223,6 +1450,8 @@ logicalrep_message_type(LogicalRepMsgType action)
 			return "ORIGIN";
 		case LOGICAL_REP_MSG_INSERT:
 			return "INSERT";
+		case LOGICAL_REP_MSG_INSERT_BATCH:
+			return "INSERT BATCH";
 		case LOGICAL_REP_MSG_UPDATE:
 			return "UPDATE";
 		case LOGICAL_REP_MSG_DELETE:
@@ -88,6 +88,12 @@
 
 #include <unistd.h>
 #include <sys/stat.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "access/detoast.h"
 #include "access/heapam.h"
@@ -97,6 +103,7 @@
 #include "access/xlog_internal.h"
 #include "catalog/catalog.h"
 #include "common/int.h"
+#include "common/pg_lzcompress.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -154,6 +161,10 @@ typedef struct TXNEntryFile
 	File		vfd;			/* -1 when the file is closed */
 	off_t		curOffset;		/* offset for next write or read. Reset to 0
 								 * when vfd is opened. */
+	char	   *block;			/* last block of changes read from the file */
+	Size		blocksize;		/* allocated size of block */
+	Size		blocklen;		/* length of the changes in block */
+	Size		blockpos;		/* offset of the next change in block */
 } TXNEntryFile;
 
 /* k-way in-order change iteration support structures */
@@ -195,6 +206,24 @@ typedef struct ReorderBufferDiskChange
 	/* data follows */
 } ReorderBufferDiskChange;
 
+/*
+ * Spill files consist of blocks, each holding one or more MAXALIGN'd
+ * ReorderBufferDiskChanges.  A block is compressed as a whole, using the
+ * method in logical_decoding_spill_compression at the time it was written.
+ * Blocks are started whenever the previous one has grown past
+ * SPILL_BLOCK_SIZE, so they only get larger than that when a single change
+ * is.
+ */
+typedef struct ReorderBufferDiskBlock
+{
+	uint32		rawsize;		/* length of the changes in the block */
+	uint32		size;			/* length of the data following on disk */
+	int			method;			/* LogicalSpillCompression, or NONE */
+	/* data follows */
+} ReorderBufferDiskBlock;
+
+#define SPILL_BLOCK_SIZE	(64 * 1024)
+
 #define IsSpecInsert(action) \
 ( \
 	((action) == REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT) \
@@ -226,8 +255,9 @@ typedef struct ReorderBufferDiskChange
 int			logical_decoding_work_mem;
 static const Size max_changes_in_memory = 4096; /* XXX for restore only */
 
-/* GUC variable */
+/* GUC variables */
 int			debug_logical_replication_streaming = DEBUG_LOGICAL_REP_STREAMING_BUFFERED;
+int			logical_decoding_spill_compression = LOGICAL_SPILL_COMPRESSION_NONE;
 
 /* ---------------------------------------
  * primary reorderbuffer support routines
@@ -266,7 +296,11 @@ static void ReorderBufferExecuteInvalidations(uint32 nmsgs, SharedInvalidationMe
 static void ReorderBufferCheckMemoryLimit(ReorderBuffer *rb);
 static void ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
 static void ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
-										 int fd, ReorderBufferChange *change);
+										 int fd, StringInfo block,
+										 ReorderBufferChange *change);
+static void ReorderBufferSerializeBlock(ReorderBuffer *rb, ReorderBufferTXN *txn,
+										int fd, StringInfo block);
+static bool ReorderBufferRestoreBlock(ReorderBuffer *rb, TXNEntryFile *file);
 static Size ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 										TXNEntryFile *file, XLogSegNo *segno);
 static void ReorderBufferRestoreChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
@@ -1328,6 +1362,10 @@ ReorderBufferIterTXNInit(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	for (off = 0; off < state->nr_txns; off++)
 	{
 		state->entries[off].file.vfd = -1;
+		state->entries[off].file.block = NULL;
+		state->entries[off].file.blocksize = 0;
+		state->entries[off].file.blocklen = 0;
+		state->entries[off].file.blockpos = 0;
 		state->entries[off].segno = 0;
 	}
 
@@ -1511,6 +1549,8 @@ ReorderBufferIterTXNFinish(ReorderBuffer *rb,
 	{
 		if (state->entries[off].file.vfd != -1)
 			FileClose(state->entries[off].file.vfd);
+		if (state->entries[off].file.block != NULL)
+			pfree(state->entries[off].file.block);
 	}
 
 	/* free memory we might have "leaked" in the last *Next call */
@@ -4000,6 +4040,7 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	XLogSegNo	curOpenSegNo = 0;
 	Size		spilled = 0;
 	Size		size = txn->size;
+	StringInfoData block;
 
 	elog(DEBUG2, "spill %u changes in XID %u to disk",
 		 (uint32) txn->nentries_mem, txn->xid);
@@ -4014,6 +4055,7 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	}
 
 	/* serialize changestream */
+	block.data = NULL;
 	dlist_foreach_modify(change_i, &txn->changes)
 	{
 		ReorderBufferChange *change;
@@ -4030,7 +4072,10 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 			char		path[MAXPGPATH];
 
 			if (fd != -1)
+			{
+				ReorderBufferSerializeBlock(rb, txn, fd, &block);
 				CloseTransientFile(fd);
+			}
 
 			XLByteToSeg(change->lsn, curOpenSegNo, wal_segment_size);
 
@@ -4049,9 +4094,17 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 				ereport(ERROR,
 						(errcode_for_file_access(),
 						 errmsg("could not open file \"%s\": %m", path)));
+
+			if (block.data == NULL)
+			{
+				MemoryContext oldcontext = MemoryContextSwitchTo(rb->context);
+
+				initStringInfo(&block);
+				MemoryContextSwitchTo(oldcontext);
+			}
 		}
 
-		ReorderBufferSerializeChange(rb, txn, fd, change);
+		ReorderBufferSerializeChange(rb, txn, fd, &block, change);
 		dlist_delete(&change->node);
 		ReorderBufferFreeChange(rb, change, false);
 
@@ -4080,15 +4133,23 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	txn->txn_flags |= RBTXN_IS_SERIALIZED;
 
 	if (fd != -1)
+	{
+		ReorderBufferSerializeBlock(rb, txn, fd, &block);
 		CloseTransientFile(fd);
+	}
+
+	if (block.data != NULL)
+		pfree(block.data);
 }
 
 /*
- * Serialize individual change to disk.
+ * Serialize individual change, adding it to the block of changes to be
+ * written to disk next.
  */
 static void
 ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
-							 int fd, ReorderBufferChange *change)
+							 int fd, StringInfo block,
+							 ReorderBufferChange *change)
 {
 	ReorderBufferDiskChange *ondisk;
 	Size		sz = sizeof(ReorderBufferDiskChange);
@@ -4269,9 +4330,118 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	ondisk->size = sz;
 
+	/* keep the changes in the block aligned, so they can be read in place */
+	enlargeStringInfo(block, MAXALIGN(sz));
+	memcpy(block->data + block->len, rb->outbuf, sz);
+	memset(block->data + block->len + sz, 0, MAXALIGN(sz) - sz);
+	block->len += MAXALIGN(sz);
+
+	/*
+	 * Keep the transaction's final_lsn up to date with each change we send to
+	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
+	 * only do this on commit and abort records, but that doesn't work if a
+	 * system crash leaves a transaction without its abort record).
+	 *
+	 * Make sure not to move it backwards.
+	 */
+	if (txn->final_lsn < change->lsn)
+		txn->final_lsn = change->lsn;
+
+	Assert(ondisk->change.action == change->action);
+
+	/* Writing out the block reuses rb->outbuf, so ondisk is invalid after */
+	if (block->len >= SPILL_BLOCK_SIZE)
+		ReorderBufferSerializeBlock(rb, txn, fd, block);
+}
+
+/*
+ * Write a block of serialized changes to disk, compressing it if requested,
+ * and reset the block.
+ */
+static void
+ReorderBufferSerializeBlock(ReorderBuffer *rb, ReorderBufferTXN *txn,
+							int fd, StringInfo block)
+{
+	ReorderBufferDiskBlock *hdr;
+	char	   *dest;
+	Size		bound;
+	int			len = -1;
+
+	if (block->len == 0)
+		return;
+
+	switch (logical_decoding_spill_compression)
+	{
+		case LOGICAL_SPILL_COMPRESSION_PGLZ:
+			bound = PGLZ_MAX_OUTPUT(block->len);
+			break;
+#ifdef USE_LZ4
+		case LOGICAL_SPILL_COMPRESSION_LZ4:
+			bound = LZ4_compressBound(block->len);
+			break;
+#endif
+#ifdef USE_ZSTD
+		case LOGICAL_SPILL_COMPRESSION_ZSTD:
+			bound = ZSTD_compressBound(block->len);
+			break;
+#endif
+		default:
+			bound = 0;
+			break;
+	}
+
+	ReorderBufferSerializeReserve(rb, sizeof(ReorderBufferDiskBlock) + bound);
+	hdr = (ReorderBufferDiskBlock *) rb->outbuf;
+	dest = rb->outbuf + sizeof(ReorderBufferDiskBlock);
+
+	switch (logical_decoding_spill_compression)
+	{
+		case LOGICAL_SPILL_COMPRESSION_PGLZ:
+			len = pglz_compress(block->data, block->len, dest,
+								PGLZ_strategy_default);
+			break;
+#ifdef USE_LZ4
+		case LOGICAL_SPILL_COMPRESSION_LZ4:
+			len = LZ4_compress_default(block->data, dest, block->len, bound);
+			if (len <= 0)
+				len = -1;
+			break;
+#endif
+#ifdef USE_ZSTD
+		case LOGICAL_SPILL_COMPRESSION_ZSTD:
+			{
+				size_t		zlen;
+
+				zlen = ZSTD_compress(dest, bound, block->data, block->len,
+									 ZSTD_CLEVEL_DEFAULT);
+				len = ZSTD_isError(zlen) ? -1 : (int) zlen;
+			}
+			break;
+#endif
+		default:
+			break;
+	}
+
+	hdr->rawsize = block->len;
+	if (len >= 0 && len < block->len)
+	{
+		hdr->method = logical_decoding_spill_compression;
+		hdr->size = len;
+	}
+	else
+	{
+		/* not compressed, data is written from the block itself */
+		hdr->method = LOGICAL_SPILL_COMPRESSION_NONE;
+		hdr->size = block->len;
+		len = 0;
+	}
+
 	errno = 0;
 	pgstat_report_wait_start(WAIT_EVENT_REORDER_BUFFER_WRITE);
-	if (write(fd, rb->outbuf, ondisk->size) != ondisk->size)
+	if (write(fd, rb->outbuf, sizeof(ReorderBufferDiskBlock) + len) !=
+		sizeof(ReorderBufferDiskBlock) + len ||
+		(hdr->method == LOGICAL_SPILL_COMPRESSION_NONE &&
+		 write(fd, block->data, block->len) != block->len))
 	{
 		int			save_errno = errno;
 
@@ -4286,18 +4456,7 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	}
 	pgstat_report_wait_end();
 
-	/*
-	 * Keep the transaction's final_lsn up to date with each change we send to
-	 * disk, so that ReorderBufferRestoreCleanup works correctly.  (We used to
-	 * only do this on commit and abort records, but that doesn't work if a
-	 * system crash leaves a transaction without its abort record).
-	 *
-	 * Make sure not to move it backwards.
-	 */
-	if (txn->final_lsn < change->lsn)
-		txn->final_lsn = change->lsn;
-
-	Assert(ondisk->change.action == change->action);
+	resetStringInfo(block);
 }
 
 /* Returns true, if the output plugin supports streaming, false, otherwise. */
@@ -4566,7 +4725,6 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	while (restored < max_changes_in_memory && *segno <= last_segno)
 	{
-		int			readBytes;
 		ReorderBufferDiskChange *ondisk;
 
 		CHECK_FOR_INTERRUPTS();
@@ -4592,6 +4750,8 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 			/* No harm in resetting the offset even in case of failure */
 			file->curOffset = 0;
+			file->blocklen = 0;
+			file->blockpos = 0;
 
 			if (*fd < 0 && errno == ENOENT)
 			{
@@ -4607,72 +4767,153 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		}
 
 		/*
-		 * Read the statically sized part of a change which has information
-		 * about the total size. If we couldn't read a record, we're at the
-		 * end of this file.
+		 * Read the next block of changes from the file once we've restored
+		 * all changes in the last one.  If we couldn't read a block, we're at
+		 * the end of this file.
 		 */
-		ReorderBufferSerializeReserve(rb, sizeof(ReorderBufferDiskChange));
-		readBytes = FileRead(file->vfd, rb->outbuf,
-							 sizeof(ReorderBufferDiskChange),
-							 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
-
-		/* eof */
-		if (readBytes == 0)
+		if (file->blockpos >= file->blocklen &&
+			!ReorderBufferRestoreBlock(rb, file))
 		{
 			FileClose(*fd);
 			*fd = -1;
 			(*segno)++;
 			continue;
 		}
-		else if (readBytes < 0)
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: %m")));
-		else if (readBytes != sizeof(ReorderBufferDiskChange))
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
-							readBytes,
-							(uint32) sizeof(ReorderBufferDiskChange))));
-
-		file->curOffset += readBytes;
-
-		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
 
-		ReorderBufferSerializeReserve(rb,
-									  sizeof(ReorderBufferDiskChange) + ondisk->size);
-		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
+		ondisk = (ReorderBufferDiskChange *) (file->block + file->blockpos);
 
-		readBytes = FileRead(file->vfd,
-							 rb->outbuf + sizeof(ReorderBufferDiskChange),
-							 ondisk->size - sizeof(ReorderBufferDiskChange),
-							 file->curOffset,
-							 WAIT_EVENT_REORDER_BUFFER_READ);
-
-		if (readBytes < 0)
+		if (ondisk->size < sizeof(ReorderBufferDiskChange) ||
+			ondisk->size > file->blocklen - file->blockpos)
 			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: %m")));
-		else if (readBytes != ondisk->size - sizeof(ReorderBufferDiskChange))
-			ereport(ERROR,
-					(errcode_for_file_access(),
-					 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
-							readBytes,
-							(uint32) (ondisk->size - sizeof(ReorderBufferDiskChange)))));
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("invalid change of size %zu in reorderbuffer spill file",
+									 ondisk->size)));
 
-		file->curOffset += readBytes;
+		file->blockpos += MAXALIGN(ondisk->size);
 
 		/*
 		 * ok, read a full change from disk, now restore it into proper
 		 * in-memory format
 		 */
-		ReorderBufferRestoreChange(rb, txn, rb->outbuf);
+		ReorderBufferRestoreChange(rb, txn, (char *) ondisk);
 		restored++;
 	}
 
 	return restored;
 }
 
+/*
+ * Read the next block of changes from a spill file into file->block,
+ * decompressing it if needed.
+ *
+ * Returns false at the end of the file.
+ */
+static bool
+ReorderBufferRestoreBlock(ReorderBuffer *rb, TXNEntryFile *file)
+{
+	ReorderBufferDiskBlock hdr;
+	char	   *data;
+	int			readBytes;
+
+	readBytes = FileRead(file->vfd, &hdr, sizeof(ReorderBufferDiskBlock),
+						 file->curOffset, WAIT_EVENT_REORDER_BUFFER_READ);
+
+	/* eof */
+	if (readBytes == 0)
+		return false;
+	else if (readBytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: %m")));
+	else if (readBytes != sizeof(ReorderBufferDiskBlock))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
+						readBytes,
+						(uint32) sizeof(ReorderBufferDiskBlock))));
+
+	file->curOffset += readBytes;
+
+	if (file->blocksize < hdr.rawsize)
+	{
+		if (file->block)
+			pfree(file->block);
+		file->block = MemoryContextAlloc(rb->context, hdr.rawsize);
+		file->blocksize = hdr.rawsize;
+	}
+
+	/* read uncompressed blocks in place, others via the IO buffer */
+	if (hdr.method == LOGICAL_SPILL_COMPRESSION_NONE)
+		data = file->block;
+	else
+	{
+		ReorderBufferSerializeReserve(rb, hdr.size);
+		data = rb->outbuf;
+	}
+
+	readBytes = FileRead(file->vfd, data, hdr.size, file->curOffset,
+						 WAIT_EVENT_REORDER_BUFFER_READ);
+
+	if (readBytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: %m")));
+	else if (readBytes != hdr.size)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from reorderbuffer spill file: read %d instead of %u bytes",
+						readBytes, hdr.size)));
+
+	file->curOffset += readBytes;
+
+	switch (hdr.method)
+	{
+		case LOGICAL_SPILL_COMPRESSION_NONE:
+			break;
+		case LOGICAL_SPILL_COMPRESSION_PGLZ:
+			if (pglz_decompress(data, hdr.size, file->block, hdr.rawsize,
+								true) != hdr.rawsize)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg_internal("could not decompress reorderbuffer spill file block using %s",
+										 "pglz")));
+			break;
+#ifdef USE_LZ4
+		case LOGICAL_SPILL_COMPRESSION_LZ4:
+			if (LZ4_decompress_safe(data, file->block, hdr.size,
+									hdr.rawsize) != hdr.rawsize)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg_internal("could not decompress reorderbuffer spill file block using %s",
+										 "lz4")));
+			break;
+#endif
+#ifdef USE_ZSTD
+		case LOGICAL_SPILL_COMPRESSION_ZSTD:
+			{
+				size_t		zlen;
+
+				zlen = ZSTD_decompress(file->block, hdr.rawsize, data,
+									   hdr.size);
+				if (ZSTD_isError(zlen) || zlen != hdr.rawsize)
+					ereport(ERROR,
+							(errcode(ERRCODE_DATA_CORRUPTED),
+							 errmsg_internal("could not decompress reorderbuffer spill file block using %s",
+											 "zstd")));
+			}
+			break;
+#endif
+		default:
+			elog(ERROR, "unrecognized reorderbuffer spill file compression method %d",
+				 hdr.method);
+	}
+
+	file->blocklen = hdr.rawsize;
+	file->blockpos = 0;
+
+	return true;
+}
+
 /*
  * Convert change from its on-disk format to in-memory format and queue it onto
  * the TXN's ->changes list.
@@ -102,6 +102,7 @@
 #include "commands/copy.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/paths.h"
 #include "parser/parse_relation.h"
 #include "pgstat.h"
 #include "replication/logicallauncher.h"
@@ -114,6 +115,7 @@
 #include "storage/ipc.h"
 #include "storage/latch.h"
 #include "storage/lmgr.h"
+#include "storage/waiteventset.h"
 #include "utils/acl.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
@@ -128,6 +130,33 @@ List	   *table_states_not_ready = NIL;
 
 static StringInfo copybuf = NULL;
 
+/*
+ * State of a table copy that uses several connections to the publisher, each
+ * copying a range of blocks of the table.  The leader connection is the
+ * first one.  ncopyconns is 0 when the table is copied over the leader
+ * connection alone.
+ */
+static WalReceiverConn **copyconns = NULL;
+static pgsocket *copyconn_fds = NULL;
+static bool *copyconn_started = NULL;
+static bool *copyconn_done = NULL;
+static int	ncopyconns = 0;
+static int	copy_next_conn = 0;
+static bool copy_binary = false;
+static bool copy_header_sent = false;
+static bool copy_trailer_sent = false;
+
+/*
+ * Header of a binary COPY stream, with no flags and no header extension,
+ * and its trailer.  When copying over several connections, the headers and
+ * trailers of the individual streams are replaced by a single one.
+ */
+static char copy_binary_header[] = "PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0";
+#define COPY_BINARY_HEADER_LEN	19
+#define COPY_BINARY_SIGNATURE_LEN	11
+static char copy_binary_trailer[] = "\377\377";
+#define COPY_BINARY_TRAILER_LEN	2
+
 /*
  * Wait until the relation sync state is set in the catalog to the expected
  * one; return true when it happens.
@@ -638,6 +667,131 @@ make_copy_attnamelist(LogicalRepRelMapEntry *rel)
 	return attnamelist;
 }
 
+/*
+ * Receive the next CopyData message of the initial table copy.
+ *
+ * Returns like walrcv_receive().  When the table is copied over several
+ * connections, the messages of all of them are returned in turns.  They each
+ * hold one row, so they can be fed to a single COPY FROM in any order, after
+ * stripping the header and trailer of every binary stream.
+ */
+static int
+copy_receive(char **buffer, pgsocket *wait_fd)
+{
+	bool		progress;
+
+	if (ncopyconns == 0)
+		return walrcv_receive(LogRepWorkerWalRcvConn, buffer, wait_fd);
+
+	if (copy_binary && !copy_header_sent)
+	{
+		copy_header_sent = true;
+		*buffer = copy_binary_header;
+		return COPY_BINARY_HEADER_LEN;
+	}
+
+	do
+	{
+		bool		all_done = true;
+
+		progress = false;
+		for (int n = 0; n < ncopyconns; n++)
+		{
+			int			i = (copy_next_conn + n) % ncopyconns;
+			char	   *buf = NULL;
+			int			len;
+
+			if (copyconn_done[i])
+				continue;
+
+			len = walrcv_receive(copyconns[i], &buf, &copyconn_fds[i]);
+			if (len < 0)
+			{
+				copyconn_done[i] = true;
+				continue;
+			}
+			all_done = false;
+			if (len == 0)
+				continue;
+
+			progress = true;
+			if (copy_binary)
+			{
+				if (!copyconn_started[i])
+				{
+					if (len < COPY_BINARY_HEADER_LEN ||
+						memcmp(buf, copy_binary_header,
+							   COPY_BINARY_SIGNATURE_LEN) != 0)
+						ereport(ERROR,
+								(errcode(ERRCODE_PROTOCOL_VIOLATION),
+								 errmsg("invalid COPY data received from publisher")));
+					copyconn_started[i] = true;
+					buf += COPY_BINARY_HEADER_LEN;
+					len -= COPY_BINARY_HEADER_LEN;
+				}
+
+				if (len == COPY_BINARY_TRAILER_LEN &&
+					memcmp(buf, copy_binary_trailer,
+						   COPY_BINARY_TRAILER_LEN) == 0)
+					len = 0;
+				if (len == 0)
+					continue;
+			}
+
+			copy_next_conn = (i + 1) % ncopyconns;
+			*buffer = buf;
+			return len;
+		}
+
+		if (all_done)
+		{
+			if (copy_binary && !copy_trailer_sent)
+			{
+				copy_trailer_sent = true;
+				*buffer = copy_binary_trailer;
+				return COPY_BINARY_TRAILER_LEN;
+			}
+			return -1;
+		}
+	} while (progress);
+
+	/* copy_wait() waits for all the sockets */
+	*wait_fd = PGINVALID_SOCKET;
+	return 0;
+}
+
+/*
+ * Wait for more data of the initial table copy to arrive, or for the latch.
+ */
+static void
+copy_wait(pgsocket fd)
+{
+	WaitEventSet *wes;
+	WaitEvent	event;
+
+	if (ncopyconns == 0)
+	{
+		(void) WaitLatchOrSocket(MyLatch,
+								 WL_SOCKET_READABLE | WL_LATCH_SET |
+								 WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+								 fd, 1000L, WAIT_EVENT_LOGICAL_SYNC_DATA);
+		return;
+	}
+
+	wes = CreateWaitEventSet(CurrentResourceOwner, ncopyconns + 2);
+	AddWaitEventToSet(wes, WL_LATCH_SET, PGINVALID_SOCKET, MyLatch, NULL);
+	AddWaitEventToSet(wes, WL_EXIT_ON_PM_DEATH, PGINVALID_SOCKET, NULL, NULL);
+	for (int i = 0; i < ncopyconns; i++)
+	{
+		if (!copyconn_done[i])
+			AddWaitEventToSet(wes, WL_SOCKET_READABLE, copyconn_fds[i],
+							  NULL, NULL);
+	}
+	(void) WaitEventSetWait(wes, 1000L, &event, 1,
+							WAIT_EVENT_LOGICAL_SYNC_DATA);
+	FreeWaitEventSet(wes);
+}
+
 /*
  * Data source callback for the COPY FROM, which reads from the remote
  * connection and passes the data back to our local COPY.
@@ -669,7 +823,7 @@ copy_read_data(void *outbuf, int minread, int maxread)
 		for (;;)
 		{
 			/* Try read the data. */
-			len = walrcv_receive(LogRepWorkerWalRcvConn, &buf, &fd);
+			len = copy_receive(&buf, &fd);
 
 			CHECK_FOR_INTERRUPTS();
 
@@ -701,10 +855,7 @@ copy_read_data(void *outbuf, int minread, int maxread)
 		/*
 		 * Wait for more data or latch.
 		 */
-		(void) WaitLatchOrSocket(MyLatch,
-								 WL_SOCKET_READABLE | WL_LATCH_SET |
-								 WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
-								 fd, 1000L, WAIT_EVENT_LOGICAL_SYNC_DATA);
+		copy_wait(fd);
 
 		ResetLatch(MyLatch);
 	}
@@ -1066,6 +1217,229 @@ fetch_remote_table_info(char *nspname, char *relname, LogicalRepRelation *lrel,
 	pfree(cmd.data);
 }
 
+/*
+ * Decide how many connections to the publisher to copy the table with.
+ *
+ * A large plain table is split into ranges of blocks that are copied over
+ * separate connections, each scanning at least min_parallel_table_scan_size
+ * of it, up to max_sync_connections_per_table connections.  This requires
+ * TID range scans on the publisher, which are available since version 14.
+ */
+static int
+copy_table_connections(LogicalRepRelation *lrel, BlockNumber *nblocks)
+{
+	WalRcvExecResult *res;
+	StringInfoData cmd;
+	TupleTableSlot *slot;
+	Oid			sizeRow[] = {INT8OID};
+	bool		isnull;
+	int64		relblocks;
+	int			nconns;
+
+	if (max_sync_connections_per_table <= 1 ||
+		lrel->relkind != RELKIND_RELATION ||
+		walrcv_server_version(LogRepWorkerWalRcvConn) < 140000)
+		return 1;
+
+	initStringInfo(&cmd);
+	appendStringInfo(&cmd,
+					 "SELECT pg_catalog.pg_relation_size(%u)"
+					 " / pg_catalog.current_setting('block_size')::int",
+					 lrel->remoteid);
+	res = walrcv_exec(LogRepWorkerWalRcvConn, cmd.data,
+					  lengthof(sizeRow), sizeRow);
+	if (res->status != WALRCV_OK_TUPLES)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("could not fetch table size for table \"%s.%s\" from publisher: %s",
+						lrel->nspname, lrel->relname, res->err)));
+
+	slot = MakeSingleTupleTableSlot(res->tupledesc, &TTSOpsMinimalTuple);
+	if (!tuplestore_gettupleslot(res->tuplestore, true, false, slot))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_OBJECT),
+				 errmsg("table \"%s.%s\" not found on publisher",
+						lrel->nspname, lrel->relname)));
+
+	relblocks = DatumGetInt64(slot_getattr(slot, 1, &isnull));
+	Assert(!isnull);
+
+	ExecDropSingleTupleTableSlot(slot);
+	walrcv_clear_result(res);
+	pfree(cmd.data);
+
+	nconns = Min(relblocks / Max(min_parallel_table_scan_size, 1),
+				 max_sync_connections_per_table);
+	if (nconns <= 1)
+		return 1;
+
+	*nblocks = (BlockNumber) relblocks;
+	return nconns;
+}
+
+/*
+ * Start copying the table over 'nconns' connections to the publisher.
+ *
+ * The snapshot of the leader connection's transaction, which is consistent
+ * with the tablesync slot, is exported and used by the other connections.
+ * Each connection then runs a COPY of one range of blocks of the table;
+ * the last range is open-ended, so that the whole table is covered even if
+ * it has been extended since its size was fetched.
+ */
+static void
+start_parallel_copy(LogicalRepRelation *lrel, List *qual, bool binary,
+					BlockNumber nblocks, int nconns)
+{
+	WalRcvExecResult *res;
+	StringInfoData cmd;
+	TupleTableSlot *slot;
+	Oid			snapRow[] = {TEXTOID};
+	bool		isnull;
+	char	   *snapshot;
+	char		slotname[NAMEDATALEN];
+	bool		must_use_password;
+	BlockNumber blocks_per_conn = nblocks / nconns;
+
+	res = walrcv_exec(LogRepWorkerWalRcvConn,
+					  "SELECT pg_catalog.pg_export_snapshot()",
+					  lengthof(snapRow), snapRow);
+	if (res->status != WALRCV_OK_TUPLES)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("could not export snapshot on publisher: %s",
+						res->err)));
+	slot = MakeSingleTupleTableSlot(res->tupledesc, &TTSOpsMinimalTuple);
+	if (!tuplestore_gettupleslot(res->tuplestore, true, false, slot))
+		elog(ERROR, "no snapshot returned by publisher");
+	snapshot = TextDatumGetCString(slot_getattr(slot, 1, &isnull));
+	Assert(!isnull);
+	ExecDropSingleTupleTableSlot(slot);
+	walrcv_clear_result(res);
+
+	copyconns = palloc0_array(WalReceiverConn *, nconns);
+	copyconn_fds = palloc_array(pgsocket, nconns);
+	copyconn_started = palloc0_array(bool, nconns);
+	copyconn_done = palloc0_array(bool, nconns);
+	ncopyconns = nconns;
+	copy_next_conn = 0;
+	copy_binary = binary;
+	copy_header_sent = false;
+	copy_trailer_sent = false;
+
+	copyconns[0] = LogRepWorkerWalRcvConn;
+
+	must_use_password = MySubscription->passwordrequired &&
+		!MySubscription->ownersuperuser;
+	ReplicationSlotNameForTablesync(MySubscription->oid,
+									MyLogicalRepWorker->relid,
+									slotname, sizeof(slotname));
+
+	initStringInfo(&cmd);
+	for (int i = 0; i < nconns; i++)
+	{
+		WalReceiverConn *conn;
+
+		if (i > 0)
+		{
+			char	   *err;
+
+			conn = walrcv_connect(MySubscription->conninfo, false, false,
+								  must_use_password, slotname, &err);
+			if (conn == NULL)
+				ereport(ERROR,
+						(errcode(ERRCODE_CONNECTION_FAILURE),
+						 errmsg("table synchronization worker for subscription \"%s\" could not connect to the publisher: %s",
+								MySubscription->name, err)));
+			copyconns[i] = conn;
+
+			res = walrcv_exec(conn,
+							  "BEGIN READ ONLY ISOLATION LEVEL REPEATABLE READ",
+							  0, NULL);
+			if (res->status != WALRCV_OK_COMMAND)
+				ereport(ERROR,
+						(errcode(ERRCODE_CONNECTION_FAILURE),
+						 errmsg("table copy could not start transaction on publisher: %s",
+								res->err)));
+			walrcv_clear_result(res);
+
+			resetStringInfo(&cmd);
+			appendStringInfo(&cmd, "SET TRANSACTION SNAPSHOT %s",
+							 quote_literal_cstr(snapshot));
+			res = walrcv_exec(conn, cmd.data, 0, NULL);
+			if (res->status != WALRCV_OK_COMMAND)
+				ereport(ERROR,
+						(errcode(ERRCODE_CONNECTION_FAILURE),
+						 errmsg("could not import snapshot on publisher: %s",
+								res->err)));
+			walrcv_clear_result(res);
+		}
+		else
+			conn = LogRepWorkerWalRcvConn;
+
+		resetStringInfo(&cmd);
+		appendStringInfoString(&cmd, "COPY (SELECT ");
+		for (int j = 0; j < lrel->natts; j++)
+		{
+			if (j > 0)
+				appendStringInfoString(&cmd, ", ");
+			appendStringInfoString(&cmd, quote_identifier(lrel->attnames[j]));
+		}
+		appendStringInfo(&cmd, " FROM ONLY %s WHERE ctid >= '(%u,0)'::pg_catalog.tid",
+						 quote_qualified_identifier(lrel->nspname, lrel->relname),
+						 i * blocks_per_conn);
+		if (i < nconns - 1)
+			appendStringInfo(&cmd, " AND ctid < '(%u,0)'::pg_catalog.tid",
+							 (i + 1) * blocks_per_conn);
+
+		/* list of OR'ed filters */
+		if (qual != NIL)
+		{
+			appendStringInfoString(&cmd, " AND (");
+			foreach_node(String, q, qual)
+			{
+				if (foreach_current_index(q) > 0)
+					appendStringInfoString(&cmd, " OR ");
+				appendStringInfoString(&cmd, strVal(q));
+			}
+			appendStringInfoChar(&cmd, ')');
+		}
+
+		appendStringInfoString(&cmd, ") TO STDOUT");
+		if (binary)
+			appendStringInfoString(&cmd, " WITH (FORMAT binary)");
+
+		res = walrcv_exec(conn, cmd.data, 0, NULL);
+		if (res->status != WALRCV_OK_COPY_OUT)
+			ereport(ERROR,
+					(errcode(ERRCODE_CONNECTION_FAILURE),
+					 errmsg("could not start initial contents copy for table \"%s.%s\": %s",
+							lrel->nspname, lrel->relname, res->err)));
+		walrcv_clear_result(res);
+	}
+
+	pfree(cmd.data);
+}
+
+/*
+ * Close the additional connections used by start_parallel_copy().
+ */
+static void
+finish_parallel_copy(void)
+{
+	for (int i = 1; i < ncopyconns; i++)
+		walrcv_disconnect(copyconns[i]);
+
+	pfree(copyconns);
+	pfree(copyconn_fds);
+	pfree(copyconn_started);
+	pfree(copyconn_done);
+	copyconns = NULL;
+	copyconn_fds = NULL;
+	copyconn_started = NULL;
+	copyconn_done = NULL;
+	ncopyconns = 0;
+}
+
 /*
  * Copy existing data of a table from publisher.
  *
@@ -1084,6 +1458,9 @@ copy_table(Relation rel)
 	ParseState *pstate;
 	List	   *options = NIL;
 	bool		gencol_published = false;
+	bool		binary;
+	BlockNumber nblocks = 0;
+	int			nconns;
 
 	/* Get the publisher relation info. */
 	fetch_remote_table_info(get_namespace_name(RelationGetNamespace(rel)),
@@ -1097,11 +1474,28 @@ copy_table(Relation rel)
 	relmapentry = logicalrep_rel_open(lrel.remoteid, NoLock);
 	Assert(rel == relmapentry->localrel);
 
+	/*
+	 * Prior to v16, initial table synchronization will use text format even
+	 * if the binary option is enabled for a subscription.
+	 */
+	binary = (walrcv_server_version(LogRepWorkerWalRcvConn) >= 160000 &&
+			  MySubscription->binary);
+	if (binary)
+		options = list_make1(makeDefElem("format",
+										 (Node *) makeString("binary"), -1));
+
 	/* Start copy on the publisher. */
 	initStringInfo(&cmd);
 
+	nconns = copy_table_connections(&lrel, &nblocks);
+	if (nconns > 1)
+	{
+		elog(DEBUG1, "copying table \"%s.%s\" with %d connections",
+			 lrel.nspname, lrel.relname, nconns);
+		start_parallel_copy(&lrel, qual, binary, nblocks, nconns);
+	}
 	/* Regular or partitioned table with no row filter or generated columns */
-	if ((lrel.relkind == RELKIND_RELATION || lrel.relkind == RELKIND_PARTITIONED_TABLE)
+	else if ((lrel.relkind == RELKIND_RELATION || lrel.relkind == RELKIND_PARTITIONED_TABLE)
 		&& qual == NIL && !gencol_published)
 	{
 		appendStringInfo(&cmd, "COPY %s",
@@ -1178,26 +1572,20 @@ copy_table(Relation rel)
 		appendStringInfoString(&cmd, ") TO STDOUT");
 	}
 
-	/*
-	 * Prior to v16, initial table synchronization will use text format even
-	 * if the binary option is enabled for a subscription.
-	 */
-	if (walrcv_server_version(LogRepWorkerWalRcvConn) >= 160000 &&
-		MySubscription->binary)
+	if (nconns == 1)
 	{
-		appendStringInfoString(&cmd, " WITH (FORMAT binary)");
-		options = list_make1(makeDefElem("format",
-										 (Node *) makeString("binary"), -1));
-	}
+		if (binary)
+			appendStringInfoString(&cmd, " WITH (FORMAT binary)");
 
-	res = walrcv_exec(LogRepWorkerWalRcvConn, cmd.data, 0, NULL);
+		res = walrcv_exec(LogRepWorkerWalRcvConn, cmd.data, 0, NULL);
+		if (res->status != WALRCV_OK_COPY_OUT)
+			ereport(ERROR,
+					(errcode(ERRCODE_CONNECTION_FAILURE),
+					 errmsg("could not start initial contents copy for table \"%s.%s\": %s",
+							lrel.nspname, lrel.relname, res->err)));
+		walrcv_clear_result(res);
+	}
 	pfree(cmd.data);
-	if (res->status != WALRCV_OK_COPY_OUT)
-		ereport(ERROR,
-				(errcode(ERRCODE_CONNECTION_FAILURE),
-				 errmsg("could not start initial contents copy for table \"%s.%s\": %s",
-						lrel.nspname, lrel.relname, res->err)));
-	walrcv_clear_result(res);
 
 	copybuf = makeStringInfo();
 
@@ -1212,6 +1600,9 @@ copy_table(Relation rel)
 	(void) CopyFrom(cstate);
 	EndCopyFrom(cstate);
 
+	if (nconns > 1)
+		finish_parallel_copy();
+
 	logicalrep_rel_close(relmapentry, NoLock);
 }
 
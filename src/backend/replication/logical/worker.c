@@ -2732,6 +2732,145 @@ apply_handle_insert(StringInfo s)
 	end_replication_step();
 }
 
+/*
+ * Handle INSERT BATCH message.
+ *
+ * The executor state is set up only once for the whole batch.  If possible,
+ * the tuples are stored with a single table_multi_insert() call, like COPY
+ * does, and inserted into the indexes after that; otherwise they are
+ * inserted one by one, like with separate INSERT messages.
+ */
+static void
+apply_handle_insert_batch(StringInfo s)
+{
+	LogicalRepRelMapEntry *rel;
+	LogicalRepTupleData *newtups;
+	int			ntuples;
+	LogicalRepRelId relid;
+	UserContext ucxt;
+	ApplyExecutionData *edata;
+	EState	   *estate;
+	TupleTableSlot *remoteslot;
+	MemoryContext oldctx;
+	bool		run_as_owner;
+	bool		partitioned;
+	bool		multi_insert;
+	TriggerDesc *trigdesc;
+	TupleTableSlot **slots = NULL;
+
+	/*
+	 * Quick return if we are skipping data modification changes or handling
+	 * streamed transactions.
+	 */
+	if (is_skipping_changes() ||
+		handle_streamed_transaction(LOGICAL_REP_MSG_INSERT_BATCH, s))
+		return;
+
+	begin_replication_step();
+
+	relid = logicalrep_read_insert_batch(s, &ntuples, &newtups);
+	rel = logicalrep_rel_open(relid, RowExclusiveLock);
+	if (!should_apply_changes_for_rel(rel))
+	{
+		/*
+		 * The relation can't become interesting in the middle of the
+		 * transaction so it's safe to unlock it.
+		 */
+		logicalrep_rel_close(rel, RowExclusiveLock);
+		end_replication_step();
+		return;
+	}
+
+	/*
+	 * Make sure that any user-supplied code runs as the table owner, unless
+	 * the user has opted out of that behavior.
+	 */
+	run_as_owner = MySubscription->runasowner;
+	if (!run_as_owner)
+		SwitchToUntrustedUser(rel->localrel->rd_rel->relowner, &ucxt);
+
+	/* Set relation for error callback */
+	apply_error_callback_arg.rel = rel;
+
+	/* Initialize the executor state. */
+	edata = create_edata_for_relation(rel);
+	estate = edata->estate;
+	remoteslot = ExecInitExtraTupleSlot(estate,
+										RelationGetDescr(rel->localrel),
+										&TTSOpsVirtual);
+
+	partitioned = (rel->localrel->rd_rel->relkind == RELKIND_PARTITIONED_TABLE);
+	if (!partitioned)
+		ExecOpenIndices(edata->targetRelInfo, false);
+
+	/*
+	 * BEFORE ROW triggers could see the effects of later tuples of the batch
+	 * if we used multi-insert, so only do that without them.  Tuples routed
+	 * to partitions are inserted one by one.
+	 */
+	trigdesc = edata->targetRelInfo->ri_TrigDesc;
+	multi_insert = (!partitioned && ntuples > 1 &&
+					(trigdesc == NULL ||
+					 (!trigdesc->trig_insert_before_row &&
+					  !trigdesc->trig_insert_instead_row)));
+	if (multi_insert)
+		slots = palloc_array(TupleTableSlot *, ntuples);
+
+	for (int i = 0; i < ntuples; i++)
+	{
+		ResetPerTupleExprContext(estate);
+
+		/* Process and store remote tuple in the slot */
+		oldctx = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+		slot_store_data(remoteslot, rel, &newtups[i]);
+		slot_fill_defaults(rel, estate, remoteslot);
+		MemoryContextSwitchTo(oldctx);
+
+		/*
+		 * With multi-insert, make a copy of the tuple that outlives the
+		 * per-tuple memory context.
+		 */
+		if (multi_insert)
+		{
+			slots[i] = table_slot_create(rel->localrel, &estate->es_tupleTable);
+			ExecCopySlot(slots[i], remoteslot);
+		}
+		/* For a partitioned table, insert the tuple into a partition. */
+		else if (partitioned)
+			apply_handle_tuple_routing(edata,
+									   remoteslot, NULL, CMD_INSERT);
+		else
+			apply_handle_insert_internal(edata, edata->targetRelInfo,
+										 remoteslot);
+	}
+
+	if (multi_insert)
+	{
+		ResultRelInfo *relinfo = edata->targetRelInfo;
+
+		ResetPerTupleExprContext(estate);
+
+		InitConflictIndexes(relinfo);
+		TargetPrivilegesCheck(relinfo->ri_RelationDesc, ACL_INSERT);
+		ExecSimpleRelationMultiInsert(relinfo, estate, slots, ntuples);
+	}
+
+	if (!partitioned)
+		ExecCloseIndices(edata->targetRelInfo);
+
+	finish_edata(edata);
+
+	/* Reset relation for error callback */
+	apply_error_callback_arg.rel = NULL;
+
+	if (!run_as_owner)
+		RestoreUserContext(&ucxt);
+
+	logicalrep_rel_close(rel, NoLock);
+
+	end_replication_step();
+}
+
 /*
  * Workhorse for apply_handle_insert()
  * relinfo is for the relation we're actually inserting into
@@ -2749,9 +2888,12 @@ apply_handle_insert_internal(ApplyExecutionData *edata,
 		   !relinfo->ri_RelationDesc->rd_rel->relhasindex ||
 		   RelationGetIndexList(relinfo->ri_RelationDesc) == NIL);
 
-	/* Caller will not have done this bit. */
-	Assert(relinfo->ri_onConflictArbiterIndexes == NIL);
-	InitConflictIndexes(relinfo);
+	/*
+	 * Caller will not have done this bit, unless this is not the first tuple
+	 * of an insert batch.
+	 */
+	if (relinfo->ri_onConflictArbiterIndexes == NIL)
+		InitConflictIndexes(relinfo);
 
 	/* Do the insert. */
 	TargetPrivilegesCheck(relinfo->ri_RelationDesc, ACL_INSERT);
@@ -3389,15 +3531,25 @@ apply_handle_tuple_routing(ApplyExecutionData *edata,
 	LogicalRepRelMapEntry *part_entry = NULL;
 	AttrMap    *attrmap = NULL;
 
-	/* ModifyTableState is needed for ExecFindPartition(). */
-	edata->mtstate = mtstate = makeNode(ModifyTableState);
-	mtstate->ps.plan = NULL;
-	mtstate->ps.state = estate;
-	mtstate->operation = operation;
-	mtstate->resultRelInfo = relinfo;
-
-	/* ... as is PartitionTupleRouting. */
-	edata->proute = proute = ExecSetupPartitionTupleRouting(estate, parentrel);
+	/*
+	 * ModifyTableState is needed for ExecFindPartition(), as is
+	 * PartitionTupleRouting.  They are set up only once when applying an
+	 * insert batch.
+	 */
+	if (edata->proute == NULL)
+	{
+		mtstate = makeNode(ModifyTableState);
+		mtstate->ps.plan = NULL;
+		mtstate->ps.state = estate;
+		mtstate->operation = operation;
+		mtstate->resultRelInfo = relinfo;
+		edata->mtstate = mtstate;
+
+		edata->proute = ExecSetupPartitionTupleRouting(estate, parentrel);
+	}
+	mtstate = edata->mtstate;
+	proute = edata->proute;
+	Assert(mtstate->operation == operation);
 
 	/*
 	 * Find the partition to which the "search tuple" belongs.
@@ -3821,6 +3973,10 @@ apply_dispatch(StringInfo s)
 			apply_handle_insert(s);
 			break;
 
+		case LOGICAL_REP_MSG_INSERT_BATCH:
+			apply_handle_insert_batch(s);
+			break;
+
 		case LOGICAL_REP_MSG_UPDATE:
 			apply_handle_update(s);
 			break;
@@ -5582,6 +5738,7 @@ set_stream_options(WalRcvStreamOptions *options,
 
 	server_version = walrcv_server_version(LogRepWorkerWalRcvConn);
 	options->proto.logical.proto_version =
+		server_version >= 190000 ? LOGICALREP_PROTO_BATCH_VERSION_NUM :
 		server_version >= 160000 ? LOGICALREP_PROTO_STREAM_PARALLEL_VERSION_NUM :
 		server_version >= 150000 ? LOGICALREP_PROTO_TWOPHASE_VERSION_NUM :
 		server_version >= 140000 ? LOGICALREP_PROTO_STREAM_VERSION_NUM :
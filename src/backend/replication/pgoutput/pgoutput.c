@@ -88,6 +88,7 @@ static bool publications_valid;
 static List *LoadPublications(List *pubnames);
 static void publication_invalidation_cb(Datum arg, SysCacheIdentifier cacheid,
 										uint32 hashvalue);
+static void pgoutput_send_insert_batch(LogicalDecodingContext *ctx);
 static void send_repl_origin(LogicalDecodingContext *ctx,
 							 ReplOriginId origin_id, XLogRecPtr origin_lsn,
 							 bool send_origin);
@@ -468,6 +469,11 @@ pgoutput_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
 										 "logical replication publication list context",
 										 ALLOCSET_SMALL_SIZES);
 
+	data->insert_batch = palloc0_object(LogicalRepInsertBatch);
+	data->insert_batch->context = AllocSetContextCreate(ctx->context,
+														"logical replication insert batch context",
+														ALLOCSET_DEFAULT_SIZES);
+
 	/*
 	 * Ensure to cleanup RelationSyncCache even when logical decoding invoked
 	 * via SQL interface ends up with an error.
@@ -637,6 +643,8 @@ pgoutput_commit_txn(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 
 	Assert(txndata);
 
+	pgoutput_send_insert_batch(ctx);
+
 	/*
 	 * We don't need to send the commit message unless some relevant change
 	 * from this transaction has been sent to the downstream.
@@ -681,6 +689,8 @@ static void
 pgoutput_prepare_txn(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 					 XLogRecPtr prepare_lsn)
 {
+	pgoutput_send_insert_batch(ctx);
+
 	OutputPluginUpdateProgress(ctx, false);
 
 	OutputPluginPrepareWrite(ctx, true);
@@ -770,6 +780,9 @@ maybe_send_schema(LogicalDecodingContext *ctx,
 	if (schema_sent)
 		return;
 
+	/* The batched INSERTs must be sent before the new schema */
+	pgoutput_send_insert_batch(ctx);
+
 	/*
 	 * Send the schema.  If the changes will be published using an ancestor's
 	 * schema, not the relation's own, send that ancestor's schema before
@@ -1605,6 +1618,36 @@ pgoutput_change(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 	 */
 	maybe_send_schema(ctx, change, relation, relentry);
 
+	/*
+	 * With protocol version 5 and higher, consecutive INSERTs into the same
+	 * relation are collected into a batch that is sent as a single INSERT
+	 * BATCH message, when a change that cannot be added to it comes along or
+	 * when the batch is full.
+	 */
+	if (data->protocol_version >= LOGICALREP_PROTO_BATCH_VERSION_NUM)
+	{
+		LogicalRepInsertBatch *batch = data->insert_batch;
+
+		if (batch->ntuples > 0 &&
+			(action != REORDER_BUFFER_CHANGE_INSERT ||
+			 batch->relid != RelationGetRelid(targetrel) ||
+			 batch->xid != xid))
+			pgoutput_send_insert_batch(ctx);
+
+		if (action == REORDER_BUFFER_CHANGE_INSERT)
+		{
+			logicalrep_insert_batch_add(batch, xid, targetrel, new_slot,
+										data->binary, relentry->columns,
+										relentry->include_gencols_type);
+
+			if (batch->ntuples >= LOGICALREP_INSERT_BATCH_MAX_TUPLES ||
+				batch->size >= LOGICALREP_INSERT_BATCH_MAX_SIZE)
+				pgoutput_send_insert_batch(ctx);
+
+			goto cleanup;
+		}
+	}
+
 	OutputPluginPrepareWrite(ctx, true);
 
 	/* Send the data */
@@ -1706,6 +1749,8 @@ pgoutput_truncate(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 
 	if (nrelids > 0)
 	{
+		pgoutput_send_insert_batch(ctx);
+
 		OutputPluginPrepareWrite(ctx, true);
 		logicalrep_write_truncate(ctx->out,
 								  xid,
@@ -1750,6 +1795,8 @@ pgoutput_message(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 			pgoutput_send_begin(ctx, txn);
 	}
 
+	pgoutput_send_insert_batch(ctx);
+
 	OutputPluginPrepareWrite(ctx, true);
 	logicalrep_write_message(ctx->out,
 							 xid,
@@ -1761,6 +1808,26 @@ pgoutput_message(LogicalDecodingContext *ctx, ReorderBufferTXN *txn,
 	OutputPluginWrite(ctx, true);
 }
 
+/*
+ * Send the INSERTs collected by pgoutput_change() as an INSERT BATCH
+ * message, if there are any.
+ *
+ * This must be done before sending anything else, so that the changes reach
+ * the subscriber in the order they were made.
+ */
+static void
+pgoutput_send_insert_batch(LogicalDecodingContext *ctx)
+{
+	PGOutputData *data = (PGOutputData *) ctx->output_plugin_private;
+
+	if (data->insert_batch == NULL || data->insert_batch->ntuples == 0)
+		return;
+
+	OutputPluginPrepareWrite(ctx, true);
+	logicalrep_write_insert_batch(ctx->out, data->insert_batch);
+	OutputPluginWrite(ctx, true);
+}
+
 /*
  * Return true if the data is associated with an origin and the user has
  * requested the changes that don't have an origin, false otherwise.
@@ -1878,6 +1945,8 @@ pgoutput_stream_stop(struct LogicalDecodingContext *ctx,
 	/* we should be streaming a transaction */
 	Assert(data->in_streaming);
 
+	pgoutput_send_insert_batch(ctx);
+
 	OutputPluginPrepareWrite(ctx, true);
 	logicalrep_write_stream_stop(ctx->out);
 	OutputPluginWrite(ctx, true);
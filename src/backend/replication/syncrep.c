@@ -63,6 +63,13 @@
  * the standbys which are considered as synchronous at that moment
  * will release waiters from the queue.
  *
+ * With many concurrent committers, SyncRepLock is the main point of
+ * contention, so we keep the work done while holding it to a minimum.  The
+ * confirmed LSNs are published as atomics, letting backends whose commit is
+ * already covered skip the queue entirely, and walsenders only unlink the
+ * released waiters while holding the lock; their latches are set as a group
+ * after it has been released.
+ *
  * Portions Copyright (c) 2010-2026, PostgreSQL Global Development Group
  *
  * IDENTIFICATION
@@ -84,6 +91,7 @@
 #include "storage/proc.h"
 #include "tcop/tcopprot.h"
 #include "utils/guc_hooks.h"
+#include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/wait_event.h"
 
@@ -95,12 +103,21 @@ char	   *SyncRepStandbyNames;
 
 static bool announce_next_takeover = true;
 
+/*
+ * Waiters released by SyncRepWakeQueue() whose latches are still to be set,
+ * see SyncRepWakeReleased().
+ */
+static ProcNumber *SyncRepReleased = NULL;
+static int	SyncRepNumReleased = 0;
+
 SyncRepConfigData *SyncRepConfig = NULL;
 static int	SyncRepWaitMode = SYNC_REP_NO_WAIT;
 
 static void SyncRepQueueInsert(int mode);
 static void SyncRepCancelWait(void);
 static int	SyncRepWakeQueue(bool all, int mode);
+static void SyncRepPrepareWake(void);
+static void SyncRepWakeReleased(void);
 
 static bool SyncRepGetSyncRecPtr(XLogRecPtr *writePtr,
 								 XLogRecPtr *flushPtr,
@@ -149,6 +166,7 @@ void
 SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 {
 	int			mode;
+	TimestampTz waitStart;
 
 	/*
 	 * This should be called while holding interrupts during a transaction
@@ -190,6 +208,18 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 	Assert(dlist_node_is_detached(&MyProc->syncRepLinks));
 	Assert(WalSndCtl != NULL);
 
+	/*
+	 * If the standbys have already confirmed this LSN, which is common when
+	 * many backends commit concurrently, we're done without touching the
+	 * lock.  The published LSN never goes backwards, so this is safe no
+	 * matter what the rest of the shared state looks like.
+	 */
+	if (lsn <= pg_atomic_read_u64(&WalSndCtl->lsn[mode]))
+		return;
+
+	/* Read the clock before taking the lock, to keep it held briefly */
+	waitStart = GetCurrentTimestamp();
+
 	LWLockAcquire(SyncRepLock, LW_EXCLUSIVE);
 	Assert(MyProc->syncRepState == SYNC_REP_NOT_WAITING);
 
@@ -208,13 +238,13 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 	if (WalSndCtl->sync_standbys_status & SYNC_STANDBY_INIT)
 	{
 		if ((WalSndCtl->sync_standbys_status & SYNC_STANDBY_DEFINED) == 0 ||
-			lsn <= WalSndCtl->lsn[mode])
+			lsn <= pg_atomic_read_u64(&WalSndCtl->lsn[mode]))
 		{
 			LWLockRelease(SyncRepLock);
 			return;
 		}
 	}
-	else if (lsn <= WalSndCtl->lsn[mode])
+	else if (lsn <= pg_atomic_read_u64(&WalSndCtl->lsn[mode]))
 	{
 		/*
 		 * The LSN is older than what we need to wait for.  The sync standby
@@ -249,6 +279,7 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 	 * ourselves to the queue.
 	 */
 	MyProc->waitLSN = lsn;
+	MyProc->syncRepWaitStart = waitStart;
 	MyProc->syncRepState = SYNC_REP_WAITING;
 	SyncRepQueueInsert(mode);
 	Assert(SyncRepQueueIsOrderedByLSN(mode));
@@ -483,7 +514,6 @@ SyncRepInitConfig(void)
 void
 SyncRepReleaseWaiters(void)
 {
-	volatile WalSndCtlData *walsndctl = WalSndCtl;
 	XLogRecPtr	writePtr;
 	XLogRecPtr	flushPtr;
 	XLogRecPtr	applyPtr;
@@ -513,6 +543,7 @@ SyncRepReleaseWaiters(void)
 	 * We're a potential sync standby. Release waiters if there are enough
 	 * sync standbys and we are considered as sync.
 	 */
+	SyncRepPrepareWake();
 	LWLockAcquire(SyncRepLock, LW_EXCLUSIVE);
 
 	/*
@@ -558,24 +589,26 @@ SyncRepReleaseWaiters(void)
 	 * Set the lsn first so that when we wake backends they will release up to
 	 * this location.
 	 */
-	if (walsndctl->lsn[SYNC_REP_WAIT_WRITE] < writePtr)
+	if (pg_atomic_read_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_WRITE]) < writePtr)
 	{
-		walsndctl->lsn[SYNC_REP_WAIT_WRITE] = writePtr;
+		pg_atomic_write_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_WRITE], writePtr);
 		numwrite = SyncRepWakeQueue(false, SYNC_REP_WAIT_WRITE);
 	}
-	if (walsndctl->lsn[SYNC_REP_WAIT_FLUSH] < flushPtr)
+	if (pg_atomic_read_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_FLUSH]) < flushPtr)
 	{
-		walsndctl->lsn[SYNC_REP_WAIT_FLUSH] = flushPtr;
+		pg_atomic_write_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_FLUSH], flushPtr);
 		numflush = SyncRepWakeQueue(false, SYNC_REP_WAIT_FLUSH);
 	}
-	if (walsndctl->lsn[SYNC_REP_WAIT_APPLY] < applyPtr)
+	if (pg_atomic_read_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_APPLY]) < applyPtr)
 	{
-		walsndctl->lsn[SYNC_REP_WAIT_APPLY] = applyPtr;
+		pg_atomic_write_u64(&WalSndCtl->lsn[SYNC_REP_WAIT_APPLY], applyPtr);
 		numapply = SyncRepWakeQueue(false, SYNC_REP_WAIT_APPLY);
 	}
 
 	LWLockRelease(SyncRepLock);
 
+	SyncRepWakeReleased();
+
 	elog(DEBUG3, "released %d procs up to write %X/%08X, %d procs up to flush %X/%08X, %d procs up to apply %X/%08X",
 		 numwrite, LSN_FORMAT_ARGS(writePtr),
 		 numflush, LSN_FORMAT_ARGS(flushPtr),
@@ -906,22 +939,32 @@ SyncRepGetStandbyPriority(void)
 
 /*
  * Walk the specified queue from head.  Set the state of any backends that
- * need to be woken, remove them from the queue, and then wake them.
- * Pass all = true to wake whole queue; otherwise, just wake up to
- * the walsender's LSN.
+ * need to be woken and remove them from the queue.  Pass all = true to wake
+ * whole queue; otherwise, just wake up to the walsender's LSN.
+ *
+ * The released backends are remembered, and the caller must wake them up
+ * with SyncRepWakeReleased() once it has released the lock.  The caller must
+ * have called SyncRepPrepareWake() before acquiring it.
+ *
+ * When called by a walsender, the time each released backend spent waiting
+ * is added to the walsender's statistics.
  *
  * The caller must hold SyncRepLock in exclusive mode.
  */
 static int
 SyncRepWakeQueue(bool all, int mode)
 {
-	volatile WalSndCtlData *walsndctl = WalSndCtl;
+	XLogRecPtr	lsn = pg_atomic_read_u64(&WalSndCtl->lsn[mode]);
 	int			numprocs = 0;
 	dlist_mutable_iter iter;
+	TimestampTz now = 0;
+	uint64		waittime = 0;
+	uint64		buckets[SYNC_REP_WAIT_BUCKETS] = {0};
 
 	Assert(mode >= 0 && mode < NUM_SYNC_REP_WAIT_MODE);
 	Assert(LWLockHeldByMeInMode(SyncRepLock, LW_EXCLUSIVE));
 	Assert(SyncRepQueueIsOrderedByLSN(mode));
+	Assert(SyncRepReleased != NULL);
 
 	dlist_foreach_modify(iter, &WalSndCtl->SyncRepQueue[mode])
 	{
@@ -930,8 +973,30 @@ SyncRepWakeQueue(bool all, int mode)
 		/*
 		 * Assume the queue is ordered by LSN
 		 */
-		if (!all && walsndctl->lsn[mode] < proc->waitLSN)
-			return numprocs;
+		if (!all && lsn < proc->waitLSN)
+			break;
+
+		if (MyWalSnd != NULL)
+		{
+			long		secs;
+			int			usecs;
+			uint64		elapsed;
+			uint64		limit = 100;
+			int			bucket = 0;
+
+			if (now == 0)
+				now = GetCurrentTimestamp();
+			TimestampDifference(proc->syncRepWaitStart, now, &secs, &usecs);
+			elapsed = (uint64) secs * USECS_PER_SEC + usecs;
+
+			while (bucket < SYNC_REP_WAIT_BUCKETS - 1 && elapsed >= limit)
+			{
+				bucket++;
+				limit *= 10;
+			}
+			buckets[bucket]++;
+			waittime += elapsed;
+		}
 
 		/*
 		 * Remove from queue.
@@ -952,16 +1017,63 @@ SyncRepWakeQueue(bool all, int mode)
 		proc->syncRepState = SYNC_REP_WAIT_COMPLETE;
 
 		/*
-		 * Wake only when we have set state and removed from queue.
+		 * Wake only when we have set state and removed from queue.  That's
+		 * normally left to SyncRepWakeReleased(), but do it right away if we
+		 * have run out of space to remember it.
 		 */
-		SetLatch(&(proc->procLatch));
+		if (SyncRepNumReleased < MaxBackends)
+			SyncRepReleased[SyncRepNumReleased++] = GetNumberFromPGProc(proc);
+		else
+			SetLatch(&(proc->procLatch));
 
 		numprocs++;
 	}
 
+	if (MyWalSnd != NULL && numprocs > 0)
+	{
+		SpinLockAcquire(&MyWalSnd->mutex);
+		MyWalSnd->syncWaitCount += numprocs;
+		MyWalSnd->syncWaitTime += waittime;
+		for (int i = 0; i < SYNC_REP_WAIT_BUCKETS; i++)
+			MyWalSnd->syncWaitBuckets[i] += buckets[i];
+		SpinLockRelease(&MyWalSnd->mutex);
+	}
+
 	return numprocs;
 }
 
+/*
+ * Make sure there's space to remember the backends released by
+ * SyncRepWakeQueue().  Must be called before acquiring SyncRepLock, since we
+ * don't want to allocate memory while holding it.
+ */
+static void
+SyncRepPrepareWake(void)
+{
+	/* A backend can only be in one queue at a time */
+	if (SyncRepReleased == NULL)
+		SyncRepReleased = MemoryContextAlloc(TopMemoryContext,
+											 sizeof(ProcNumber) * MaxBackends);
+	SyncRepNumReleased = 0;
+}
+
+/*
+ * Wake up the backends released by SyncRepWakeQueue().
+ *
+ * This is done after releasing SyncRepLock, so that new waiters don't have
+ * to wait for a potentially large group of latches to be set.  The released
+ * backends may see their state change before their latch is set, and might
+ * even have moved on to a new wait, but that is harmless: they just see a
+ * spurious wakeup.
+ */
+static void
+SyncRepWakeReleased(void)
+{
+	for (int i = 0; i < SyncRepNumReleased; i++)
+		SetLatch(&GetPGProcByNumber(SyncRepReleased[i])->procLatch);
+	SyncRepNumReleased = 0;
+}
+
 /*
  * The checkpointer calls this as needed to update the shared
  * sync_standbys_status flag, so that backends don't remain permanently wedged
@@ -977,6 +1089,7 @@ SyncRepUpdateSyncStandbysDefined(void)
 	if (sync_standbys_defined !=
 		((WalSndCtl->sync_standbys_status & SYNC_STANDBY_DEFINED) != 0))
 	{
+		SyncRepPrepareWake();
 		LWLockAcquire(SyncRepLock, LW_EXCLUSIVE);
 
 		/*
@@ -1003,6 +1116,8 @@ SyncRepUpdateSyncStandbysDefined(void)
 			(sync_standbys_defined ? SYNC_STANDBY_DEFINED : 0);
 
 		LWLockRelease(SyncRepLock);
+
+		SyncRepWakeReleased();
 	}
 	else if ((WalSndCtl->sync_standbys_status & SYNC_STANDBY_INIT) == 0)
 	{
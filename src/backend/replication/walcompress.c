@@ -0,0 +1,319 @@
+/*-------------------------------------------------------------------------
+ *
+ * walcompress.c
+ *		Streaming compression of WAL sent over physical replication.
+ *
+ * A walsender that has been asked to compress the stream runs each chunk of
+ * WAL it sends through a compression context that lives for the whole
+ * duration of START_REPLICATION, and the walreceiver runs the chunks through
+ * a matching decompression context.  Because the contexts are never reset
+ * between messages, the compressor can find matches in WAL that was sent in
+ * earlier messages, which matters a lot for WAL: the chunks are at most
+ * MAX_SEND_SIZE bytes, and are often much smaller than that when the
+ * standby is caught up.
+ *
+ * For zstd, that is just a single frame that is never ended; every message
+ * is flushed with ZSTD_e_flush so that the receiver can decode it fully.
+ * For lz4 we use the block streaming API, and keep the last 64kB of the
+ * stream around as the dictionary for the next block on both sides.
+ *
+ * Portions Copyright (c) 2010-2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/replication/walcompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "replication/walcompress.h"
+#include "utils/memutils.h"
+
+/* Size of the history kept by lz4 streams, the maximum lz4 offset */
+#define WAL_LZ4_DICT_SIZE	(64 * 1024)
+
+struct WalStreamCompressor
+{
+	pg_compress_algorithm algorithm;
+	bool		decompress;
+
+#ifdef USE_LZ4
+	LZ4_stream_t *lz4_stream;	/* compression side only */
+	char	   *lz4_dict;
+	int			lz4_dict_len;	/* decompression side only */
+#endif
+#ifdef USE_ZSTD
+	ZSTD_CCtx  *zstd_cctx;
+	ZSTD_DCtx  *zstd_dctx;
+#endif
+};
+
+/*
+ * Is the given algorithm usable for streaming WAL in this build?
+ */
+bool
+WalStreamCompressionSupported(pg_compress_algorithm algorithm)
+{
+	switch (algorithm)
+	{
+		case PG_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			return true;
+#else
+			return false;
+#endif
+		case PG_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return false;
+	}
+}
+
+/*
+ * Set up a compression or decompression context for a new stream.
+ *
+ * The caller must have checked WalStreamCompressionSupported().
+ */
+WalStreamCompressor *
+WalStreamCompressorCreate(pg_compress_algorithm algorithm, bool decompress)
+{
+	WalStreamCompressor *ws;
+
+	Assert(WalStreamCompressionSupported(algorithm));
+
+	ws = MemoryContextAllocZero(TopMemoryContext, sizeof(WalStreamCompressor));
+	ws->algorithm = algorithm;
+	ws->decompress = decompress;
+
+	switch (algorithm)
+	{
+		case PG_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			ws->lz4_dict = MemoryContextAlloc(TopMemoryContext,
+											  WAL_LZ4_DICT_SIZE);
+			if (!decompress)
+			{
+				ws->lz4_stream = LZ4_createStream();
+				if (ws->lz4_stream == NULL)
+					elog(ERROR, "could not create lz4 compression context");
+			}
+#endif
+			break;
+		case PG_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			if (decompress)
+			{
+				ws->zstd_dctx = ZSTD_createDCtx();
+				if (ws->zstd_dctx == NULL)
+					elog(ERROR, "could not create zstd decompression context");
+			}
+			else
+			{
+				ws->zstd_cctx = ZSTD_createCCtx();
+				if (ws->zstd_cctx == NULL)
+					elog(ERROR, "could not create zstd compression context");
+			}
+#endif
+			break;
+		default:
+			elog(ERROR, "unsupported WAL stream compression algorithm %d",
+				 (int) algorithm);
+	}
+
+	return ws;
+}
+
+/*
+ * Release a context created by WalStreamCompressorCreate().
+ */
+void
+WalStreamCompressorFree(WalStreamCompressor *ws)
+{
+#ifdef USE_LZ4
+	if (ws->lz4_stream)
+		LZ4_freeStream(ws->lz4_stream);
+	if (ws->lz4_dict)
+		pfree(ws->lz4_dict);
+#endif
+#ifdef USE_ZSTD
+	if (ws->zstd_cctx)
+		ZSTD_freeCCtx(ws->zstd_cctx);
+	if (ws->zstd_dctx)
+		ZSTD_freeDCtx(ws->zstd_dctx);
+#endif
+	pfree(ws);
+}
+
+/*
+ * Compress 'srclen' bytes at 'src' as the next chunk of the stream, and
+ * append the result to 'dst'.  Returns the compressed size.
+ */
+size_t
+WalStreamCompress(WalStreamCompressor *ws, const char *src, size_t srclen,
+				  StringInfo dst)
+{
+	Assert(!ws->decompress);
+
+	switch (ws->algorithm)
+	{
+#ifdef USE_LZ4
+		case PG_COMPRESSION_LZ4:
+			{
+				int			bound = LZ4_compressBound((int) srclen);
+				int			len;
+
+				enlargeStringInfo(dst, bound);
+				len = LZ4_compress_fast_continue(ws->lz4_stream, src,
+												 &dst->data[dst->len],
+												 (int) srclen, bound, 1);
+				if (len <= 0)
+					elog(ERROR, "could not compress WAL data with lz4");
+				dst->len += len;
+
+				/*
+				 * The source buffer is about to be overwritten with the next
+				 * chunk, so move the history the next block may refer to
+				 * into memory we own.
+				 */
+				LZ4_saveDict(ws->lz4_stream, ws->lz4_dict, WAL_LZ4_DICT_SIZE);
+
+				return len;
+			}
+#endif
+#ifdef USE_ZSTD
+		case PG_COMPRESSION_ZSTD:
+			{
+				ZSTD_inBuffer in = {src, srclen, 0};
+				size_t		start = dst->len;
+				size_t		ret;
+
+				enlargeStringInfo(dst, ZSTD_compressBound(srclen));
+				for (;;)
+				{
+					ZSTD_outBuffer out;
+
+					out.dst = &dst->data[dst->len];
+					out.size = dst->maxlen - dst->len - 1;
+					out.pos = 0;
+
+					ret = ZSTD_compressStream2(ws->zstd_cctx, &out, &in,
+											   ZSTD_e_flush);
+					if (ZSTD_isError(ret))
+						elog(ERROR, "could not compress WAL data with zstd: %s",
+							 ZSTD_getErrorName(ret));
+					dst->len += out.pos;
+
+					/* done when all input is consumed and flushed out */
+					if (ret == 0 && in.pos == in.size)
+						break;
+					enlargeStringInfo(dst, ret > 0 ? ret : BLCKSZ);
+				}
+				dst->data[dst->len] = '\0';
+
+				return dst->len - start;
+			}
+#endif
+		default:
+			elog(ERROR, "unsupported WAL stream compression algorithm %d",
+				 (int) ws->algorithm);
+	}
+
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * Decompress the next chunk of the stream, 'srclen' bytes at 'src', into
+ * 'dst'.  The chunk must decompress to exactly 'rawlen' bytes.
+ *
+ * The input comes from the network, so a failure here is reported as a
+ * protocol violation.
+ */
+void
+WalStreamDecompress(WalStreamCompressor *ws, const char *src, size_t srclen,
+					char *dst, size_t rawlen)
+{
+	Assert(ws->decompress);
+
+	switch (ws->algorithm)
+	{
+#ifdef USE_LZ4
+		case PG_COMPRESSION_LZ4:
+			{
+				int			len;
+
+				len = LZ4_decompress_safe_usingDict(src, dst, (int) srclen,
+													(int) rawlen,
+													ws->lz4_dict,
+													ws->lz4_dict_len);
+				if (len < 0 || (size_t) len != rawlen)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg("could not decompress WAL data received from primary using lz4")));
+
+				/* Keep the last WAL_LZ4_DICT_SIZE bytes of the stream */
+				if (rawlen >= WAL_LZ4_DICT_SIZE)
+				{
+					memcpy(ws->lz4_dict, dst + rawlen - WAL_LZ4_DICT_SIZE,
+						   WAL_LZ4_DICT_SIZE);
+					ws->lz4_dict_len = WAL_LZ4_DICT_SIZE;
+				}
+				else
+				{
+					int			keep = Min(ws->lz4_dict_len,
+										   WAL_LZ4_DICT_SIZE - (int) rawlen);
+
+					memmove(ws->lz4_dict,
+							ws->lz4_dict + ws->lz4_dict_len - keep, keep);
+					memcpy(ws->lz4_dict + keep, dst, rawlen);
+					ws->lz4_dict_len = keep + (int) rawlen;
+				}
+				break;
+			}
+#endif
+#ifdef USE_ZSTD
+		case PG_COMPRESSION_ZSTD:
+			{
+				ZSTD_inBuffer in = {src, srclen, 0};
+				ZSTD_outBuffer out = {dst, rawlen, 0};
+
+				while (in.pos < in.size)
+				{
+					size_t		in_pos = in.pos;
+					size_t		out_pos = out.pos;
+					size_t		ret;
+
+					ret = ZSTD_decompressStream(ws->zstd_dctx, &out, &in);
+					if (ZSTD_isError(ret))
+						ereport(ERROR,
+								(errcode(ERRCODE_PROTOCOL_VIOLATION),
+								 errmsg("could not decompress WAL data received from primary using zstd: %s",
+										ZSTD_getErrorName(ret))));
+
+					/* no progress means the chunk is longer than announced */
+					if (in.pos == in_pos && out.pos == out_pos)
+						break;
+				}
+				if (in.pos != in.size || out.pos != rawlen)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg("could not decompress WAL data received from primary using zstd: %s",
+									"unexpected decompressed length")));
+				break;
+			}
+#endif
+		default:
+			elog(ERROR, "unsupported WAL stream compression algorithm %d",
+				 (int) ws->algorithm);
+	}
+}
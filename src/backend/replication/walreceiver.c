@@ -66,6 +66,7 @@
 #include "pgstat.h"
 #include "postmaster/auxprocess.h"
 #include "postmaster/interrupt.h"
+#include "replication/walcompress.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
 #include "storage/ipc.h"
@@ -76,6 +77,7 @@
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
+#include "utils/memutils.h"
 #include "utils/pg_lsn.h"
 #include "utils/ps_status.h"
 #include "utils/timestamp.h"
@@ -90,6 +92,7 @@
 int			wal_receiver_status_interval;
 int			wal_receiver_timeout;
 bool		hot_standby_feedback;
+int			wal_receiver_compression = PG_COMPRESSION_NONE;
 
 /* libpqwalreceiver connection */
 static WalReceiverConn *wrconn = NULL;
@@ -104,6 +107,14 @@ static int	recvFile = -1;
 static TimeLineID recvFileTLI = 0;
 static XLogSegNo recvSegNo = 0;
 
+/*
+ * Decompression context of the current stream if it is compressed, and a
+ * buffer to decompress each chunk of WAL into before writing it out.
+ */
+static WalStreamCompressor *wal_decompressor = NULL;
+static char *decompress_buf = NULL;
+static Size decompress_buf_size = 0;
+
 /*
  * LogstreamResult indicates the byte positions that we have already
  * written/fsynced.
@@ -144,6 +155,7 @@ static void XLogWalRcvWrite(char *buf, Size nbytes, XLogRecPtr recptr,
 static void XLogWalRcvFlush(bool dying, TimeLineID tli);
 static void XLogWalRcvClose(XLogRecPtr recptr, TimeLineID tli);
 static void XLogWalRcvSendReply(bool force, bool requestReply, bool checkApply);
+static void XLogWalRcvSendApplyReplyIfRequested(void);
 static void XLogWalRcvSendHSFeedback(bool immed);
 static void ProcessWalSndrMessage(XLogRecPtr walEnd, TimestampTz sendTime);
 static void WalRcvComputeNextWakeup(WalRcvWakeupReason reason, TimestampTz now);
@@ -394,8 +406,23 @@ WalReceiverMain(const void *startup_data, size_t startup_data_len)
 		options.startpoint = startpoint;
 		options.slotname = slotname[0] != '\0' ? slotname : NULL;
 		options.proto.physical.startpointTLI = startpointTLI;
+		options.proto.physical.compression = wal_receiver_compression;
 		if (walrcv_startstreaming(wrconn, &options))
 		{
+			/*
+			 * Every stream starts with fresh compression state on the
+			 * sending side, so we need a fresh decompression context too.
+			 */
+			if (wal_decompressor)
+			{
+				WalStreamCompressorFree(wal_decompressor);
+				wal_decompressor = NULL;
+			}
+			if (options.proto.physical.compression != PG_COMPRESSION_NONE)
+				wal_decompressor =
+					WalStreamCompressorCreate(options.proto.physical.compression,
+											  true);
+
 			if (first_stream)
 				ereport(LOG,
 						errmsg("started streaming WAL from primary at %X/%08X on timeline %u",
@@ -510,6 +537,14 @@ WalReceiverMain(const void *startup_data, size_t startup_data_len)
 					 * them.
 					 */
 					XLogWalRcvFlush(false, startpointTLI);
+
+					/*
+					 * While the primary keeps sending, we might not get to
+					 * wait on our latch for a while; don't let pending apply
+					 * feedback wait that long.  Backends on the primary may
+					 * be waiting for it.
+					 */
+					XLogWalRcvSendApplyReplyIfRequested();
 				}
 
 				/* Check if we need to exit the streaming loop. */
@@ -548,18 +583,7 @@ WalReceiverMain(const void *startup_data, size_t startup_data_len)
 					ResetLatch(MyLatch);
 					CHECK_FOR_INTERRUPTS();
 
-					if (walrcv->apply_reply_requested)
-					{
-						/*
-						 * The recovery process has asked us to send apply
-						 * feedback now.  Make sure the flag is really set to
-						 * false in shared memory before sending the reply, so
-						 * we don't miss a new request for a reply.
-						 */
-						walrcv->apply_reply_requested = false;
-						pg_memory_barrier();
-						XLogWalRcvSendReply(false, false, true);
-					}
+					XLogWalRcvSendApplyReplyIfRequested();
 				}
 				if (rc & WL_TIMEOUT)
 				{
@@ -873,6 +897,49 @@ XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len, TimeLineID tli)
 				XLogWalRcvWrite(buf, len, dataStart, tli);
 				break;
 			}
+		case PqReplMsg_CompressedWALData:
+			{
+				StringInfoData incoming_message;
+				uint32		rawlen;
+
+				hdrlen = sizeof(int64) + sizeof(int64) + sizeof(int64) +
+					sizeof(int32);
+				if (len < hdrlen || wal_decompressor == NULL)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid compressed WAL message received from primary")));
+
+				/* initialize a StringInfo with the given buffer */
+				initReadOnlyStringInfo(&incoming_message, buf, hdrlen);
+
+				/* read the fields */
+				dataStart = pq_getmsgint64(&incoming_message);
+				walEnd = pq_getmsgint64(&incoming_message);
+				sendTime = pq_getmsgint64(&incoming_message);
+				rawlen = pq_getmsgint(&incoming_message, 4);
+				ProcessWalSndrMessage(walEnd, sendTime);
+
+				if (rawlen > MaxAllocSize)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid compressed WAL message received from primary")));
+
+				if (decompress_buf_size < rawlen)
+				{
+					if (decompress_buf)
+						pfree(decompress_buf);
+					decompress_buf = MemoryContextAlloc(TopMemoryContext,
+														rawlen);
+					decompress_buf_size = rawlen;
+				}
+
+				buf += hdrlen;
+				len -= hdrlen;
+				WalStreamDecompress(wal_decompressor, buf, len,
+									decompress_buf, rawlen);
+				XLogWalRcvWrite(decompress_buf, rawlen, dataStart, tli);
+				break;
+			}
 		case PqReplMsg_Keepalive:
 			{
 				StringInfoData incoming_message;
@@ -1196,6 +1263,27 @@ XLogWalRcvSendReply(bool force, bool requestReply, bool checkApply)
 	walrcv_send(wrconn, reply_message.data, reply_message.len);
 }
 
+/*
+ * Send a reply to the primary if the startup process has asked us to send
+ * apply feedback, see WalRcvRequestApplyReply().
+ */
+static void
+XLogWalRcvSendApplyReplyIfRequested(void)
+{
+	WalRcvData *walrcv = WalRcv;
+
+	if (walrcv->apply_reply_requested)
+	{
+		/*
+		 * Make sure the flag is really set to false in shared memory before
+		 * sending the reply, so we don't miss a new request for a reply.
+		 */
+		walrcv->apply_reply_requested = false;
+		pg_memory_barrier();
+		XLogWalRcvSendReply(false, false, true);
+	}
+}
+
 /*
  * Send hot standby feedback message to primary, plus the current time,
  * in case they don't have a watch.
@@ -64,6 +64,7 @@
 #include "catalog/pg_authid.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
+#include "common/compression.h"
 #include "funcapi.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -78,6 +79,7 @@
 #include "replication/slot.h"
 #include "replication/snapbuild.h"
 #include "replication/syncrep.h"
+#include "replication/walcompress.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
 #include "replication/walsender_private.h"
@@ -92,6 +94,7 @@
 #include "tcop/dest.h"
 #include "tcop/tcopprot.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/lsyscache.h"
@@ -194,6 +197,13 @@ static StringInfoData output_message;
 static StringInfoData reply_message;
 static StringInfoData tmpbuf;
 
+/*
+ * Compression context of the physical stream, if the client asked for
+ * compression, and the buffer that compressed messages are built in.
+ */
+static WalStreamCompressor *wal_compressor = NULL;
+static StringInfoData compressed_message;
+
 /* Timestamp of last ProcessRepliesIfAny(). */
 static TimestampTz last_processing = 0;
 
@@ -206,6 +216,9 @@ static TimestampTz last_reply_timestamp = 0;
 /* Have we sent a heartbeat message asking for reply, since last reply? */
 static bool waiting_for_ping_response = false;
 
+/* Do we need to release sync rep waiters after processing replies? */
+static bool sync_rep_release_pending = false;
+
 /* Timestamp when walsender received the shutdown request */
 static TimestampTz shutdown_request_timestamp = 0;
 
@@ -834,6 +847,48 @@ HandleUploadManifestPacket(StringInfo buf, off_t *offset,
 	return false;
 }
 
+/*
+ * Process extra options given to physical START_REPLICATION.
+ */
+static void
+parseStartReplicationOptions(StartReplicationCmd *cmd,
+							 pg_compress_algorithm *compression)
+{
+	bool		compression_given = false;
+
+	foreach_node(DefElem, defel, cmd->options)
+	{
+		if (strcmp(defel->defname, "compression") == 0)
+		{
+			char	   *algorithm;
+
+			if (compression_given)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			compression_given = true;
+
+			algorithm = defGetString(defel);
+			if (strcmp(algorithm, "none") == 0)
+				*compression = PG_COMPRESSION_NONE;
+			else if (!parse_compress_algorithm(algorithm, compression) ||
+					 (*compression != PG_COMPRESSION_LZ4 &&
+					  *compression != PG_COMPRESSION_ZSTD))
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unrecognized value for %s option \"%s\": \"%s\"",
+								"START_REPLICATION", defel->defname, algorithm)));
+			else if (!WalStreamCompressionSupported(*compression))
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("%s compression is not supported by this build",
+								algorithm)));
+		}
+		else
+			elog(ERROR, "unrecognized option: %s", defel->defname);
+	}
+}
+
 /*
  * Handle START_REPLICATION command.
  *
@@ -846,6 +901,16 @@ StartReplication(StartReplicationCmd *cmd)
 	StringInfoData buf;
 	XLogRecPtr	FlushPtr;
 	TimeLineID	FlushTLI;
+	pg_compress_algorithm compression = PG_COMPRESSION_NONE;
+
+	parseStartReplicationOptions(cmd, &compression);
+
+	/* Release a compression context left behind by an earlier error */
+	if (wal_compressor)
+	{
+		WalStreamCompressorFree(wal_compressor);
+		wal_compressor = NULL;
+	}
 
 	/* create xlogreader for physical replication */
 	xlogreader =
@@ -996,9 +1061,19 @@ StartReplication(StartReplicationCmd *cmd)
 		/* Start streaming from the requested point */
 		sentPtr = cmd->startpoint;
 
+		/* Set up compression of the stream, if requested */
+		if (compression != PG_COMPRESSION_NONE)
+		{
+			wal_compressor = WalStreamCompressorCreate(compression, false);
+			initStringInfo(&compressed_message);
+		}
+
 		/* Initialize shared memory status, too */
 		SpinLockAcquire(&MyWalSnd->mutex);
 		MyWalSnd->sentPtr = sentPtr;
+		MyWalSnd->compression = compression;
+		MyWalSnd->compressionRawBytes = 0;
+		MyWalSnd->compressionSentBytes = 0;
 		SpinLockRelease(&MyWalSnd->mutex);
 
 		SyncRepInitConfig();
@@ -1009,6 +1084,17 @@ StartReplication(StartReplicationCmd *cmd)
 		WalSndLoop(XLogSendPhysical);
 
 		replication_active = false;
+
+		if (wal_compressor)
+		{
+			WalStreamCompressorFree(wal_compressor);
+			wal_compressor = NULL;
+
+			SpinLockAcquire(&MyWalSnd->mutex);
+			MyWalSnd->compression = PG_COMPRESSION_NONE;
+			SpinLockRelease(&MyWalSnd->mutex);
+		}
+
 		if (got_STOPPING)
 			proc_exit(0);
 		WalSndSetState(WALSNDSTATE_STARTUP);
@@ -2428,6 +2514,13 @@ ProcessRepliesIfAny(void)
 		last_reply_timestamp = last_processing;
 		waiting_for_ping_response = false;
 	}
+
+	/* Release sync rep waiters covered by the replies we received */
+	if (sync_rep_release_pending)
+	{
+		sync_rep_release_pending = false;
+		SyncRepReleaseWaiters();
+	}
 }
 
 /*
@@ -2593,8 +2686,14 @@ ProcessStandbyReplyMessage(void)
 		SpinLockRelease(&walsnd->mutex);
 	}
 
+	/*
+	 * Release the backends waiting for these positions once we have
+	 * processed all the replies available.  A busy standby often sends
+	 * several replies in a row, and there's no point in waking each batch
+	 * of waiters separately.
+	 */
 	if (!am_cascading_walsender)
-		SyncRepReleaseWaiters();
+		sync_rep_release_pending = true;
 
 	/*
 	 * Advance our local xmin horizon when the client confirmed a flush.
@@ -3192,6 +3291,13 @@ InitWalSenderSlot(void)
 			walsnd->applyLag = -1;
 			walsnd->sync_standby_priority = 0;
 			walsnd->replyTime = 0;
+			walsnd->compression = PG_COMPRESSION_NONE;
+			walsnd->compressionRawBytes = 0;
+			walsnd->compressionSentBytes = 0;
+			walsnd->syncWaitCount = 0;
+			walsnd->syncWaitTime = 0;
+			memset(walsnd->syncWaitBuckets, 0,
+				   sizeof(walsnd->syncWaitBuckets));
 
 			/*
 			 * The kind assignment is done here and not in StartReplication()
@@ -3328,6 +3434,9 @@ XLogSendPhysical(void)
 	XLogSegNo	segno;
 	WALReadError errinfo;
 	Size		rbytes;
+	StringInfo	message;
+	uint32		rawlen = 0;
+	size_t		compressedlen = 0;
 
 	/* If requested switch the WAL sender to the stopping state. */
 	if (got_STOPPING)
@@ -3593,15 +3702,39 @@ retry:
 	output_message.len += nbytes;
 	output_message.data[output_message.len] = '\0';
 
+	/*
+	 * If the stream is compressed, send the WAL we just read through the
+	 * compressor and wrap the result in a compressed WAL data message, which
+	 * additionally carries the uncompressed length.
+	 */
+	message = &output_message;
+	if (wal_compressor)
+	{
+		int			hdrlen = 1 + sizeof(int64) + sizeof(int64) + sizeof(int64);
+
+		rawlen = output_message.len - hdrlen;
+
+		resetStringInfo(&compressed_message);
+		pq_sendbyte(&compressed_message, PqReplMsg_CompressedWALData);
+		pq_sendint64(&compressed_message, sentPtr); /* dataStart */
+		pq_sendint64(&compressed_message, SendRqstPtr); /* walEnd */
+		pq_sendint64(&compressed_message, 0);	/* sendtime, filled in last */
+		pq_sendint32(&compressed_message, rawlen);	/* uncompressed length */
+		compressedlen = WalStreamCompress(wal_compressor,
+										  &output_message.data[hdrlen],
+										  rawlen, &compressed_message);
+		message = &compressed_message;
+	}
+
 	/*
 	 * Fill the send timestamp last, so that it is taken as late as possible.
 	 */
 	resetStringInfo(&tmpbuf);
 	pq_sendint64(&tmpbuf, GetCurrentTimestamp());
-	memcpy(&output_message.data[1 + sizeof(int64) + sizeof(int64)],
+	memcpy(&message->data[1 + sizeof(int64) + sizeof(int64)],
 		   tmpbuf.data, sizeof(int64));
 
-	pq_putmessage_noblock(PqMsg_CopyData, output_message.data, output_message.len);
+	pq_putmessage_noblock(PqMsg_CopyData, message->data, message->len);
 
 	sentPtr = endptr;
 
@@ -3611,6 +3744,11 @@ retry:
 
 		SpinLockAcquire(&walsnd->mutex);
 		walsnd->sentPtr = sentPtr;
+		if (wal_compressor)
+		{
+			walsnd->compressionRawBytes += rawlen;
+			walsnd->compressionSentBytes += compressedlen;
+		}
 		SpinLockRelease(&walsnd->mutex);
 	}
 
@@ -3979,7 +4117,10 @@ static void
 WalSndShmemInit(void *arg)
 {
 	for (int i = 0; i < NUM_SYNC_REP_WAIT_MODE; i++)
+	{
 		dlist_init(&(WalSndCtl->SyncRepQueue[i]));
+		pg_atomic_init_u64(&WalSndCtl->lsn[i], InvalidXLogRecPtr);
+	}
 
 	for (int i = 0; i < max_wal_senders; i++)
 	{
@@ -4208,7 +4349,7 @@ offset_to_interval(TimeOffset offset)
 Datum
 pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_SENDERS_COLS	12
+#define PG_STAT_GET_WAL_SENDERS_COLS	17
 	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
 	SyncRepStandbyData *sync_standbys;
 	int			num_standbys;
@@ -4236,6 +4377,12 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		int			pid;
 		WalSndState state;
 		TimestampTz replyTime;
+		pg_compress_algorithm compression;
+		uint64		compressionRawBytes;
+		uint64		compressionSentBytes;
+		uint64		syncWaitCount;
+		uint64		syncWaitTime;
+		uint64		syncWaitBuckets[SYNC_REP_WAIT_BUCKETS];
 		bool		is_sync_standby;
 		Datum		values[PG_STAT_GET_WAL_SENDERS_COLS];
 		bool		nulls[PG_STAT_GET_WAL_SENDERS_COLS] = {0};
@@ -4259,6 +4406,13 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		applyLag = walsnd->applyLag;
 		priority = walsnd->sync_standby_priority;
 		replyTime = walsnd->replyTime;
+		compression = walsnd->compression;
+		compressionRawBytes = walsnd->compressionRawBytes;
+		compressionSentBytes = walsnd->compressionSentBytes;
+		syncWaitCount = walsnd->syncWaitCount;
+		syncWaitTime = walsnd->syncWaitTime;
+		memcpy(syncWaitBuckets, walsnd->syncWaitBuckets,
+			   sizeof(syncWaitBuckets));
 		SpinLockRelease(&walsnd->mutex);
 
 		/*
@@ -4355,6 +4509,36 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 				nulls[11] = true;
 			else
 				values[11] = TimestampTzGetDatum(replyTime);
+
+			if (compression == PG_COMPRESSION_NONE)
+			{
+				nulls[12] = true;
+				nulls[13] = true;
+			}
+			else
+			{
+				values[12] = CStringGetTextDatum(get_compress_algorithm_name(compression));
+
+				/* ratio of WAL bytes streamed to bytes actually sent */
+				if (compressionSentBytes == 0)
+					nulls[13] = true;
+				else
+					values[13] = Float8GetDatum((double) compressionRawBytes /
+												(double) compressionSentBytes);
+			}
+
+			/* synchronous replication waits released by this walsender */
+			values[14] = Int64GetDatum((int64) syncWaitCount);
+			values[15] = Float8GetDatum((double) syncWaitTime / 1000.0);
+			{
+				Datum		buckets[SYNC_REP_WAIT_BUCKETS];
+
+				for (int b = 0; b < SYNC_REP_WAIT_BUCKETS; b++)
+					buckets[b] = Int64GetDatum((int64) syncWaitBuckets[b]);
+				values[16] = PointerGetDatum(construct_array_builtin(buckets,
+																	 SYNC_REP_WAIT_BUCKETS,
+																	 INT8OID));
+			}
 		}
 
 		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
@@ -4516,6 +4516,7 @@ FlushBuffer(BufferDesc *buf, SMgrRelation reln, IOObject io_object,
 	ErrorContextCallback errcallback;
 	instr_time	io_start;
 	Block		bufBlock;
+	Page		compressedBlock = NULL;
 
 	Assert(BufferLockHeldByMeInMode(buf, BUFFER_LOCK_EXCLUSIVE) ||
 		   BufferLockHeldByMeInMode(buf, BUFFER_LOCK_SHARE_EXCLUSIVE));
@@ -4578,15 +4579,33 @@ FlushBuffer(BufferDesc *buf, SMgrRelation reln, IOObject io_object,
 	 */
 	bufBlock = BufHdrGetBlock(buf);
 
+	/*
+	 * Pages that VACUUM found to be all-frozen, in tables that asked for it,
+	 * are written in compressed form if that saves space.  Any modification
+	 * of such a heap page clears PD_ALL_VISIBLE, so checking that too keeps
+	 * us from compressing pages that are no longer cold.  A torn write of a
+	 * compressed image can only be repaired from a full-page image, which
+	 * hint-only changes get only if XLogHintBitIsNeeded(), so don't compress
+	 * otherwise (data checksums may have been turned off since VACUUM marked
+	 * the page).
+	 */
+	if (PageIsCompressible((Page) bufBlock) &&
+		PageIsAllVisible((Page) bufBlock) &&
+		XLogHintBitIsNeeded())
+		compressedBlock = PageCompress((Page) bufBlock);
+
 	/* Update page checksum if desired. */
-	PageSetChecksum((Page) bufBlock, buf->tag.blockNum);
+	if (compressedBlock)
+		PageSetChecksum(compressedBlock, buf->tag.blockNum);
+	else
+		PageSetChecksum((Page) bufBlock, buf->tag.blockNum);
 
 	io_start = pgstat_prepare_io_time(track_io_timing);
 
 	smgrwrite(reln,
 			  BufTagGetForkNum(&buf->tag),
 			  buf->tag.blockNum,
-			  bufBlock,
+			  compressedBlock ? compressedBlock : bufBlock,
 			  false);
 
 	/*
@@ -8599,8 +8618,15 @@ buffer_readv_complete_one(PgAioTargetData *td, uint8 buf_off, Buffer buffer,
 			VALGRIND_MAKE_MEM_DEFINED(bufdata, BLCKSZ);
 #endif
 
+		/*
+		 * A page written in compressed form is restored here, so that the
+		 * rest of the system never sees the compressed image.  An image that
+		 * can't be decompressed is treated like any other invalid page.
+		 */
 		if (!PageIsVerified((Page) bufdata, tag.blockNum, piv_flags,
-							failed_checksum))
+							failed_checksum) ||
+			(PageIsCompressed((Page) bufdata) &&
+			 !PageDecompress((Page) bufdata)))
 		{
 			if (flags & READ_BUFFERS_ZERO_ON_ERROR)
 			{
@@ -244,6 +244,7 @@ ProcGlobalShmemInit(void *arg)
 	ProcGlobal->checkpointerProc = INVALID_PROC_NUMBER;
 	pg_atomic_init_u32(&ProcGlobal->procArrayGroupFirst, INVALID_PROC_NUMBER);
 	pg_atomic_init_u32(&ProcGlobal->clogGroupFirst, INVALID_PROC_NUMBER);
+	pg_atomic_init_u32(&ProcGlobal->walFlushGroupFirst, INVALID_PROC_NUMBER);
 
 	ptr = AllProcsShmemPtr;
 	requestSize = ProcGlobalAllProcsShmemSize;
@@ -371,6 +372,7 @@ ProcGlobalShmemInit(void *arg)
 		 */
 		pg_atomic_init_u32(&(proc->procArrayGroupNext), INVALID_PROC_NUMBER);
 		pg_atomic_init_u32(&(proc->clogGroupNext), INVALID_PROC_NUMBER);
+		pg_atomic_init_u32(&(proc->walFlushGroupNext), INVALID_PROC_NUMBER);
 		pg_atomic_init_u64(&(proc->waitStart), 0);
 	}
 
@@ -531,6 +533,11 @@ InitProcess(void)
 	MyProc->clogGroupMemberLsn = InvalidXLogRecPtr;
 	Assert(pg_atomic_read_u32(&MyProc->clogGroupNext) == INVALID_PROC_NUMBER);
 
+	/* Initialize fields for group WAL flush. */
+	MyProc->walFlushGroupMember = false;
+	MyProc->walFlushGroupMemberLsn = InvalidXLogRecPtr;
+	Assert(pg_atomic_read_u32(&MyProc->walFlushGroupNext) == INVALID_PROC_NUMBER);
+
 	/*
 	 * Acquire ownership of the PGPROC's latch, so that we can use WaitLatch
 	 * on it.  That allows us to repoint the process latch, which so far
@@ -692,6 +699,8 @@ InitAuxiliaryProcess(void)
 	dlist_node_init(&MyProc->waitLink);
 	MyProc->waitProcLock = NULL;
 	pg_atomic_write_u64(&MyProc->waitStart, 0);
+	MyProc->walFlushGroupMember = false;
+	MyProc->walFlushGroupMemberLsn = InvalidXLogRecPtr;
 #ifdef USE_ASSERT_CHECKING
 	{
 		int			i;
@@ -14,9 +14,14 @@
  */
 #include "postgres.h"
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
 #include "access/htup_details.h"
 #include "access/itup.h"
 #include "access/xlog.h"
+#include "common/pg_lzcompress.h"
 #include "pgstat.h"
 #include "storage/checksum.h"
 #include "utils/memdebug.h"
@@ -26,6 +31,31 @@
 /* GUC variable */
 bool		ignore_checksum_failure = false;
 
+/*
+ * A compressed page image consists of a page header, followed by a
+ * PageCompressHeader and the compressed contents of the original page,
+ * without the hole between pd_lower and pd_upper.
+ */
+typedef struct PageCompressHeader
+{
+	uint16		pch_hole_offset;	/* pd_lower of the original page */
+	uint16		pch_hole_length;	/* pd_upper - pd_lower */
+	uint16		pch_length;		/* length of compressed data */
+	uint8		pch_method;		/* PAGE_COMPRESS_* */
+	uint8		pch_unused;
+	char		pch_data[FLEXIBLE_ARRAY_MEMBER];
+} PageCompressHeader;
+
+#define PAGE_COMPRESS_PGLZ		1
+#define PAGE_COMPRESS_LZ4		2
+
+#define SizeOfPageCompressHeader \
+	(SizeOfPageHeaderData + offsetof(PageCompressHeader, pch_data))
+
+/* the most compressed data an image may hold */
+#define PAGE_COMPRESS_MAX_LENGTH \
+	(BLCKSZ - PAGE_COMPRESS_UNIT - SizeOfPageCompressHeader)
+
 
 /* ----------------------------------------------------------------
  *						Page support functions
@@ -1528,3 +1558,142 @@ PageSetChecksum(Page page, BlockNumber blkno)
 	((PageHeader) page)->pd_checksum = pg_checksum_page(page, blkno);
 	RESUME_INTERRUPTS();
 }
+
+
+/*
+ * PageCompress
+ *		Produce the compressed on-disk image of a page.
+ *
+ * The image is a valid page, whose header has the original pd_lsn and
+ * PD_COMPRESSED set, and which is empty apart from the compressed contents
+ * of the original page following the header.  The rest of the block is
+ * zero, which filesystems that compress data transparently store in little
+ * space.
+ *
+ * Returns NULL if the page does not compress well enough to save at least
+ * PAGE_COMPRESS_UNIT bytes.  Otherwise, the result points to static storage
+ * that is overwritten by the next call.  The caller is responsible for
+ * setting the checksum of the image.
+ */
+Page
+PageCompress(const PageData *page)
+{
+	static PGAlignedBlock image;
+	static PGAlignedBlock source;
+	static char compressed[PGLZ_MAX_OUTPUT(BLCKSZ)];
+	const PageHeaderData *phdr = (const PageHeaderData *) page;
+	PageHeader	ihdr = (PageHeader) image.data;
+	PageCompressHeader *chdr;
+	uint16		hole_offset = phdr->pd_lower;
+	uint16		hole_length = phdr->pd_upper - phdr->pd_lower;
+	int			source_len;
+	int			len;
+	uint8		method;
+
+	if (PAGE_COMPRESS_MAX_LENGTH <= 0 ||
+		phdr->pd_lower < SizeOfPageHeaderData ||
+		phdr->pd_lower > phdr->pd_upper ||
+		phdr->pd_upper > BLCKSZ)
+		return NULL;
+
+	/* squeeze out the hole, as done for full-page images in WAL */
+	memcpy(source.data, page, hole_offset);
+	memcpy(source.data + hole_offset, page + hole_offset + hole_length,
+		   BLCKSZ - (hole_offset + hole_length));
+	source_len = BLCKSZ - hole_length;
+
+#ifdef USE_LZ4
+	method = PAGE_COMPRESS_LZ4;
+	len = LZ4_compress_default(source.data, compressed, source_len,
+							   PAGE_COMPRESS_MAX_LENGTH);
+	if (len <= 0)
+		return NULL;
+#else
+	method = PAGE_COMPRESS_PGLZ;
+	len = pglz_compress(source.data, source_len, compressed,
+						PGLZ_strategy_default);
+	if (len < 0 || len > PAGE_COMPRESS_MAX_LENGTH)
+		return NULL;
+#endif
+
+	memset(image.data, 0, BLCKSZ);
+	memcpy(image.data, page, SizeOfPageHeaderData);
+	ihdr->pd_flags = PD_COMPRESSED;
+	ihdr->pd_lower = SizeOfPageHeaderData;
+	ihdr->pd_upper = SizeOfPageHeaderData;
+	ihdr->pd_special = SizeOfPageHeaderData;
+	ihdr->pd_prune_xid = InvalidTransactionId;
+
+	chdr = (PageCompressHeader *) (image.data + SizeOfPageHeaderData);
+	chdr->pch_hole_offset = hole_offset;
+	chdr->pch_hole_length = hole_length;
+	chdr->pch_length = len;
+	chdr->pch_method = method;
+	memcpy(chdr->pch_data, compressed, len);
+
+	return image.data;
+}
+
+/*
+ * PageDecompress
+ *		Restore, in place, the page a compressed image was made from.
+ *
+ * The image must already have passed PageIsVerified().  Returns false if it
+ * turns out to be corrupt, or uses a compression method this build doesn't
+ * support, in which case the page is left unchanged.  This may be called
+ * while completing an I/O, so it must not throw errors.
+ */
+bool
+PageDecompress(Page page)
+{
+	static PGAlignedBlock source;
+	static PGAlignedBlock result;
+	PageCompressHeader *chdr;
+	int			source_len;
+	int			len;
+
+	Assert(PageIsCompressed(page));
+
+	chdr = (PageCompressHeader *) (page + SizeOfPageHeaderData);
+	if (chdr->pch_length > PAGE_COMPRESS_MAX_LENGTH ||
+		chdr->pch_hole_offset < SizeOfPageHeaderData ||
+		chdr->pch_hole_offset + chdr->pch_hole_length > BLCKSZ)
+		return false;
+	source_len = BLCKSZ - chdr->pch_hole_length;
+
+	switch (chdr->pch_method)
+	{
+		case PAGE_COMPRESS_PGLZ:
+			len = pglz_decompress(chdr->pch_data, chdr->pch_length,
+								  source.data, source_len, true);
+			break;
+#ifdef USE_LZ4
+		case PAGE_COMPRESS_LZ4:
+			len = LZ4_decompress_safe(chdr->pch_data, source.data,
+									  chdr->pch_length, source_len);
+			break;
+#endif
+		default:
+			/* includes LZ4 in builds without it */
+			return false;
+	}
+	if (len != source_len)
+		return false;
+
+	memcpy(result.data, source.data, chdr->pch_hole_offset);
+	memset(result.data + chdr->pch_hole_offset, 0, chdr->pch_hole_length);
+	memcpy(result.data + chdr->pch_hole_offset + chdr->pch_hole_length,
+		   source.data + chdr->pch_hole_offset,
+		   source_len - chdr->pch_hole_offset);
+
+	/* the header of the original page must agree with the image */
+	if (PageIsCompressed(result.data) ||
+		((PageHeader) result.data)->pd_lower != chdr->pch_hole_offset ||
+		((PageHeader) result.data)->pd_upper !=
+		chdr->pch_hole_offset + chdr->pch_hole_length ||
+		PageGetLSN(result.data) != PageGetLSN(page))
+		return false;
+
+	memcpy(page, result.data, BLCKSZ);
+	return true;
+}
@@ -13,6 +13,7 @@
  */
 #include "postgres.h"
 
+#include "access/detoast.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_type.h"
 #include "common/hashfn.h"
@@ -39,9 +40,17 @@
 #define JSONB_MAX_ELEMS (Min(MaxAllocSize / sizeof(JsonbValue), JB_CMASK))
 #define JSONB_MAX_PAIRS (Min(MaxAllocSize / sizeof(JsonbPair), JB_CMASK))
 
+/*
+ * Toasted values smaller than this are detoasted whole to look up a key:
+ * each slice costs a separate fetch from the toast table, so fetching just
+ * the parts needed only pays off for large values.
+ */
+#define JSONB_SLICED_LOOKUP_THRESHOLD	(64 * 1024)
+
 static void fillJsonbValue(JsonbContainer *container, int index,
 						   char *base_addr, uint32 offset,
 						   JsonbValue *result);
+static varlena *fetchJsonbSlice(varlena *attr, uint32 offset, uint32 length);
 static bool equalsJsonbScalarValue(JsonbValue *a, JsonbValue *b);
 static int	compareJsonbScalarValue(JsonbValue *a, JsonbValue *b);
 static Jsonb *convertToJsonb(JsonbValue *val);
@@ -463,6 +472,131 @@ getKeyJsonValueFromContainer(JsonbContainer *container,
 	return NULL;
 }
 
+/*
+ * Find value by key in the root object of a jsonb datum, which may be
+ * toasted, and fetch it into 'res', which is also returned.  Returns NULL if
+ * the key is not found or the root is not an object.
+ *
+ * For large values of which detoast_attr_slice can fetch slices cheaply,
+ * only the root's JEntries, its keys and the value found are fetched, rather
+ * than the whole document.  Otherwise this is the same as detoasting the
+ * datum and calling getKeyJsonValueFromContainer.
+ */
+JsonbValue *
+getKeyJsonValueFromDatum(Datum jsonb, const char *keyVal, int keyLen,
+						 JsonbValue *res)
+{
+	varlena    *attr = (varlena *) DatumGetPointer(jsonb);
+	varlena    *slice;
+	varlena    *keys;
+	varlena    *value;
+	JsonbContainer *container;
+	uint32		header;
+	uint32		count;
+	uint32		base;
+	uint32		stopLow,
+				stopHigh;
+
+	if (!detoast_attr_slice_is_cheap(attr) ||
+		toast_raw_datum_size(jsonb) < JSONB_SLICED_LOOKUP_THRESHOLD)
+	{
+		Jsonb	   *jb = DatumGetJsonbP(jsonb);
+
+		if (!JB_ROOT_IS_OBJECT(jb))
+			return NULL;
+		return getKeyJsonValueFromContainer(&jb->root, keyVal, keyLen, res);
+	}
+
+	slice = fetchJsonbSlice(attr, 0, sizeof(uint32));
+	memcpy(&header, VARDATA(slice), sizeof(uint32));
+	pfree(slice);
+
+	count = header & JB_CMASK;
+	if ((header & JB_FOBJECT) == 0 || count == 0)
+		return NULL;
+
+	/*
+	 * Fetch the root container up to the end of its JEntries, which is
+	 * enough for getJsonbOffset() and friends.  Keys are stored before all
+	 * values, so they end where the first value begins.
+	 */
+	base = offsetof(JsonbContainer, children) + count * 2 * sizeof(JEntry);
+	slice = fetchJsonbSlice(attr, 0, base);
+	container = (JsonbContainer *) VARDATA(slice);
+	keys = fetchJsonbSlice(attr, base, getJsonbOffset(container, count));
+
+	/* Binary search the keys, as in getKeyJsonValueFromContainer */
+	stopLow = 0;
+	stopHigh = count;
+	while (stopLow < stopHigh)
+	{
+		uint32		stopMiddle;
+		int			difference;
+
+		stopMiddle = stopLow + (stopHigh - stopLow) / 2;
+
+		difference = lengthCompareJsonbString(VARDATA(keys) +
+											  getJsonbOffset(container, stopMiddle),
+											  getJsonbLength(container, stopMiddle),
+											  keyVal, keyLen);
+
+		if (difference == 0)
+		{
+			int			index = stopMiddle + count;
+			uint32		offset = getJsonbOffset(container, index);
+			uint32		start = INTALIGN_DOWN(offset);
+
+			/*
+			 * Fetch the value from an int-aligned offset, so that numerics
+			 * and containers, which are aligned within the document, are
+			 * aligned in the slice too.
+			 */
+			value = fetchJsonbSlice(attr, base + start,
+									offset - start +
+									getJsonbLength(container, index));
+
+			if (!res)
+				res = palloc_object(JsonbValue);
+
+			fillJsonbValue(container, index, VARDATA(value),
+						   offset - start, res);
+
+			pfree(keys);
+			pfree(slice);
+			return res;
+		}
+		else
+		{
+			if (difference < 0)
+				stopLow = stopMiddle + 1;
+			else
+				stopHigh = stopMiddle;
+		}
+	}
+
+	/* Not found */
+	pfree(keys);
+	pfree(slice);
+	return NULL;
+}
+
+/*
+ * Fetch a slice of a toasted jsonb datum, complaining if it's shorter than
+ * its JEntries say it should be.
+ */
+static varlena *
+fetchJsonbSlice(varlena *attr, uint32 offset, uint32 length)
+{
+	varlena    *slice = detoast_attr_slice(attr, offset, length);
+
+	if (VARSIZE(slice) - VARHDRSZ != length)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("unexpected end of jsonb value")));
+
+	return slice;
+}
+
 /*
  * Get i-th value of a Jsonb array.
  *
@@ -60,6 +60,9 @@ typedef struct CatCInProgress
 
 static CatCInProgress *catcache_in_progress_stack = NULL;
 
+/* GUC parameter: space for cache entries, in kB; 0 means no limit */
+int			catalog_cache_memory_limit = 0;
+
  /* #define CACHEDEBUG */	/* turns DEBUG elogs on */
 
 /*
@@ -108,6 +111,7 @@ static void CatCachePrintStats(int code, Datum arg);
 #endif
 static void CatCacheRemoveCTup(CatCache *cache, CatCTup *ct);
 static void CatCacheRemoveCList(CatCache *cache, CatCList *cl);
+static void CatCacheEvict(void);
 static void RehashCatCache(CatCache *cp);
 static void RehashCatCacheLists(CatCache *cp);
 static void CatalogCacheInitializeCache(CatCache *cache);
@@ -571,6 +575,8 @@ CatCacheRemoveCTup(CatCache *cache, CatCTup *ct)
 		CatCacheFreeKeys(cache->cc_tupdesc, cache->cc_nkeys,
 						 cache->cc_keyno, ct->keys);
 
+	dlist_delete(&ct->lru_elem);
+	CacheHdr->ch_nbytes -= GetMemoryChunkSpace(ct);
 	pfree(ct);
 
 	--cache->cc_ntup;
@@ -615,12 +621,66 @@ CatCacheRemoveCList(CatCache *cache, CatCList *cl)
 	CatCacheFreeKeys(cache->cc_tupdesc, cl->nkeys,
 					 cache->cc_keyno, cl->keys);
 
+	CacheHdr->ch_nbytes -= GetMemoryChunkSpace(cl);
 	pfree(cl);
 
 	--cache->cc_nlist;
 }
 
 
+/*
+ *	CatCacheEvict
+ *
+ *	Remove least recently used entries until the caches take no more space
+ *	than catalog_cache_memory_limit.  Entries that are in use, or that belong
+ *	to a list that is in use, are skipped.  Removing a member of a list
+ *	removes the whole list, as an invalidation would.
+ *
+ *	The space of the removed entries goes back to CatCacheMemoryContext for
+ *	reuse by new entries, not to the operating system.
+ */
+static void
+CatCacheEvict(void)
+{
+	Size		limit = (Size) catalog_cache_memory_limit * 1024;
+	dlist_node *cur;
+
+	if (CacheHdr->ch_nbytes <= limit || dlist_is_empty(&CacheHdr->ch_lru))
+		return;
+
+	cur = dlist_tail_node(&CacheHdr->ch_lru);
+	while (CacheHdr->ch_nbytes > limit)
+	{
+		CatCTup    *ct = dlist_container(CatCTup, lru_elem, cur);
+		dlist_node *prev = NULL;
+
+		if (dlist_has_prev(&CacheHdr->ch_lru, cur))
+			prev = dlist_prev_node(&CacheHdr->ch_lru, cur);
+
+		if (ct->refcount == 0 &&
+			(ct->c_list == NULL || ct->c_list->refcount == 0))
+		{
+			bool		had_list = (ct->c_list != NULL);
+
+			CatCacheRemoveCTup(ct->my_cache, ct);
+
+			/*
+			 * Removing the list may also have removed other members of it,
+			 * possibly including the one we were going to look at next, so
+			 * start over from the end.
+			 */
+			if (had_list)
+				prev = dlist_is_empty(&CacheHdr->ch_lru) ? NULL :
+					dlist_tail_node(&CacheHdr->ch_lru);
+		}
+
+		if (prev == NULL)
+			break;
+		cur = prev;
+	}
+}
+
+
 /*
  *	CatCacheInvalidate
  *
@@ -934,6 +994,18 @@ InitCatCache(int id,
 		CacheHdr = palloc_object(CatCacheHeader);
 		slist_init(&CacheHdr->ch_caches);
 		CacheHdr->ch_ntup = 0;
+
+		/*
+		 * Keep the entries in a context of their own.  Space freed when
+		 * entries are evicted under catalog_cache_memory_limit then stays
+		 * available to new entries, and the effect of the limit shows in
+		 * pg_backend_memory_contexts.
+		 */
+		CacheHdr->ch_context = AllocSetContextCreate(CacheMemoryContext,
+													 "CatCacheMemoryContext",
+													 ALLOCSET_DEFAULT_SIZES);
+		dlist_init(&CacheHdr->ch_lru);
+		CacheHdr->ch_nbytes = 0;
 #ifdef CATCACHE_STATS
 		/* set up to dump stats at backend exit */
 		on_proc_exit(CatCachePrintStats, 0);
@@ -947,7 +1019,8 @@ InitCatCache(int id,
 	 */
 	cp = (CatCache *) palloc_aligned(sizeof(CatCache), PG_CACHE_LINE_SIZE,
 									 MCXT_ALLOC_ZERO);
-	cp->cc_bucket = palloc0(nbuckets * sizeof(dlist_head));
+	cp->cc_bucket = MemoryContextAllocZero(CacheHdr->ch_context,
+										   nbuckets * sizeof(dlist_head));
 
 	/*
 	 * Many catcaches never receive any list searches.  Therefore, we don't
@@ -1011,7 +1084,7 @@ RehashCatCache(CatCache *cp)
 
 	/* Allocate a new, larger, hash table. */
 	newnbuckets = cp->cc_nbuckets * 2;
-	newbucket = (dlist_head *) MemoryContextAllocZero(CacheMemoryContext, newnbuckets * sizeof(dlist_head));
+	newbucket = (dlist_head *) MemoryContextAllocZero(CacheHdr->ch_context, newnbuckets * sizeof(dlist_head));
 
 	/* Move all entries from old hash table to new. */
 	for (i = 0; i < cp->cc_nbuckets; i++)
@@ -1056,7 +1129,7 @@ RehashCatCacheLists(CatCache *cp)
 
 	/* Allocate a new, larger, hash table. */
 	newnbuckets = cp->cc_nlbuckets * 2;
-	newbucket = (dlist_head *) MemoryContextAllocZero(CacheMemoryContext, newnbuckets * sizeof(dlist_head));
+	newbucket = (dlist_head *) MemoryContextAllocZero(CacheHdr->ch_context, newnbuckets * sizeof(dlist_head));
 
 	/* Move all entries from old hash table to new. */
 	for (i = 0; i < cp->cc_nlbuckets; i++)
@@ -1484,6 +1557,7 @@ SearchCatCacheInternal(CatCache *cache,
 		 * near the front of the hashbucket's list.)
 		 */
 		dlist_move_head(bucket, &ct->cache_elem);
+		dlist_move_head(&CacheHdr->ch_lru, &ct->lru_elem);
 
 		/*
 		 * If it's a positive entry, bump its refcount and return it. If it's
@@ -1800,7 +1874,7 @@ SearchCatCacheList(CatCache *cache,
 		int			nbuckets = 16;
 
 		cache->cc_lbucket = (dlist_head *)
-			MemoryContextAllocZero(CacheMemoryContext,
+			MemoryContextAllocZero(CacheHdr->ch_context,
 								   nbuckets * sizeof(dlist_head));
 		/* Don't set cc_nlbuckets if we get OOM allocating cc_lbucket */
 		cache->cc_nlbuckets = nbuckets;
@@ -1852,9 +1926,12 @@ SearchCatCacheList(CatCache *cache,
 		 * for its hashbucket, so as to speed subsequent searches.  (We do not
 		 * move the members to the fronts of their hashbucket lists, however,
 		 * since there's no point in that unless they are searched for
-		 * individually.)
+		 * individually.  They do count as used for LRU eviction, though,
+		 * since evicting one of them would take the list with it.)
 		 */
 		dlist_move_head(lbucket, &cl->cache_elem);
+		for (i = 0; i < cl->n_members; i++)
+			dlist_move_head(&CacheHdr->ch_lru, &cl->members[i]->lru_elem);
 
 		/* Bump the list's refcount and return it */
 		ResourceOwnerEnlarge(CurrentResourceOwner);
@@ -2031,7 +2108,7 @@ SearchCatCacheList(CatCache *cache,
 		ResourceOwnerEnlarge(CurrentResourceOwner);
 
 		/* Now we can build the CatCList entry. */
-		oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+		oldcxt = MemoryContextSwitchTo(CacheHdr->ch_context);
 		nmembers = list_length(ctlist);
 		cl = (CatCList *)
 			palloc(offsetof(CatCList, members) + nmembers * sizeof(CatCTup *));
@@ -2090,6 +2167,7 @@ SearchCatCacheList(CatCache *cache,
 		cl->members[i++] = ct = (CatCTup *) lfirst(ctlist_item);
 		Assert(ct->c_list == NULL);
 		ct->c_list = cl;
+		dlist_move_head(&CacheHdr->ch_lru, &ct->lru_elem);
 		/* release the temporary refcount on the member */
 		Assert(ct->refcount > 0);
 		ct->refcount--;
@@ -2105,6 +2183,7 @@ SearchCatCacheList(CatCache *cache,
 	dlist_push_head(lbucket, &cl->cache_elem);
 
 	cache->cc_nlist++;
+	CacheHdr->ch_nbytes += GetMemoryChunkSpace(cl);
 
 	/* Finally, bump the list's refcount and return it */
 	cl->refcount++;
@@ -2168,6 +2247,10 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	CatCTup    *ct;
 	MemoryContext oldcxt;
 
+	/* Make room for the new entry, if the caches are over their limit */
+	if (catalog_cache_memory_limit > 0)
+		CatCacheEvict();
+
 	if (ntp)
 	{
 		int			i;
@@ -2233,7 +2316,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 
 		/* Allocate memory for CatCTup and the cached tuple in one go */
 		ct = (CatCTup *)
-			MemoryContextAlloc(CacheMemoryContext,
+			MemoryContextAlloc(CacheHdr->ch_context,
 							   MAXALIGN(sizeof(CatCTup)) + dtp->t_len);
 		ct->tuple.t_len = dtp->t_len;
 		ct->tuple.t_self = dtp->t_self;
@@ -2265,7 +2348,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	else
 	{
 		/* Set up keys for a negative cache entry */
-		oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+		oldcxt = MemoryContextSwitchTo(CacheHdr->ch_context);
 		ct = palloc_object(CatCTup);
 
 		/*
@@ -2290,9 +2373,11 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, Datum *arguments,
 	ct->hash_value = hashValue;
 
 	dlist_push_head(&cache->cc_bucket[hashIndex], &ct->cache_elem);
+	dlist_push_head(&CacheHdr->ch_lru, &ct->lru_elem);
 
 	cache->cc_ntup++;
 	CacheHdr->ch_ntup++;
+	CacheHdr->ch_nbytes += GetMemoryChunkSpace(ct);
 
 	/*
 	 * If the hash table has become too full, enlarge the buckets array. Quite
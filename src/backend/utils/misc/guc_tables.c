@@ -37,6 +37,7 @@
 #include "access/xlog_internal.h"
 #include "access/xlogprefetcher.h"
 #include "access/xlogrecovery.h"
+#include "access/xlogredoworker.h"
 #include "access/xlogutils.h"
 #include "archive/archive_module.h"
 #include "catalog/namespace.h"
@@ -94,6 +95,7 @@
 #include "tsearch/ts_cache.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
+#include "utils/catcache.h"
 #include "utils/float.h"
 #include "utils/guc_hooks.h"
 #include "utils/guc_tables.h"
@@ -447,6 +449,18 @@ static const struct config_enum_entry debug_logical_replication_streaming_option
 StaticAssertDecl(lengthof(ssl_protocol_versions_info) == (PG_TLS1_3_VERSION + 2),
 				 "array length mismatch");
 
+static const struct config_enum_entry logical_decoding_spill_compression_options[] = {
+	{"pglz", LOGICAL_SPILL_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", LOGICAL_SPILL_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", LOGICAL_SPILL_COMPRESSION_ZSTD, false},
+#endif
+	{"off", LOGICAL_SPILL_COMPRESSION_NONE, false},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry recovery_init_sync_method_options[] = {
 	{"fsync", DATA_DIR_SYNC_METHOD_FSYNC, false},
 #ifdef HAVE_SYNCFS
@@ -472,6 +486,9 @@ static const struct config_enum_entry default_toast_compression_options[] = {
 	{"pglz", TOAST_PGLZ_COMPRESSION, false},
 #ifdef  USE_LZ4
 	{"lz4", TOAST_LZ4_COMPRESSION, false},
+#endif
+#ifdef  USE_ZSTD
+	{"zstd", TOAST_ZSTD_COMPRESSION, false},
 #endif
 	{NULL, 0, false}
 };
@@ -495,6 +512,18 @@ static const struct config_enum_entry wal_compression_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry wal_receiver_compression_options[] = {
+#ifdef USE_LZ4
+	{"lz4", PG_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", PG_COMPRESSION_ZSTD, false},
+#endif
+	{"off", PG_COMPRESSION_NONE, false},
+	{"none", PG_COMPRESSION_NONE, true},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry file_copy_method_options[] = {
 	{"copy", FILE_COPY_METHOD_COPY, false},
 #if defined(HAVE_COPYFILE) && defined(COPYFILE_CLONE_FORCE) || defined(HAVE_COPY_FILE_RANGE)
@@ -1424,6 +1424,7 @@ static const TCPattern tcpatterns[] =
 
 /* Storage parameters for CREATE TABLE and ALTER TABLE */
 static const char *const table_storage_parameters[] = {
+	"adaptive_fillfactor",
 	"autovacuum_analyze_scale_factor",
 	"autovacuum_analyze_threshold",
 	"autovacuum_enabled",
@@ -1441,6 +1442,7 @@ static const char *const table_storage_parameters[] = {
 	"autovacuum_vacuum_max_threshold",
 	"autovacuum_vacuum_scale_factor",
 	"autovacuum_vacuum_threshold",
+	"compress_frozen_pages",
 	"fillfactor",
 	"log_autovacuum_min_duration",
 	"log_autoanalyze_min_duration",
@@ -2535,14 +2537,14 @@ match_previous_words(int pattern_id,
 	else if (Matches("ALTER", "INDEX", MatchAny, "RESET", "("))
 		COMPLETE_WITH("fillfactor",
 					  "deduplicate_items",	/* BTREE */
-					  "fastupdate", "gin_pending_list_limit",	/* GIN */
+					  "fastupdate", "gin_pending_list_limit", "deferred_cleanup",	/* GIN */
 					  "buffering",	/* GiST */
 					  "pages_per_range", "autosummarize"	/* BRIN */
 			);
 	else if (Matches("ALTER", "INDEX", MatchAny, "SET", "("))
 		COMPLETE_WITH("fillfactor =",
 					  "deduplicate_items =",	/* BTREE */
-					  "fastupdate =", "gin_pending_list_limit =",	/* GIN */
+					  "fastupdate =", "gin_pending_list_limit =", "deferred_cleanup =",	/* GIN */
 					  "buffering =",	/* GiST */
 					  "pages_per_range =", "autosummarize ="	/* BRIN */
 			);
@@ -2999,7 +3001,7 @@ match_previous_words(int pattern_id,
 	/* ALTER TABLE ALTER [COLUMN] <foo> SET ( */
 	else if (Matches("ALTER", "TABLE", MatchAny, "ALTER", "COLUMN", MatchAny, "SET", "(") ||
 			 Matches("ALTER", "TABLE", MatchAny, "ALTER", MatchAny, "SET", "("))
-		COMPLETE_WITH("n_distinct", "n_distinct_inherited");
+		COMPLETE_WITH("compression_level", "n_distinct", "n_distinct_inherited");
 	/* ALTER TABLE ALTER [COLUMN] <foo> SET COMPRESSION */
 	else if (Matches("ALTER", "TABLE", MatchAny, "ALTER", "COLUMN", MatchAny, "SET", "COMPRESSION") ||
 			 Matches("ALTER", "TABLE", MatchAny, "ALTER", MatchAny, "SET", "COMPRESSION"))
@@ -261,6 +261,8 @@ typedef struct IndexAmRoutine
 	bool		amcanmulticol;
 	/* does AM require scans to have a constraint on the first index column? */
 	bool		amoptionalkey;
+	/* does AM require scans to have a constraint on every key column? */
+	bool		amrequireallkeys;
 	/* does AM handle ScalarArrayOpExpr quals? */
 	bool		amsearcharray;
 	/* does AM handle IS NULL/IS NOT NULL quals? */
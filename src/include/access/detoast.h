@@ -63,6 +63,15 @@ extern varlena *detoast_attr_slice(varlena *attr,
 								   int32 sliceoffset,
 								   int32 slicelength);
 
+/* ----------
+ * detoast_attr_slice_is_cheap() -
+ *
+ *		Tells whether detoast_attr_slice can fetch any portion of a
+ *		toasted attribute without fetching or decompressing all of it.
+ * ----------
+ */
+extern bool detoast_attr_slice_is_cheap(varlena *attr);
+
 /* ----------
  * toast_raw_datum_size -
  *
@@ -24,6 +24,8 @@
 #include "nodes/primnodes.h"
 #include "storage/block.h"
 #include "storage/bufpage.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
 #include "utils/relcache.h"
 
 /*
@@ -250,4 +252,6 @@ typedef struct
 
 extern StrategyNumber gisttranslatecmptype(CompareType cmptype, Oid opfamily);
 
+extern void _gist_parallel_build_main(dsm_segment *seg, shm_toc *toc);
+
 #endif							/* GIST_H */
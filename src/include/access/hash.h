@@ -459,8 +459,10 @@ extern void _h_indexbuild(HSpool *hspool, Relation heapRel);
 
 /* hashutil.c */
 extern bool _hash_checkqual(IndexScanDesc scan, IndexTuple itup);
-extern uint32 _hash_datum2hashkey(Relation rel, Datum key);
-extern uint32 _hash_datum2hashkey_type(Relation rel, Datum key, Oid keytype);
+extern uint32 _hash_datum2hashkey(Relation rel, AttrNumber attno, Datum key);
+extern uint32 _hash_datum2hashkey_type(Relation rel, AttrNumber attno,
+									   Datum key, Oid keytype);
+extern uint32 _hash_combine_hashkeys(const uint32 *colhashes, int ncols);
 extern Bucket _hash_hashkey2bucket(uint32 hashkey, uint32 maxbucket,
 								   uint32 highmask, uint32 lowmask);
 extern uint32 _hash_spareindex(uint32 num_bucket);
@@ -58,5 +58,6 @@ extern Buffer RelationGetBufferForTuple(Relation relation, Size len,
 										BulkInsertStateData *bistate,
 										Buffer *vmbuffer, Buffer *vmbuffer_other,
 										int num_pages);
+extern Size HeapPageGetFSMFreeSpace(Relation relation, Buffer buffer);
 
 #endif							/* HIO_H */
@@ -1089,6 +1089,19 @@ typedef struct BTScanOpaqueData
 	 */
 	int			markItemIndex;	/* itemIndex, or -1 if not valid */
 
+	/*
+	 * Heap prefetching state for plain index scans.  prefetchMaximum is the
+	 * number of items to stay ahead of the scan (0 disables prefetching).
+	 * prefetchItem is the next currPos.items[] index to prefetch, valid only
+	 * while prefetchPage and prefetchDir still match the scan's position.
+	 * prefetchBlock is the heap block we most recently prefetched.
+	 */
+	int			prefetchMaximum;
+	int			prefetchItem;
+	BlockNumber prefetchPage;
+	ScanDirection prefetchDir;
+	BlockNumber prefetchBlock;
+
 	/* keep these last in struct for efficiency */
 	BTScanPosData currPos;		/* current position data */
 	BTScanPosData markPos;		/* marked position, if any */
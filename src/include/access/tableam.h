@@ -384,6 +384,27 @@ typedef struct TableAmRoutine
 									 ScanDirection direction,
 									 TupleTableSlot *slot);
 
+	/*
+	 * Optional callback to tell a scan what the caller is going to do with
+	 * the tuples it returns, so that AMs that store columns separately can
+	 * avoid reading data that is not needed.
+	 *
+	 * `attrs` holds the attribute numbers of the columns the caller looks
+	 * at, offset by FirstLowInvalidHeapAttributeNumber as done by
+	 * pull_varattnos(), or is NULL if all columns are needed.  The AM is free
+	 * to return any value, typically NULL, for the other columns.
+	 *
+	 * `keys` are conditions that all returned tuples must satisfy for the
+	 * caller to be interested in them.  Unlike the keys passed to
+	 * scan_begin, these are only a hint: the caller checks its quals itself,
+	 * so the AM may skip tuples that fail them but need not.
+	 *
+	 * Called right after scan_begin, and stays in effect across rescans.
+	 */
+	void		(*scan_set_pushdown) (TableScanDesc scan,
+									  Bitmapset *attrs,
+									  int nkeys, ScanKeyData *keys);
+
 	/*-----------
 	 * Optional functions to provide scanning for ranges of ItemPointers.
 	 * Implementations must either provide both of these functions, or neither
@@ -586,7 +607,8 @@ typedef struct TableAmRoutine
 								 bool wait,
 								 TM_FailureData *tmfd,
 								 LockTupleMode *lockmode,
-								 TU_UpdateIndexes *update_indexes);
+								 TU_UpdateIndexes *update_indexes,
+								 Bitmapset **unchanged_attrs);
 
 	/* see table_tuple_lock() for reference about parameters */
 	TM_Result	(*tuple_lock) (Relation rel,
@@ -1104,6 +1126,20 @@ table_scan_getnextslot(TableScanDesc sscan, ScanDirection direction, TupleTableS
 	return sscan->rs_rd->rd_tableam->scan_getnextslot(sscan, direction, slot);
 }
 
+/*
+ * Tell `scan` which columns the caller needs and which tuples it is
+ * interested in, if the AM can make use of that.  See scan_set_pushdown in
+ * TableAmRoutine.
+ */
+static inline void
+table_scan_set_pushdown(TableScanDesc sscan, Bitmapset *attrs,
+						int nkeys, ScanKeyData *keys)
+{
+	if (sscan->rs_rd->rd_tableam->scan_set_pushdown != NULL)
+		sscan->rs_rd->rd_tableam->scan_set_pushdown(sscan, attrs,
+													nkeys, keys);
+}
+
 /* ----------------------------------------------------------------------------
  * TID Range scanning related functions.
  * ----------------------------------------------------------------------------
@@ -1579,6 +1615,10 @@ table_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
  *	lockmode - filled with lock mode acquired on tuple
  *	update_indexes - in success cases this is set if new index entries
  *		are required for this tuple; see TU_UpdateIndexes
+ *	unchanged_attrs - if not NULL, in success cases this is set to the indexed
+ *		attributes whose values the update left unchanged, offset by
+ *		FirstLowInvalidHeapAttributeNumber.  An AM that cannot tell sets it
+ *		to NULL, so that no attribute is taken to be unchanged.
  *
  * Normal, successful return value is TM_Ok, which means we did actually
  * update it.  Failure return codes are TM_SelfModified, TM_Updated, and
@@ -1599,12 +1639,13 @@ table_tuple_update(Relation rel, ItemPointer otid, TupleTableSlot *slot,
 				   CommandId cid, uint32 options,
 				   Snapshot snapshot, Snapshot crosscheck,
 				   bool wait, TM_FailureData *tmfd, LockTupleMode *lockmode,
-				   TU_UpdateIndexes *update_indexes)
+				   TU_UpdateIndexes *update_indexes, Bitmapset **unchanged_attrs)
 {
 	return rel->rd_tableam->tuple_update(rel, otid, slot,
 										 cid, options, snapshot, crosscheck,
 										 wait, tmfd,
-										 lockmode, update_indexes);
+										 lockmode, update_indexes,
+										 unchanged_attrs);
 }
 
 /*
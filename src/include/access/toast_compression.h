@@ -30,15 +30,23 @@ extern PGDLLIMPORT int default_toast_compression;
  * Don't use these values for anything other than understanding the meaning
  * of the raw bits from a varlena; in particular, if the goal is to identify
  * a compression method, use the constants TOAST_PGLZ_COMPRESSION, etc.
- * below. We might someday support more than 4 compression methods, but
- * we can never have more than 4 values in this enum, because there are
- * only 2 bits available in the places where this is stored.
+ * below.  The IDs stored in va_extinfo must fit in 2 bits, so there can
+ * never be more than 4 of them; only TOAST_INVALID_COMPRESSION_ID, which is
+ * never stored, lies beyond that range.
+ *
+ * TOAST_SEGMENTED_COMPRESSION_ID is not a compression method of its own: it
+ * marks a large value that was split into segments compressed independently
+ * with one of the other methods, so that parts of it can be decompressed
+ * without the rest (see toast_internals.h).  TOAST_INVALID_COMPRESSION_ID is
+ * never written to disk.
  */
 typedef enum ToastCompressionId
 {
 	TOAST_PGLZ_COMPRESSION_ID = 0,
 	TOAST_LZ4_COMPRESSION_ID = 1,
-	TOAST_INVALID_COMPRESSION_ID = 2,
+	TOAST_ZSTD_COMPRESSION_ID = 2,
+	TOAST_SEGMENTED_COMPRESSION_ID = 3,
+	TOAST_INVALID_COMPRESSION_ID = 4,
 } ToastCompressionId;
 
 /*
@@ -48,6 +56,7 @@ typedef enum ToastCompressionId
  */
 #define TOAST_PGLZ_COMPRESSION			'p'
 #define TOAST_LZ4_COMPRESSION			'l'
+#define TOAST_ZSTD_COMPRESSION			'z'
 #define InvalidCompressionMethod		'\0'
 
 #define CompressionMethodIsValid(cm)  ((cm) != InvalidCompressionMethod)
@@ -74,6 +83,12 @@ extern varlena *lz4_decompress_datum(const varlena *value);
 extern varlena *lz4_decompress_datum_slice(const varlena *value,
 										   int32 slicelength);
 
+/* zstd compression/decompression routines */
+extern varlena *zstd_compress_datum(const varlena *value, int level);
+extern varlena *zstd_decompress_datum(const varlena *value);
+extern varlena *zstd_decompress_datum_slice(const varlena *value,
+											int32 slicelength);
+
 /* other stuff */
 extern ToastCompressionId toast_get_compression_id(varlena *attr);
 extern char CompressionNameToMethod(const char *compression);
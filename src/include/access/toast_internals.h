@@ -40,12 +40,44 @@ typedef struct toast_compress_header
 	do { \
 		Assert((len) > 0 && (len) <= VARLENA_EXTSIZE_MASK); \
 		Assert((cm_method) == TOAST_PGLZ_COMPRESSION_ID || \
-			   (cm_method) == TOAST_LZ4_COMPRESSION_ID); \
+			   (cm_method) == TOAST_LZ4_COMPRESSION_ID || \
+			   (cm_method) == TOAST_ZSTD_COMPRESSION_ID || \
+			   (cm_method) == TOAST_SEGMENTED_COMPRESSION_ID); \
 		((toast_compress_header *) (ptr))->tcinfo = \
 			(len) | ((uint32) (cm_method) << VARLENA_EXTSIZE_BITS); \
 	} while (0)
 
-extern Datum toast_compress_datum(Datum value, char cmethod);
+/*
+ * Values larger than TOAST_SEGMENTED_THRESHOLD are compressed in segments of
+ * TOAST_SEGMENT_SIZE raw bytes, each compressed on its own, so that a slice
+ * of the value can be fetched and decompressed without the rest.  Such a
+ * value has TOAST_SEGMENTED_COMPRESSION_ID in its toast_compress_header, and
+ * the header below follows it.  The segments come next, each starting at an
+ * int-aligned offset from the end of the header.  Each segment is stored as
+ * a complete varlena: compressed with the method in cmid, or plain if it
+ * did not compress.
+ */
+typedef struct toast_segmented_header
+{
+	uint8		cmid;			/* ToastCompressionId of the segments */
+	uint8		unused[3];
+	uint32		segsize;		/* raw size of every segment but the last */
+	uint32		nsegments;
+	uint32		segend[FLEXIBLE_ARRAY_MEMBER];	/* where each segment ends,
+												 * counted from the end of
+												 * the header */
+} toast_segmented_header;
+
+#define TOAST_SEGMENT_SIZE			(64 * 1024)
+#define TOAST_SEGMENTED_THRESHOLD	(2 * TOAST_SEGMENT_SIZE)
+
+#define TOAST_SEGMENTED_HDRSZ(nsegments) \
+	(offsetof(toast_segmented_header, segend) + (nsegments) * sizeof(uint32))
+#define TOAST_SEGMENT_START(hdr, i) \
+	((i) == 0 ? 0 : INTALIGN((hdr)->segend[(i) - 1]))
+
+extern Datum toast_compress_datum(Datum value, char cmethod, int cmlevel);
+extern ToastCompressionId toast_segmented_compression_id(varlena *attr);
 extern Oid	toast_get_valid_index(Oid toastoid, LOCKMODE lock);
 
 extern void toast_delete_datum(Relation rel, Datum value, bool is_speculative);
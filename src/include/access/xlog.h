@@ -17,6 +17,7 @@
 #include "datatype/timestamp.h"
 #include "lib/stringinfo.h"
 #include "nodes/pg_list.h"
+#include "storage/aio_types.h"
 
 
 /* Sync methods */
@@ -48,6 +49,7 @@ extern PGDLLIMPORT bool EnableHotStandby;
 extern PGDLLIMPORT bool fullPageWrites;
 extern PGDLLIMPORT bool wal_log_hints;
 extern PGDLLIMPORT int wal_compression;
+extern PGDLLIMPORT int wal_record_compression;
 extern PGDLLIMPORT bool wal_init_zero;
 extern PGDLLIMPORT bool wal_recycle;
 extern PGDLLIMPORT bool *wal_consistency_checking;
@@ -57,10 +59,14 @@ extern PGDLLIMPORT int CommitDelay;
 extern PGDLLIMPORT int CommitSiblings;
 extern PGDLLIMPORT bool track_wal_io_timing;
 extern PGDLLIMPORT int wal_decode_buffer_size;
+extern PGDLLIMPORT int wal_io_concurrency;
 extern PGDLLIMPORT int data_checksums;
 
 extern PGDLLIMPORT int CheckPointSegments;
 
+/* Upper limit for wal_io_concurrency */
+#define MAX_WAL_IO_CONCURRENCY 64
+
 /* Archive modes */
 typedef enum ArchiveMode
 {
@@ -301,6 +307,12 @@ extern bool IsInstallXLogFileSegmentActive(void);
 extern void ResetInstallXLogFileSegmentActive(void);
 extern void XLogShutdownWalRcv(void);
 
+/*
+ * AIO target and callbacks for asynchronous WAL writes.
+ */
+extern PGDLLIMPORT const PgAioTargetInfo aio_wal_target_info;
+extern PGDLLIMPORT const PgAioHandleCallbacks aio_wal_writev_cb;
+
 /*
  * Routines to start, stop, and get status of a base backup.
  */
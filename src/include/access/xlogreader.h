@@ -306,6 +306,13 @@ struct XLogReaderState
 	char	   *readRecordBuf;
 	uint32		readRecordBufSize;
 
+	/*
+	 * Buffer to decompress the data of the record being decoded into, if it
+	 * was written with XLR_COMPRESSED (expandable).
+	 */
+	char	   *decompressBuf;
+	uint32		decompressBufSize;
+
 	/* Buffer to hold error message */
 	char	   *errormsg_buf;
 	bool		errormsg_deferred;
@@ -394,6 +401,7 @@ extern bool WALRead(XLogReaderState *state,
 
 /* Functions for decoding an XLogRecord */
 
+extern size_t XLogRecordRawLength(const XLogRecord *record);
 extern size_t DecodeXLogRecordRequiredSpace(size_t xl_tot_len);
 extern bool DecodeXLogRecord(XLogReaderState *state,
 							 DecodedXLogRecord *decoded,
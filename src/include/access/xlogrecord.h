@@ -90,6 +90,16 @@ typedef struct XLogRecord
  */
 #define XLR_CHECK_CONSISTENCY	0x02
 
+/*
+ * If wal_record_compression is enabled, everything that follows the fixed
+ * XLogRecord header -- the block headers, the block data and the main data
+ * -- may be compressed as a whole.  In that case this flag is set, and the
+ * header is followed by an XLogRecordCompressHeader and the compressed
+ * bytes.  xl_tot_len and xl_crc cover the record as it is stored, i.e. the
+ * compressed form.  This flag is set internally by XLogInsert.
+ */
+#define XLR_COMPRESSED			0x04
+
 /*
  * Header info for block data appended to an XLOG record.
  *
@@ -226,6 +236,23 @@ typedef struct XLogRecordDataHeaderLong
 
 #define SizeOfXLogRecordDataHeaderLong (sizeof(uint8) + sizeof(uint32))
 
+/*
+ * Header that follows the XLogRecord header of a record with XLR_COMPRESSED
+ * set.  'raw_length' is the length of the data after decompression, not
+ * counting the XLogRecord header.
+ */
+typedef struct XLogRecordCompressHeader
+{
+	uint8		method;			/* XLR_COMPRESS_* */
+	/* followed by uint32 raw_length, unaligned */
+}			XLogRecordCompressHeader;
+
+#define SizeOfXLogRecordCompressHeader (sizeof(uint8) + sizeof(uint32))
+
+#define XLR_COMPRESS_PGLZ			1
+#define XLR_COMPRESS_LZ4			2
+#define XLR_COMPRESS_ZSTD			3
+
 /*
  * Block IDs used to distinguish different kinds of record fragments. Block
  * references are numbered from 0 to XLR_MAX_BLOCK_ID. A rmgr is free to use
@@ -0,0 +1,37 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogredoworker.h
+ *		Declarations for parallel WAL redo.
+ *
+ * Portions Copyright (c) 2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/include/access/xlogredoworker.h
+ *-------------------------------------------------------------------------
+ */
+#ifndef XLOGREDOWORKER_H
+#define XLOGREDOWORKER_H
+
+#include "access/xlogreader.h"
+
+/* GUCs */
+extern PGDLLIMPORT int recovery_parallel_workers;
+
+/*
+ * True in the startup process while WAL redo workers are running, and in the
+ * WAL redo workers themselves.
+ */
+extern PGDLLIMPORT bool ParallelRedoActive;
+
+/* Functions called by the startup process */
+extern void XLogRedoWorkersStart(void);
+extern void XLogRedoWorkersStop(void);
+extern bool XLogRedoWorkerDispatch(XLogReaderState *record);
+extern bool XLogRedoWorkersSync(void);
+extern void XLogRedoWorkersPrepareRecord(XLogReaderState *record);
+
+/* Entry point of a WAL redo worker */
+extern void RedoWorkerMain(Datum main_arg);
+
+#endif							/* XLOGREDOWORKER_H */
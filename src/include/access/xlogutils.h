@@ -60,8 +60,18 @@ extern PGDLLIMPORT HotStandbyState standbyState;
 #define InHotStandby (standbyState >= STANDBY_SNAPSHOT_PENDING)
 
 
+/* Callback for XLogForwardInvalidPages() */
+typedef void (*XLogInvalidPageCallback) (RelFileLocator locator,
+										 ForkNumber forkno,
+										 BlockNumber blkno,
+										 bool present, void *arg);
+
 extern bool XLogHaveInvalidPages(void);
 extern void XLogCheckInvalidPages(void);
+extern void XLogRememberInvalidPage(RelFileLocator locator, ForkNumber forkno,
+									BlockNumber blkno, bool present);
+extern void XLogForwardInvalidPages(XLogInvalidPageCallback callback,
+									void *arg);
 
 extern void XLogDropRelation(RelFileLocator rlocator, ForkNumber forknum);
 extern void XLogDropDatabase(Oid dbid);
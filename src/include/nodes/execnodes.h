@@ -1671,6 +1671,10 @@ typedef struct SeqScanState
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
 	struct SharedSeqScanInstrumentation *sinstrument;
+	bool		pushdown;		/* call table_scan_set_pushdown()? */
+	Bitmapset  *pushdown_attrs; /* columns needed, or NULL for all */
+	int			pushdown_nkeys; /* number of pushdown_keys */
+	ScanKeyData *pushdown_keys; /* quals usable as scan keys */
 } SeqScanState;
 
 /* ----------------
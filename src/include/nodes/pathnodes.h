@@ -971,6 +971,7 @@ typedef struct PartitionSchemeData *PartitionScheme;
 
 /* Bitmask of flags supported by table AMs */
 #define AMFLAG_HAS_TID_RANGE (1 << 0)
+#define AMFLAG_HAS_PUSHDOWN (1 << 1)
 
 typedef enum RelOptKind
 {
@@ -1435,6 +1436,7 @@ typedef struct IndexOptInfo
 	 */
 	bool		amcanorderbyop;
 	bool		amoptionalkey;
+	bool		amrequireallkeys;
 	bool		amsearcharray;
 	bool		amsearchnulls;
 	/* does AM have amgettuple interface? */
@@ -23,6 +23,7 @@
 typedef enum
 {
 	AVW_BRINSummarizeRange,
+	AVW_GINCleanPendingList,
 } AutoVacuumWorkItemType;
 
 
@@ -41,6 +42,7 @@ extern PGDLLIMPORT int autovacuum_anl_thresh;
 extern PGDLLIMPORT double autovacuum_anl_scale;
 extern PGDLLIMPORT int autovacuum_freeze_max_age;
 extern PGDLLIMPORT int autovacuum_multixact_freeze_max_age;
+extern PGDLLIMPORT int autovacuum_freeze_trigger_age;
 extern PGDLLIMPORT double autovacuum_vac_cost_delay;
 extern PGDLLIMPORT int autovacuum_vac_cost_limit;
 extern PGDLLIMPORT double autovacuum_freeze_score_weight;
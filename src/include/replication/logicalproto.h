@@ -36,13 +36,18 @@
  * LOGICALREP_PROTO_STREAM_PARALLEL_VERSION_NUM is the minimum protocol version
  * where we support applying large streaming transactions in parallel.
  * Introduced in PG16.
+ *
+ * LOGICALREP_PROTO_BATCH_VERSION_NUM is the minimum protocol version where
+ * consecutive inserts into the same relation are sent as Insert Batch
+ * messages.  Introduced in PG19.
  */
 #define LOGICALREP_PROTO_MIN_VERSION_NUM 1
 #define LOGICALREP_PROTO_VERSION_NUM 1
 #define LOGICALREP_PROTO_STREAM_VERSION_NUM 2
 #define LOGICALREP_PROTO_TWOPHASE_VERSION_NUM 3
 #define LOGICALREP_PROTO_STREAM_PARALLEL_VERSION_NUM 4
-#define LOGICALREP_PROTO_MAX_VERSION_NUM LOGICALREP_PROTO_STREAM_PARALLEL_VERSION_NUM
+#define LOGICALREP_PROTO_BATCH_VERSION_NUM 5
+#define LOGICALREP_PROTO_MAX_VERSION_NUM LOGICALREP_PROTO_BATCH_VERSION_NUM
 
 /*
  * Logical message types
@@ -60,6 +65,7 @@ typedef enum LogicalRepMsgType
 	LOGICAL_REP_MSG_COMMIT = 'C',
 	LOGICAL_REP_MSG_ORIGIN = 'O',
 	LOGICAL_REP_MSG_INSERT = 'I',
+	LOGICAL_REP_MSG_INSERT_BATCH = 'J',
 	LOGICAL_REP_MSG_UPDATE = 'U',
 	LOGICAL_REP_MSG_DELETE = 'D',
 	LOGICAL_REP_MSG_TRUNCATE = 'T',
@@ -97,6 +103,8 @@ typedef struct LogicalRepTupleData
 #define LOGICALREP_COLUMN_UNCHANGED	'u'
 #define LOGICALREP_COLUMN_TEXT		't'
 #define LOGICALREP_COLUMN_BINARY	'b' /* added in PG14 */
+#define LOGICALREP_COLUMN_REPEATED	'r' /* same as in the previous tuple of
+										 * an Insert Batch, added in PG19 */
 
 typedef uint32 LogicalRepRelId;
 
@@ -180,6 +188,28 @@ typedef struct LogicalRepRollbackPreparedTxnData
 	char		gid[GIDSIZE];
 } LogicalRepRollbackPreparedTxnData;
 
+/* Limits at which a batch of inserts is sent, even if more could follow */
+#define LOGICALREP_INSERT_BATCH_MAX_TUPLES	1000
+#define LOGICALREP_INSERT_BATCH_MAX_SIZE	(1024 * 1024)
+
+/*
+ * A batch of inserts into one relation, being assembled to be sent as one
+ * Insert Batch message.  The values are kept column by column, each column's
+ * values for all tuples in one buffer, which is how they are sent.
+ */
+typedef struct LogicalRepInsertBatch
+{
+	MemoryContext context;		/* holds the column buffers */
+	Oid			relid;			/* relation the tuples are sent as */
+	TransactionId xid;			/* as passed to logicalrep_write_insert() */
+	int			ntuples;		/* number of tuples in the batch */
+	int			ncols;			/* number of columns sent per tuple */
+	StringInfoData *colbufs;	/* encoded values, one buffer per column */
+	int		   *lastvalue;		/* offset of the last value in each buffer */
+	int		   *lastlen;		/* length of that value */
+	Size		size;			/* total size of the column buffers */
+} LogicalRepInsertBatch;
+
 /*
  * Transaction protocol information for stream abort.
  */
@@ -227,6 +257,16 @@ extern void logicalrep_write_insert(StringInfo out, TransactionId xid,
 									bool binary, Bitmapset *columns,
 									PublishGencolsType include_gencols_type);
 extern LogicalRepRelId logicalrep_read_insert(StringInfo in, LogicalRepTupleData *newtup);
+extern void logicalrep_insert_batch_add(LogicalRepInsertBatch *batch,
+										TransactionId xid, Relation rel,
+										TupleTableSlot *newslot, bool binary,
+										Bitmapset *columns,
+										PublishGencolsType include_gencols_type);
+extern void logicalrep_write_insert_batch(StringInfo out,
+										  LogicalRepInsertBatch *batch);
+extern LogicalRepRelId logicalrep_read_insert_batch(StringInfo in,
+													int *ntuples,
+													LogicalRepTupleData **newtups);
 extern void logicalrep_write_update(StringInfo out, TransactionId xid,
 									Relation rel, TupleTableSlot *oldslot,
 									TupleTableSlot *newslot, bool binary,
@@ -14,6 +14,7 @@
 #define PGOUTPUT_H
 
 #include "nodes/pg_list.h"
+#include "replication/logicalproto.h"
 
 typedef struct PGOutputData
 {
@@ -25,6 +26,9 @@ typedef struct PGOutputData
 	bool		in_streaming;	/* true if we are streaming a chunk of
 								 * transaction */
 
+	/* INSERTs not sent yet, with protocol version 5 and higher */
+	LogicalRepInsertBatch *insert_batch;
+
 	/* client-supplied info: */
 	uint32		protocol_version;
 	List	   *publication_names;
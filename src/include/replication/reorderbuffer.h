@@ -26,6 +26,7 @@
 /* GUC variables */
 extern PGDLLIMPORT int logical_decoding_work_mem;
 extern PGDLLIMPORT int debug_logical_replication_streaming;
+extern PGDLLIMPORT int logical_decoding_spill_compression;
 
 /* possible values for debug_logical_replication_streaming */
 typedef enum
@@ -34,6 +35,15 @@ typedef enum
 	DEBUG_LOGICAL_REP_STREAMING_IMMEDIATE,
 }			DebugLogicalRepStreamingMode;
 
+/* possible values for logical_decoding_spill_compression */
+typedef enum
+{
+	LOGICAL_SPILL_COMPRESSION_NONE = 0,
+	LOGICAL_SPILL_COMPRESSION_PGLZ,
+	LOGICAL_SPILL_COMPRESSION_LZ4,
+	LOGICAL_SPILL_COMPRESSION_ZSTD,
+}			LogicalSpillCompression;
+
 /*
  * Types of the change passed to a 'change' callback.
  *
@@ -26,6 +26,13 @@
 
 #define NUM_SYNC_REP_WAIT_MODE	3
 
+/*
+ * Buckets of the wait time distribution reported in pg_stat_replication.
+ * Bucket i counts waits shorter than 10^i * 100 microseconds, the last one
+ * counts all longer waits.
+ */
+#define SYNC_REP_WAIT_BUCKETS	6
+
 /* syncRepState */
 #define SYNC_REP_NOT_WAITING		0
 #define SYNC_REP_WAITING			1
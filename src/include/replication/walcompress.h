@@ -0,0 +1,34 @@
+/*-------------------------------------------------------------------------
+ *
+ * walcompress.h
+ *		Streaming compression of WAL sent over physical replication.
+ *
+ * Portions Copyright (c) 2010-2026, PostgreSQL Global Development Group
+ *
+ * src/include/replication/walcompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _WALCOMPRESS_H
+#define _WALCOMPRESS_H
+
+#include "common/compression.h"
+#include "lib/stringinfo.h"
+
+/*
+ * State of one direction of a compressed WAL stream.  Compression contexts
+ * are kept across messages, so that every message can refer back to WAL sent
+ * in earlier messages of the same stream.
+ */
+typedef struct WalStreamCompressor WalStreamCompressor;
+
+extern bool WalStreamCompressionSupported(pg_compress_algorithm algorithm);
+extern WalStreamCompressor *WalStreamCompressorCreate(pg_compress_algorithm algorithm,
+													  bool decompress);
+extern void WalStreamCompressorFree(WalStreamCompressor *ws);
+extern size_t WalStreamCompress(WalStreamCompressor *ws, const char *src,
+								size_t srclen, StringInfo dst);
+extern void WalStreamDecompress(WalStreamCompressor *ws, const char *src,
+								size_t srclen, char *dst, size_t rawlen);
+
+#endif							/* _WALCOMPRESS_H */
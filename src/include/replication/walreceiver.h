@@ -16,6 +16,7 @@
 
 #include "access/xlog.h"
 #include "access/xlogdefs.h"
+#include "common/compression.h"
 #include "pgtime.h"
 #include "port/atomics.h"
 #include "replication/logicalproto.h"
@@ -28,6 +29,7 @@
 extern PGDLLIMPORT int wal_receiver_status_interval;
 extern PGDLLIMPORT int wal_receiver_timeout;
 extern PGDLLIMPORT bool hot_standby_feedback;
+extern PGDLLIMPORT int wal_receiver_compression;
 
 /*
  * MAXCONNINFO: maximum size of a connection string.
@@ -177,6 +179,7 @@ typedef struct
 		struct
 		{
 			TimeLineID	startpointTLI;	/* Starting timeline */
+			pg_compress_algorithm compression;	/* Stream compression */
 		}			physical;
 		struct
 		{
@@ -13,9 +13,11 @@
 #define _WALSENDER_PRIVATE_H
 
 #include "access/xlog.h"
+#include "common/compression.h"
 #include "lib/ilist.h"
 #include "nodes/nodes.h"
 #include "nodes/replnodes.h"
+#include "port/atomics.h"
 #include "replication/syncrep.h"
 #include "storage/condition_variable.h"
 #include "storage/shmem.h"
@@ -76,6 +78,23 @@ typedef struct WalSnd
 	TimestampTz replyTime;
 
 	ReplicationKind kind;
+
+	/*
+	 * Compression of the physical WAL stream, and the number of bytes of WAL
+	 * sent before and after compression since the stream was started.
+	 */
+	pg_compress_algorithm compression;
+	uint64		compressionRawBytes;
+	uint64		compressionSentBytes;
+
+	/*
+	 * Number and total duration (in microseconds) of the synchronous
+	 * replication waits this walsender has released, and their distribution
+	 * over SYNC_REP_WAIT_BUCKETS buckets; see SyncRepWakeQueue().
+	 */
+	uint64		syncWaitCount;
+	uint64		syncWaitTime;
+	uint64		syncWaitBuckets[SYNC_REP_WAIT_BUCKETS];
 } WalSnd;
 
 extern PGDLLIMPORT WalSnd *MyWalSnd;
@@ -91,9 +110,12 @@ typedef struct
 
 	/*
 	 * Current location of the head of the queue. All waiters should have a
-	 * waitLSN that follows this value. Protected by SyncRepLock.
+	 * waitLSN that follows this value.  Only advanced while holding
+	 * SyncRepLock, but may be read without it: the value never goes
+	 * backwards, so a backend that sees its commit LSN already covered
+	 * doesn't need to queue up at all.
 	 */
-	XLogRecPtr	lsn[NUM_SYNC_REP_WAIT_MODE];
+	pg_atomic_uint64 lsn[NUM_SYNC_REP_WAIT_MODE];
 
 	/*
 	 * Status of data related to the synchronous standbys.  Waiting backends
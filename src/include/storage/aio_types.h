@@ -69,6 +69,15 @@ typedef union PgAioTargetData
 		bool		is_temp:1;	/* proc can be inferred by owning AIO */
 		bool		skip_fsync:1;
 	}			smgr;
+
+	struct
+	{
+		uint64		segno;		/* WAL segment number */
+		uint32		tli;		/* timeline of the segment */
+		uint32		offset;		/* offset of the write in the segment */
+		uint32		nbytes;		/* length of the write */
+		int			open_flags; /* sync bits the segment was opened with */
+	}			wal;
 } PgAioTargetData;
 
 
@@ -209,13 +209,22 @@ typedef PageHeaderData *PageHeader;
  * PD_PAGE_FULL is set if an UPDATE doesn't find enough free space in the
  * page for its new tuple version; this suggests that a prune is needed.
  * Again, this is just a hint.
+ *
+ * PD_COMPRESSIBLE is set by VACUUM on all-frozen heap pages of tables with
+ * compress_frozen_pages enabled, and asks for the page to be written to disk
+ * in compressed form.  It is a hint as well.
+ *
+ * PD_COMPRESSED is only ever set in the on-disk image of a compressed page,
+ * never on a page in a buffer; see PageCompress().
  */
 #define PD_HAS_FREE_LINES	0x0001	/* are there any unused line pointers? */
 #define PD_PAGE_FULL		0x0002	/* not enough free space for new tuple? */
 #define PD_ALL_VISIBLE		0x0004	/* all tuples on page are visible to
 									 * everyone */
+#define PD_COMPRESSIBLE		0x0008	/* write page in compressed form? */
+#define PD_COMPRESSED		0x0010	/* image is a compressed page */
 
-#define PD_VALID_FLAG_BITS	0x0007	/* OR of all valid pd_flags bits */
+#define PD_VALID_FLAG_BITS	0x001F	/* OR of all valid pd_flags bits */
 
 /*
  * Page layout version number 0 is for pre-7.3 Postgres releases.
@@ -467,6 +476,28 @@ PageClearAllVisible(Page page)
 	((PageHeader) page)->pd_flags &= ~PD_ALL_VISIBLE;
 }
 
+static inline bool
+PageIsCompressible(const PageData *page)
+{
+	return ((const PageHeaderData *) page)->pd_flags & PD_COMPRESSIBLE;
+}
+static inline void
+PageSetCompressible(Page page)
+{
+	((PageHeader) page)->pd_flags |= PD_COMPRESSIBLE;
+}
+static inline void
+PageClearCompressible(Page page)
+{
+	((PageHeader) page)->pd_flags &= ~PD_COMPRESSIBLE;
+}
+
+static inline bool
+PageIsCompressed(const PageData *page)
+{
+	return ((const PageHeaderData *) page)->pd_flags & PD_COMPRESSED;
+}
+
 static inline TransactionId
 PageGetPruneXid(const PageData *page)
 {
@@ -502,6 +533,13 @@ do { \
 #define PIV_IGNORE_CHECKSUM_FAILURE (1 << 2)
 #define PIV_ZERO_BUFFERS_ON_ERROR (1 << 3)
 
+/*
+ * PageCompress() only produces an image if it leaves at least this many
+ * bytes at the end of the block unused, as filesystems that compress data
+ * store it in units of about this size.
+ */
+#define PAGE_COMPRESS_UNIT		4096
+
 #define PageAddItem(page, item, size, offsetNumber, overwrite, is_heap) \
 	PageAddItemExtended(page, item, size, offsetNumber, \
 						((overwrite) ? PAI_OVERWRITE : 0) | \
@@ -538,5 +576,7 @@ extern void PageIndexTupleDeleteNoCompact(Page page, OffsetNumber offnum);
 extern bool PageIndexTupleOverwrite(Page page, OffsetNumber offnum,
 									const void *newtup, Size newsize);
 extern void PageSetChecksum(Page page, BlockNumber blkno);
+extern Page PageCompress(const PageData *page);
+extern bool PageDecompress(Page page);
 
 #endif							/* BUFPAGE_H */
@@ -347,6 +347,8 @@ typedef struct PGPROC
 	XLogRecPtr	waitLSN;		/* waiting for this LSN or higher */
 	int			syncRepState;	/* wait state for sync rep */
 	dlist_node	syncRepLinks;	/* list link if process is in syncrep queue */
+	TimestampTz syncRepWaitStart;	/* time the wait started, set together
+									 * with waitLSN */
 
 	/************************************************************************
 	 * Support for group XID clearing
@@ -377,6 +379,15 @@ typedef struct PGPROC
 	XLogRecPtr	clogGroupMemberLsn; /* WAL location of commit record for clog
 									 * group member */
 
+	/************************************************************************
+	 * Support for group WAL flush
+	 ************************************************************************/
+
+	bool		walFlushGroupMember;	/* true, if member of WAL flush group */
+	pg_atomic_uint32 walFlushGroupNext; /* next WAL flush group member */
+	XLogRecPtr	walFlushGroupMemberLsn; /* WAL location up to which the
+										 * member needs WAL flushed */
+
 	/************************************************************************
 	 * Status reporting
 	 ************************************************************************/
@@ -486,6 +497,8 @@ typedef struct PROC_HDR
 	pg_atomic_uint32 procArrayGroupFirst;
 	/* First pgproc waiting for group transaction status update */
 	pg_atomic_uint32 clogGroupFirst;
+	/* First pgproc waiting for group WAL flush */
+	pg_atomic_uint32 walFlushGroupFirst;
 
 	/*
 	 * Current slot numbers of some auxiliary processes. There can be only one
@@ -95,6 +95,13 @@ typedef struct catctup
 	 */
 	dlist_node	cache_elem;		/* member for CatCache.cc_bucket[] dlist */
 
+	/*
+	 * Each tuple is also a member of a dlist of the tuples of all caches,
+	 * kept in LRU order, from which tuples are evicted when the caches go
+	 * over catalog_cache_memory_limit.
+	 */
+	dlist_node	lru_elem;		/* member for CatCacheHeader.ch_lru dlist */
+
 	int			ct_magic;		/* for identifying CatCTup entries */
 #define CT_MAGIC   0x57261502
 
@@ -187,12 +194,19 @@ typedef struct catcacheheader
 {
 	slist_head	ch_caches;		/* head of list of CatCache structs */
 	int			ch_ntup;		/* # of tuples in all caches */
+	MemoryContext ch_context;	/* holds the entries of all caches */
+	dlist_head	ch_lru;			/* tuples of all caches, most recently used
+								 * first */
+	Size		ch_nbytes;		/* space taken by entries of all caches */
 } CatCacheHeader;
 
 
 /* this extern duplicates utils/memutils.h... */
 extern PGDLLIMPORT MemoryContext CacheMemoryContext;
 
+/* GUC parameter */
+extern PGDLLIMPORT int catalog_cache_memory_limit;
+
 extern void CreateCacheMemoryContext(void);
 
 extern CatCache *InitCatCache(int id, Oid reloid, Oid indexoid,
@@ -429,6 +429,9 @@ extern JsonbValue *findJsonbValueFromContainer(JsonbContainer *container,
 extern JsonbValue *getKeyJsonValueFromContainer(JsonbContainer *container,
 												const char *keyVal, int keyLen,
 												JsonbValue *res);
+extern JsonbValue *getKeyJsonValueFromDatum(Datum jsonb,
+											const char *keyVal, int keyLen,
+											JsonbValue *res);
 extern JsonbValue *getIthJsonbValueFromContainer(JsonbContainer *container,
 												 uint32 i);
 extern void pushJsonbValue(JsonbInState *pstate,
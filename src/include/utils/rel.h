@@ -356,6 +356,8 @@ typedef struct StdRdOptions
 	 * to freeze. 0 if disabled, -1 if unspecified.
 	 */
 	double		vacuum_max_eager_freeze_failure_rate;
+	bool		compress_frozen_pages;	/* compress all-frozen pages on disk */
+	bool		adaptive_fillfactor;	/* reserve space for HOT updates */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR			10
@@ -411,6 +413,25 @@ typedef struct StdRdOptions
 	((relation)->rd_options ? \
 	 ((StdRdOptions *) (relation)->rd_options)->parallel_workers : (defaultpw))
 
+/*
+ * RelationUsesAdaptiveFillFactor
+ *		Returns whether free space should be reserved on pages for HOT
+ *		updates, based on the updates they have seen.  Note multiple eval
+ *		of argument!
+ */
+#define RelationUsesAdaptiveFillFactor(relation) \
+	((relation)->rd_options ? \
+	 ((StdRdOptions *) (relation)->rd_options)->adaptive_fillfactor : false)
+
+/*
+ * RelationCompressesFrozenPages
+ *		Returns whether VACUUM should mark the relation's all-frozen pages
+ *		to be written in compressed form.  Note multiple eval of argument!
+ */
+#define RelationCompressesFrozenPages(relation) \
+	((relation)->rd_options ? \
+	 ((StdRdOptions *) (relation)->rd_options)->compress_frozen_pages : false)
+
 /* ViewOptions->check_option values */
 typedef enum ViewOptCheckOption
 {
@@ -0,0 +1,86 @@
+
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Check that pages of tables with compress_frozen_pages are written in
+# compressed form only when their rewrite is protected by full-page images,
+# and that they read back correctly once they are no longer in shared
+# buffers.
+
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init(no_data_checksums => 1);
+$node->append_conf('postgresql.conf', 'wal_log_hints = off');
+$node->append_conf('postgresql.conf', 'autovacuum = off');
+$node->start;
+
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE compressed (i int, t text)
+	WITH (compress_frozen_pages = true, autovacuum_enabled = false);
+INSERT INTO compressed
+	SELECT g, repeat('x', 100) || g FROM generate_series(1, 5000) g;
+});
+
+my $expected = $node->safe_psql('postgres',
+	q{SELECT count(*), sum(i), md5(string_agg(t, ',' ORDER BY i)) FROM compressed}
+);
+
+# Whether the second half of the first block on disk is all zeroes.  An
+# ordinary heap page keeps its tuples at the end of the block, while a
+# compressed one only uses the space after its header.
+sub first_block_tail_is_zero
+{
+	return $node->safe_psql(
+		'postgres', q{
+SELECT pg_read_binary_file(pg_relation_filepath('compressed'), 4096, 4096)
+	= decode(repeat('00', 4096), 'hex')
+});
+}
+
+# Without data checksums or wal_log_hints, VACUUM must not mark the pages.
+$node->safe_psql('postgres',
+	'VACUUM (FREEZE, DISABLE_PAGE_SKIPPING) compressed');
+$node->safe_psql('postgres', 'CHECKPOINT');
+is(first_block_tail_is_zero(), 'f',
+	'pages are not compressed when hint bit changes are not WAL-logged');
+
+# With wal_log_hints, they are compressed when written out.
+$node->append_conf('postgresql.conf', 'wal_log_hints = on');
+$node->restart;
+$node->safe_psql('postgres',
+	'VACUUM (FREEZE, DISABLE_PAGE_SKIPPING) compressed');
+$node->safe_psql('postgres', 'CHECKPOINT');
+is(first_block_tail_is_zero(), 't', 'all-frozen pages are compressed');
+
+# Restarting empties shared buffers, so the pages must be decompressed when
+# they are read back.
+$node->restart;
+is( $node->safe_psql(
+		'postgres',
+		q{SELECT count(*), sum(i), md5(string_agg(t, ',' ORDER BY i)) FROM compressed}
+	),
+	$expected,
+	'rows read back from compressed pages');
+
+# Modifying a row makes its page be written uncompressed again.
+$node->safe_psql('postgres',
+	"UPDATE compressed SET t = t WHERE i = 1");
+$node->safe_psql('postgres', 'CHECKPOINT');
+is(first_block_tail_is_zero(), 'f', 'modified page is written uncompressed');
+
+$node->restart;
+is( $node->safe_psql(
+		'postgres',
+		q{SELECT count(*), sum(i), md5(string_agg(t, ',' ORDER BY i)) FROM compressed}
+	),
+	$expected,
+	'rows read back after the page was rewritten');
+
+$node->stop;
+
+done_testing();
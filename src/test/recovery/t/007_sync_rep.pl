@@ -218,4 +218,18 @@ standby4|1|quorum),
 	'all standbys are considered as candidates for quorum sync standbys',
 	'ANY 2(*)');
 
+# Commits waiting for the quorum are accounted to the walsenders that
+# released them.
+$node_primary->safe_psql('postgres',
+	'CREATE TABLE sync_wait_test AS SELECT 1 AS a');
+$node_primary->safe_psql('postgres', 'INSERT INTO sync_wait_test VALUES (2)');
+is( $node_primary->safe_psql(
+		'postgres', qq(SELECT sum(sync_wait_count) >= 1,
+  sum(sync_wait_count) = sum((SELECT sum(b) FROM unnest(sync_wait_histogram) b)),
+  bool_and(cardinality(sync_wait_histogram) = 6),
+  bool_and(sync_wait_time >= 0)
+FROM pg_stat_replication)),
+	't|t|t|t',
+	'sync replication waits are reported in pg_stat_replication');
+
 done_testing();
@@ -0,0 +1,67 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test streaming replication with the WAL stream compressed, using each
+# compression method supported by the build.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my @methods;
+push @methods, 'lz4' if check_pg_config("#define USE_LZ4 1");
+push @methods, 'zstd' if check_pg_config("#define USE_ZSTD 1");
+
+if (!@methods)
+{
+	plan skip_all => 'no compression method for WAL streaming supported by this build';
+}
+
+my $primary = PostgreSQL::Test::Cluster->new('primary');
+$primary->init(allows_streaming => 1);
+$primary->start;
+
+my $backup_name = 'my_backup';
+$primary->backup($backup_name);
+
+$primary->safe_psql('postgres', 'CREATE TABLE tab_int (a int, b text)');
+
+foreach my $method (@methods)
+{
+	my $standby = PostgreSQL::Test::Cluster->new("standby_$method");
+	$standby->init_from_backup($primary, $backup_name, has_streaming => 1);
+	$standby->append_conf('postgresql.conf',
+		"wal_receiver_compression = $method");
+	$standby->start;
+
+	$primary->safe_psql('postgres',
+		"INSERT INTO tab_int SELECT g, repeat('x', 100) FROM generate_series(1, 10000) g"
+	);
+	$primary->wait_for_replay_catchup($standby);
+
+	is( $primary->safe_psql(
+			'postgres',
+			"SELECT compression, compression_ratio > 1 FROM pg_stat_replication WHERE application_name = 'standby_$method'"
+		),
+		"$method|t",
+		"WAL stream is compressed with $method");
+
+	is( $standby->safe_psql('postgres', 'SELECT count(*) FROM tab_int'),
+		$primary->safe_psql('postgres', 'SELECT count(*) FROM tab_int'),
+		"standby using $method is caught up");
+
+	# Restart streaming, which must start a new compressed stream
+	$standby->restart;
+	$primary->safe_psql('postgres',
+		"INSERT INTO tab_int SELECT g, 'after restart' FROM generate_series(1, 1000) g"
+	);
+	$primary->wait_for_replay_catchup($standby);
+
+	is( $standby->safe_psql('postgres', 'SELECT count(*) FROM tab_int'),
+		$primary->safe_psql('postgres', 'SELECT count(*) FROM tab_int'),
+		"standby using $method is caught up after restart");
+
+	$standby->stop;
+}
+
+done_testing();
@@ -0,0 +1,50 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test writing WAL through the AIO subsystem with wal_io_concurrency, with
+# each io_method supported by the build, and check that everything written
+# survives a crash.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my @methods = ('worker', 'sync');
+push @methods, 'io_uring' if check_pg_config("#define USE_LIBURING 1");
+
+foreach my $method (@methods)
+{
+	my $node = PostgreSQL::Test::Cluster->new("node_$method");
+	$node->init;
+	$node->append_conf(
+		'postgresql.conf', qq(
+io_method = $method
+wal_io_concurrency = 8
+io_combine_limit = 2
+wal_buffers = 4MB
+));
+	$node->start;
+
+	$node->safe_psql('postgres', 'CREATE TABLE tab_int (a int, b text)');
+
+	# One large transaction, so that WAL is written in large batches that
+	# are split into many IOs, crossing segment boundaries.
+	$node->safe_psql('postgres',
+		"INSERT INTO tab_int SELECT g, repeat('x', 200) FROM generate_series(1, 100000) g"
+	);
+
+	# And many small commits, each writing and flushing a little WAL.
+	$node->safe_psql('postgres',
+		"DO \$\$BEGIN FOR i IN 1..500 LOOP INSERT INTO tab_int VALUES (i, 'small'); COMMIT; END LOOP; END\$\$"
+	);
+
+	$node->stop('immediate');
+	$node->start;
+
+	is($node->safe_psql('postgres', 'SELECT count(*) FROM tab_int'),
+		'100500', "$method: all rows are recovered after a crash");
+
+	$node->stop;
+}
+
+done_testing();
@@ -0,0 +1,91 @@
+
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test replay with WAL redo workers: a standby using recovery_parallel_workers
+# must end up with the same data as the primary, including after a crash.
+# shared_buffers is kept at its minimum so that the workers write out pages
+# they replayed before the startup process reports them as replayed.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $primary = PostgreSQL::Test::Cluster->new('primary');
+$primary->init(allows_streaming => 1);
+$primary->start;
+
+my $backup_name = 'my_backup';
+$primary->backup($backup_name);
+
+my $standby = PostgreSQL::Test::Cluster->new('standby');
+$standby->init_from_backup($primary, $backup_name, has_streaming => 1);
+$standby->append_conf(
+	'postgresql.conf', qq(
+recovery_parallel_workers = 4
+shared_buffers = 128kB
+));
+$standby->start;
+$standby->wait_for_log(qr/using 4 WAL redo workers/);
+
+# Compare the contents of the tables on the primary and the standby, with
+# both sequential and index scans.
+sub check_standby
+{
+	my ($test_name) = @_;
+
+	local $Test::Builder::Level = $Test::Builder::Level + 1;
+
+	my $queries = q{
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*), sum(a), md5(string_agg(b, ',' ORDER BY a)) FROM tab_int
+	WHERE a > 0;
+RESET enable_seqscan;
+SELECT count(*), sum(a), md5(string_agg(b, ',' ORDER BY a)) FROM tab_int;
+SELECT count(*), md5(string_agg(t::text, ',' ORDER BY id)) FROM tab_multi;
+};
+
+	$primary->wait_for_replay_catchup($standby);
+	is($standby->safe_psql('postgres', $queries),
+		$primary->safe_psql('postgres', $queries), $test_name);
+	return;
+}
+
+$primary->safe_psql(
+	'postgres', q{
+CREATE TABLE tab_int (a int PRIMARY KEY, b text);
+CREATE TABLE tab_multi (id int, t text);
+INSERT INTO tab_int SELECT g, repeat('x', 50) || g FROM generate_series(1, 20000) g;
+});
+# COPY inserts its rows with multi-insert records
+$primary->safe_psql('postgres',
+	"COPY tab_multi (id) FROM STDIN;\n" . join("\n", 1 .. 5000) . "\n\\.\n");
+
+# HOT and non-HOT updates, deletes and row locks
+$primary->safe_psql(
+	'postgres', q{
+UPDATE tab_int SET b = b || 'u' WHERE a % 3 = 0;
+UPDATE tab_int SET a = a + 100000 WHERE a % 7 = 0;
+DELETE FROM tab_int WHERE a % 11 = 0;
+SELECT count(*) FROM (SELECT * FROM tab_int WHERE a % 13 = 0 FOR UPDATE) s;
+UPDATE tab_multi SET t = 'row ' || id WHERE id % 2 = 0;
+});
+check_standby('data replayed by WAL redo workers matches the primary');
+
+# Crash the standby, and let it replay again from its last restartpoint
+# after more changes.
+$standby->stop('immediate');
+$primary->safe_psql(
+	'postgres', q{
+INSERT INTO tab_int SELECT g, repeat('y', 50) || g FROM generate_series(20001, 30000) g;
+UPDATE tab_int SET b = b || 'v' WHERE a % 5 = 0;
+DELETE FROM tab_int WHERE a % 17 = 0;
+});
+$standby->start;
+check_standby('data matches the primary after a crash of the standby');
+
+$primary->stop;
+$standby->stop;
+
+done_testing();
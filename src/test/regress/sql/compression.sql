@@ -81,6 +81,24 @@ SELECT pg_column_compression(f1) FROM cmdata;
 SELECT length(f1) FROM cmdata;
 SELECT length(f1) FROM cmmove1;
 
+-- large values are compressed in segments, and slices of them can be read
+CREATE TABLE cmsegmented (f1 text COMPRESSION pglz, f2 jsonb COMPRESSION pglz);
+INSERT INTO cmsegmented
+  SELECT string_agg(g::text || repeat('x', g % 7), ','),
+         jsonb_object_agg('k' || g, repeat('v', g % 10))
+  FROM generate_series(1, 50000) g;
+SELECT pg_column_compression(f1) AS f1_cm, pg_column_compression(f2) AS f2_cm,
+       pg_column_size(f1) < octet_length(f1) AS f1_compressed
+  FROM cmsegmented;
+SELECT substr(f1, 1, 20) = substr(f1 || '', 1, 20) AS prefix_ok,
+       substr(f1, 200001, 100000) = substr(f1 || '', 200001, 100000) AS middle_ok,
+       substr(f1, 390000) = substr(f1 || '', 390000) AS suffix_ok
+  FROM cmsegmented;
+SELECT f2 -> 'k12345' AS k12345, f2 ->> 'k50000' AS k50000,
+       f2 -> 'k0' AS k0, f2 ->> 'k7' AS k7
+  FROM cmsegmented;
+DROP TABLE cmsegmented;
+
 CREATE TABLE badcompresstbl (a text COMPRESSION I_Do_Not_Exist_Compression); -- fails
 CREATE TABLE badcompresstbl (a text);
 ALTER TABLE badcompresstbl ALTER a SET COMPRESSION I_Do_Not_Exist_Compression; -- fails
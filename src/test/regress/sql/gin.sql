@@ -19,6 +19,15 @@ vacuum gin_test_tbl; -- flush the fastupdate buffers
 
 select gin_clean_pending_list('gin_test_idx'); -- nothing to flush
 
+-- Defer pending list cleanup to autovacuum.  Whether or not autovacuum gets
+-- to it, the inserting session cleans up once the list reaches twice its
+-- limit, and searches see the pending entries either way.
+alter index gin_test_idx set (deferred_cleanup = on, gin_pending_list_limit = 64);
+insert into gin_test_tbl select array[4, g] from generate_series(1, 2000) g;
+select count(*) from gin_test_tbl where i @> array[4];
+alter index gin_test_idx reset (deferred_cleanup, gin_pending_list_limit);
+delete from gin_test_tbl where i @> array[4];
+
 -- Test vacuuming
 delete from gin_test_tbl where i @> array[2];
 vacuum gin_test_tbl;
@@ -180,6 +180,20 @@ reset enable_indexonlyscan;
 
 drop table gist_tbl;
 
+-- test a parallel sorted build
+create table gist_par_tbl (p point);
+insert into gist_par_tbl
+  select point(0.05*i, 0.05*i) from generate_series(0,10000) as i;
+begin;
+set local min_parallel_table_scan_size = 0;
+set local max_parallel_maintenance_workers = 4;
+create index gist_par_tbl_idx on gist_par_tbl using gist (p);
+commit;
+set enable_seqscan=off;
+select count(*) from gist_par_tbl where p <@ box(point(0,0), point(100.02,100.02));
+reset enable_seqscan;
+drop table gist_par_tbl;
+
 -- test an unlogged table, mostly to get coverage of gistbuildempty
 create unlogged table gist_tbl (b box);
 create index gist_tbl_box_index on gist_tbl using gist (b);
@@ -346,6 +346,23 @@ INSERT INTO hash_heap_float4 VALUES (1.1,1);
 CREATE INDEX hash_idx ON hash_heap_float4 USING hash (x);
 DROP TABLE hash_heap_float4 CASCADE;
 
+-- Multi-column hash index; usable only with a qual on every column
+CREATE TABLE hash_multi_heap (a int4, b text);
+INSERT INTO hash_multi_heap
+  SELECT i % 100, 'v' || (i / 100) FROM generate_series(0, 9999) i;
+CREATE INDEX hash_multi_idx ON hash_multi_heap USING hash (a, b);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF)
+SELECT * FROM hash_multi_heap WHERE a = 42 AND b = 'v7';
+SELECT * FROM hash_multi_heap WHERE a = 42 AND b = 'v7';
+SELECT * FROM hash_multi_heap WHERE a = 42::int8 AND b = 'v7';
+SELECT * FROM hash_multi_heap WHERE a = 42 AND b = 'v100';
+SELECT count(*) FROM hash_multi_heap WHERE a = 42;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE hash_multi_heap;
+
 -- Test out-of-range fillfactor values
 CREATE INDEX hash_f8_index2 ON hash_f8_heap USING hash (random float8_ops)
 	WITH (fillfactor=9);
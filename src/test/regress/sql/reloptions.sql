@@ -94,6 +94,19 @@ INSERT INTO reloptions_test VALUES (1, NULL), (NULL, NULL);
 VACUUM (FREEZE, DISABLE_PAGE_SKIPPING) reloptions_test;
 SELECT pg_relation_size('reloptions_test') = 0;
 
+-- Test compress_frozen_pages option
+CREATE TABLE reloptions_compress(i INT, t text)
+	WITH (compress_frozen_pages=true, autovacuum_enabled=false);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_compress'::regclass;
+INSERT INTO reloptions_compress SELECT g, repeat('x', 20) FROM generate_series(1, 1000) g;
+VACUUM (FREEZE, DISABLE_PAGE_SKIPPING) reloptions_compress;
+CHECKPOINT;
+SELECT count(*), sum(i) FROM reloptions_compress;
+ALTER TABLE reloptions_compress SET (compress_frozen_pages=false);
+VACUUM (FREEZE, DISABLE_PAGE_SKIPPING) reloptions_compress;
+SELECT count(*), sum(i) FROM reloptions_compress;
+DROP TABLE reloptions_compress;
+
 -- Test toast.* options
 DROP TABLE reloptions_test;
 
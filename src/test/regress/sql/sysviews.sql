@@ -42,6 +42,21 @@ from contexts c1, contexts c2
 where c2.name = 'CacheMemoryContext'
 and c1.path[c2.level] = c2.path[c2.level];
 
+-- The catalog cache entries, whose space catalog_cache_memory_limit
+-- bounds, are kept in a child of CacheMemoryContext.
+select c1.name, c1.total_bytes > 0
+from pg_backend_memory_contexts c1, pg_backend_memory_contexts c2
+where c1.name = 'CatCacheMemoryContext'
+and c2.name = 'CacheMemoryContext'
+and c1.path[c2.level] = c2.path[c2.level];
+
+-- Looking up many catalog entries under a small cache limit evicts entries
+-- along the way.
+set catalog_cache_memory_limit = '64kB';
+select count(*) > 1000 as ok
+from pg_proc where pg_get_function_arguments(oid) is not null;
+reset catalog_cache_memory_limit;
+
 -- At introduction, pg_config had 23 entries; it may grow
 select count(*) > 20 as ok from pg_config;
 
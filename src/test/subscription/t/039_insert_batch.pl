@@ -0,0 +1,107 @@
+
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test that inserts are sent and applied as Insert Batch messages with
+# protocol version 5
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_publisher = PostgreSQL::Test::Cluster->new('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+my $node_subscriber = PostgreSQL::Test::Cluster->new('subscriber');
+$node_subscriber->init;
+$node_subscriber->start;
+
+my $ddl = qq(
+	CREATE TABLE tab_batch (a int primary key, b text, c int);
+	CREATE TABLE tab_part (a int primary key, b text) PARTITION BY RANGE (a);
+	CREATE TABLE tab_part_1 PARTITION OF tab_part FOR VALUES FROM (0) TO (500);
+	CREATE TABLE tab_part_2 PARTITION OF tab_part FOR VALUES FROM (500) TO (MAXVALUE);
+	CREATE TABLE tab_trig (a int primary key, b text);
+);
+$node_publisher->safe_psql('postgres', $ddl);
+$node_subscriber->safe_psql('postgres', $ddl);
+
+# A BEFORE ROW trigger on the subscriber prevents the use of multi-insert
+$node_subscriber->safe_psql(
+	'postgres', qq(
+	CREATE FUNCTION upper_b() RETURNS trigger LANGUAGE plpgsql AS \$\$
+	BEGIN
+		NEW.b := upper(NEW.b);
+		RETURN NEW;
+	END \$\$;
+	CREATE TRIGGER upper_b BEFORE INSERT ON tab_trig
+		FOR EACH ROW EXECUTE FUNCTION upper_b();
+	ALTER TABLE tab_trig ENABLE ALWAYS TRIGGER upper_b;
+));
+
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR TABLE tab_batch, tab_part, tab_trig WITH (publish_via_partition_root = true)"
+);
+
+# Check the messages sent for a multi-row insert, using a separate slot
+$node_publisher->safe_psql('postgres',
+	"SELECT pg_create_logical_replication_slot('test_slot', 'pgoutput')");
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab_batch SELECT g, 'x', NULL FROM generate_series(1, 10) g"
+);
+
+my $result = $node_publisher->safe_psql(
+	'postgres', qq(
+		SELECT string_agg(chr(get_byte(data, 0)), '')
+		FROM pg_logical_slot_get_binary_changes('test_slot', NULL, NULL,
+			'proto_version', '5',
+			'publication_names', 'tap_pub')
+));
+is($result, 'BRJC', 'inserts are sent in one insert batch message');
+
+$node_publisher->safe_psql('postgres',
+	"SELECT pg_drop_replication_slot('test_slot')");
+$node_publisher->safe_psql('postgres', "TRUNCATE tab_batch");
+
+$node_subscriber->safe_psql('postgres',
+	"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr' PUBLICATION tap_pub"
+);
+$node_subscriber->wait_for_subscription_sync($node_publisher, 'tap_sub');
+
+# Batches mixing repeated, NULL and distinct values, broken up by an update
+# in the middle and by the size limit of the batch
+$node_publisher->safe_psql(
+	'postgres', qq(
+	BEGIN;
+	INSERT INTO tab_batch SELECT g, CASE WHEN g % 3 = 0 THEN NULL ELSE 'v' || (g / 10) END, g / 100 FROM generate_series(1, 2500) g;
+	UPDATE tab_batch SET c = -1 WHERE a = 7;
+	INSERT INTO tab_batch SELECT g, 'after update', 1 FROM generate_series(2501, 2600) g;
+	INSERT INTO tab_part SELECT g, 'p' || (g % 2) FROM generate_series(1, 1000) g;
+	INSERT INTO tab_trig SELECT g, 'x' FROM generate_series(1, 100) g;
+	COMMIT;
+));
+$node_publisher->wait_for_catchup('tap_sub');
+
+my $query =
+  "SELECT count(*), count(b), sum(c), md5(string_agg(b, ',' ORDER BY a)) FROM tab_batch";
+is( $node_subscriber->safe_psql('postgres', $query),
+	$node_publisher->safe_psql('postgres', $query),
+	'batched inserts are replicated');
+
+$query =
+  "SELECT count(*), md5(string_agg(b, ',' ORDER BY a)) FROM tab_part";
+is( $node_subscriber->safe_psql('postgres', $query),
+	$node_publisher->safe_psql('postgres', $query),
+	'batched inserts into a partitioned table are replicated');
+
+is( $node_subscriber->safe_psql('postgres',
+		"SELECT count(*), min(b), max(b) FROM tab_trig"),
+	'100|X|X',
+	'BEFORE ROW triggers fire for batched inserts');
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');
+
+done_testing();
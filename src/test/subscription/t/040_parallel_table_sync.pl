@@ -0,0 +1,79 @@
+
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test the initial synchronization of a table copied over several
+# connections to the publisher
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_publisher = PostgreSQL::Test::Cluster->new('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+my $node_subscriber = PostgreSQL::Test::Cluster->new('subscriber');
+$node_subscriber->init;
+$node_subscriber->append_conf(
+	'postgresql.conf', qq(
+max_sync_connections_per_table = 4
+min_parallel_table_scan_size = 8kB
+));
+$node_subscriber->start;
+
+my $ddl = "CREATE TABLE tab_big (a int primary key, b text)";
+$node_publisher->safe_psql('postgres', $ddl);
+$node_subscriber->safe_psql('postgres', $ddl);
+
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab_big SELECT g, repeat('x', g % 100) FROM generate_series(1, 20000) g"
+);
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR TABLE tab_big");
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub_filter FOR TABLE tab_big WHERE (a % 3 = 0)");
+
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+my $query = "SELECT count(*), sum(a), md5(string_agg(b, ',' ORDER BY a)) FROM tab_big";
+
+foreach my $binary ('false', 'true')
+{
+	$node_subscriber->safe_psql('postgres',
+		"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr' PUBLICATION tap_pub WITH (binary = $binary)"
+	);
+	$node_subscriber->wait_for_subscription_sync($node_publisher, 'tap_sub');
+
+	is( $node_subscriber->safe_psql('postgres', $query),
+		$node_publisher->safe_psql('postgres', $query),
+		"table copied over several connections with binary = $binary");
+
+	# Changes made after the copy are replicated on top of it
+	$node_publisher->safe_psql('postgres',
+		"UPDATE tab_big SET b = 'updated' WHERE a % 1000 = 0");
+	$node_publisher->wait_for_catchup('tap_sub');
+
+	is( $node_subscriber->safe_psql('postgres', $query),
+		$node_publisher->safe_psql('postgres', $query),
+		"changes replicated after copy with binary = $binary");
+
+	$node_subscriber->safe_psql('postgres', "DROP SUBSCRIPTION tap_sub");
+	$node_subscriber->safe_psql('postgres', "TRUNCATE tab_big");
+}
+
+# Row filters are applied to every range
+$node_subscriber->safe_psql('postgres',
+	"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr' PUBLICATION tap_pub_filter"
+);
+$node_subscriber->wait_for_subscription_sync($node_publisher, 'tap_sub');
+
+is( $node_subscriber->safe_psql('postgres', $query),
+	$node_publisher->safe_psql('postgres',
+		"SELECT count(*), sum(a), md5(string_agg(b, ',' ORDER BY a)) FROM tab_big WHERE a % 3 = 0"
+	),
+	'table copied over several connections with a row filter');
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');
+
+done_testing();